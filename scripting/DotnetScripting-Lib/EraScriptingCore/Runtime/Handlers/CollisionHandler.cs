@@ -15,4 +15,15 @@ public class CollisionHandler : IEHandler
                 Debug.LogError("Failed to call OnCollisionEnter.");
         }
     }
+
+    // All collision events of one frame. events points to count pairs of entity ids.
+    [UnmanagedCaller]
+    public static unsafe void HandleCollisions(IntPtr events, int count)
+    {
+        int* ids = (int*)events;
+        for (int i = 0; i < count; i++)
+        {
+            HandleCollision(ids[2 * i], ids[2 * i + 1]);
+        }
+    }
 }
@@ -8,6 +8,7 @@ public delegate void Call();
 public delegate Task CallMain();
 public delegate void CallUpdate(float dt);
 public delegate void CallHandleColls(int id1, int id2);
+public delegate void CallHandleCollsBatch(IntPtr events, int count);
 public delegate void CallHandleTrs(IntPtr trs, int id);
 
 public delegate void CallAddComp(int id, IntPtr comp);
@@ -782,8 +782,8 @@ void animation_component::drawCurrentSkeleton(const ref<multi_mesh>& mesh, const
 			}
 			else
 			{
-				*vertices++ = { skeleton.joints[joint.parentID].bindTransform.col3.xyz, limbTypeColors[parentJoint.limbType] };
-				*vertices++ = { joint.bindTransform.col3.xyz, limbTypeColors[parentJoint.limbType] };
+				*vertices++ = { skeleton.joints[joint.parentID].bindTransform.cols[3].xyz, limbTypeColors[parentJoint.limbType] };
+				*vertices++ = { joint.bindTransform.cols[3].xyz, limbTypeColors[parentJoint.limbType] };
 			}
 		}
 		else
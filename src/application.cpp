@@ -31,6 +31,7 @@
 #include <px/physics/px_joint.h>
 #include <px/physics/px_character_controller_component.h>
 #include <px/core/px_tasks.h>
+#include <px/core/px_scene_query_batch.h>
 #include <px/core/px_aggregate.h>
 #include <px/features/px_ragdoll.h>
 #include <EraScriptingLauncher-Lib/src/script.h>
@@ -95,47 +96,39 @@ struct updatePhysicsAndScriptingData
 	const user_input& input;
 };
 
-void updatePhysXPhysicsAndScripting(escene& currentScene, enative_scripting_linker core, float dt, const user_input& in)
+NODISCARD job_handle updatePhysXPhysicsAndScripting(escene& currentScene, enative_scripting_linker core, float dt, const user_input& in)
 {
 	updatePhysicsAndScriptingData data = { core, currentScene, dt, in};
 
-	highPriorityJobQueue.createJob<updatePhysicsAndScriptingData>([](updatePhysicsAndScriptingData& data, job_handle)
+	return highPriorityJobQueue.createJob<updatePhysicsAndScriptingData>([](updatePhysicsAndScriptingData& data, job_handle)
 	{
 		{
 			px_physics_engine::get()->update(data.deltaTime);
 
-			while (px_physics_engine::collisionQueue.size())
+			// Only this job consumes the queue, so the batch can be static.
+			static collision_handling_data collisionBatch[px_collision_event_queue::capacity];
+			uint32 numCollisions = px_physics_engine::collisionQueue.drain(collisionBatch, px_collision_event_queue::capacity);
+			if (numCollisions)
 			{
-				const auto& c = px_physics_engine::collisionQueue.back();
-				px_physics_engine::collisionQueue.pop();
-				data.core.handle_coll(c.id1, c.id2);
+				data.core.handle_colls((intptr_t)collisionBatch, numCollisions);
+			}
+
+			if (uint32 numDropped = px_physics_engine::collisionQueue.resetNumDropped())
+			{
+				LOG_WARNING("Physics> Collision event queue overflowed. Dropped %u events", numDropped);
 			}
 		}
 
 		updateScripting(data);
 
 		data.core.handleInput(reinterpret_cast<uintptr_t>(&data.input.keyboard[0]));
-	}, data).submitNow();
-
-	const auto& nav_objects = data.scene.group(component_group<navigation_component, transform_component>);
-
-	if (nav_objects.size())
-	{
-		struct nav_process_data
-		{
-			decltype(nav_objects) objects;
-		};
-
-		nav_process_data nav_data{ nav_objects };
 
-		lowPriorityJobQueue.createJob<nav_process_data>([](nav_process_data& data, job_handle)
+		// Navigation moves the transforms, so it runs here instead of concurrently with the rest of the frame.
+		for (auto [entityHandle, nav, transform] : data.scene.group(component_group<navigation_component, transform_component>).each())
 		{
-			for (auto [entityHandle, nav, transform] : data.objects.each())
-			{
-				nav.processPath();
-			}
-		}, nav_data).submitNow();
-	}
+			nav.processPath();
+		}
+	}, data);
 }
 
 void updateScripting(updatePhysicsAndScriptingData& data)
@@ -307,6 +300,18 @@ void application::initialize(main_renderer* renderer, editor_panels* editorPanel
 		std::cout << "Overlapping: " << overlap_info.isOverlapping << "\n";
 		std::cout << "Results: " << overlap_info.results.size() << "\n";
 
+		// The same queries through the batched interface, which is meant for many queries per frame.
+		px_scene_query_batch queryBatch(2);
+		uint32 batchedRaycast = queryBatch.addRaycast(vec3(20.f, 34.5f, -5.f), vec3(0, -1, 0), 100.f); // Starts just below SpherePX1.
+		uint32 batchedOverlap = queryBatch.addOverlapCapsule(vec3(0, -5, 0), 1.5f, 3.0f, quat::identity);
+		queryBatch.execute();
+
+		if (queryBatch.getNumHits(batchedRaycast))
+		{
+			std::cout << "Batched raycast. Dist: " << queryBatch.getHits(batchedRaycast)[0].distance << "\n";
+		}
+		std::cout << "Batched overlap results: " << queryBatch.getNumHits(batchedOverlap) << "\n";
+
 		editor.physicsSettings.collisionBeginCallback = [rng = random_number_generator{ 519431 }](const collision_begin_event& e) mutable
 		{
 			float speed = length(e.relativeVelocity);
@@ -531,12 +536,18 @@ void application::update(const user_input& input, float dt)
 	}
 
 	static float physicsTimer = 0.f;
-	physicsStep(scene, stackArena, physicsTimer, physics_settings(), dt);
+	physics_settings physicsSettings;
+	physicsSettings.asyncStepping = true;
+	setPhysicsFocusPoints(scene, &camera.position, 1); // Only used if physicsSettings.enableRegions is set.
 
+	// PhysX, scripting and navigation modify the registry, so they run as continuation of the physics step. From here until waitForPhysicsStep
+	// below, this update only animates and renders, which is allowed while the step runs (see physics_settings::asyncStepping).
+	job_handle physXAndScriptingJob = {};
 	if (this->scene.isPausable())
 	{
-		updatePhysXPhysicsAndScripting(scene, linker, dt, input);
+		physXAndScriptingJob = updatePhysXPhysicsAndScripting(scene, linker, dt, input);
 	}
+	physicsStep(scene, stackArena, physicsTimer, physicsSettings, dt, physXAndScriptingJob);
 
 	// Particles
 #if 0
@@ -651,6 +662,9 @@ void application::update(const user_input& input, float dt)
 	renderer->setSun(sun);
 	renderer->setCamera(camera);
 
+	// End of the asynchronous physics step. The main thread jobs, and everything outside of this update (file drops, editor panels), may modify the scene.
+	waitForPhysicsStep();
+
 	executeMainThreadJobs();
 }
 
@@ -5,6 +5,7 @@
 #include "core/camera_controller.h"
 #include "geometry/mesh.h"
 #include "core/math.h"
+#include "core/job_system.h"
 #include "scene/scene.h"
 #include "rendering/main_renderer.h"
 #include "particles/fire_particle_system.h"
@@ -30,7 +31,8 @@ NODISCARD bool editFireParticleSystem(fire_particle_system& particleSystem);
 NODISCARD bool editBoidParticleSystem(boid_particle_system& particleSystem);
 
 struct updatePhysicsAndScriptingData;
-void updatePhysXPhysicsAndScripting(escene& currentScene, enative_scripting_linker core, float dt, const user_input& in);
+// Creates, but does not submit, the job which updates PhysX, scripting and navigation. It is passed to physicsStep as continuation.
+NODISCARD job_handle updatePhysXPhysicsAndScripting(escene& currentScene, enative_scripting_linker core, float dt, const user_input& in);
 void updateScripting(updatePhysicsAndScriptingData& data);
 
 struct application
@@ -1,8 +1,14 @@
 #include "pch.h"
 #define PROFILING_INTERNAL
 #include "cpu_profiling.h"
+
+// The profiler window needs the DX context and ImGui. PHYSICS_ONLY builds (e.g. the headless physics benchmark) only record and summarize.
+#ifndef PHYSICS_ONLY
 #include "dx/dx_context.h"
 #include "core/imgui.h"
+#endif
+
+#include <unordered_map>
 
 bool cpuProfilerWindowOpen = false;
 
@@ -13,6 +19,8 @@ std::atomic<uint32> cpuProfileCompletelyWritten[2];
 profile_event cpuProfileEvents[2][MAX_NUM_CPU_PROFILE_EVENTS];
 profile_stat cpuProfileStats[2][MAX_NUM_CPU_PROFILE_STATS];
 
+#ifndef PHYSICS_ONLY
+
 #define MAX_NUM_CPU_PROFILE_THREADS 128
 #define MAX_NUM_CPU_PROFILE_FRAMES 1024
 
@@ -86,6 +94,92 @@ static void initializeNewFrame(cpu_profile_frame& oldFrame, cpu_profile_frame& n
 	}
 }
 
+#endif
+
+static cpu_profile_summary_entry& findSummaryEntry(std::vector<cpu_profile_summary_entry>& entries, const char* name)
+{
+	for (cpu_profile_summary_entry& e : entries)
+	{
+		if (e.name == name)
+		{
+			return e;
+		}
+	}
+	cpu_profile_summary_entry& e = entries.emplace_back();
+	e.name = name;
+	return e;
+}
+
+static void addToSummaryEntry(cpu_profile_summary_entry& e, double value)
+{
+	e.total += value;
+	e.maximum = (e.count == 0) ? value : max(e.maximum, value);
+	++e.count;
+}
+
+void cpuProfilingCollectSummary(cpu_profile_summary& summary)
+{
+	uint32 arrayIndex = _CPU_PROFILE_GET_ARRAY_INDEX(cpuProfileIndex);
+	uint32 currentIndex = cpuProfileIndex.exchange((1 - arrayIndex) << 31);
+
+	profile_event* events = cpuProfileEvents[arrayIndex];
+	uint32 numEvents = _CPU_PROFILE_GET_EVENT_INDEX(currentIndex);
+	profile_stat* stats = cpuProfileStats[arrayIndex];
+	uint32 numStats = _CPU_PROFILE_GET_STAT_INDEX(currentIndex);
+	uint32 numWrites = numEvents + numStats;
+
+	while (numWrites > cpuProfileCompletelyWritten[arrayIndex]) {}
+	cpuProfileCompletelyWritten[arrayIndex] = 0;
+
+	static const uint64 clockFrequency = cpuProfilingClockFrequency();
+
+	// Events of one thread are recorded in program order, so begin and end events can be matched with a stack per thread without sorting.
+	// Blocks, which are still open at the time of the call, are dropped.
+	std::unordered_map<uint32, std::vector<const profile_event*>> openBlocks;
+
+	for (uint32 i = 0; i < numEvents; ++i)
+	{
+		const profile_event& e = events[i];
+		if (e.type == profile_event_begin_block)
+		{
+			openBlocks[e.threadID].push_back(&e);
+		}
+		else if (e.type == profile_event_end_block)
+		{
+			auto& stack = openBlocks[e.threadID];
+			if (!stack.empty())
+			{
+				const profile_event* begin = stack.back();
+				stack.pop_back();
+
+				double duration = (double)(e.timestamp - begin->timestamp) / clockFrequency * 1000.0;
+				addToSummaryEntry(findSummaryEntry(summary.blocks, e.name), duration);
+			}
+		}
+	}
+
+	for (uint32 i = 0; i < numStats; ++i)
+	{
+		const profile_stat& stat = stats[i];
+
+		double value;
+		switch (stat.type)
+		{
+			case profile_stat_type_bool: value = stat.boolValue ? 1.0 : 0.0; break;
+			case profile_stat_type_int32: value = (double)stat.int32Value; break;
+			case profile_stat_type_uint32: value = (double)stat.uint32Value; break;
+			case profile_stat_type_int64: value = (double)stat.int64Value; break;
+			case profile_stat_type_uint64: value = (double)stat.uint64Value; break;
+			case profile_stat_type_float: value = (double)stat.floatValue; break;
+			default: continue;
+		}
+
+		addToSummaryEntry(findSummaryEntry(summary.stats, stat.label), value);
+	}
+}
+
+#ifndef PHYSICS_ONLY
+
 void cpuProfilingResolveTimeStamps()
 {
 	uint32 currentFrame = profileFrameWriteIndex;
@@ -141,8 +235,7 @@ void cpuProfilingResolveTimeStamps()
 			uint64 frameEndTimestamp;
 			if (handleProfileEvent(events, i, numEvents, stack[threadIndex], depth[threadIndex], frame->profileBlockPool, frame->totalNumProfileBlocks, frameEndTimestamp, false))
 			{
-				static uint64 clockFrequency;
-				static bool performanceFrequencyQueried = QueryPerformanceFrequency((LARGE_INTEGER*)&clockFrequency);
+				static const uint64 clockFrequency = cpuProfilingClockFrequency();
 
 				cpu_profile_frame* previousFrame;
 				if (!pauseRecording)
@@ -314,3 +407,5 @@ void cpuProfilingResolveTimeStamps()
 }
 
 #endif
+
+#endif
@@ -5,8 +5,50 @@
 
 extern bool cpuProfilerWindowOpen;
 
+// Accumulated profile blocks and stats for tools without the profiler window (e.g. headless benchmarks). Entries are matched by name.
+struct cpu_profile_summary_entry
+{
+	std::string name;
+	double total = 0.0; // Milliseconds for blocks, sum of the values for stats.
+	double maximum = 0.0;
+	uint32 count = 0;
+};
+
+struct cpu_profile_summary
+{
+	std::vector<cpu_profile_summary_entry> blocks;
+	std::vector<cpu_profile_summary_entry> stats; // Only numeric stats.
+};
+
 #if ENABLE_CPU_PROFILING
 
+#if !defined(_WIN32)
+#include <chrono>
+#endif
+
+// Timestamps of profile events, in ticks of cpuProfilingClockFrequency.
+inline uint64 cpuProfilingTimestamp()
+{
+#if defined(_WIN32)
+	uint64 result;
+	QueryPerformanceCounter((LARGE_INTEGER*)&result);
+	return result;
+#else
+	return (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline uint64 cpuProfilingClockFrequency()
+{
+#if defined(_WIN32)
+	uint64 result;
+	QueryPerformanceFrequency((LARGE_INTEGER*)&result);
+	return result;
+#else
+	return 1000000000ull;
+#endif
+}
+
 #define _CPU_PROFILE_BLOCK_(counter, name) cpu_profile_block_recorder COMPOSITE_VARNAME(__PROFILE_BLOCK, counter)(name)
 #define CPU_PROFILE_BLOCK(name) _CPU_PROFILE_BLOCK_(__COUNTER__, name)
 
@@ -31,7 +73,7 @@ extern bool cpuProfilerWindowOpen;
 	e->threadID = getThreadIDFast(); \
 	e->name = name_; \
 	e->type = type_; \
-	QueryPerformanceCounter((LARGE_INTEGER*)&e->timestamp); \
+	e->timestamp = cpuProfilingTimestamp(); \
 	cpuProfileCompletelyWritten[arrayIndex].fetch_add(1, std::memory_order_release); // Mark this event as written. Release means that the compiler may not reorder the previous writes after this.
 
 struct cpu_profile_block_recorder
@@ -104,7 +146,13 @@ inline void CPU_PROFILE_STAT(const char* label, uint64 value) { _CPU_PROFILE_STA
 inline void CPU_PROFILE_STAT(const char* label, float value) { _CPU_PROFILE_STAT(label, value, floatValue, profile_stat_type_float); }
 inline void CPU_PROFILE_STAT(const char* label, const char* value) { _CPU_PROFILE_STAT(label, value, stringValue, profile_stat_type_string); }
 
+#ifndef PHYSICS_ONLY
 void cpuProfilingResolveTimeStamps();
+#endif
+
+// Headless alternative to cpuProfilingResolveTimeStamps. Consumes all events and stats recorded since the last call and adds them to the summary.
+// Must be called often enough, that the recording arrays don't overflow (e.g. once per frame). Don't mix with cpuProfilingResolveTimeStamps.
+void cpuProfilingCollectSummary(cpu_profile_summary& summary);
 
 #undef recordProfileEvent
 
@@ -119,16 +167,13 @@ struct cpu_print_profile_block_recorder
 	cpu_print_profile_block_recorder(const char* name)
 		: name(name)
 	{
-		QueryPerformanceCounter((LARGE_INTEGER*)&start);
+		start = cpuProfilingTimestamp();
 	}
 
 	~cpu_print_profile_block_recorder()
 	{
-		uint64 end;
-		QueryPerformanceCounter((LARGE_INTEGER*)&end);
-
-		uint64 clockFrequency;
-		QueryPerformanceFrequency((LARGE_INTEGER*)&clockFrequency);
+		uint64 end = cpuProfilingTimestamp();
+		uint64 clockFrequency = cpuProfilingClockFrequency();
 
 		float duration = (float)(end - start) / clockFrequency * 1000.f;
 		std::cout << "Profile block '" << name << "' took " << duration << "ms.\n";
@@ -142,6 +187,7 @@ struct cpu_print_profile_block_recorder
 
 #define cpuProfilingFrameEndMarker(...)
 #define cpuProfilingResolveTimeStamps(...)
+#define cpuProfilingCollectSummary(...)
 
 #define CPU_PRINT_PROFILE_BLOCK(...)
 
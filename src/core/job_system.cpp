@@ -1,22 +1,25 @@
 #include "pch.h"
 #include "job_system.h"
 #include "math.h"
-#include "imgui.h"
 
 void job_queue::initialize(uint32 numThreads, uint32 threadOffset, int threadPriority, const wchar* description)
 {
     queue = moodycamel::ConcurrentQueue<int32>(capacity);
+    this->numThreads = numThreads;
 
     for (uint32 i = 0; i < numThreads; ++i)
     {
         std::thread thread([this, i]() { threadFunc(i); });
 
+#if defined(_WIN32)
         HANDLE handle = (HANDLE)thread.native_handle();
         SetThreadPriority(handle, threadPriority);
 
         uint64 affinityMask = 1ull << (i + threadOffset);
         SetThreadAffinityMask(handle, affinityMask);
         SetThreadDescription(handle, description);
+#endif
+        // Elsewhere (only PHYSICS_ONLY tools), the workers are plain std::threads, left to the OS scheduler without priorities, pinning or names.
 
         thread.detach();
     }
@@ -152,15 +155,23 @@ job_queue mainThreadJobQueue;
 
 void initializeJobSystem()
 {
+#if defined(_WIN32)
     HANDLE handle = GetCurrentThread();
     SetThreadAffinityMask(handle, 1);
     SetThreadPriority(handle, THREAD_PRIORITY_HIGHEST);
     CloseHandle(handle);
 
+    const int normalPriority = THREAD_PRIORITY_NORMAL;
+    const int belowNormalPriority = THREAD_PRIORITY_BELOW_NORMAL;
+#else
+    const int normalPriority = 0;
+    const int belowNormalPriority = 0;
+#endif
+
     //uint32 numHardwareThreads = std::thread::hardware_concurrency();
 
-    highPriorityJobQueue.initialize(4, 1, THREAD_PRIORITY_NORMAL, L"High priority worker");
-    lowPriorityJobQueue.initialize(4, 5, THREAD_PRIORITY_BELOW_NORMAL, L"Low priority worker");
+    highPriorityJobQueue.initialize(4, 1, normalPriority, L"High priority worker");
+    lowPriorityJobQueue.initialize(4, 5, belowNormalPriority, L"Low priority worker");
     mainThreadJobQueue.initialize(0, 0, 0, 0);
 }
 
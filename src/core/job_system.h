@@ -70,6 +70,11 @@ struct job_queue
 
     void waitForCompletion();
 
+    // Executes one pending job on the calling thread, if there is one. Lets threads which wait for external work help out instead of idling.
+    bool executeNextJob();
+
+    uint32 getNumThreads() const { return numThreads; }
+
 private:
     friend struct job_handle;
 
@@ -79,7 +84,6 @@ private:
 
     int32 allocateJob();
     void finishJob(int32 handle);
-    bool executeNextJob();
     void threadFunc(int32 threadIndex);
 
     moodycamel::ConcurrentQueue<int32> queue;
@@ -91,6 +95,7 @@ private:
     job_queue_entry allJobs[capacity];
     std::atomic<uint32> nextFreeJob = 0;
 
+    uint32 numThreads = 0;
 
     std::condition_variable wakeCondition;
     std::mutex wakeMutex;
@@ -100,5 +105,44 @@ extern job_queue highPriorityJobQueue;
 extern job_queue lowPriorityJobQueue;
 extern job_queue mainThreadJobQueue;
 
+// Splits [0, count) into ranges of at least minRangeSize elements and calls func(begin, end) for each of them on the given queue.
+// Blocks until all ranges are processed. The calling thread helps executing jobs while waiting.
+template <typename func_t>
+void parallelFor(job_queue& queue, uint32 count, uint32 minRangeSize, const func_t& func)
+{
+    static constexpr uint32 maxNumRanges = 16;
+
+    if (count == 0)
+        return;
+
+    uint32 rangeSize = max(minRangeSize, (count + maxNumRanges - 1) / maxNumRanges);
+    if (rangeSize >= count)
+    {
+        func(0u, count);
+        return;
+    }
+
+    struct parallel_for_data
+    {
+        const func_t* func;
+        uint32 begin;
+        uint32 end;
+    };
+
+    job_handle parent = queue.createJob<parallel_for_data>([](parallel_for_data& data, job_handle) {}, { &func, 0, 0 });
+
+    for (uint32 begin = 0; begin < count; begin += rangeSize)
+    {
+        parallel_for_data data = { &func, begin, min(begin + rangeSize, count) };
+        queue.createJob<parallel_for_data>([](parallel_for_data& data, job_handle)
+        {
+            (*data.func)(data.begin, data.end);
+        }, data, parent).submitNow();
+    }
+
+    parent.submitNow();
+    parent.waitForCompletion();
+}
+
 void initializeJobSystem();
 void executeMainThreadJobs();
\ No newline at end of file
@@ -246,7 +246,11 @@ mat3 transpose(const mat3& a)
 mat4 transpose(const mat4& a)
 {
 	mat4 result = a;
-	transpose(result.f40, result.f41, result.f42, result.f43);
+#if ROW_MAJOR
+	transpose(result.rows[0].f4, result.rows[1].f4, result.rows[2].f4, result.rows[3].f4);
+#else
+	transpose(result.cols[0].f4, result.cols[1].f4, result.cols[2].f4, result.cols[3].f4);
+#endif
 	return result;
 }
 
@@ -221,6 +221,7 @@ union vec3
 	{
 		float r, g, b;
 	};
+#if defined(_MSC_VER)
 	struct
 	{
 		vec2 xy;
@@ -231,6 +232,10 @@ union vec3
 		float x;
 		vec2 yz;
 	};
+#else
+	// GCC and Clang allow neither members with constructors nor repeated names in anonymous structs, so only the swizzles at offset 0 exist there.
+	vec2 xy;
+#endif
 	float data[3];
 
 	vec3() {}
@@ -251,6 +256,7 @@ union vec4
 	{
 		float r, g, b, a;
 	};
+#if defined(_MSC_VER)
 	struct
 	{
 		vec3 xyz;
@@ -266,6 +272,10 @@ union vec4
 		float x;
 		vec3 yzw;
 	};
+#else
+	vec3 xyz;
+	vec2 xy;
+#endif
 	w4_float f4;
 	float data[4];
 
@@ -284,11 +294,20 @@ union quat
 	{
 		float x, y, z, w;
 	};
+#if defined(_MSC_VER)
 	struct
 	{
 		vec3 v;
 		float cosHalfAngle;
 	};
+#else
+	vec3 v;
+	struct
+	{
+		float vData[3];
+		float cosHalfAngle;
+	};
+#endif
 	vec4 v4;
 	w4_float f4;
 
@@ -327,11 +346,13 @@ union mat2
 			m00, m01,
 			m10, m11;
 	};
+#if defined(_MSC_VER)
 	struct
 	{
 		vec2 row0;
 		vec2 row1;
 	};
+#endif
 	vec2 rows[2];
 #else
 	struct
@@ -340,11 +361,13 @@ union mat2
 			m00, m10,
 			m01, m11;
 	};
+#if defined(_MSC_VER)
 	struct
 	{
 		vec2 col0;
 		vec2 col1;
 	};
+#endif
 	vec2 cols[2];
 #endif
 	float m[4];
@@ -368,12 +391,14 @@ union mat3
 			m10, m11, m12,
 			m20, m21, m22;
 	};
+#if defined(_MSC_VER)
 	struct
 	{
 		vec3 row0;
 		vec3 row1;
 		vec3 row2;
 	};
+#endif
 	vec3 rows[3];
 #else
 	struct
@@ -383,12 +408,14 @@ union mat3
 			m01, m11, m21,
 			m02, m12, m22;
 	};
+#if defined(_MSC_VER)
 	struct
 	{
 		vec3 col0;
 		vec3 col1;
 		vec3 col2;
 	};
+#endif
 	vec3 cols[3];
 #endif
 	float m[9];
@@ -414,6 +441,7 @@ union mat4
 			m20, m21, m22, m23,
 			m30, m31, m32, m33;
 	};
+#if defined(_MSC_VER)
 	struct
 	{
 		vec4 row0;
@@ -421,6 +449,7 @@ union mat4
 		vec4 row2;
 		vec4 row3;
 	};
+#endif
 	vec4 rows[4];
 #else
 	struct
@@ -431,6 +460,7 @@ union mat4
 			m02, m12, m22, m32,
 			m03, m13, m23, m33;
 	};
+#if defined(_MSC_VER)
 	struct
 	{
 		vec4 col0;
@@ -438,8 +468,10 @@ union mat4
 		vec4 col2;
 		vec4 col3;
 	};
+#endif
 	vec4 cols[4];
 #endif
+#if defined(_MSC_VER)
 	struct
 	{
 		w4_float f40;
@@ -447,6 +479,7 @@ union mat4
 		w4_float f42;
 		w4_float f43;
 	};
+#endif
 	float m[16];
 
 	mat4() {}
@@ -7,14 +7,26 @@ struct w4_float;
 struct w8_float;
 struct w16_float;
 
+// GCC and Clang reject members with constructors in anonymous structs. There the wide types are plain structs holding only their named
+// components, so code shared between compilers must not use the aliases (data, xy, xyz, v, v4, m, ...) of the MSVC layouts.
+#if defined(_MSC_VER)
+#define WIDE_MATH_TYPE union
+#else
+#define WIDE_MATH_TYPE struct
+#endif
+
 template <typename simd_t>
-union wN_vec2
+WIDE_MATH_TYPE wN_vec2
 {
+#if defined(_MSC_VER)
 	struct
 	{
 		simd_t x, y;
 	};
 	simd_t data[2];
+#else
+	simd_t x, y;
+#endif
 
 	wN_vec2() {}
 	wN_vec2(simd_t v) : wN_vec2(v, v) {}
@@ -27,8 +39,9 @@ union wN_vec2
 };
 
 template <typename simd_t>
-union wN_vec3
+WIDE_MATH_TYPE wN_vec3
 {
+#if defined(_MSC_VER)
 	struct
 	{
 		simd_t x, y, z;
@@ -43,6 +56,9 @@ union wN_vec3
 		simd_t z;
 	};
 	simd_t data[3];
+#else
+	simd_t x, y, z;
+#endif
 
 	wN_vec3() {}
 	wN_vec3(simd_t v) : wN_vec3(v, v, v) {}
@@ -52,12 +68,13 @@ union wN_vec3
 
 	void store(float* xDest, float* yDest, float* zDest) { x.store(xDest); y.store(yDest); z.store(zDest); }
 
-	static NODISCARD wN_vec3 zero() { return wN_vec3<simd_t>(simd_t::zero()); }
+	NODISCARD static wN_vec3 zero() { return wN_vec3<simd_t>(simd_t::zero()); }
 };
 
 template <typename simd_t>
-union wN_vec4
+WIDE_MATH_TYPE wN_vec4
 {
+#if defined(_MSC_VER)
 	struct
 	{
 		simd_t x, y, z, w;
@@ -77,6 +94,9 @@ union wN_vec4
 		wN_vec2<simd_t> zw;
 	};
 	simd_t data[4];
+#else
+	simd_t x, y, z, w;
+#endif
 
 	wN_vec4() {}
 	wN_vec4(simd_t v) : wN_vec4(v, v, v, v) {}
@@ -90,8 +110,9 @@ union wN_vec4
 };
 
 template <typename simd_t>
-union wN_quat
+WIDE_MATH_TYPE wN_quat
 {
+#if defined(_MSC_VER)
 	struct
 	{
 		simd_t x, y, z, w;
@@ -103,6 +124,9 @@ union wN_quat
 	};
 	wN_vec4<simd_t> v4;
 	simd_t data[4];
+#else
+	simd_t x, y, z, w;
+#endif
 
 	wN_quat() {}
 	wN_quat(simd_t x, simd_t y, simd_t z, simd_t w) : x(x), y(y), z(z), w(w) {}
@@ -115,8 +139,9 @@ union wN_quat
 };
 
 template <typename simd_t>
-union wN_mat2
+WIDE_MATH_TYPE wN_mat2
 {
+#if defined(_MSC_VER)
 	struct
 	{
 		simd_t
@@ -124,6 +149,11 @@ union wN_mat2
 			m01, m11;
 	};
 	simd_t m[4];
+#else
+	simd_t
+		m00, m10,
+		m01, m11;
+#endif
 
 	wN_mat2() {}
 	wN_mat2(
@@ -132,8 +162,9 @@ union wN_mat2
 };
 
 template <typename simd_t>
-union wN_mat3
+WIDE_MATH_TYPE wN_mat3
 {
+#if defined(_MSC_VER)
 	struct
 	{
 		simd_t
@@ -142,6 +173,12 @@ union wN_mat3
 			m02, m12, m22;
 	};
 	simd_t m[9];
+#else
+	simd_t
+		m00, m10, m20,
+		m01, m11, m21,
+		m02, m12, m22;
+#endif
 
 	wN_mat3() {}
 	wN_mat3(
@@ -151,8 +188,9 @@ union wN_mat3
 };
 
 template <typename simd_t>
-union wN_mat4
+WIDE_MATH_TYPE wN_mat4
 {
+#if defined(_MSC_VER)
 	struct
 	{
 		simd_t
@@ -162,6 +200,13 @@ union wN_mat4
 			m03, m13, m23, m33;
 	};
 	simd_t m[16];
+#else
+	simd_t
+		m00, m10, m20, m30,
+		m01, m11, m21, m31,
+		m02, m12, m22, m32,
+		m03, m13, m23, m33;
+#endif
 
 	wN_mat4() {}
 	wN_mat4(
@@ -274,53 +319,53 @@ NODISCARD static wN_quat<simd_t> ifThen(cmp_t cond, wN_quat<simd_t> ifCase, wN_q
 	return { ifThen(cond, ifCase.x, thenCase.x), ifThen(cond, ifCase.y, thenCase.y), ifThen(cond, ifCase.z, thenCase.z), ifThen(cond, ifCase.w, thenCase.w) };
 }
 
-template <typename simd_t> static NODISCARD wN_vec2<simd_t> noz(wN_vec2<simd_t> a) { simd_t sl = squaredLength(a); return ifThen(sl < 1e-8f, wN_vec2<simd_t>::zero(), a * rsqrt(sl)); }
-template <typename simd_t> static NODISCARD wN_vec3<simd_t> noz(wN_vec3<simd_t> a) { simd_t sl = squaredLength(a); return ifThen(sl < 1e-8f, wN_vec3<simd_t>::zero(), a * rsqrt(sl)); }
-template <typename simd_t> static NODISCARD wN_vec4<simd_t> noz(wN_vec4<simd_t> a) { simd_t sl = squaredLength(a); return ifThen(sl < 1e-8f, wN_vec4<simd_t>::zero(), a * rsqrt(sl)); }
+template <typename simd_t> NODISCARD static wN_vec2<simd_t> noz(wN_vec2<simd_t> a) { simd_t sl = squaredLength(a); return ifThen(sl < 1e-8f, wN_vec2<simd_t>::zero(), a * rsqrt(sl)); }
+template <typename simd_t> NODISCARD static wN_vec3<simd_t> noz(wN_vec3<simd_t> a) { simd_t sl = squaredLength(a); return ifThen(sl < 1e-8f, wN_vec3<simd_t>::zero(), a * rsqrt(sl)); }
+template <typename simd_t> NODISCARD static wN_vec4<simd_t> noz(wN_vec4<simd_t> a) { simd_t sl = squaredLength(a); return ifThen(sl < 1e-8f, wN_vec4<simd_t>::zero(), a * rsqrt(sl)); }
 
-template <typename simd_t> static NODISCARD wN_vec2<simd_t> normalize(wN_vec2<simd_t> a) { simd_t l2 = squaredLength(a); return a * rsqrt(l2); }
-template <typename simd_t> static NODISCARD wN_vec3<simd_t> normalize(wN_vec3<simd_t> a) { simd_t l2 = squaredLength(a); return a * rsqrt(l2); }
-template <typename simd_t> static NODISCARD wN_vec4<simd_t> normalize(wN_vec4<simd_t> a) { simd_t l2 = squaredLength(a); return a * rsqrt(l2); }
+template <typename simd_t> NODISCARD static wN_vec2<simd_t> normalize(wN_vec2<simd_t> a) { simd_t l2 = squaredLength(a); return a * rsqrt(l2); }
+template <typename simd_t> NODISCARD static wN_vec3<simd_t> normalize(wN_vec3<simd_t> a) { simd_t l2 = squaredLength(a); return a * rsqrt(l2); }
+template <typename simd_t> NODISCARD static wN_vec4<simd_t> normalize(wN_vec4<simd_t> a) { simd_t l2 = squaredLength(a); return a * rsqrt(l2); }
 
-template <typename simd_t> static NODISCARD wN_vec2<simd_t> abs(wN_vec2<simd_t> a) { return wN_vec2(abs(a.x), abs(a.y)); }
-template <typename simd_t> static NODISCARD wN_vec3<simd_t> abs(wN_vec3<simd_t> a) { return wN_vec3(abs(a.x), abs(a.y), abs(a.z)); }
-template <typename simd_t> static NODISCARD wN_vec4<simd_t> abs(wN_vec4<simd_t> a) { return wN_vec4(abs(a.x), abs(a.y), abs(a.z), abs(a.w)); }
+template <typename simd_t> NODISCARD static wN_vec2<simd_t> abs(wN_vec2<simd_t> a) { return wN_vec2(abs(a.x), abs(a.y)); }
+template <typename simd_t> NODISCARD static wN_vec3<simd_t> abs(wN_vec3<simd_t> a) { return wN_vec3(abs(a.x), abs(a.y), abs(a.z)); }
+template <typename simd_t> NODISCARD static wN_vec4<simd_t> abs(wN_vec4<simd_t> a) { return wN_vec4(abs(a.x), abs(a.y), abs(a.z), abs(a.w)); }
 
-template <typename simd_t> static NODISCARD wN_vec2<simd_t> round(wN_vec2<simd_t> a) { return wN_vec2(round(a.x), round(a.y)); }
-template <typename simd_t> static NODISCARD wN_vec3<simd_t> round(wN_vec3<simd_t> a) { return wN_vec3(round(a.x), round(a.y), round(a.z)); }
-template <typename simd_t> static NODISCARD wN_vec4<simd_t> round(wN_vec4<simd_t> a) { return wN_vec4(round(a.x), round(a.y), round(a.z), round(a.w)); }
+template <typename simd_t> NODISCARD static wN_vec2<simd_t> round(wN_vec2<simd_t> a) { return wN_vec2(round(a.x), round(a.y)); }
+template <typename simd_t> NODISCARD static wN_vec3<simd_t> round(wN_vec3<simd_t> a) { return wN_vec3(round(a.x), round(a.y), round(a.z)); }
+template <typename simd_t> NODISCARD static wN_vec4<simd_t> round(wN_vec4<simd_t> a) { return wN_vec4(round(a.x), round(a.y), round(a.z), round(a.w)); }
 
-template <typename simd_t> static NODISCARD wN_quat<simd_t> normalize(wN_quat<simd_t> a) { wN_quat<simd_t> result; result.v4 = normalize(a.v4); return result; }
-template <typename simd_t> static NODISCARD wN_quat<simd_t> conjugate(wN_quat<simd_t> a) { return { -a.x, -a.y, -a.z, a.w }; }
+template <typename simd_t> NODISCARD static wN_quat<simd_t> normalize(wN_quat<simd_t> a) { simd_t s = rsqrt(a.x * a.x + a.y * a.y + a.z * a.z + a.w * a.w); return { a.x * s, a.y * s, a.z * s, a.w * s }; }
+template <typename simd_t> NODISCARD static wN_quat<simd_t> conjugate(wN_quat<simd_t> a) { return { -a.x, -a.y, -a.z, a.w }; }
 
-template <typename simd_t> static NODISCARD wN_quat<simd_t> operator+(wN_quat<simd_t> a, wN_quat<simd_t> b) { wN_quat result; result.v4 = a.v4 + b.v4; return result; }
+template <typename simd_t> NODISCARD static wN_quat<simd_t> operator+(wN_quat<simd_t> a, wN_quat<simd_t> b) { return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; }
 
 template <typename simd_t>
 static wN_quat<simd_t> operator*(wN_quat<simd_t> a, wN_quat<simd_t> b)
 {
-	wN_quat<simd_t> result;
-	result.w = fmsub(a.w, b.w, dot(a.v, b.v));
-	result.v = a.v * b.w + b.v * a.w + cross(a.v, b.v);
-	return result;
+	wN_vec3<simd_t> av(a.x, a.y, a.z);
+	wN_vec3<simd_t> bv(b.x, b.y, b.z);
+	wN_vec3<simd_t> v = av * b.w + bv * a.w + cross(av, bv);
+	return { v.x, v.y, v.z, fmsub(a.w, b.w, dot(av, bv)) };
 }
 
-template <typename simd_t> static wN_quat<simd_t> operator*(wN_quat<simd_t> q, simd_t s) { wN_quat result; result.v4 = q.v4 * s;	return result; }
-template <typename simd_t> static wN_vec3<simd_t> operator*(wN_quat<simd_t> q, wN_vec3<simd_t> v) { wN_quat p(v.x, v.y, v.z, simd_t::zero()); return (q * p * conjugate(q)).v; }
+template <typename simd_t> static wN_quat<simd_t> operator*(wN_quat<simd_t> q, simd_t s) { return { q.x * s, q.y * s, q.z * s, q.w * s }; }
+template <typename simd_t> static wN_vec3<simd_t> operator*(wN_quat<simd_t> q, wN_vec3<simd_t> v) { wN_quat p(v.x, v.y, v.z, simd_t::zero()); wN_quat r = q * p * conjugate(q); return wN_vec3<simd_t>(r.x, r.y, r.z); }
 
 template <typename simd_t> static auto operator==(wN_quat<simd_t> a, wN_quat<simd_t> b) { return a.x == b.x & a.y == b.y & a.z == b.z & a.w == b.w; }
 
-template <typename simd_t> static NODISCARD wN_vec2<simd_t> lerp(wN_vec2<simd_t> l, wN_vec2<simd_t> u, simd_t t) { return fmadd(wN_vec2<simd_t>(t), u - l, l); }
-template <typename simd_t> static NODISCARD wN_vec3<simd_t> lerp(wN_vec3<simd_t> l, wN_vec3<simd_t> u, simd_t t) { return fmadd(wN_vec3<simd_t>(t), u - l, l); }
-template <typename simd_t> static NODISCARD wN_vec4<simd_t> lerp(wN_vec4<simd_t> l, wN_vec4<simd_t> u, simd_t t) { return fmadd(wN_vec4<simd_t>(t), u - l, l); }
-template <typename simd_t> static NODISCARD wN_quat<simd_t> lerp(wN_quat<simd_t> l, wN_quat<simd_t> u, simd_t t) { wN_quat result; result.v4 = lerp(l.v4, u.v4, t); return normalize(result); }
+template <typename simd_t> NODISCARD static wN_vec2<simd_t> lerp(wN_vec2<simd_t> l, wN_vec2<simd_t> u, simd_t t) { return fmadd(wN_vec2<simd_t>(t), u - l, l); }
+template <typename simd_t> NODISCARD static wN_vec3<simd_t> lerp(wN_vec3<simd_t> l, wN_vec3<simd_t> u, simd_t t) { return fmadd(wN_vec3<simd_t>(t), u - l, l); }
+template <typename simd_t> NODISCARD static wN_vec4<simd_t> lerp(wN_vec4<simd_t> l, wN_vec4<simd_t> u, simd_t t) { return fmadd(wN_vec4<simd_t>(t), u - l, l); }
+template <typename simd_t> NODISCARD static wN_quat<simd_t> lerp(wN_quat<simd_t> l, wN_quat<simd_t> u, simd_t t) { wN_quat result = { fmadd(t, u.x - l.x, l.x), fmadd(t, u.y - l.y, l.y), fmadd(t, u.z - l.z, l.z), fmadd(t, u.w - l.w, l.w) }; return normalize(result); }
 
-template <typename simd_t> static NODISCARD wN_vec2<simd_t> exp(wN_vec2<simd_t> v) { return wN_vec2(exp(v.x), exp(v.y)); }
-template <typename simd_t> static NODISCARD wN_vec3<simd_t> exp(wN_vec3<simd_t> v) { return wN_vec3(exp(v.x), exp(v.y), exp(v.z)); }
-template <typename simd_t> static NODISCARD wN_vec4<simd_t> exp(wN_vec4<simd_t> v) { return wN_vec4(exp(v.x), exp(v.y), exp(v.z), exp(v.w)); }
+template <typename simd_t> NODISCARD static wN_vec2<simd_t> exp(wN_vec2<simd_t> v) { return wN_vec2(exp(v.x), exp(v.y)); }
+template <typename simd_t> NODISCARD static wN_vec3<simd_t> exp(wN_vec3<simd_t> v) { return wN_vec3(exp(v.x), exp(v.y), exp(v.z)); }
+template <typename simd_t> NODISCARD static wN_vec4<simd_t> exp(wN_vec4<simd_t> v) { return wN_vec4(exp(v.x), exp(v.y), exp(v.z), exp(v.w)); }
 
-template <typename simd_t> static NODISCARD wN_vec2<simd_t> pow(wN_vec2<simd_t> v, simd_t e) { return wN_vec2(pow(v.x, e), pow(v.y, e)); }
-template <typename simd_t> static NODISCARD wN_vec3<simd_t> pow(wN_vec3<simd_t> v, simd_t e) { return wN_vec3(pow(v.x, e), pow(v.y, e), pow(v.z, e)); }
-template <typename simd_t> static NODISCARD wN_vec4<simd_t> pow(wN_vec4<simd_t> v, simd_t e) { return wN_vec4(pow(v.x, e), pow(v.y, e), pow(v.z, e), pow(v.w, e)); }
+template <typename simd_t> NODISCARD static wN_vec2<simd_t> pow(wN_vec2<simd_t> v, simd_t e) { return wN_vec2(pow(v.x, e), pow(v.y, e)); }
+template <typename simd_t> NODISCARD static wN_vec3<simd_t> pow(wN_vec3<simd_t> v, simd_t e) { return wN_vec3(pow(v.x, e), pow(v.y, e), pow(v.z, e)); }
+template <typename simd_t> NODISCARD static wN_vec4<simd_t> pow(wN_vec4<simd_t> v, simd_t e) { return wN_vec4(pow(v.x, e), pow(v.y, e), pow(v.z, e), pow(v.w, e)); }
 
 
 template <typename simd_t>
@@ -415,17 +460,57 @@ static wN_mat4<simd_t> operator*(const wN_mat4<simd_t>& a, const wN_mat4<simd_t>
 	return result;
 }
 
-template <typename simd_t> static wN_mat2<simd_t> operator*(const wN_mat2<simd_t>& a, simd_t b) { wN_mat2<simd_t> result; for (uint32 i = 0; i < 4; ++i) { result.m[i] = a.m[i] * b; } return result; }
-template <typename simd_t> static wN_mat3<simd_t> operator*(const wN_mat3<simd_t>& a, simd_t b) { wN_mat3<simd_t> result; for (uint32 i = 0; i < 9; ++i) { result.m[i] = a.m[i] * b; } return result; }
-template <typename simd_t> static wN_mat4<simd_t> operator*(const wN_mat4<simd_t>& a, simd_t b) { wN_mat4<simd_t> result; for (uint32 i = 0; i < 16; ++i) { result.m[i] = a.m[i] * b; } return result; }
+template <typename simd_t> static wN_mat2<simd_t> operator*(const wN_mat2<simd_t>& a, simd_t b)
+{
+	return wN_mat2<simd_t>(
+		a.m00 * b, a.m01 * b,
+		a.m10 * b, a.m11 * b);
+}
+
+template <typename simd_t> static wN_mat3<simd_t> operator*(const wN_mat3<simd_t>& a, simd_t b)
+{
+	return wN_mat3<simd_t>(
+		a.m00 * b, a.m01 * b, a.m02 * b,
+		a.m10 * b, a.m11 * b, a.m12 * b,
+		a.m20 * b, a.m21 * b, a.m22 * b);
+}
+
+template <typename simd_t> static wN_mat4<simd_t> operator*(const wN_mat4<simd_t>& a, simd_t b)
+{
+	return wN_mat4<simd_t>(
+		a.m00 * b, a.m01 * b, a.m02 * b, a.m03 * b,
+		a.m10 * b, a.m11 * b, a.m12 * b, a.m13 * b,
+		a.m20 * b, a.m21 * b, a.m22 * b, a.m23 * b,
+		a.m30 * b, a.m31 * b, a.m32 * b, a.m33 * b);
+}
 
 template <typename simd_t> static wN_mat2<simd_t> operator*(simd_t b, const wN_mat2<simd_t>& a) { return a * b; }
 template <typename simd_t> static wN_mat3<simd_t> operator*(simd_t b, const wN_mat3<simd_t>& a) { return a * b; }
 template <typename simd_t> static wN_mat4<simd_t> operator*(simd_t b, const wN_mat4<simd_t>& a) { return a * b; }
 
-template <typename simd_t> static wN_mat2<simd_t> operator+(const wN_mat2<simd_t>& a, const wN_mat2<simd_t>& b) { wN_mat2<simd_t> result; for (uint32 i = 0; i < 4; ++i) { result.m[i] = a.m[i] + b.m[i]; } return result; }
-template <typename simd_t> static wN_mat3<simd_t> operator+(const wN_mat3<simd_t>& a, const wN_mat3<simd_t>& b) { wN_mat3<simd_t> result; for (uint32 i = 0; i < 9; ++i) { result.m[i] = a.m[i] + b.m[i]; } return result; }
-template <typename simd_t> static wN_mat4<simd_t> operator+(const wN_mat4<simd_t>& a, const wN_mat4<simd_t>& b) { wN_mat4<simd_t> result; for (uint32 i = 0; i < 16; ++i) { result.m[i] = a.m[i] + b.m[i]; } return result; }
+template <typename simd_t> static wN_mat2<simd_t> operator+(const wN_mat2<simd_t>& a, const wN_mat2<simd_t>& b)
+{
+	return wN_mat2<simd_t>(
+		a.m00 + b.m00, a.m01 + b.m01,
+		a.m10 + b.m10, a.m11 + b.m11);
+}
+
+template <typename simd_t> static wN_mat3<simd_t> operator+(const wN_mat3<simd_t>& a, const wN_mat3<simd_t>& b)
+{
+	return wN_mat3<simd_t>(
+		a.m00 + b.m00, a.m01 + b.m01, a.m02 + b.m02,
+		a.m10 + b.m10, a.m11 + b.m11, a.m12 + b.m12,
+		a.m20 + b.m20, a.m21 + b.m21, a.m22 + b.m22);
+}
+
+template <typename simd_t> static wN_mat4<simd_t> operator+(const wN_mat4<simd_t>& a, const wN_mat4<simd_t>& b)
+{
+	return wN_mat4<simd_t>(
+		a.m00 + b.m00, a.m01 + b.m01, a.m02 + b.m02, a.m03 + b.m03,
+		a.m10 + b.m10, a.m11 + b.m11, a.m12 + b.m12, a.m13 + b.m13,
+		a.m20 + b.m20, a.m21 + b.m21, a.m22 + b.m22, a.m23 + b.m23,
+		a.m30 + b.m30, a.m31 + b.m31, a.m32 + b.m32, a.m33 + b.m33);
+}
 
 template <typename simd_t>
 NODISCARD static wN_mat2<simd_t> transpose(const wN_mat2<simd_t>& a)
@@ -504,6 +589,39 @@ NODISCARD static wN_vec3<simd_t> solveLinearSystem(const wN_mat3<simd_t>& A, wN_
 	return x;
 }
 
+template <typename simd_t>
+NODISCARD static wN_mat3<simd_t> quaternionToMat3(wN_quat<simd_t> q)
+{
+	simd_t qxx = q.x * q.x;
+	simd_t qyy = q.y * q.y;
+	simd_t qzz = q.z * q.z;
+	simd_t qxz = q.x * q.z;
+	simd_t qxy = q.x * q.y;
+	simd_t qyz = q.y * q.z;
+	simd_t qwx = q.w * q.x;
+	simd_t qwy = q.w * q.y;
+	simd_t qwz = q.w * q.z;
+
+	simd_t one = 1.f;
+	simd_t two = 2.f;
+
+	wN_mat3<simd_t> result;
+
+	result.m00 = one - two * (qyy + qzz);
+	result.m10 = two * (qxy + qwz);
+	result.m20 = two * (qxz - qwy);
+
+	result.m01 = two * (qxy - qwz);
+	result.m11 = one - two * (qxx + qzz);
+	result.m21 = two * (qyz + qwx);
+
+	result.m02 = two * (qxz + qwy);
+	result.m12 = two * (qyz - qwx);
+	result.m22 = one - two * (qxx + qyy);
+
+	return result;
+}
+
 template <typename simd_t>
 static wN_quat<simd_t> rotateFromTo(wN_vec3<simd_t> _from, wN_vec3<simd_t> _to)
 {
@@ -556,13 +674,14 @@ void getAxisRotation(wN_quat<simd_t> q, wN_vec3<simd_t>& axis, simd_t& angle)
 	angle = zero;
 	axis = wN_vec3<simd_t>(one, zero, zero);
 
-	simd_t sqLength = squaredLength(q.v);
+	wN_vec3<simd_t> qv(q.x, q.y, q.z);
+	simd_t sqLength = squaredLength(qv);
 	auto mask = sqLength > zero;
 	if (anyTrue(mask))
 	{
 		simd_t angleOverride = simd_t(2.f) * acos(q.w);
 		simd_t invLength = one / sqrt(sqLength);
-		wN_vec3<simd_t> axisOverride = q.v * invLength;
+		wN_vec3<simd_t> axisOverride = qv * invLength;
 
 		angle = ifThen(mask, angleOverride, angle);
 		axis = ifThen(mask, axisOverride, axis);
@@ -588,8 +707,11 @@ template<typename simd_t>
 inline wN_quat<simd_t>::wN_quat(wN_vec3<simd_t> axis, simd_t angle)
 {
 	simd_t h = 0.5f;
+	wN_vec3<simd_t> v = axis * sin(angle * h);
+	x = v.x;
+	y = v.y;
+	z = v.z;
 	w = cos(angle * h);
-	v = axis * sin(angle * h);
 }
 
 template<typename simd_t>
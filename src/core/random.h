@@ -10,7 +10,7 @@ struct random_number_generator
 	random_number_generator() {}
 	random_number_generator(uint64 seed) { state = seed; }
 
-	inline NODISCARD uint64 randomUint64()
+	NODISCARD inline uint64 randomUint64()
 	{
 		uint64 x = state;
 		x ^= x << 13;
@@ -20,39 +20,39 @@ struct random_number_generator
 		return x;
 	}
 
-	inline NODISCARD uint32 randomUint32()
+	NODISCARD inline uint32 randomUint32()
 	{
 		return (uint32)randomUint64();
 	}
 
-	inline NODISCARD uint64 randomUint64Between(uint64 lo, uint64 hi)
+	NODISCARD inline uint64 randomUint64Between(uint64 lo, uint64 hi)
 	{
 		return randomUint64() % (hi - lo) + lo;
 	}
 
-	inline NODISCARD uint32 randomUint32Between(uint32 lo, uint32 hi)
+	NODISCARD inline uint32 randomUint32Between(uint32 lo, uint32 hi)
 	{
 		return randomUint32() % (hi - lo) + lo;
 	}
 
-	inline NODISCARD float randomFloat01()
+	NODISCARD inline float randomFloat01()
 	{
 		return randomUint32() / (float)UINT_MAX;
 	}
 
-	inline NODISCARD float randomFloatBetween(float lo, float hi)
+	NODISCARD inline float randomFloatBetween(float lo, float hi)
 	{
 		return remap(randomFloat01(), 0.f, 1.f, lo, hi);
 	}
 
-	inline NODISCARD vec2 randomVec2Between(float lo, float hi)
+	NODISCARD inline vec2 randomVec2Between(float lo, float hi)
 	{
 		return vec2(
 			randomFloatBetween(lo, hi),
 			randomFloatBetween(lo, hi));
 	}
 
-	inline NODISCARD vec3 randomVec3Between(float lo, float hi)
+	NODISCARD inline vec3 randomVec3Between(float lo, float hi)
 	{
 		return vec3(
 			randomFloatBetween(lo, hi),
@@ -60,7 +60,7 @@ struct random_number_generator
 			randomFloatBetween(lo, hi));
 	}
 
-	inline NODISCARD vec4 randomVec4Between(float lo, float hi)
+	NODISCARD inline vec4 randomVec4Between(float lo, float hi)
 	{
 		return vec4(
 			randomFloatBetween(lo, hi),
@@ -69,12 +69,12 @@ struct random_number_generator
 			randomFloatBetween(lo, hi));
 	}
 
-	inline NODISCARD vec3 randomPointOnUnitSphere()
+	NODISCARD inline vec3 randomPointOnUnitSphere()
 	{
 		return normalize(randomVec3Between(-1.f, 1.f));
 	}
 
-	inline NODISCARD quat randomRotation(float maxAngle = M_PI)
+	NODISCARD inline quat randomRotation(float maxAngle = M_PI)
 	{
 		return quat(randomPointOnUnitSphere(), randomFloatBetween(-maxAngle, maxAngle));
 	}
@@ -113,8 +113,8 @@ NODISCARD static uint32 hash(uint32 x, uint32 y) { return hash(x ^ hash(y)); }
 NODISCARD static uint32 hash(uint32 x, uint32 y, uint32 z) { return hash(x ^ hash(y) ^ hash(z)); }
 NODISCARD static uint32 hash(uint32 x, uint32 y, uint32 z, uint32 w) { return hash(x ^ hash(y) ^ hash(z) ^ hash(w)); }
 
-inline NODISCARD float asfloat(uint32 u) { return *(float*)&u; }
-inline NODISCARD uint32 asuint(float f) { return *(uint32*)&f; }
+NODISCARD inline float asfloat(uint32 u) { return *(float*)&u; }
+NODISCARD inline uint32 asuint(float f) { return *(uint32*)&f; }
 
 // Construct a float with half-open range [0:1] using low 23 bits.
 // All zeroes yields 0.0, all ones yields the next smallest representable value below 1.0.
@@ -320,7 +320,7 @@ NODISCARD static vec3 fbm(fbm_noise_2D noiseFunc, vec2 x, uint32 numOctaves = 6,
 		ASSERT(n.x >= -1.f);
 
 		value += amplitude * n.x;		// Accumulate values.
-		deriv += amplitude * m * n.yz;  // Accumulate derivatives.
+		deriv += amplitude * m * vec2(n.y, n.z);  // Accumulate derivatives.
 
 		amplitude *= gain;
 
@@ -343,7 +343,7 @@ NODISCARD static vec4 fbm(fbm_noise_3D noiseFunc, vec3 x, uint32 numOctaves = 6,
 		vec4 n = noiseFunc(x);
 
 		value += amplitude * n.x;		// Accumulate values.
-		deriv += amplitude * m * n.yzw; // Accumulate derivatives.
+		deriv += amplitude * m * vec3(n.y, n.z, n.w); // Accumulate derivatives.
 
 		amplitude *= gain;
 
@@ -5,6 +5,19 @@
 
 #define SIMD_SSE_2 // All x64 processors support SSE2.
 
+// Read access to single lanes. MSVC exposes them as union members of the vector types, GCC and Clang allow subscripting the vector types.
+#if defined(_MSC_VER)
+#define SIMD_LANE_F32_128(v, i) ((v).m128_f32[i])
+#define SIMD_LANE_I32_128(v, i) ((v).m128i_i32[i])
+#define SIMD_LANE_F32_256(v, i) ((v).m256_f32[i])
+#define SIMD_LANE_I32_256(v, i) ((v).m256i_i32[i])
+#else
+#define SIMD_LANE_F32_128(v, i) ((v)[i])
+#define SIMD_LANE_I32_128(v, i) (((__v4si)(v))[i])
+#define SIMD_LANE_F32_256(v, i) ((v)[i])
+#define SIMD_LANE_I32_256(v, i) (((__v8si)(v))[i])
+#endif
+
 #if defined(__AVX__)
 #if defined(__AVX512F__)
 #define SIMD_AVX_512
@@ -174,11 +187,11 @@ struct w4_float
 	w4_float(const float* baseAddress, int a, int b, int c, int d) : w4_float(baseAddress, _mm_setr_epi32(a, b, c, d)) {}
 #else
 	w4_float(const float* baseAddress, int a, int b, int c, int d) { f = _mm_setr_ps(baseAddress[a], baseAddress[b], baseAddress[c], baseAddress[d]);  }
-	w4_float(const float* baseAddress, __m128i indices) : w4_float(baseAddress, indices.m128i_i32[0], indices.m128i_i32[1], indices.m128i_i32[2], indices.m128i_i32[3]) {}
+	w4_float(const float* baseAddress, __m128i indices) : w4_float(baseAddress, SIMD_LANE_I32_128(indices, 0), SIMD_LANE_I32_128(indices, 1), SIMD_LANE_I32_128(indices, 2), SIMD_LANE_I32_128(indices, 3)) {}
 #endif
 
 	operator __m128() { return f; }
-	float operator[](uint32 i) const { return this->f.m128_f32[i]; }
+	float operator[](uint32 i) const { return SIMD_LANE_F32_128(this->f, i); }
 
 	void store(float* f_) const { _mm_storeu_ps(f_, f); }
 
@@ -188,18 +201,18 @@ struct w4_float
 #else
 	void scatter(float* baseAddress, int a, int b, int c, int d) const
 	{
-		baseAddress[a] = this->f.m128_f32[0];
-		baseAddress[b] = this->f.m128_f32[1];
-		baseAddress[c] = this->f.m128_f32[2];
-		baseAddress[d] = this->f.m128_f32[3];
+		baseAddress[a] = SIMD_LANE_F32_128(this->f, 0);
+		baseAddress[b] = SIMD_LANE_F32_128(this->f, 1);
+		baseAddress[c] = SIMD_LANE_F32_128(this->f, 2);
+		baseAddress[d] = SIMD_LANE_F32_128(this->f, 3);
 	}
 
 	void scatter(float* baseAddress, __m128i indices) const
 	{
-		baseAddress[indices.m128i_i32[0]] = this->f.m128_f32[0];
-		baseAddress[indices.m128i_i32[1]] = this->f.m128_f32[1];
-		baseAddress[indices.m128i_i32[2]] = this->f.m128_f32[2];
-		baseAddress[indices.m128i_i32[3]] = this->f.m128_f32[3];
+		baseAddress[SIMD_LANE_I32_128(indices, 0)] = SIMD_LANE_F32_128(this->f, 0);
+		baseAddress[SIMD_LANE_I32_128(indices, 1)] = SIMD_LANE_F32_128(this->f, 1);
+		baseAddress[SIMD_LANE_I32_128(indices, 2)] = SIMD_LANE_F32_128(this->f, 2);
+		baseAddress[SIMD_LANE_I32_128(indices, 3)] = SIMD_LANE_F32_128(this->f, 3);
 	}
 #endif
 
@@ -222,11 +235,11 @@ struct w4_int
 	w4_int(const int* baseAddress, int a, int b, int c, int d) : w4_int(baseAddress, _mm_setr_epi32(a, b, c, d)) {}
 #else
 	w4_int(const int* baseAddress, int a, int b, int c, int d) { i = _mm_setr_epi32(baseAddress[a], baseAddress[b], baseAddress[c], baseAddress[d]); }
-	w4_int(const int* baseAddress, __m128i indices) : w4_int(baseAddress, indices.m128i_i32[0], indices.m128i_i32[1], indices.m128i_i32[2], indices.m128i_i32[3]) {}
+	w4_int(const int* baseAddress, __m128i indices) : w4_int(baseAddress, SIMD_LANE_I32_128(indices, 0), SIMD_LANE_I32_128(indices, 1), SIMD_LANE_I32_128(indices, 2), SIMD_LANE_I32_128(indices, 3)) {}
 #endif
 
 	operator __m128i() { return i; }
-	int operator[](uint32 i) const { return this->i.m128i_i32[i]; }
+	int operator[](uint32 i) const { return SIMD_LANE_I32_128(this->i, i); }
 
 	void store(int* i_) const { _mm_storeu_si128((__m128i*)i_, i); }
 
@@ -236,18 +249,18 @@ struct w4_int
 #else
 	void scatter(int* baseAddress, int a, int b, int c, int d) const
 	{
-		baseAddress[a] = this->i.m128i_i32[0];
-		baseAddress[b] = this->i.m128i_i32[1];
-		baseAddress[c] = this->i.m128i_i32[2];
-		baseAddress[d] = this->i.m128i_i32[3];
+		baseAddress[a] = SIMD_LANE_I32_128(this->i, 0);
+		baseAddress[b] = SIMD_LANE_I32_128(this->i, 1);
+		baseAddress[c] = SIMD_LANE_I32_128(this->i, 2);
+		baseAddress[d] = SIMD_LANE_I32_128(this->i, 3);
 	}
 
 	void scatter(int* baseAddress, __m128i indices) const
 	{
-		baseAddress[indices.m128i_i32[0]] = this->i.m128i_i32[0];
-		baseAddress[indices.m128i_i32[1]] = this->i.m128i_i32[1];
-		baseAddress[indices.m128i_i32[2]] = this->i.m128i_i32[2];
-		baseAddress[indices.m128i_i32[3]] = this->i.m128i_i32[3];
+		baseAddress[SIMD_LANE_I32_128(indices, 0)] = SIMD_LANE_I32_128(this->i, 0);
+		baseAddress[SIMD_LANE_I32_128(indices, 1)] = SIMD_LANE_I32_128(this->i, 1);
+		baseAddress[SIMD_LANE_I32_128(indices, 2)] = SIMD_LANE_I32_128(this->i, 2);
+		baseAddress[SIMD_LANE_I32_128(indices, 3)] = SIMD_LANE_I32_128(this->i, 3);
 	}
 #endif
 
@@ -269,7 +282,11 @@ static w4_int operator-(w4_int a, w4_int b) { return _mm_sub_epi32(a, b); }
 static w4_int& operator-=(w4_int& a, w4_int b) { a = a - b; return a; }
 static w4_int operator*(w4_int a, w4_int b) { return _mm_mul_epi32(a, b); }
 static w4_int& operator*=(w4_int& a, w4_int b) { a = a * b; return a; }
+#if defined(_MSC_VER)
 static w4_int operator/(w4_int a, w4_int b) { return _mm_div_epi32(a, b); }
+#else
+static w4_int operator/(w4_int a, w4_int b) { return w4_int(a[0] / b[0], a[1] / b[1], a[2] / b[2], a[3] / b[3]); } // _mm_div_epi32 is an MSVC (SVML) intrinsic.
+#endif
 static w4_int& operator/=(w4_int& a, w4_int b) { a = a / b; return a; }
 static w4_int operator&(w4_int a, w4_int b) { return _mm_and_si128(a, b); }
 static w4_int& operator&=(w4_int& a, w4_int b) { a = a & b; return a; }
@@ -332,7 +349,7 @@ static w4_float& operator<<=(w4_float& a, int b) { a = a << b; return a; }
 
 static w4_float operator-(w4_float a) { return _mm_xor_ps(a, reinterpret(w4_int(1 << 31))); }
 
-static float addElements(w4_float a) { __m128 aa = _mm_hadd_ps(a, a); aa = _mm_hadd_ps(aa, aa); return aa.m128_f32[0]; }
+static float addElements(w4_float a) { __m128 aa = _mm_hadd_ps(a, a); aa = _mm_hadd_ps(aa, aa); return SIMD_LANE_F32_128(aa, 0); }
 
 NODISCARD static w4_float fmadd(w4_float a, w4_float b, w4_float c) { return _mm_fmadd_ps(a, b, c); }
 NODISCARD static w4_float fmsub(w4_float a, w4_float b, w4_float c) { return _mm_fmsub_ps(a, b, c); }
@@ -462,6 +479,21 @@ static void store8(float* baseAddress, const uint16* indices, uint32 stride,
 	in7.store(baseAddress + strideInFloats * indices[3] + 4);
 }
 
+// Same as store8, but lanes whose index equals skipIndex are not written.
+static void store8Except(float* baseAddress, const uint16* indices, uint16 skipIndex, uint32 stride,
+	w4_float in0, w4_float in1, w4_float in2, w4_float in3, w4_float in4, w4_float in5, w4_float in6, w4_float in7)
+{
+	const uint32 strideInFloats = stride / sizeof(float);
+
+	transpose(in0, in1, in2, in3);
+	transpose(in4, in5, in6, in7);
+
+	if (indices[0] != skipIndex) { in0.store(baseAddress + strideInFloats * indices[0]); in4.store(baseAddress + strideInFloats * indices[0] + 4); }
+	if (indices[1] != skipIndex) { in1.store(baseAddress + strideInFloats * indices[1]); in5.store(baseAddress + strideInFloats * indices[1] + 4); }
+	if (indices[2] != skipIndex) { in2.store(baseAddress + strideInFloats * indices[2]); in6.store(baseAddress + strideInFloats * indices[2] + 4); }
+	if (indices[3] != skipIndex) { in3.store(baseAddress + strideInFloats * indices[3]); in7.store(baseAddress + strideInFloats * indices[3] + 4); }
+}
+
 #endif
 
 #if defined(SIMD_AVX_2)
@@ -479,7 +511,7 @@ struct w8_float
 	w8_float(const float* baseAddress, int a, int b, int c, int d, int e, int f, int g, int h) : w8_float(baseAddress, _mm256_setr_epi32(a, b, c, d, e, f, g, h)) {}
 
 	operator __m256() { return f; }
-	float operator[](uint32 i) const { return this->f.m256_f32[i]; }
+	float operator[](uint32 i) const { return SIMD_LANE_F32_256(this->f, i); }
 
 	void store(float* f_) const { _mm256_storeu_ps(f_, f); }
 
@@ -489,26 +521,26 @@ struct w8_float
 #else
 	void scatter(float* baseAddress, int a, int b, int c, int d, int e, int f, int g, int h) const
 	{
-		baseAddress[a] = this->f.m256_f32[0];
-		baseAddress[b] = this->f.m256_f32[1];
-		baseAddress[c] = this->f.m256_f32[2];
-		baseAddress[d] = this->f.m256_f32[3];
-		baseAddress[e] = this->f.m256_f32[4];
-		baseAddress[f] = this->f.m256_f32[5];
-		baseAddress[g] = this->f.m256_f32[6];
-		baseAddress[h] = this->f.m256_f32[7];
+		baseAddress[a] = SIMD_LANE_F32_256(this->f, 0);
+		baseAddress[b] = SIMD_LANE_F32_256(this->f, 1);
+		baseAddress[c] = SIMD_LANE_F32_256(this->f, 2);
+		baseAddress[d] = SIMD_LANE_F32_256(this->f, 3);
+		baseAddress[e] = SIMD_LANE_F32_256(this->f, 4);
+		baseAddress[f] = SIMD_LANE_F32_256(this->f, 5);
+		baseAddress[g] = SIMD_LANE_F32_256(this->f, 6);
+		baseAddress[h] = SIMD_LANE_F32_256(this->f, 7);
 	}
 
 	void scatter(float* baseAddress, __m256i indices) const
 	{
-		baseAddress[indices.m256i_i32[0]] = this->f.m256_f32[0];
-		baseAddress[indices.m256i_i32[1]] = this->f.m256_f32[1];
-		baseAddress[indices.m256i_i32[2]] = this->f.m256_f32[2];
-		baseAddress[indices.m256i_i32[3]] = this->f.m256_f32[3];
-		baseAddress[indices.m256i_i32[4]] = this->f.m256_f32[4];
-		baseAddress[indices.m256i_i32[5]] = this->f.m256_f32[5];
-		baseAddress[indices.m256i_i32[6]] = this->f.m256_f32[6];
-		baseAddress[indices.m256i_i32[7]] = this->f.m256_f32[7];
+		baseAddress[SIMD_LANE_I32_256(indices, 0)] = SIMD_LANE_F32_256(this->f, 0);
+		baseAddress[SIMD_LANE_I32_256(indices, 1)] = SIMD_LANE_F32_256(this->f, 1);
+		baseAddress[SIMD_LANE_I32_256(indices, 2)] = SIMD_LANE_F32_256(this->f, 2);
+		baseAddress[SIMD_LANE_I32_256(indices, 3)] = SIMD_LANE_F32_256(this->f, 3);
+		baseAddress[SIMD_LANE_I32_256(indices, 4)] = SIMD_LANE_F32_256(this->f, 4);
+		baseAddress[SIMD_LANE_I32_256(indices, 5)] = SIMD_LANE_F32_256(this->f, 5);
+		baseAddress[SIMD_LANE_I32_256(indices, 6)] = SIMD_LANE_F32_256(this->f, 6);
+		baseAddress[SIMD_LANE_I32_256(indices, 7)] = SIMD_LANE_F32_256(this->f, 7);
 	}
 #endif
 
@@ -530,7 +562,7 @@ struct w8_int
 	w8_int(const int* baseAddress, int a, int b, int c, int d, int e, int f, int g, int h) : w8_int(baseAddress, _mm256_setr_epi32(a, b, c, d, e, f, g, h)) {}
 
 	operator __m256i() { return i; }
-	int operator[](uint32 i) const { return this->i.m256i_i32[i]; }
+	int operator[](uint32 i) const { return SIMD_LANE_I32_256(this->i, i); }
 
 	void store(int* i_) const { _mm256_storeu_epi32(i_, i); }
 
@@ -540,26 +572,26 @@ struct w8_int
 #else
 	void scatter(int* baseAddress, int a, int b, int c, int d, int e, int f, int g, int h) const
 	{
-		baseAddress[a] = this->i.m256i_i32[0];
-		baseAddress[b] = this->i.m256i_i32[1];
-		baseAddress[c] = this->i.m256i_i32[2];
-		baseAddress[d] = this->i.m256i_i32[3];
-		baseAddress[e] = this->i.m256i_i32[4];
-		baseAddress[f] = this->i.m256i_i32[5];
-		baseAddress[g] = this->i.m256i_i32[6];
-		baseAddress[h] = this->i.m256i_i32[7];
+		baseAddress[a] = SIMD_LANE_I32_256(this->i, 0);
+		baseAddress[b] = SIMD_LANE_I32_256(this->i, 1);
+		baseAddress[c] = SIMD_LANE_I32_256(this->i, 2);
+		baseAddress[d] = SIMD_LANE_I32_256(this->i, 3);
+		baseAddress[e] = SIMD_LANE_I32_256(this->i, 4);
+		baseAddress[f] = SIMD_LANE_I32_256(this->i, 5);
+		baseAddress[g] = SIMD_LANE_I32_256(this->i, 6);
+		baseAddress[h] = SIMD_LANE_I32_256(this->i, 7);
 	}
 
 	void scatter(int* baseAddress, __m256i indices) const
 	{
-		baseAddress[indices.m256i_i32[0]] = this->i.m256i_i32[0];
-		baseAddress[indices.m256i_i32[1]] = this->i.m256i_i32[1];
-		baseAddress[indices.m256i_i32[2]] = this->i.m256i_i32[2];
-		baseAddress[indices.m256i_i32[3]] = this->i.m256i_i32[3];
-		baseAddress[indices.m256i_i32[4]] = this->i.m256i_i32[4];
-		baseAddress[indices.m256i_i32[5]] = this->i.m256i_i32[5];
-		baseAddress[indices.m256i_i32[6]] = this->i.m256i_i32[6];
-		baseAddress[indices.m256i_i32[7]] = this->i.m256i_i32[7];
+		baseAddress[SIMD_LANE_I32_256(indices, 0)] = SIMD_LANE_I32_256(this->i, 0);
+		baseAddress[SIMD_LANE_I32_256(indices, 1)] = SIMD_LANE_I32_256(this->i, 1);
+		baseAddress[SIMD_LANE_I32_256(indices, 2)] = SIMD_LANE_I32_256(this->i, 2);
+		baseAddress[SIMD_LANE_I32_256(indices, 3)] = SIMD_LANE_I32_256(this->i, 3);
+		baseAddress[SIMD_LANE_I32_256(indices, 4)] = SIMD_LANE_I32_256(this->i, 4);
+		baseAddress[SIMD_LANE_I32_256(indices, 5)] = SIMD_LANE_I32_256(this->i, 5);
+		baseAddress[SIMD_LANE_I32_256(indices, 6)] = SIMD_LANE_I32_256(this->i, 6);
+		baseAddress[SIMD_LANE_I32_256(indices, 7)] = SIMD_LANE_I32_256(this->i, 7);
 	}
 #endif
 
@@ -581,7 +613,11 @@ static w8_int operator-(w8_int a, w8_int b) { return _mm256_sub_epi32(a, b); }
 static w8_int& operator-=(w8_int& a, w8_int b) { a = a - b; return a; }
 static w8_int operator*(w8_int a, w8_int b) { return _mm256_mul_epi32(a, b); }
 static w8_int& operator*=(w8_int& a, w8_int b) { a = a * b; return a; }
+#if defined(_MSC_VER)
 static w8_int operator/(w8_int a, w8_int b) { return _mm256_div_epi32(a, b); }
+#else
+static w8_int operator/(w8_int a, w8_int b) { return w8_int(a[0] / b[0], a[1] / b[1], a[2] / b[2], a[3] / b[3], a[4] / b[4], a[5] / b[5], a[6] / b[6], a[7] / b[7]); } // _mm256_div_epi32 is an MSVC (SVML) intrinsic.
+#endif
 static w8_int& operator/=(w8_int& a, w8_int b) { a = a / b; return a; }
 static w8_int operator&(w8_int a, w8_int b) { return _mm256_and_si256(a, b); }
 static w8_int& operator&=(w8_int& a, w8_int b) { a = a & b; return a; }
@@ -662,7 +698,7 @@ static w8_float& operator<<=(w8_float& a, int b) { a = a << b; return a; }
 
 static w8_float operator-(w8_float a) { return _mm256_xor_ps(a, reinterpret(w8_int(1 << 31))); }
 
-static float addElements(w8_float a) { __m256 aa = _mm256_hadd_ps(a, a); aa = _mm256_hadd_ps(aa, aa); return aa.m256_f32[0] + aa.m256_f32[4]; }
+static float addElements(w8_float a) { __m256 aa = _mm256_hadd_ps(a, a); aa = _mm256_hadd_ps(aa, aa); return SIMD_LANE_F32_256(aa, 0) + SIMD_LANE_F32_256(aa, 4); }
 
 NODISCARD static w8_float fmadd(w8_float a, w8_float b, w8_float c) { return _mm256_fmadd_ps(a, b, c); }
 NODISCARD static w8_float fmsub(w8_float a, w8_float b, w8_float c) { return _mm256_fmsub_ps(a, b, c); }
@@ -884,6 +920,24 @@ static void store8(float* baseAddress, const uint16* indices, uint32 stride,
 	in6.store(baseAddress + strideInFloats * indices[6]);
 	in7.store(baseAddress + strideInFloats * indices[7]);
 }
+
+// Same as store8, but lanes whose index equals skipIndex are not written.
+static void store8Except(float* baseAddress, const uint16* indices, uint16 skipIndex, uint32 stride,
+	w8_float in0, w8_float in1, w8_float in2, w8_float in3, w8_float in4, w8_float in5, w8_float in6, w8_float in7)
+{
+	const uint32 strideInFloats = stride / sizeof(float);
+
+	transpose(in0, in1, in2, in3, in4, in5, in6, in7);
+
+	if (indices[0] != skipIndex) { in0.store(baseAddress + strideInFloats * indices[0]); }
+	if (indices[1] != skipIndex) { in1.store(baseAddress + strideInFloats * indices[1]); }
+	if (indices[2] != skipIndex) { in2.store(baseAddress + strideInFloats * indices[2]); }
+	if (indices[3] != skipIndex) { in3.store(baseAddress + strideInFloats * indices[3]); }
+	if (indices[4] != skipIndex) { in4.store(baseAddress + strideInFloats * indices[4]); }
+	if (indices[5] != skipIndex) { in5.store(baseAddress + strideInFloats * indices[5]); }
+	if (indices[6] != skipIndex) { in6.store(baseAddress + strideInFloats * indices[6]); }
+	if (indices[7] != skipIndex) { in7.store(baseAddress + strideInFloats * indices[7]); }
+}
 #endif
 
 #if defined(SIMD_AVX_512)
@@ -943,7 +997,23 @@ static w16_int operator-(w16_int a, w16_int b) { return _mm512_sub_epi32(a, b);
 static w16_int& operator-=(w16_int& a, w16_int b) { a = a - b; return a; }
 static w16_int operator*(w16_int a, w16_int b) { return _mm512_mul_epi32(a, b); }
 static w16_int& operator*=(w16_int& a, w16_int b) { a = a * b; return a; }
+#if defined(_MSC_VER)
 static w16_int operator/(w16_int a, w16_int b) { return _mm512_div_epi32(a, b); }
+#else
+static w16_int operator/(w16_int a, w16_int b)
+{
+	// _mm512_div_epi32 is an MSVC (SVML) intrinsic.
+	alignas(64) int32 x[16];
+	alignas(64) int32 y[16];
+	_mm512_store_si512(x, a);
+	_mm512_store_si512(y, b);
+	for (uint32 i = 0; i < 16; ++i)
+	{
+		x[i] /= y[i];
+	}
+	return _mm512_load_si512(x);
+}
+#endif
 static w16_int& operator/=(w16_int& a, w16_int b) { a = a / b; return a; }
 static w16_int operator&(w16_int a, w16_int b) { return _mm512_and_epi32(a, b); }
 static w16_int& operator&=(w16_int& a, w16_int b) { a = a & b; return a; }
@@ -2,6 +2,7 @@
 #include <functional>
 
 // All functions return the value before the operation.
+#if defined(_WIN32)
 NODISCARD static uint32 atomicAdd(volatile uint32& a, uint32 b) { return InterlockedAdd((volatile LONG*)&a, b) - b; }
 NODISCARD static uint64 atomicAdd(volatile uint64& a, uint64 b) {	return InterlockedAdd64((volatile LONG64*)&a, b) - b; }
 NODISCARD static uint32 atomicIncrement(volatile uint32& a) {	return InterlockedIncrement((volatile LONG*)&a) - 1; }
@@ -19,4 +20,22 @@ NODISCARD static uint32 getThreadIDFast()
 	uint8* threadLocalStorage = (uint8*)__readgsqword(0x30);
 	uint32 threadID = *(uint32*)(threadLocalStorage + 0x48);
 	return threadID;
-}
\ No newline at end of file
+}
+#else
+NODISCARD static uint32 atomicAdd(volatile uint32& a, uint32 b) { return __atomic_fetch_add(&a, b, __ATOMIC_SEQ_CST); }
+NODISCARD static uint64 atomicAdd(volatile uint64& a, uint64 b) { return __atomic_fetch_add(&a, b, __ATOMIC_SEQ_CST); }
+NODISCARD static uint32 atomicIncrement(volatile uint32& a) { return __atomic_fetch_add(&a, 1, __ATOMIC_SEQ_CST); }
+NODISCARD static uint64 atomicIncrement(volatile uint64& a) { return __atomic_fetch_add(&a, 1, __ATOMIC_SEQ_CST); }
+NODISCARD static uint32 atomicDecrement(volatile uint32& a) { return __atomic_fetch_sub(&a, 1, __ATOMIC_SEQ_CST); }
+NODISCARD static uint64 atomicDecrement(volatile uint64& a) { return __atomic_fetch_sub(&a, 1, __ATOMIC_SEQ_CST); }
+NODISCARD static uint32 atomicCompareExchange(volatile uint32& destination, uint32 exchange, uint32 compare) { __atomic_compare_exchange_n(&destination, &compare, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); return compare; }
+NODISCARD static uint64 atomicCompareExchange(volatile uint64& destination, uint64 exchange, uint64 compare) { __atomic_compare_exchange_n(&destination, &compare, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); return compare; }
+NODISCARD static uint32 atomicExchange(volatile uint32& destination, uint32 exchange) { return __atomic_exchange_n(&destination, exchange, __ATOMIC_SEQ_CST); }
+NODISCARD static uint64 atomicExchange(volatile uint64& destination, uint64 exchange) { return __atomic_exchange_n(&destination, exchange, __ATOMIC_SEQ_CST); }
+
+NODISCARD static uint32 getThreadIDFast()
+{
+	// Only used to tell threads apart (e.g. in the profiler), so the truncated hash of the thread's id is good enough.
+	return (uint32)std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+#endif
\ No newline at end of file
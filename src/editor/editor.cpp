@@ -1247,6 +1247,8 @@ bool eeditor::drawSceneHierarchy()
 								ImGui::PropertySlider("Angular velocity damping", rb.angularDamping));
 							UNDOABLE_COMPONENT_SETTING("rigid body gravity factor", rb.gravityFactor,
 								ImGui::PropertySlider("Gravity factor", rb.gravityFactor));
+							UNDOABLE_COMPONENT_SETTING("rigid body continuous collision", rb.continuousCollision,
+								ImGui::PropertyCheckbox("Continuous collision", rb.continuousCollision));
 
 							ImGui::PropertyValue("Linear velocity", rb.linearVelocity);
 							ImGui::PropertyValue("Angular velocity", rb.angularVelocity);
@@ -2946,6 +2948,17 @@ void eeditor::drawSettings(float dt)
 					ImGui::PropertyCheckbox("SIMD narrow phase", physicsSettings.simdNarrowPhase));
 				UNDOABLE_SETTING("SIMD constraint solver", physicsSettings.simdConstraintSolver,
 					ImGui::PropertyCheckbox("SIMD constraint solver", physicsSettings.simdConstraintSolver));
+				UNDOABLE_SETTING("parallel constraint solver", physicsSettings.parallelConstraintSolver,
+					ImGui::PropertyCheckbox("Parallel constraint solver", physicsSettings.parallelConstraintSolver));
+				UNDOABLE_SETTING("warm start collisions", physicsSettings.warmStartCollisions,
+					ImGui::PropertyCheckbox("Warm start collisions", physicsSettings.warmStartCollisions));
+
+				UNDOABLE_SETTING("enable sleeping", physicsSettings.enableSleeping,
+					ImGui::PropertyCheckbox("Enable sleeping", physicsSettings.enableSleeping));
+				UNDOABLE_SETTING("time to sleep", physicsSettings.timeToSleep,
+					ImGui::PropertySlider("Time to sleep", physicsSettings.timeToSleep, 0.f, 5.f));
+				UNDOABLE_SETTING("enable CCD", physicsSettings.enableCCD,
+					ImGui::PropertyCheckbox("Continuous collision detection", physicsSettings.enableCCD));
 
 				ImGui::EndProperties();
 			}
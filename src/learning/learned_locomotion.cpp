@@ -85,6 +85,24 @@ void learned_locomotion::updateConstraint(escene& scene, cone_twist_constraint_h
 	c.swingMotorAxis = action.swingAxisAngle;
 }
 
+void learned_locomotion::updateJoint(articulation_joint& joint, hinge_action action) const
+{
+	joint.maxMotorTorque = 200.f;
+	joint.motorType = constraint_position_motor;
+	joint.motorTargetAngle = action.targetAngle;
+}
+
+void learned_locomotion::updateJoint(articulation_joint& joint, cone_twist_action action) const
+{
+	joint.maxSwingMotorTorque = 200.f;
+	joint.maxTwistMotorTorque = 200.f;
+	joint.swingMotorType = constraint_position_motor;
+	joint.twistMotorType = constraint_position_motor;
+	joint.swingMotorTargetAngle = action.swingTargetAngle;
+	joint.twistMotorTargetAngle = action.twistTargetAngle;
+	joint.swingMotorAxis = action.swingAxisAngle;
+}
+
 void learned_locomotion::applyAction(escene& scene, const learning_action& action)
 {
 	const float beta = 0.1f;
@@ -96,6 +114,20 @@ void learned_locomotion::applyAction(escene& scene, const learning_action& actio
 		out[i] = lerp(out[i], in[i], beta);
 	}
 
+	if (ragdoll.articulated)
+	{
+		articulation_component& articulation = ragdoll.torso.getComponent<articulation_component>();
+		for (uint32 i = 0; i < NUM_CONE_TWIST_CONSTRAINTS; ++i)
+		{
+			updateJoint(articulation.getJoint(ragdoll.sphericalJoints[i]), lastSmoothedAction.coneTwistActions[i]);
+		}
+		for (uint32 i = 0; i < NUM_HINGE_CONSTRAINTS; ++i)
+		{
+			updateJoint(articulation.getJoint(ragdoll.hingeJoints[i]), lastSmoothedAction.hingeActions[i]);
+		}
+		return;
+	}
+
 	for (uint32 i = 0; i < NUM_CONE_TWIST_CONSTRAINTS; ++i)
 	{
 		updateConstraint(scene, ragdoll.coneTwistConstraints[i], lastSmoothedAction.coneTwistActions[i]);
@@ -301,8 +333,8 @@ void training_locomotion::reset(escene& scene)
 
 	for (uint32 i = 0; i < NUM_BODY_PARTS; ++i)
 	{
-		getLocalPositions(ragdoll.bodyParts[i], localPositions[i]);
-		getBodyPartTarget(ragdoll.bodyParts[i], ragdoll.bodyPartParents[i], targets[i], localPositions[i], torsoTransform);
+		getLocalPositions(ragdoll.bodyPart(i), localPositions[i]);
+		getBodyPartTarget(ragdoll.bodyPart(i), ragdoll.bodyPartParent(i), targets[i], localPositions[i], torsoTransform);
 	}
 
 	learned_locomotion::reset(scene);
@@ -330,7 +362,7 @@ float training_locomotion::getReward() const
 
 	for (uint32 i = 0; i < NUM_BODY_PARTS; ++i)
 	{
-		body_part_error err = readPartDifference(ragdoll.bodyParts[i], ragdoll.bodyPartParents[i], targets[i], localPositions[i], torsoTransform);
+		body_part_error err = readPartDifference(ragdoll.bodyPart(i), ragdoll.bodyPartParent(i), targets[i], localPositions[i], torsoTransform);
 		positionError += err.positionError;
 		velocityError += err.velocityError;
 		rotationError += err.rotationError;
@@ -443,7 +475,7 @@ extern "C" __declspec(dllexport) int updatePhysics(float* action, float* outStat
 	{
 		uint32 bodyPartIndex = rng.randomUint32Between(0, learned_locomotion::NUM_BODY_PARTS - 1);
 
-		vec3 part = trainingEnv->ragdoll.bodyParts[bodyPartIndex].getComponent<transform_component>().position + vec3(0.f, 0.2f, 0.f);
+		vec3 part = trainingEnv->ragdoll.bodyPart(bodyPartIndex).getComponent<transform_component>().position + vec3(0.f, 0.2f, 0.f);
 		vec3 direction = normalize(vec3(rng.randomFloatBetween(-1.f, 1.f), 0.f, rng.randomFloatBetween(-1.f, 1.f)));
 		vec3 origin = part - direction * 5.f;
 
@@ -452,6 +484,7 @@ extern "C" __declspec(dllexport) int updatePhysics(float* action, float* outStat
 
 	physics_settings physicsSettings;
 	physicsSettings.frameRate = 60;
+	physicsSettings.enableSleeping = false; // Motor targets change without applying forces, so the ragdoll must never fall asleep.
 
 	const float physicsFixedTimeStep = 1.f / (float)physicsSettings.frameRate;
 	float physicsTimer = 0.f;
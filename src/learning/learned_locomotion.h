@@ -10,7 +10,7 @@ struct learned_locomotion
 
 	static const uint32 NUM_CONE_TWIST_CONSTRAINTS =  arraysize(humanoid_ragdoll::coneTwistConstraints);
 	static const uint32 NUM_HINGE_CONSTRAINTS = arraysize(humanoid_ragdoll::hingeConstraints);
-	static const uint32 NUM_BODY_PARTS = arraysize(humanoid_ragdoll::bodyParts);
+	static const uint32 NUM_BODY_PARTS = humanoid_ragdoll::numBodyParts;
 
 	struct hinge_action
 	{
@@ -67,6 +67,8 @@ struct learned_locomotion
 protected:
 	void updateConstraint(escene& scene, hinge_constraint_handle handle, hinge_action action = {}) const;
 	void updateConstraint(escene& scene, cone_twist_constraint_handle handle, cone_twist_action action = {}) const;
+	void updateJoint(articulation_joint& joint, hinge_action action) const; // Used instead of the constraints if the ragdoll is articulated.
+	void updateJoint(articulation_joint& joint, cone_twist_action action) const;
 	void applyAction(escene& scene, const learning_action& action);
 
 	NODISCARD trs getCoordinateSystem() const;
@@ -5,10 +5,17 @@
 
 #define LOG_LEVEL_PROFILE 0
 
+#if defined(_WIN32)
 #include <Windows.h>
 #include <windowsx.h>
 #include <tchar.h>
+#endif
 
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 #include <limits>
 #include <array>
 #include <string>
@@ -20,7 +27,13 @@
 namespace fs = std::filesystem;
 
 #include <mutex>
+
+#if defined(_WIN32)
 #include <wrl.h> 
+#else
+// Only PHYSICS_ONLY tools (e.g. the headless physics benchmark) are built on other platforms. They need nothing from Windows.h except this intrinsic.
+inline void __debugbreak() { __builtin_trap(); }
+#endif
 
 #define RELEASE_PTR(ptr) if(ptr) { delete ptr; ptr = nullptr; }
 #define RELEASE_ARRAY_PTR(arrayPtr) if(arrayPtr) { delete[] arrayPtr; arrayPtr = nullptr; } 
@@ -64,8 +77,10 @@ template <typename T> struct is_ref<ref<T>> : std::true_type {};
 template <typename T> inline constexpr bool is_ref_v = is_ref<T>::value;
 
 
+#if defined(_WIN32)
 template <typename T>
 using com = Microsoft::WRL::ComPtr<T>;
+#endif
 
 #define arraysize(arr) (sizeof(arr) / sizeof((arr)[0]))
 
@@ -86,6 +101,7 @@ template <auto V> static constexpr auto force_consteval = V;
 #define setBit(mask, bit) (mask) |= (1 << (bit))
 #define unsetBit(mask, bit) (mask) ^= (1 << (bit))
 
+#if defined(_WIN32)
 static void checkResultInternal(HRESULT hr, const char* file, int32 line)
 {
 	if (FAILED(hr))
@@ -105,4 +121,5 @@ static void checkResultInternal(HRESULT hr, const char* file, int32 line)
 	}
 }
 
-#define checkResult(hr) checkResultInternal(hr, __FILE__, __LINE__)
\ No newline at end of file
+#define checkResult(hr) checkResultInternal(hr, __FILE__, __LINE__)
+#endif
\ No newline at end of file
@@ -0,0 +1,927 @@
+#include "pch.h"
+#include "articulation.h"
+#include "physics.h"
+#include "snapshot.h"
+#include "core/cpu_profiling.h"
+#include "core/job_system.h"
+
+#define ARTICULATION_LIMIT_BETA 0.2f
+#define ARTICULATION_SWING_MOTOR_GAIN 0.2f // Same as the cone twist constraint.
+#define ARTICULATION_MIN_SWING_ANGLE 1e-4f
+#define DT_THRESHOLD 1e-5f
+
+// Spatial (6D) vectors and matrices. Everything is given in world space, relative to a reference point, which is fixed during one step
+// (the center of gravity of the root at the beginning of the step). With a common frame, no coordinate transforms between links are needed.
+// Motion vectors are (angular velocity, velocity of the point at the reference). Force vectors are (torque around the reference, force).
+struct spatial_vector
+{
+	vec3 angular;
+	vec3 linear;
+};
+
+static spatial_vector operator+(spatial_vector a, spatial_vector b) { return { a.angular + b.angular, a.linear + b.linear }; }
+static spatial_vector operator-(spatial_vector a, spatial_vector b) { return { a.angular - b.angular, a.linear - b.linear }; }
+static spatial_vector operator-(spatial_vector a) { return { -a.angular, -a.linear }; }
+static spatial_vector operator*(spatial_vector a, float b) { return { a.angular * b, a.linear * b }; }
+static spatial_vector& operator+=(spatial_vector& a, spatial_vector b) { a = a + b; return a; }
+static float dot(spatial_vector a, spatial_vector b) { return dot(a.angular, b.angular) + dot(a.linear, b.linear); }
+
+static const spatial_vector zeroSpatialVector = { vec3(0.f), vec3(0.f) };
+
+static spatial_vector crossMotion(spatial_vector v, spatial_vector m) { return { cross(v.angular, m.angular), cross(v.angular, m.linear) + cross(v.linear, m.angular) }; }
+static spatial_vector crossForce(spatial_vector v, spatial_vector f) { return { cross(v.angular, f.angular) + cross(v.linear, f.linear), cross(v.angular, f.linear) }; }
+
+// Velocity of a body at its center of gravity c (relative to the reference point) to spatial velocity and back.
+static spatial_vector toSpatialVelocity(vec3 linearVelocity, vec3 angularVelocity, vec3 c) { return { angularVelocity, linearVelocity + cross(c, angularVelocity) }; }
+static vec3 linearVelocityAt(spatial_vector v, vec3 c) { return v.linear + cross(v.angular, c); }
+
+struct spatial_matrix
+{
+	// Blocks, which map angular and linear parts to angular and linear parts.
+	mat3 aa, al;
+	mat3 la, ll;
+};
+
+static const spatial_matrix zeroSpatialMatrix = { mat3::zero, mat3::zero, mat3::zero, mat3::zero };
+
+static spatial_vector operator*(const spatial_matrix& m, spatial_vector v) { return { m.aa * v.angular + m.al * v.linear, m.la * v.angular + m.ll * v.linear }; }
+static spatial_matrix operator+(const spatial_matrix& a, const spatial_matrix& b) { return { a.aa + b.aa, a.al + b.al, a.la + b.la, a.ll + b.ll }; }
+static spatial_matrix operator-(const spatial_matrix& a, const spatial_matrix& b) { return { a.aa - b.aa, a.al - b.al, a.la - b.la, a.ll - b.ll }; }
+
+static spatial_matrix outerProduct(spatial_vector a, spatial_vector b)
+{
+	return { outerProduct(a.angular, b.angular), outerProduct(a.angular, b.linear), outerProduct(a.linear, b.angular), outerProduct(a.linear, b.linear) };
+}
+
+// Inertia of a rigid body with the given mass and rotational inertia (around the center of gravity) at c.
+static spatial_matrix spatialInertia(float mass, const mat3& inertia, vec3 c)
+{
+	mat3 cx = getSkewMatrix(c);
+	return { inertia - cx * cx * mass, cx * mass, cx * -mass, mat3::identity * mass };
+}
+
+// Solves m * x = r with the Schur complement of the linear block. m must be a (symmetric positive definite) inertia.
+static spatial_vector solve(const spatial_matrix& m, spatial_vector r)
+{
+	mat3 invLL = invert(m.ll);
+	mat3 schur = m.aa - m.al * invLL * m.la;
+	vec3 angular = invert(schur) * (r.angular - m.al * (invLL * r.linear));
+	vec3 linear = invLL * (r.linear - m.la * angular);
+	return { angular, linear };
+}
+
+struct articulation_link_scratch
+{
+	rigid_body_component* rb;
+	physics_transform1_component* transform;
+
+	vec3 cog; // Relative to the reference point.
+	vec3 anchor; // Relative to the reference point.
+
+	// Motion subspace of the joint. One column per degree of freedom of the joint velocity, the columns of unused degrees of freedom are zero.
+	spatial_vector S[3];
+
+	spatial_matrix inertia;
+	spatial_matrix articulatedInertia; // Inertia of the link including its subtree.
+	spatial_matrix projectedInertia; // Articulated inertia as seen by the parent through the joint.
+	spatial_vector U[3]; // articulatedInertia * S.
+	mat3 D; // Joint space inertia S^T * U. Padded with identity for unused degrees of freedom.
+	mat3 invD;
+
+	spatial_vector velocity;
+
+	// Temporaries of the recursions.
+	spatial_vector bias;
+	spatial_vector velocityProduct;
+	spatial_vector acceleration;
+	vec3 u;
+};
+
+struct articulation_instance
+{
+	articulation_component* articulation;
+	articulation_link_scratch* links;
+	uint32 numLinks;
+	vec3 reference;
+	bool fixedBase; // Kinematic root.
+	trs rootTransform; // At the beginning of the step. The rigid body integration moves the root with the solver velocity, which is replaced afterwards.
+
+	// Scratch for impulses, one per link.
+	spatial_vector* linkImpulses;
+	vec3* jointImpulses;
+};
+
+struct articulation_step
+{
+	articulation_instance* instances;
+	uint32 count;
+};
+
+static vec3 transposeMul(const spatial_vector (&columns)[3], spatial_vector v) { return vec3(dot(columns[0], v), dot(columns[1], v), dot(columns[2], v)); }
+static spatial_vector mul(const spatial_vector (&columns)[3], vec3 v) { return columns[0] * v.x + columns[1] * v.y + columns[2] * v.z; }
+
+static float wrapAngle(float angle)
+{
+	while (angle > M_PI) { angle -= 2.f * M_PI; }
+	while (angle < -M_PI) { angle += 2.f * M_PI; }
+	return angle;
+}
+
+static quat getJointRotation(const articulation_joint& joint)
+{
+	return (joint.type == articulation_joint_hinge) ? quat(joint.localAxis, joint.angle) : joint.rotation;
+}
+
+articulation_component::articulation_component(entity_handle root)
+{
+	articulation_link& link = links.emplace_back();
+	link.entity = root;
+	link.parent = -1;
+}
+
+uint32 articulation_component::addLink(eentity& parent, eentity& child, const articulation_joint& joint)
+{
+	ASSERT(parent.registry == child.registry);
+	ASSERT(!links.empty());
+
+	int32 parentIndex = -1;
+	for (uint32 i = 0; i < (uint32)links.size(); ++i)
+	{
+		ASSERT(links[i].entity != child.handle);
+		if (links[i].entity == parent.handle)
+		{
+			parentIndex = (int32)i;
+		}
+	}
+	ASSERT(parentIndex != -1);
+
+	rigid_body_component& parentRB = parent.getComponent<rigid_body_component>();
+	rigid_body_component& childRB = child.getComponent<rigid_body_component>();
+	ASSERT(childRB.invMass > 0.f);
+
+	if (links.size() == 1)
+	{
+		rootLinearVelocity = parentRB.linearVelocity;
+		rootAngularVelocity = parentRB.angularVelocity;
+	}
+
+	parentRB.articulated = true;
+	childRB.articulated = true;
+	parentRB.wakeUp();
+	childRB.wakeUp();
+
+	articulation_link& link = links.emplace_back();
+	link.entity = child.handle;
+	link.parent = parentIndex;
+	link.joint = joint;
+
+	return (uint32)links.size() - 1;
+}
+
+static articulation_joint createJoint(articulation_joint_type type, const trs& parentTransform, const trs& childTransform, vec3 globalAnchor, vec3 globalAxis)
+{
+	articulation_joint joint;
+	joint.type = type;
+
+	joint.localAnchorParent = inverseTransformPosition(parentTransform, globalAnchor);
+	joint.localAnchorChild = inverseTransformPosition(childTransform, globalAnchor);
+	joint.restRotation = conjugate(parentTransform.rotation) * childTransform.rotation;
+
+	joint.localAxis = normalize(inverseTransformDirection(parentTransform, globalAxis));
+	getTangents(joint.localAxis, joint.localTangent, joint.localBitangent);
+
+	joint.minRotationLimit = 1.f;
+	joint.maxRotationLimit = -1.f;
+	joint.swingLimit = -1.f;
+	joint.twistLimit = -1.f;
+
+	// Motors are disabled by default.
+	joint.motorType = constraint_velocity_motor;
+	joint.motorVelocity = 0.f;
+	joint.maxMotorTorque = -1.f;
+
+	joint.swingMotorType = constraint_velocity_motor;
+	joint.swingMotorVelocity = 0.f;
+	joint.maxSwingMotorTorque = -1.f;
+	joint.swingMotorAxis = 0.f;
+
+	joint.twistMotorType = constraint_velocity_motor;
+	joint.twistMotorVelocity = 0.f;
+	joint.maxTwistMotorTorque = -1.f;
+
+	joint.angle = 0.f;
+	joint.rotation = quat::identity;
+	joint.velocity = vec3(0.f);
+
+	return joint;
+}
+
+uint32 articulation_component::addHingeJoint(eentity& parent, eentity& child, vec3 globalAnchor, vec3 globalHingeAxis, float minLimit, float maxLimit)
+{
+	articulation_joint joint = createJoint(articulation_joint_hinge, parent.getComponent<transform_component>(), child.getComponent<transform_component>(),
+		globalAnchor, globalHingeAxis);
+	joint.minRotationLimit = minLimit;
+	joint.maxRotationLimit = maxLimit;
+	return addLink(parent, child, joint);
+}
+
+uint32 articulation_component::addSphericalJoint(eentity& parent, eentity& child, vec3 globalAnchor, vec3 globalAxis, float swingLimit, float twistLimit)
+{
+	articulation_joint joint = createJoint(articulation_joint_spherical, parent.getComponent<transform_component>(), child.getComponent<transform_component>(),
+		globalAnchor, globalAxis);
+	joint.swingLimit = swingLimit;
+	joint.twistLimit = twistLimit;
+	return addLink(parent, child, joint);
+}
+
+struct articulation_joint_state
+{
+	float angle;
+	quat rotation;
+	vec3 velocity;
+};
+
+void articulation_component::writeSnapshot(physics_snapshot_writer& writer) const
+{
+	writer.write(rootLinearVelocity);
+	writer.write(rootAngularVelocity);
+
+	uint32 numLinks = (uint32)links.size();
+	writer.write(numLinks);
+	for (const articulation_link& link : links)
+	{
+		writer.write(articulation_joint_state{ link.joint.angle, link.joint.rotation, link.joint.velocity });
+	}
+}
+
+bool articulation_component::readSnapshot(physics_snapshot_reader& reader)
+{
+	uint32 numLinks;
+	if (!reader.read(rootLinearVelocity) || !reader.read(rootAngularVelocity) || !reader.read(numLinks) || numLinks != (uint32)links.size())
+	{
+		return false;
+	}
+
+	for (articulation_link& link : links)
+	{
+		articulation_joint_state state;
+		if (!reader.read(state))
+		{
+			return false;
+		}
+		link.joint.angle = state.angle;
+		link.joint.rotation = state.rotation;
+		link.joint.velocity = state.velocity;
+	}
+	return true;
+}
+
+void wakeUpArticulations(escene& scene)
+{
+	for (auto [entityHandle, articulation] : scene.view<articulation_component>().each())
+	{
+		bool anyAwake = false;
+		bool allValid = true;
+		for (const articulation_link& link : articulation.links)
+		{
+			eentity entity = { link.entity, scene };
+			rigid_body_component* rb = entity.valid() ? entity.getComponentIfExists<rigid_body_component>() : 0;
+			if (!rb || !entity.hasComponent<physics_transform1_component>())
+			{
+				allValid = false;
+				break;
+			}
+			anyAwake |= !rb->isSleeping();
+		}
+
+		if (!allValid)
+		{
+			// A link has been deleted. Dissolve the articulation into free rigid bodies.
+			for (const articulation_link& link : articulation.links)
+			{
+				eentity entity = { link.entity, scene };
+				if (rigid_body_component* rb = entity.valid() ? entity.getComponentIfExists<rigid_body_component>() : 0)
+				{
+					rb->articulated = false;
+				}
+			}
+			articulation.links.clear();
+			continue;
+		}
+
+		for (articulation_link& link : articulation.links)
+		{
+			rigid_body_component& rb = scene.registry.get<rigid_body_component>(link.entity);
+			if (anyAwake)
+			{
+				// Keep the sleep timer, so that the articulation falls asleep once all links have been resting for long enough.
+				rb.sleepingIsland = 0;
+			}
+			else
+			{
+				link.joint.velocity = vec3(0.f);
+			}
+		}
+
+		if (!anyAwake)
+		{
+			articulation.rootLinearVelocity = vec3(0.f);
+			articulation.rootAngularVelocity = vec3(0.f);
+		}
+	}
+}
+
+// Forward kinematics. Places all links according to the root transform and the joint state, and sets up the inertias and motion subspaces.
+static void computeKinematics(articulation_instance& instance)
+{
+	const articulation_component& articulation = *instance.articulation;
+	articulation_link_scratch* links = instance.links;
+
+	instance.reference = links[0].rb->getGlobalCOGPosition(*links[0].transform);
+
+	for (uint32 i = 0; i < instance.numLinks; ++i)
+	{
+		articulation_link_scratch& s = links[i];
+		const rigid_body_component& rb = *s.rb;
+		trs& transform = *s.transform;
+
+		if (i > 0)
+		{
+			const articulation_joint& joint = articulation.links[i].joint;
+			const trs& parentTransform = *links[articulation.links[i].parent].transform;
+
+			vec3 globalAnchor = transformPosition(parentTransform, joint.localAnchorParent);
+
+			transform.rotation = normalize(parentTransform.rotation * getJointRotation(joint) * joint.restRotation);
+			transform.position = globalAnchor - transform.rotation * joint.localAnchorChild;
+
+			s.anchor = globalAnchor - instance.reference;
+
+			if (joint.type == articulation_joint_hinge)
+			{
+				vec3 axis = parentTransform.rotation * joint.localAxis;
+				s.S[0] = { axis, cross(s.anchor, axis) };
+				s.S[1] = zeroSpatialVector;
+				s.S[2] = zeroSpatialVector;
+			}
+			else
+			{
+				const vec3 basis[] = { vec3(1.f, 0.f, 0.f), vec3(0.f, 1.f, 0.f), vec3(0.f, 0.f, 1.f) };
+				for (uint32 k = 0; k < 3; ++k)
+				{
+					vec3 axis = parentTransform.rotation * basis[k];
+					s.S[k] = { axis, cross(s.anchor, axis) };
+				}
+			}
+		}
+
+		s.cog = rb.getGlobalCOGPosition(transform) - instance.reference;
+
+		if (rb.invMass > 0.f)
+		{
+			mat3 rot = quaternionToMat3(transform.rotation);
+			mat3 inertia = rot * invert(rb.invInertia) * transpose(rot);
+			s.inertia = spatialInertia(1.f / rb.invMass, inertia, s.cog);
+		}
+		else
+		{
+			s.inertia = zeroSpatialMatrix;
+		}
+	}
+}
+
+// Articulated body inertias. Only depend on the configuration.
+static void computeArticulatedInertias(articulation_instance& instance)
+{
+	const articulation_component& articulation = *instance.articulation;
+	articulation_link_scratch* links = instance.links;
+
+	for (uint32 i = 0; i < instance.numLinks; ++i)
+	{
+		links[i].articulatedInertia = links[i].inertia;
+	}
+
+	for (uint32 i = instance.numLinks - 1; i > 0; --i)
+	{
+		articulation_link_scratch& s = links[i];
+		const articulation_joint& joint = articulation.links[i].joint;
+
+		for (uint32 k = 0; k < 3; ++k)
+		{
+			s.U[k] = s.articulatedInertia * s.S[k];
+		}
+
+		if (joint.type == articulation_joint_hinge)
+		{
+			s.D = mat3(
+				dot(s.S[0], s.U[0]), 0.f, 0.f,
+				0.f, 1.f, 0.f,
+				0.f, 0.f, 1.f);
+		}
+		else
+		{
+			s.D = mat3(
+				dot(s.S[0], s.U[0]), dot(s.S[0], s.U[1]), dot(s.S[0], s.U[2]),
+				dot(s.S[1], s.U[0]), dot(s.S[1], s.U[1]), dot(s.S[1], s.U[2]),
+				dot(s.S[2], s.U[0]), dot(s.S[2], s.U[1]), dot(s.S[2], s.U[2]));
+		}
+		s.invD = invert(s.D);
+
+		s.projectedInertia = s.articulatedInertia;
+		for (uint32 r = 0; r < 3; ++r)
+		{
+			vec3 invDRow = row(s.invD, r);
+			s.projectedInertia = s.projectedInertia - outerProduct(s.U[r], mul(s.U, invDRow));
+		}
+
+		articulation_link_scratch& parent = links[articulation.links[i].parent];
+		parent.articulatedInertia = parent.articulatedInertia + s.projectedInertia;
+	}
+}
+
+// Spatial velocities of all links from the root velocity and the joint velocities.
+static void computeVelocities(articulation_instance& instance)
+{
+	const articulation_component& articulation = *instance.articulation;
+	articulation_link_scratch* links = instance.links;
+
+	vec3 rootLinearVelocity = instance.fixedBase ? links[0].rb->linearVelocity : articulation.rootLinearVelocity;
+	vec3 rootAngularVelocity = instance.fixedBase ? links[0].rb->angularVelocity : articulation.rootAngularVelocity;
+	links[0].velocity = toSpatialVelocity(rootLinearVelocity, rootAngularVelocity, links[0].cog);
+
+	for (uint32 i = 1; i < instance.numLinks; ++i)
+	{
+		articulation_link_scratch& s = links[i];
+		s.velocity = links[articulation.links[i].parent].velocity + mul(s.S, articulation.links[i].joint.velocity);
+	}
+}
+
+static void writeVelocitiesToRigidBodies(articulation_instance& instance)
+{
+	for (uint32 i = 0; i < instance.numLinks; ++i)
+	{
+		articulation_link_scratch& s = instance.links[i];
+		if (i == 0 && instance.fixedBase)
+		{
+			continue;
+		}
+		s.rb->angularVelocity = s.velocity.angular;
+		s.rb->linearVelocity = linearVelocityAt(s.velocity, s.cog);
+	}
+}
+
+static void addRootVelocity(articulation_instance& instance, spatial_vector deltaVelocity)
+{
+	if (!instance.fixedBase)
+	{
+		articulation_component& articulation = *instance.articulation;
+		articulation.rootAngularVelocity += deltaVelocity.angular;
+		articulation.rootLinearVelocity += linearVelocityAt(deltaVelocity, instance.links[0].cog);
+	}
+}
+
+// Applies impulses to the articulation and updates the root and joint velocities. Link impulses are spatial force vectors, joint impulses are
+// given in joint space. Either may be null.
+static void propagateImpulses(articulation_instance& instance, const spatial_vector* linkImpulses, const vec3* jointImpulses)
+{
+	articulation_component& articulation = *instance.articulation;
+	articulation_link_scratch* links = instance.links;
+
+	for (uint32 i = 0; i < instance.numLinks; ++i)
+	{
+		links[i].bias = linkImpulses ? -linkImpulses[i] : zeroSpatialVector;
+	}
+
+	for (uint32 i = instance.numLinks - 1; i > 0; --i)
+	{
+		articulation_link_scratch& s = links[i];
+		s.u = (jointImpulses ? jointImpulses[i] : vec3(0.f)) - transposeMul(s.S, s.bias);
+		links[articulation.links[i].parent].bias += s.bias + mul(s.U, s.invD * s.u);
+	}
+
+	links[0].acceleration = instance.fixedBase ? zeroSpatialVector : -solve(links[0].articulatedInertia, links[0].bias);
+	addRootVelocity(instance, links[0].acceleration);
+	links[0].velocity += links[0].acceleration;
+
+	for (uint32 i = 1; i < instance.numLinks; ++i)
+	{
+		articulation_link_scratch& s = links[i];
+		const spatial_vector& parentDeltaVelocity = links[articulation.links[i].parent].acceleration;
+
+		vec3 deltaJointVelocity = s.invD * (s.u - transposeMul(s.U, parentDeltaVelocity));
+		articulation.links[i].joint.velocity += deltaJointVelocity;
+
+		s.acceleration = parentDeltaVelocity + mul(s.S, deltaJointVelocity);
+		s.velocity += s.acceleration;
+	}
+}
+
+// Propagates velocity changes of the rigid bodies, which were made outside of the articulation (by the constraint solver or by the user).
+static void propagateRigidBodyVelocityChanges(articulation_instance& instance)
+{
+	spatial_vector* impulses = instance.linkImpulses;
+
+	bool changed = false;
+	for (uint32 i = 0; i < instance.numLinks; ++i)
+	{
+		const articulation_link_scratch& s = instance.links[i];
+		if (i == 0 && instance.fixedBase)
+		{
+			impulses[i] = zeroSpatialVector;
+			continue;
+		}
+
+		spatial_vector deltaVelocity = toSpatialVelocity(s.rb->linearVelocity, s.rb->angularVelocity, s.cog) - s.velocity;
+		impulses[i] = s.inertia * deltaVelocity;
+		changed |= dot(deltaVelocity, deltaVelocity) > 1e-10f;
+	}
+
+	if (changed)
+	{
+		propagateImpulses(instance, impulses, 0);
+	}
+}
+
+// Featherstone's articulated body algorithm. Integrates the root and joint velocities under external forces, gravity and velocity products.
+static void integrateForces(articulation_instance& instance, vec3 globalForceField, float dt)
+{
+	articulation_component& articulation = *instance.articulation;
+	articulation_link_scratch* links = instance.links;
+
+	for (uint32 i = 0; i < instance.numLinks; ++i)
+	{
+		articulation_link_scratch& s = links[i];
+		const rigid_body_component& rb = *s.rb;
+
+		vec3 force = rb.forceAccumulator + globalForceField;
+		if (rb.invMass > 0.f)
+		{
+			force.y += GRAVITY / rb.invMass * rb.gravityFactor;
+		}
+		spatial_vector externalForce = { rb.torqueAccumulator + cross(s.cog, force), force };
+
+		s.bias = crossForce(s.velocity, s.inertia * s.velocity) - externalForce;
+		s.velocityProduct = (i > 0) ? crossMotion(links[articulation.links[i].parent].velocity, mul(s.S, articulation.links[i].joint.velocity)) : zeroSpatialVector;
+	}
+
+	for (uint32 i = instance.numLinks - 1; i > 0; --i)
+	{
+		articulation_link_scratch& s = links[i];
+		s.u = -transposeMul(s.S, s.bias);
+		links[articulation.links[i].parent].bias += s.bias + s.projectedInertia * s.velocityProduct + mul(s.U, s.invD * s.u);
+	}
+
+	links[0].acceleration = instance.fixedBase ? zeroSpatialVector : -solve(links[0].articulatedInertia, links[0].bias);
+	addRootVelocity(instance, links[0].acceleration * dt);
+
+	for (uint32 i = 1; i < instance.numLinks; ++i)
+	{
+		articulation_link_scratch& s = links[i];
+		spatial_vector acceleration = links[articulation.links[i].parent].acceleration + s.velocityProduct;
+
+		vec3 jointAcceleration = s.invD * (s.u - transposeMul(s.U, acceleration));
+		articulation.links[i].joint.velocity += jointAcceleration * dt;
+
+		s.acceleration = acceleration + mul(s.S, jointAcceleration);
+	}
+
+	// Damping.
+	if (!instance.fixedBase)
+	{
+		articulation.rootLinearVelocity *= 1.f / (1.f + dt * links[0].rb->linearDamping);
+		articulation.rootAngularVelocity *= 1.f / (1.f + dt * links[0].rb->angularDamping);
+	}
+	for (uint32 i = 1; i < instance.numLinks; ++i)
+	{
+		articulation.links[i].joint.velocity *= 1.f / (1.f + dt * links[i].rb->angularDamping);
+	}
+}
+
+static float getEffectiveInertia(const articulation_link_scratch& s, vec3 axis)
+{
+	return dot(axis, s.D * axis);
+}
+
+static float getSignedTwistAngle(quat twist, vec3 axis)
+{
+	return wrapAngle(2.f * atan2(dot(twist.v, axis), twist.w));
+}
+
+// Joint impulses of the motors. Like in the constraint solver, the motors try to reach their target velocity within one step, limited by their maximum torque.
+static void computeMotorImpulses(const articulation_instance& instance, vec3* outJointImpulses, float dt)
+{
+	const articulation_component& articulation = *instance.articulation;
+	float invDt = (dt > DT_THRESHOLD) ? (1.f / dt) : 0.f;
+
+	for (uint32 i = 1; i < instance.numLinks; ++i)
+	{
+		const articulation_joint& joint = articulation.links[i].joint;
+		const articulation_link_scratch& s = instance.links[i];
+		vec3 impulse(0.f);
+
+		if (joint.type == articulation_joint_hinge)
+		{
+			if (joint.maxMotorTorque > 0.f)
+			{
+				float targetVelocity = joint.motorVelocity;
+				if (joint.motorType == constraint_position_motor)
+				{
+					float minLimit = (joint.minRotationLimit <= 0.f) ? joint.minRotationLimit : -M_PI;
+					float maxLimit = (joint.maxRotationLimit >= 0.f) ? joint.maxRotationLimit : M_PI;
+					targetVelocity = (clamp(joint.motorTargetAngle, minLimit, maxLimit) - joint.angle) * invDt;
+				}
+
+				float maxImpulse = joint.maxMotorTorque * dt;
+				impulse.x = clamp(s.D.m00 * (targetVelocity - joint.velocity.x), -maxImpulse, maxImpulse);
+			}
+		}
+		else
+		{
+			vec3 axis = joint.localAxis;
+
+			if (joint.maxTwistMotorTorque > 0.f)
+			{
+				float targetVelocity = joint.twistMotorVelocity;
+				if (joint.twistMotorType == constraint_position_motor)
+				{
+					quat twist, swing;
+					decomposeQuaternionIntoTwistAndSwing(joint.rotation, axis, twist, swing);
+
+					float limit = (joint.twistLimit >= 0.f) ? joint.twistLimit : M_PI;
+					targetVelocity = (clamp(joint.twistMotorTargetAngle, -limit, limit) - getSignedTwistAngle(twist, axis)) * invDt;
+				}
+
+				float maxImpulse = joint.maxTwistMotorTorque * dt;
+				impulse += axis * clamp(getEffectiveInertia(s, axis) * (targetVelocity - dot(joint.velocity, axis)), -maxImpulse, maxImpulse);
+			}
+
+			if (joint.maxSwingMotorTorque > 0.f)
+			{
+				vec3 motorAxis = cos(joint.swingMotorAxis) * joint.localTangent + sin(joint.swingMotorAxis) * joint.localBitangent;
+				float targetVelocity = joint.swingMotorVelocity;
+
+				if (joint.swingMotorType == constraint_position_motor)
+				{
+					float targetAngle = joint.swingMotorTargetAngle;
+					if (joint.swingLimit >= 0.f)
+					{
+						targetAngle = clamp(targetAngle, -joint.swingLimit, joint.swingLimit);
+					}
+
+					vec3 targetDirection = quat(motorAxis, targetAngle) * axis;
+					vec3 currentDirection = joint.rotation * axis;
+					motorAxis = noz(cross(currentDirection, targetDirection));
+
+					float deltaAngle = acos(clamp(dot(targetDirection, currentDirection), -1.f, 1.f));
+					targetVelocity = deltaAngle * invDt * ARTICULATION_SWING_MOTOR_GAIN;
+				}
+
+				float maxImpulse = joint.maxSwingMotorTorque * dt;
+				impulse += motorAxis * clamp(getEffectiveInertia(s, motorAxis) * (targetVelocity - dot(joint.velocity, motorAxis)), -maxImpulse, maxImpulse);
+			}
+		}
+
+		outJointImpulses[i] = impulse;
+	}
+}
+
+// Impulse along the axis, so that the velocity along it stays within [minVelocity, maxVelocity].
+static vec3 getLimitImpulse(const articulation_link_scratch& s, vec3 axis, float velocity, float minVelocity, float maxVelocity)
+{
+	if (velocity < minVelocity)
+	{
+		return axis * (getEffectiveInertia(s, axis) * (minVelocity - velocity));
+	}
+	if (velocity > maxVelocity)
+	{
+		return axis * (getEffectiveInertia(s, axis) * (maxVelocity - velocity));
+	}
+	return vec3(0.f);
+}
+
+// Maximum velocity, so that the angle does not pass the limit in this step. Violated limits are pushed back softly.
+static float getLimitVelocity(float limit, float angle, float invDt, bool violated)
+{
+	return (limit - angle) * invDt * (violated ? ARTICULATION_LIMIT_BETA : 1.f);
+}
+
+// Joint impulses of the limits. Returns false if no limit is active.
+static bool computeLimitImpulses(const articulation_instance& instance, vec3* outJointImpulses, float dt)
+{
+	if (dt <= DT_THRESHOLD)
+	{
+		return false;
+	}
+
+	const articulation_component& articulation = *instance.articulation;
+	float invDt = 1.f / dt;
+	bool active = false;
+
+	for (uint32 i = 1; i < instance.numLinks; ++i)
+	{
+		const articulation_joint& joint = articulation.links[i].joint;
+		const articulation_link_scratch& s = instance.links[i];
+		vec3 impulse(0.f);
+
+		if (joint.type == articulation_joint_hinge)
+		{
+			float minVelocity = (joint.minRotationLimit <= 0.f) ? getLimitVelocity(joint.minRotationLimit, joint.angle, invDt, joint.angle < joint.minRotationLimit) : -FLT_MAX;
+			float maxVelocity = (joint.maxRotationLimit >= 0.f) ? getLimitVelocity(joint.maxRotationLimit, joint.angle, invDt, joint.angle > joint.maxRotationLimit) : FLT_MAX;
+			impulse = getLimitImpulse(s, vec3(1.f, 0.f, 0.f), joint.velocity.x, minVelocity, maxVelocity);
+		}
+		else
+		{
+			vec3 axis = joint.localAxis;
+
+			quat twist, swing;
+			decomposeQuaternionIntoTwistAndSwing(joint.rotation, axis, twist, swing);
+
+			if (joint.swingLimit >= 0.f)
+			{
+				if (swing.w < 0.f)
+				{
+					swing = quat(-swing.x, -swing.y, -swing.z, -swing.w);
+				}
+
+				vec3 swingAxis; float swingAngle;
+				getAxisRotation(swing, swingAxis, swingAngle);
+
+				if (swingAngle > ARTICULATION_MIN_SWING_ANGLE)
+				{
+					float maxVelocity = getLimitVelocity(joint.swingLimit, swingAngle, invDt, swingAngle > joint.swingLimit);
+					impulse += getLimitImpulse(s, swingAxis, dot(joint.velocity, swingAxis), -FLT_MAX, maxVelocity);
+				}
+			}
+
+			if (joint.twistLimit >= 0.f)
+			{
+				float twistAngle = getSignedTwistAngle(twist, axis);
+				vec3 childAxis = joint.rotation * axis;
+
+				float minVelocity = getLimitVelocity(-joint.twistLimit, twistAngle, invDt, twistAngle < -joint.twistLimit);
+				float maxVelocity = getLimitVelocity(joint.twistLimit, twistAngle, invDt, twistAngle > joint.twistLimit);
+				impulse += getLimitImpulse(s, childAxis, dot(joint.velocity, childAxis), minVelocity, maxVelocity);
+			}
+		}
+
+		outJointImpulses[i] = impulse;
+		active |= impulse != vec3(0.f);
+	}
+
+	return active;
+}
+
+static void applyJointLimits(articulation_instance& instance, float dt)
+{
+	instance.jointImpulses[0] = vec3(0.f);
+	if (computeLimitImpulses(instance, instance.jointImpulses, dt))
+	{
+		propagateImpulses(instance, 0, instance.jointImpulses);
+	}
+}
+
+static void applyJointMotors(articulation_instance& instance, float dt)
+{
+	instance.jointImpulses[0] = vec3(0.f);
+	computeMotorImpulses(instance, instance.jointImpulses, dt);
+	propagateImpulses(instance, 0, instance.jointImpulses);
+}
+
+static void integrateJoints(articulation_instance& instance, float dt)
+{
+	articulation_component& articulation = *instance.articulation;
+	articulation_link_scratch& root = instance.links[0];
+
+	if (!instance.fixedBase)
+	{
+		const trs& start = instance.rootTransform;
+		vec3 cogPosition = root.rb->getGlobalCOGPosition(start) + articulation.rootLinearVelocity * dt;
+
+		vec3 angularVelocity = articulation.rootAngularVelocity;
+		quat deltaRot(0.5f * angularVelocity.x, 0.5f * angularVelocity.y, 0.5f * angularVelocity.z, 0.f);
+		deltaRot = deltaRot * start.rotation;
+
+		trs& transform = *root.transform;
+		transform.rotation = normalize(start.rotation + (deltaRot * dt));
+		transform.position = cogPosition - transform.rotation * root.rb->localCOGPosition;
+	}
+
+	for (uint32 i = 1; i < instance.numLinks; ++i)
+	{
+		articulation_joint& joint = articulation.links[i].joint;
+		if (joint.type == articulation_joint_hinge)
+		{
+			joint.angle = wrapAngle(joint.angle + joint.velocity.x * dt);
+		}
+		else
+		{
+			vec3 w = joint.velocity;
+			quat deltaRot(0.5f * w.x, 0.5f * w.y, 0.5f * w.z, 0.f);
+			deltaRot = deltaRot * joint.rotation;
+			joint.rotation = normalize(joint.rotation + (deltaRot * dt));
+		}
+	}
+}
+
+articulation_step* integrateArticulationForces(escene& scene, eallocator& arena, const bool* sleepingPerBody, vec3 globalForceField, float dt)
+{
+	uint32 numArticulations = scene.numberOfComponentsOfType<articulation_component>();
+	if (numArticulations == 0)
+	{
+		return 0;
+	}
+
+	CPU_PROFILE_BLOCK("Integrate articulation forces");
+
+	articulation_step* step = arena.allocate<articulation_step>();
+	step->instances = arena.allocate<articulation_instance>(numArticulations);
+	step->count = 0;
+
+	for (auto [entityHandle, articulation] : scene.view<articulation_component>().each())
+	{
+		uint32 numLinks = (uint32)articulation.links.size();
+		if (numLinks < 2)
+		{
+			continue;
+		}
+
+		// wakeUpArticulations has made sure that the links are valid.
+		articulation_link_scratch* links = arena.allocate<articulation_link_scratch>(numLinks);
+		bool sleeping = false;
+		for (uint32 i = 0; i < numLinks; ++i)
+		{
+			eentity entity = { articulation.links[i].entity, scene };
+			sleeping |= sleepingPerBody[entity.getComponentIndex<rigid_body_component>()];
+			links[i].rb = &entity.getComponent<rigid_body_component>();
+			links[i].transform = &entity.getComponent<physics_transform1_component>();
+		}
+
+		if (sleeping)
+		{
+			continue;
+		}
+
+		articulation_instance& instance = step->instances[step->count++];
+		instance.articulation = &articulation;
+		instance.links = links;
+		instance.numLinks = numLinks;
+		instance.fixedBase = links[0].rb->invMass == 0.f;
+		instance.rootTransform = *links[0].transform;
+		instance.linkImpulses = arena.allocate<spatial_vector>(numLinks);
+		instance.jointImpulses = arena.allocate<vec3>(numLinks);
+	}
+
+	// Articulations are independent of each other.
+	parallelFor(highPriorityJobQueue, step->count, 4, [step, globalForceField, dt](uint32 begin, uint32 end)
+	{
+		for (uint32 i = begin; i < end; ++i)
+		{
+			articulation_instance& instance = step->instances[i];
+
+			computeKinematics(instance);
+			computeArticulatedInertias(instance);
+			computeVelocities(instance);
+
+			propagateRigidBodyVelocityChanges(instance);
+			integrateForces(instance, globalForceField, dt);
+			computeVelocities(instance);
+
+			applyJointMotors(instance, dt);
+			applyJointLimits(instance, dt);
+
+			writeVelocitiesToRigidBodies(instance);
+		}
+	});
+
+	CPU_PROFILE_STAT("Num articulations", step->count);
+
+	return step;
+}
+
+void integrateArticulationVelocities(escene& scene, articulation_step* step, float dt)
+{
+	if (!step || step->count == 0)
+	{
+		return;
+	}
+
+	CPU_PROFILE_BLOCK("Integrate articulation velocities");
+
+	parallelFor(highPriorityJobQueue, step->count, 4, [step, dt](uint32 begin, uint32 end)
+	{
+		for (uint32 i = begin; i < end; ++i)
+		{
+			articulation_instance& instance = step->instances[i];
+
+			// The configuration has not changed since integrateArticulationForces, so the inertias are still valid.
+			propagateRigidBodyVelocityChanges(instance);
+			applyJointLimits(instance, dt);
+
+			integrateJoints(instance, dt);
+
+			computeKinematics(instance);
+			computeVelocities(instance);
+			writeVelocitiesToRigidBodies(instance);
+		}
+	});
+}
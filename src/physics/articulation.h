@@ -0,0 +1,121 @@
+#pragma once
+
+#include "core/math.h"
+#include "core/memory.h"
+#include "scene/scene.h"
+#include "constraints.h"
+
+struct physics_snapshot_writer;
+struct physics_snapshot_reader;
+
+// Tree of rigid bodies, which is simulated in reduced (joint) coordinates with Featherstone's articulated body algorithm in O(n).
+// Since only the joint angles are integrated, the joints can not drift apart or stretch, independent of the number of solver iterations.
+// The links keep their rigid bodies and colliders. Collisions are solved by the regular constraint solver, the resulting change in velocity
+// is then propagated through the articulated body inertia, so that the whole tree reacts to it.
+// The component sits on the root entity. Links must not additionally be connected by constraints. Deleting a link dissolves the articulation
+// into free rigid bodies.
+
+enum articulation_joint_type
+{
+	articulation_joint_hinge,
+	articulation_joint_spherical,
+};
+
+struct articulation_joint
+{
+	articulation_joint_type type;
+
+	vec3 localAnchorParent;
+	vec3 localAnchorChild;
+	quat restRotation; // Rotation of the child relative to the parent at creation.
+
+	// In the parent's local space. Hinge axis, or twist axis of spherical joints. The tangents are the reference for swingMotorAxis.
+	vec3 localAxis;
+	vec3 localTangent;
+	vec3 localBitangent;
+
+	// Limits. Same conventions as in hinge_constraint and cone_twist_constraint: Limits outside of the specified range are disabled.
+	float minRotationLimit; // Hinge. [-pi, 0]
+	float maxRotationLimit; // Hinge. [0, pi]
+	float swingLimit; // Spherical. Negative to disable.
+	float twistLimit; // Spherical. Negative to disable.
+
+	// Motor of hinge joints. Disabled if maxMotorTorque <= 0.
+	constraint_motor_type motorType;
+	union
+	{
+		float motorVelocity;
+		float motorTargetAngle;
+	};
+	float maxMotorTorque;
+
+	// Motors of spherical joints. Disabled if the maximum torque <= 0.
+	constraint_motor_type swingMotorType;
+	union
+	{
+		float swingMotorVelocity;
+		float swingMotorTargetAngle;
+	};
+	float maxSwingMotorTorque;
+	float swingMotorAxis;
+
+	constraint_motor_type twistMotorType;
+	union
+	{
+		float twistMotorVelocity;
+		float twistMotorTargetAngle;
+	};
+	float maxTwistMotorTorque;
+
+	// State. The hinge angle or the rotation of spherical joints (in the parent's space, relative to the rest rotation).
+	// The joint velocity is the angular velocity relative to the parent in the parent's space. Hinges only use the x component.
+	float angle;
+	quat rotation;
+	vec3 velocity;
+};
+
+struct articulation_link
+{
+	entity_handle entity;
+	int32 parent; // Index into links. Parents always come before their children. -1 for the root.
+	articulation_joint joint; // Connects the link to its parent. Unused for the root.
+};
+
+struct articulation_component
+{
+	articulation_component() {}
+	articulation_component(entity_handle root);
+
+	// Adds child as a new link below parent, which must already be part of the articulation. Both need a rigid body. Returns the index of the joint.
+	// Anchors and axes are given in the current configuration, which becomes the rest configuration of the joint.
+	NODISCARD uint32 addHingeJoint(eentity& parent, eentity& child, vec3 globalAnchor, vec3 globalHingeAxis, float minLimit, float maxLimit);
+	NODISCARD uint32 addSphericalJoint(eentity& parent, eentity& child, vec3 globalAnchor, vec3 globalAxis, float swingLimit, float twistLimit);
+
+	NODISCARD articulation_joint& getJoint(uint32 index) { return links[index].joint; }
+	NODISCARD uint32 getNumLinks() const { return (uint32)links.size(); }
+
+	// Joint state for physics snapshots (see snapshot.h). The snapshot must have been written by an articulation with the same links.
+	void writeSnapshot(physics_snapshot_writer& writer) const;
+	NODISCARD bool readSnapshot(physics_snapshot_reader& reader);
+
+	std::vector<articulation_link> links; // The root is links[0].
+
+	// Velocity of the root at its center of gravity. The root velocity is owned by the articulation, the rigid body only mirrors it.
+	vec3 rootLinearVelocity = vec3(0.f);
+	vec3 rootAngularVelocity = vec3(0.f);
+
+private:
+	NODISCARD uint32 addLink(eentity& parent, eentity& child, const articulation_joint& joint);
+};
+
+// Internal. Called by the physics step. Articulations are only simulated if all of their links are awake.
+struct articulation_step;
+
+// Wakes up all links of an articulation if one of them is awake, and dissolves articulations with deleted links.
+void wakeUpArticulations(escene& scene);
+
+// Before the constraint solver. Integrates the forces in joint space and writes the resulting link velocities to the rigid bodies.
+NODISCARD articulation_step* integrateArticulationForces(escene& scene, eallocator& arena, const bool* sleepingPerBody, vec3 globalForceField, float dt);
+
+// After the constraint solver. Propagates the velocity changes of the solver through the articulations, integrates the joints and writes the link transforms.
+void integrateArticulationVelocities(escene& scene, articulation_step* step, float dt);
@@ -0,0 +1,646 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "physics.h"
+#include "ragdoll.h"
+#include "snapshot.h"
+#include "collision_broad.h"
+#include "collision_narrow.h"
+#include "terrain/heightmap_collider.h"
+#include "core/cpu_profiling.h"
+#include "core/memory.h"
+#include "core/random.h"
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
+
+struct physics_benchmark_scene
+{
+	escene scene;
+	physics_settings settings;
+	std::vector<std::vector<uint16>> heightmapChunks; // Heightmap colliders don't own their heights.
+};
+
+typedef void (*physics_benchmark_setup_func)(physics_benchmark_scene& s);
+
+static const physics_material benchmarkMaterial = { physics_material_type_wood, 0.1f, 0.8f, 500.f };
+
+static void addGround(escene& scene, float halfExtent = 60.f)
+{
+	scene.createEntity("Ground")
+		.addComponent<transform_component>(vec3(0.f, -1.f, 0.f), quat::identity)
+		.addComponent<collider_component>(collider_component::asAABB(bounding_box::fromCenterRadius(vec3(0.f), vec3(halfExtent, 1.f, halfExtent)), benchmarkMaterial));
+}
+
+static void setupBoxPyramids(physics_benchmark_scene& s)
+{
+	addGround(s.scene);
+
+	const uint32 numPyramids = 4;
+	const uint32 numLevels = 20;
+	const vec3 radius(0.5f);
+
+	for (uint32 p = 0; p < numPyramids; ++p)
+	{
+		float z = (p - (numPyramids - 1) * 0.5f) * 8.f;
+		for (uint32 level = 0; level < numLevels; ++level)
+		{
+			uint32 numBoxes = numLevels - level;
+			for (uint32 i = 0; i < numBoxes; ++i)
+			{
+				vec3 position((i - (numBoxes - 1) * 0.5f) * radius.x * 2.05f, radius.y + level * radius.y * 2.f, z);
+
+				s.scene.createEntity("Box")
+					.addComponent<transform_component>(position, quat::identity)
+					.addComponent<collider_component>(collider_component::asAABB(bounding_box::fromCenterRadius(vec3(0.f), radius), benchmarkMaterial))
+					.addComponent<rigid_body_component>(false);
+			}
+		}
+	}
+}
+
+static void setupSpherePile(physics_benchmark_scene& s)
+{
+	addGround(s.scene);
+
+	// Walls keep the pile together.
+	const float halfExtent = 6.f;
+	for (uint32 i = 0; i < 4; ++i)
+	{
+		quat rotation(vec3(0.f, 1.f, 0.f), i * M_PI_OVER_2);
+		s.scene.createEntity("Wall")
+			.addComponent<transform_component>(rotation * vec3(halfExtent + 0.5f, 5.f, 0.f), rotation)
+			.addComponent<collider_component>(collider_component::asAABB(bounding_box::fromCenterRadius(vec3(0.f), vec3(0.5f, 5.f, halfExtent + 1.f)), benchmarkMaterial));
+	}
+
+	random_number_generator rng = { 15123 };
+
+	const uint32 numPerDim = 12;
+	const uint32 numLayers = 20;
+	for (uint32 y = 0; y < numLayers; ++y)
+	{
+		for (uint32 z = 0; z < numPerDim; ++z)
+		{
+			for (uint32 x = 0; x < numPerDim; ++x)
+			{
+				vec3 position = vec3(x - (numPerDim - 1) * 0.5f, 1.f + y, z - (numPerDim - 1) * 0.5f) + rng.randomVec3Between(-0.05f, 0.05f);
+
+				s.scene.createEntity("Sphere")
+					.addComponent<transform_component>(position, quat::identity)
+					.addComponent<collider_component>(collider_component::asSphere({ vec3(0.f), 0.45f }, benchmarkMaterial))
+					.addComponent<rigid_body_component>(false);
+			}
+		}
+	}
+}
+
+static bounding_hull_geometry createDebrisHullGeometry(random_number_generator& rng)
+{
+	// Icosahedron with randomly displaced vertices.
+	const float t = (1.f + sqrt(5.f)) * 0.5f;
+
+	vec3 vertices[] =
+	{
+		vec3(-1.f, t, 0.f), vec3(1.f, t, 0.f), vec3(-1.f, -t, 0.f), vec3(1.f, -t, 0.f),
+		vec3(0.f, -1.f, t), vec3(0.f, 1.f, t), vec3(0.f, -1.f, -t), vec3(0.f, 1.f, -t),
+		vec3(t, 0.f, -1.f), vec3(t, 0.f, 1.f), vec3(-t, 0.f, -1.f), vec3(-t, 0.f, 1.f),
+	};
+
+	for (vec3& v : vertices)
+	{
+		v *= 0.2f * rng.randomFloatBetween(0.6f, 1.2f);
+	}
+
+	indexed_triangle16 triangles[] =
+	{
+		{ 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+		{ 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+		{ 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+		{ 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 },
+	};
+
+	return bounding_hull_geometry::fromMesh(vertices, arraysize(vertices), triangles, arraysize(triangles));
+}
+
+static void setupHullDebris(physics_benchmark_scene& s)
+{
+	addGround(s.scene);
+
+	random_number_generator rng = { 712345 };
+
+	// Hull geometries are global and never freed, so they are only created once for all runs.
+	const uint32 numGeometries = 8;
+	static uint32 geometryIndices[numGeometries];
+	static bool geometriesCreated = false;
+	if (!geometriesCreated)
+	{
+		for (uint32 i = 0; i < numGeometries; ++i)
+		{
+			geometryIndices[i] = allocateBoundingHullGeometry(createDebrisHullGeometry(rng));
+		}
+		geometriesCreated = true;
+	}
+
+	const uint32 numDebris = 1500;
+	for (uint32 i = 0; i < numDebris; ++i)
+	{
+		vec3 position = rng.randomVec3Between(-15.f, 15.f);
+		position.y = rng.randomFloatBetween(0.5f, 10.f);
+
+		bounding_hull hull;
+		hull.rotation = normalize(quat(rng.randomFloatBetween(-1.f, 1.f), rng.randomFloatBetween(-1.f, 1.f), rng.randomFloatBetween(-1.f, 1.f), 1.f));
+		hull.position = vec3(0.f);
+		hull.geometryIndex = geometryIndices[i % numGeometries];
+
+		s.scene.createEntity("Debris")
+			.addComponent<transform_component>(position, quat::identity)
+			.addComponent<collider_component>(collider_component::asHull(hull, benchmarkMaterial))
+			.addComponent<rigid_body_component>(false);
+	}
+}
+
+static void setupRagdollPile(physics_benchmark_scene& s)
+{
+	addGround(s.scene);
+
+	const uint32 numPerDim = 4;
+	const uint32 numLayers = 6;
+	for (uint32 y = 0; y < numLayers; ++y)
+	{
+		for (uint32 z = 0; z < numPerDim; ++z)
+		{
+			for (uint32 x = 0; x < numPerDim; ++x)
+			{
+				vec3 hipPosition((x - (numPerDim - 1) * 0.5f) * 1.2f, 1.5f + y * 2.5f, (z - (numPerDim - 1) * 0.5f) * 1.2f);
+				humanoid_ragdoll::create(s.scene, hipPosition, y * 0.7f + x * 0.3f);
+			}
+		}
+	}
+}
+
+// Rolling hills, centered at the origin.
+static heightmap_collider_component& addRollingHills(physics_benchmark_scene& s, uint32 chunksPerDim, float chunkSize, float amplitude)
+{
+	const uint32 numVerticesPerDim = TERRAIN_LOD_0_VERTICES_PER_DIMENSION;
+
+	s.heightmapChunks.resize(chunksPerDim * chunksPerDim);
+
+	heightmap_collider_component& heightmap = s.scene.createEntity("Terrain")
+		.addComponent<heightmap_collider_component>(chunksPerDim, chunkSize, benchmarkMaterial)
+		.getComponent<heightmap_collider_component>();
+
+	for (uint32 cz = 0; cz < chunksPerDim; ++cz)
+	{
+		for (uint32 cx = 0; cx < chunksPerDim; ++cx)
+		{
+			std::vector<uint16>& heights = s.heightmapChunks[cz * chunksPerDim + cx];
+			heights.resize(numVerticesPerDim * numVerticesPerDim);
+
+			for (uint32 z = 0; z < numVerticesPerDim; ++z)
+			{
+				for (uint32 x = 0; x < numVerticesPerDim; ++x)
+				{
+					float worldX = (cx + (float)x / (numVerticesPerDim - 1)) * chunkSize;
+					float worldZ = (cz + (float)z / (numVerticesPerDim - 1)) * chunkSize;
+					float h = 0.5f + 0.25f * sin(worldX * 0.15f) + 0.25f * cos(worldZ * 0.1f);
+					heights[z * numVerticesPerDim + x] = (uint16)(saturate(h) * UINT16_MAX);
+				}
+			}
+
+			heightmap.collider(cx, cz).setHeights(heights.data());
+		}
+	}
+
+	float halfSize = chunksPerDim * chunkSize * 0.5f;
+	heightmap.update(vec3(-halfSize, -amplitude, -halfSize), amplitude);
+
+	return heightmap;
+}
+
+static void setupVehicleOnHeightmap(physics_benchmark_scene& s)
+{
+	addRollingHills(s, 2, 64.f, 6.f);
+
+	// The gear-driven vehicle in vehicle.cpp builds its meshes together with its bodies, so a simpler car with motorized wheel hinges is used here.
+	vec3 chassisPosition(0.f, 3.f, 0.f);
+	eentity chassis = s.scene.createEntity("Chassis")
+		.addComponent<transform_component>(chassisPosition, quat::identity)
+		.addComponent<collider_component>(collider_component::asAABB(bounding_box::fromCenterRadius(vec3(0.f), vec3(0.9f, 0.25f, 2.f)), benchmarkMaterial))
+		.addComponent<rigid_body_component>(false);
+
+	physics_material wheelMaterial = { physics_material_type_wood, 0.1f, 1.f, 200.f };
+	for (uint32 i = 0; i < 4; ++i)
+	{
+		float side = (i & 1) ? 1.f : -1.f;
+		float front = (i & 2) ? 1.f : -1.f;
+		vec3 wheelPosition = chassisPosition + vec3(side * 1.2f, -0.3f, front * 1.5f);
+
+		bounding_cylinder cylinder = { vec3(-0.15f, 0.f, 0.f), vec3(0.15f, 0.f, 0.f), 0.5f };
+
+		eentity wheel = s.scene.createEntity("Wheel")
+			.addComponent<transform_component>(wheelPosition, quat::identity)
+			.addComponent<collider_component>(collider_component::asCylinder(cylinder, wheelMaterial))
+			.addComponent<rigid_body_component>(false);
+
+		auto handle = addHingeConstraintFromGlobalPoints(chassis, wheel, wheelPosition, vec3(1.f, 0.f, 0.f));
+		hinge_constraint& hinge = getConstraint(s.scene, handle);
+		hinge.motorType = constraint_velocity_motor;
+		hinge.motorVelocity = -8.f;
+		hinge.maxMotorTorque = 200.f;
+	}
+}
+
+// Many AI cars, as in traffic simulations. The chassis are rigid bodies, the wheels are raycast_vehicle_component wheels.
+static void setupRaycastVehicles(physics_benchmark_scene& s)
+{
+	const uint32 numVehiclesX = 25;
+	const uint32 numVehiclesZ = 20;
+	const float spacing = 9.f;
+
+	heightmap_collider_component& heightmap = addRollingHills(s, 4, 64.f, 6.f);
+
+	random_number_generator rng = { 48213 };
+
+	for (uint32 z = 0; z < numVehiclesZ; ++z)
+	{
+		for (uint32 x = 0; x < numVehiclesX; ++x)
+		{
+			vec2 groundPosition((x - (numVehiclesX - 1) * 0.5f) * spacing, (z - (numVehiclesZ - 1) * 0.5f) * spacing);
+			vec3 chassisPosition(groundPosition.x, heightmap.getHeightAt(groundPosition) + 1.2f, groundPosition.y);
+			quat rotation(vec3(0.f, 1.f, 0.f), rng.randomFloatBetween(-M_PI, M_PI));
+
+			raycast_vehicle_component vehicle = raycast_vehicle_component::fourWheels(0.8f, 1.4f, 0.f, 0.35f);
+			vehicle.throttle = rng.randomFloatBetween(0.3f, 1.f);
+			vehicle.steering = rng.randomFloatBetween(-0.5f, 0.5f);
+
+			s.scene.createEntity("Car")
+				.addComponent<transform_component>(chassisPosition, rotation)
+				.addComponent<collider_component>(collider_component::asAABB(bounding_box::fromCenterRadius(vec3(0.f), vec3(0.9f, 0.3f, 2.f)), benchmarkMaterial))
+				.addComponent<rigid_body_component>(false)
+				.addComponent<raycast_vehicle_component>(vehicle);
+		}
+	}
+}
+
+static void setupClothGrids(physics_benchmark_scene& s)
+{
+	addGround(s.scene);
+
+	const uint32 numCloths = 4;
+	for (uint32 i = 0; i < numCloths; ++i)
+	{
+		vec3 position((i - (numCloths - 1) * 0.5f) * 12.f, 10.f, 0.f);
+
+		// Obstacle below each cloth.
+		s.scene.createEntity("Obstacle")
+			.addComponent<transform_component>(position + vec3(0.f, -5.f, 3.f), quat::identity)
+			.addComponent<collider_component>(collider_component::asSphere({ vec3(0.f), 2.f }, benchmarkMaterial));
+
+		s.scene.createEntity("Cloth")
+			.addComponent<transform_component>(position, quat(vec3(1.f, 0.f, 0.f), deg2rad(-60.f)))
+			.addComponent<cloth_component>(10.f, 10.f, 48u, 48u, 8.f);
+	}
+
+	s.settings.numClothPositionIterations = 4;
+}
+
+struct physics_benchmark_desc
+{
+	const char* name;
+	physics_benchmark_setup_func setup;
+};
+
+static const physics_benchmark_desc physicsBenchmarks[] =
+{
+	{ "Box pyramids", setupBoxPyramids },
+	{ "Sphere pile", setupSpherePile },
+	{ "Hull debris", setupHullDebris },
+	{ "Ragdoll pile", setupRagdollPile },
+	{ "Vehicle on heightmap", setupVehicleOnHeightmap },
+	{ "Raycast vehicles", setupRaycastVehicles },
+	{ "Cloth grids", setupClothGrids },
+};
+
+static void printSummaryEntries(std::vector<cpu_profile_summary_entry>& entries, uint32 numFrames, bool timings)
+{
+	std::sort(entries.begin(), entries.end(), [](const cpu_profile_summary_entry& a, const cpu_profile_summary_entry& b) { return a.total > b.total; });
+
+	for (const cpu_profile_summary_entry& e : entries)
+	{
+		if (timings)
+		{
+			std::cout << "    " << e.name << ": " << (e.total / numFrames) << "ms per frame, max " << e.maximum << "ms, " << ((float)e.count / numFrames) << " calls per frame\n";
+		}
+		else
+		{
+			std::cout << "    " << e.name << ": avg " << (e.total / e.count) << ", max " << e.maximum << '\n';
+		}
+	}
+}
+
+void benchmarkPhysicsScenes(uint32 numFrames, const char* sceneFilter)
+{
+	eallocator arena;
+	arena.initialize();
+
+	std::cout << "Physics benchmark, " << numFrames << " frames per scene\n";
+
+	for (const physics_benchmark_desc& desc : physicsBenchmarks)
+	{
+		if (sceneFilter && !strstr(desc.name, sceneFilter))
+		{
+			continue;
+		}
+
+		physics_benchmark_scene s;
+		s.settings.fixedFrameRate = false; // One step per frame.
+		desc.setup(s);
+
+		float dt = 1.f / s.settings.frameRate;
+		float timer = 0.f;
+
+		// Drop everything, which was recorded during setup.
+		cpu_profile_summary summary;
+		cpuProfilingCollectSummary(summary);
+		summary = {};
+
+		double totalTime = 0.0;
+		double maxTime = 0.0;
+
+		for (uint32 frame = 0; frame < numFrames; ++frame)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			physicsStep(s.scene, arena, timer, s.settings, dt);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			double time = std::chrono::duration<double, std::milli>(end - start).count();
+			totalTime += time;
+			maxTime = max(maxTime, time);
+
+			// Collected every frame, so that the recording arrays don't overflow.
+			cpuProfilingCollectSummary(summary);
+		}
+
+		std::cout << desc.name << ": " << s.scene.numberOfComponentsOfType<rigid_body_component>() << " rigid bodies, "
+			<< s.scene.numberOfComponentsOfType<collider_component>() << " colliders, " << s.scene.numberOfComponentsOfType<cloth_component>() << " cloths. "
+			<< "Avg " << (totalTime / numFrames) << "ms, max " << maxTime << "ms per frame\n";
+
+#if ENABLE_CPU_PROFILING
+		std::cout << "  Phases:\n";
+		printSummaryEntries(summary.blocks, numFrames, true);
+		std::cout << "  Stats:\n";
+		printSummaryEntries(summary.stats, numFrames, false);
+#endif
+
+		s.scene.clearAll();
+	}
+}
+
+bool testPhysicsSceneDeterminism(uint32 numWarmupSteps, const char* sceneFilter)
+{
+	eallocator arena;
+	arena.initialize();
+
+	// Stepped twice within one call to testPhysicsDeterminism, so this is kept short (see snapshot.h).
+	const uint32 numTestSteps = 8;
+
+	std::cout << "Physics determinism test, " << numWarmupSteps << " warmup steps, " << numTestSteps << " test steps per scene\n";
+
+	bool allDeterministic = true;
+
+	for (const physics_benchmark_desc& desc : physicsBenchmarks)
+	{
+		if (sceneFilter && !strstr(desc.name, sceneFilter))
+		{
+			continue;
+		}
+
+		physics_benchmark_scene s;
+		s.settings.fixedFrameRate = false; // One step per frame.
+		desc.setup(s);
+
+		float dt = 1.f / s.settings.frameRate;
+		float timer = 0.f;
+
+		// The warmup runs here instead of in testPhysicsDeterminism, so that the profile recordings can be dropped every frame.
+		cpu_profile_summary summary;
+		for (uint32 frame = 0; frame < numWarmupSteps; ++frame)
+		{
+			physicsStep(s.scene, arena, timer, s.settings, dt);
+			cpuProfilingCollectSummary(summary);
+		}
+
+		bool deterministic = testPhysicsDeterminism(s.scene, arena, s.settings, dt, 0, numTestSteps);
+		cpuProfilingCollectSummary(summary);
+
+		std::cout << desc.name << ": " << (deterministic ? "deterministic" : "NOT DETERMINISTIC") << '\n';
+		allDeterministic &= deterministic;
+
+		s.scene.clearAll();
+	}
+
+	return allDeterministic;
+}
+
+static void randomNarrowphaseCollider(random_number_generator& rng, collider_type type, const bounding_hull_geometry* hullGeometry, uint16 index, collider_union& out)
+{
+	vec3 center = rng.randomVec3Between(-1.f, 1.f);
+	vec3 axis = normalize(rng.randomVec3Between(-1.f, 1.f) + vec3(0.f, 0.01f, 0.f)) * rng.randomFloatBetween(0.2f, 0.5f);
+	float radius = rng.randomFloatBetween(0.2f, 0.6f);
+
+	switch (type)
+	{
+		case collider_type_sphere: out.sphere = { center, radius }; break;
+		case collider_type_capsule: out.capsule = { center - axis, center + axis, radius * 0.6f }; break;
+		case collider_type_cylinder: out.cylinder = { center - axis, center + axis, radius * 0.6f }; break;
+		case collider_type_aabb: out.aabb = bounding_box::fromCenterRadius(center, rng.randomVec3Between(0.2f, 0.6f)); break;
+		case collider_type_obb:
+		{
+			quat rotation = normalize(quat(rng.randomFloatBetween(-1.f, 1.f), rng.randomFloatBetween(-1.f, 1.f), rng.randomFloatBetween(-1.f, 1.f), 1.f));
+			out.obb = { rotation, center, rng.randomVec3Between(0.2f, 0.6f) };
+		} break;
+		case collider_type_hull:
+		{
+			quat rotation = normalize(quat(rng.randomFloatBetween(-1.f, 1.f), rng.randomFloatBetween(-1.f, 1.f), rng.randomFloatBetween(-1.f, 1.f), 1.f));
+			out.hull.rotation = rotation;
+			out.hull.position = center;
+			out.hull.geometryPtr = hullGeometry;
+		} break;
+		default: ASSERT(false); break;
+	}
+
+	out.type = type;
+	out.material = { physics_material_type_none, 0.2f, 0.5f, 1.f };
+
+	// Every collider is its own rigid body, so that the body pair of a contact identifies the collider pair.
+	out.objectType = physics_object_type_rigid_body;
+	out.objectIndex = index;
+}
+
+struct narrowphase_benchmark_run
+{
+	double time; // Microseconds per iteration.
+	uint32 numCollisions;
+	uint32 numContacts;
+	std::unordered_map<uint32, float> deepestPenetrationPerPair;
+};
+
+static narrowphase_benchmark_run runNarrowphase(const std::vector<collider_union>& colliders, const std::vector<collider_pair>& pairs, eallocator& arena, uint32 numIterations, bool simd)
+{
+	uint32 numPairs = (uint32)pairs.size();
+
+	std::vector<collider_pair> pairsScratch;
+	std::vector<collision_contact> contacts(numPairs * 4);
+	std::vector<constraint_body_pair> bodyPairs(numPairs * 4);
+	std::vector<collider_pair> colliderPairs(numPairs);
+	std::vector<uint8> contactCounts(numPairs);
+	std::vector<non_collision_interaction> nonCollisionInteractions(numPairs);
+
+	narrowphase_benchmark_run run = {};
+	narrowphase_result result = {};
+
+	for (uint32 i = 0; i < numIterations; ++i)
+	{
+		// The narrow phase reorders the pairs in place.
+		pairsScratch = pairs;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		result = narrowphase(colliders.data(), pairsScratch.data(), numPairs, arena,
+			contacts.data(), bodyPairs.data(), colliderPairs.data(), contactCounts.data(), nonCollisionInteractions.data(), simd);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		run.time += std::chrono::duration<double, std::micro>(end - start).count();
+
+		// Drop the recorded profile blocks, so that the recording arrays don't overflow.
+		cpu_profile_summary summary;
+		cpuProfilingCollectSummary(summary);
+	}
+
+	run.time /= numIterations;
+	run.numCollisions = result.numCollisions;
+	run.numContacts = result.numContacts;
+
+	// The SIMD path does not write the contacts of a collision contiguously, so the contacts are matched to their pair through the body pair.
+	for (uint32 i = 0; i < result.numContacts; ++i)
+	{
+		constraint_body_pair bodyPair = bodyPairs[i];
+		uint32 key = ((uint32)min(bodyPair.rbA, bodyPair.rbB) << 16) | max(bodyPair.rbA, bodyPair.rbB);
+
+		auto [it, inserted] = run.deepestPenetrationPerPair.try_emplace(key, contacts[i].penetrationDepth);
+		if (!inserted)
+		{
+			it->second = max(it->second, contacts[i].penetrationDepth);
+		}
+	}
+
+	return run;
+}
+
+struct narrowphase_benchmark_desc
+{
+	const char* name;
+	collider_type typeA;
+	collider_type typeB;
+};
+
+static const narrowphase_benchmark_desc narrowphaseBenchmarks[] =
+{
+	{ "Sphere vs sphere", collider_type_sphere, collider_type_sphere },
+	{ "Sphere vs capsule", collider_type_sphere, collider_type_capsule },
+	{ "Sphere vs cylinder", collider_type_sphere, collider_type_cylinder },
+	{ "Sphere vs AABB", collider_type_sphere, collider_type_aabb },
+	{ "Sphere vs OBB", collider_type_sphere, collider_type_obb },
+	{ "Sphere vs hull", collider_type_sphere, collider_type_hull },
+	{ "Capsule vs capsule", collider_type_capsule, collider_type_capsule },
+	{ "Capsule vs cylinder", collider_type_capsule, collider_type_cylinder },
+	{ "Capsule vs AABB", collider_type_capsule, collider_type_aabb },
+	{ "Capsule vs OBB", collider_type_capsule, collider_type_obb },
+	{ "Capsule vs hull", collider_type_capsule, collider_type_hull },
+	{ "Cylinder vs cylinder", collider_type_cylinder, collider_type_cylinder },
+	{ "Cylinder vs AABB", collider_type_cylinder, collider_type_aabb },
+	{ "Cylinder vs OBB", collider_type_cylinder, collider_type_obb },
+	{ "Cylinder vs hull", collider_type_cylinder, collider_type_hull },
+	{ "AABB vs AABB", collider_type_aabb, collider_type_aabb },
+	{ "AABB vs OBB", collider_type_aabb, collider_type_obb },
+	{ "AABB vs hull", collider_type_aabb, collider_type_hull },
+	{ "OBB vs OBB", collider_type_obb, collider_type_obb },
+	{ "OBB vs hull", collider_type_obb, collider_type_hull },
+	{ "Hull vs hull", collider_type_hull, collider_type_hull },
+};
+
+void benchmarkNarrowphase(uint32 numPairsPerType, uint32 numIterations)
+{
+	ASSERT(numPairsPerType * 2 <= UINT16_MAX);
+
+	eallocator arena;
+	arena.initialize();
+
+	random_number_generator hullRng = { 1234 };
+	bounding_hull_geometry hullGeometry = createDebrisHullGeometry(hullRng);
+
+	std::cout << "Narrow phase benchmark, " << numPairsPerType << " pairs per type\n";
+
+	uint32 numMismatchingTypes = 0;
+
+	for (const narrowphase_benchmark_desc& desc : narrowphaseBenchmarks)
+	{
+		random_number_generator rng = { 612345 };
+
+		std::vector<collider_union> colliders(numPairsPerType * 2);
+		std::vector<collider_pair> pairs(numPairsPerType);
+		for (uint32 i = 0; i < numPairsPerType; ++i)
+		{
+			uint16 a = (uint16)(i * 2 + 0);
+			uint16 b = (uint16)(i * 2 + 1);
+			randomNarrowphaseCollider(rng, desc.typeA, &hullGeometry, a, colliders[a]);
+			randomNarrowphaseCollider(rng, desc.typeB, &hullGeometry, b, colliders[b]);
+			pairs[i] = { a, b };
+		}
+
+		narrowphase_benchmark_run scalar = runNarrowphase(colliders, pairs, arena, numIterations, false);
+		narrowphase_benchmark_run simd = runNarrowphase(colliders, pairs, arena, numIterations, true);
+
+		// Pair types without a SIMD kernel run the scalar test in both runs, so they must match exactly.
+		uint32 numMismatchingPairs = 0;
+		float maxPenetrationError = 0.f;
+		for (auto [key, depth] : scalar.deepestPenetrationPerPair)
+		{
+			auto it = simd.deepestPenetrationPerPair.find(key);
+			if (it == simd.deepestPenetrationPerPair.end())
+			{
+				++numMismatchingPairs;
+				continue;
+			}
+
+			float error = abs(it->second - depth);
+			maxPenetrationError = max(maxPenetrationError, error);
+			if (error > 1e-3f)
+			{
+				++numMismatchingPairs;
+			}
+		}
+		for (auto [key, depth] : simd.deepestPenetrationPerPair)
+		{
+			if (scalar.deepestPenetrationPerPair.find(key) == scalar.deepestPenetrationPerPair.end())
+			{
+				++numMismatchingPairs;
+			}
+		}
+
+		std::cout << desc.name << ": scalar " << scalar.time << "us (" << scalar.numCollisions << " collisions, " << scalar.numContacts << " contacts), "
+			<< "SIMD " << simd.time << "us (" << simd.numCollisions << " collisions, " << simd.numContacts << " contacts), speedup " << (scalar.time / simd.time) << "x, "
+			<< "max penetration error " << maxPenetrationError;
+
+		if (numMismatchingPairs)
+		{
+			std::cout << ", MISMATCH in " << numMismatchingPairs << " pairs";
+			++numMismatchingTypes;
+		}
+
+		std::cout << '\n';
+	}
+
+	if (numMismatchingTypes)
+	{
+		std::cout << "Scalar and SIMD narrow phase disagree for " << numMismatchingTypes << " pair types\n";
+	}
+}
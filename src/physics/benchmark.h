@@ -0,0 +1,19 @@
+#pragma once
+
+#include "core/math.h"
+
+// Headless benchmark of the custom physics world. Builds canonical scenes (box pyramids, sphere piles, hull debris, ragdolls, a vehicle on a heightmap, 500 raycast vehicles, cloth),
+// steps each for numFrames fixed steps and prints the frame timings, the per-phase timings and the averaged CPU_PROFILE_STATs to stdout.
+// Needs no GPU or window, so it also runs in PHYSICS_ONLY builds. The job system must be initialized.
+// Also builds on Linux with GCC (-mavx2 -mfma): there the job system runs on plain std::threads and the profiler on std::chrono, PHYSICS_ONLY builds compile
+// the profiler without DX and ImGui, and the SIMD wrappers and math types avoid the MSVC-only layouts. EnTT and the PhysX SDK are still required.
+// If sceneFilter is set, only scenes whose name contains it are run.
+void benchmarkPhysicsScenes(uint32 numFrames = 600, const char* sceneFilter = 0);
+
+// Steps each benchmark scene numWarmupSteps times, then runs testPhysicsDeterminism on it (snapshot, step, restore, step again and compare the state hashes).
+// Prints the result per scene and returns true if all scenes are deterministic.
+NODISCARD bool testPhysicsSceneDeterminism(uint32 numWarmupSteps = 120, const char* sceneFilter = 0);
+
+// Runs the narrow phase on randomly placed pairs of each primitive pair type, once with the scalar and once with the SIMD path, and prints the timings to stdout.
+// Also checks, that both paths find the same colliding pairs with the same penetration depths, and reports the pair types where they disagree.
+void benchmarkNarrowphase(uint32 numPairsPerType = 4096, uint32 numIterations = 16);
@@ -0,0 +1,55 @@
+#include "pch.h"
+
+#ifdef ERA_PHYSICS_BENCHMARK
+
+#include "benchmark.h"
+#include "core/job_system.h"
+
+// Entry point of the headless physics benchmark executable, which is built with PHYSICS_ONLY and ERA_PHYSICS_BENCHMARK defined, on Windows or Linux (see benchmark.h).
+// Usage: physics_benchmark [numFrames] [sceneFilter] [--narrowphase] [--determinism]
+// With --determinism, the scenes are checked for bit-exact snapshot restores after numFrames warmup steps instead of timed. The process then exits with EXIT_FAILURE if any scene diverges.
+int main(int argc, char** argv)
+{
+	uint32 numFrames = 600;
+	const char* sceneFilter = 0;
+	bool narrowphase = false;
+	bool determinism = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--narrowphase") == 0)
+		{
+			narrowphase = true;
+		}
+		else if (strcmp(argv[i], "--determinism") == 0)
+		{
+			determinism = true;
+		}
+		else if (uint32 n = (uint32)atoi(argv[i]))
+		{
+			numFrames = n;
+		}
+		else
+		{
+			sceneFilter = argv[i];
+		}
+	}
+
+	initializeJobSystem();
+
+	if (narrowphase)
+	{
+		benchmarkNarrowphase();
+	}
+
+	if (determinism)
+	{
+		return testPhysicsSceneDeterminism(numFrames, sceneFilter) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	benchmarkPhysicsScenes(numFrames, sceneFilter);
+
+	return EXIT_SUCCESS;
+}
+
+#endif
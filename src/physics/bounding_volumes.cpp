@@ -3,6 +3,7 @@
 #include "collision_gjk.h"
 
 #include <unordered_map>
+#include <algorithm>
 
 NODISCARD static bool pointInAABB(vec3 point, bounding_box aabb)
 {
@@ -81,28 +82,20 @@ NODISCARD bounding_oriented_box bounding_box::transformToOBB(quat rotation, vec3
 NODISCARD bounding_box_corners bounding_box::getCorners() const
 {
 	bounding_box_corners result;
-	result.i = minCorner;
-	result.x = vec3(maxCorner.x, minCorner.y, minCorner.z);
-	result.y = vec3(minCorner.x, maxCorner.y, minCorner.z);
-	result.xy = vec3(maxCorner.x, maxCorner.y, minCorner.z);
-	result.z = vec3(minCorner.x, minCorner.y, maxCorner.z);
-	result.xz = vec3(maxCorner.x, minCorner.y, maxCorner.z);
-	result.yz = vec3(minCorner.x, maxCorner.y, maxCorner.z);
-	result.xyz = maxCorner;
+	for (uint32 i = 0; i < 8; ++i)
+	{
+		result.corners[i] = vec3((i & 1) ? maxCorner.x : minCorner.x, (i & 2) ? maxCorner.y : minCorner.y, (i & 4) ? maxCorner.z : minCorner.z);
+	}
 	return result;
 }
 
 NODISCARD bounding_box_corners bounding_box::getCorners(quat rotation, vec3 translation) const
 {
-	bounding_box_corners result;
-	result.i = rotation * minCorner + translation;
-	result.x = rotation * vec3(maxCorner.x, minCorner.y, minCorner.z) + translation;
-	result.y = rotation * vec3(minCorner.x, maxCorner.y, minCorner.z) + translation;
-	result.xy = rotation * vec3(maxCorner.x, maxCorner.y, minCorner.z) + translation;
-	result.z = rotation * vec3(minCorner.x, minCorner.y, maxCorner.z) + translation;
-	result.xz = rotation * vec3(maxCorner.x, minCorner.y, maxCorner.z) + translation;
-	result.yz = rotation * vec3(minCorner.x, maxCorner.y, maxCorner.z) + translation;
-	result.xyz = rotation * maxCorner + translation;
+	bounding_box_corners result = getCorners();
+	for (uint32 i = 0; i < 8; ++i)
+	{
+		result.corners[i] = rotation * result.corners[i] + translation;
+	}
 	return result;
 }
 
@@ -1023,13 +1016,9 @@ NODISCARD bool aabbVsTriangle(const bounding_box& aabb, vec3 a, vec3 b, vec3 c)
 
 NODISCARD bool obbVsOBB(const bounding_oriented_box& a, const bounding_oriented_box& b)
 {
-	union obb_axes
+	struct obb_axes
 	{
-		struct
-		{
-			vec3 x, y, z;
-		};
-		vec3 u[3];
+		vec3 x, y, z;
 	};
 
 	float ra, rb, penetration;
@@ -1345,9 +1334,201 @@ NODISCARD static void addBoundingHullEdge(uint32 a, uint32 b, uint32 face, std::
 	}
 }
 
+// Builds the convex hull of at most maxNumVertices of the given points. Starting with a tetrahedron, the point farthest outside of the current hull
+// is added, until the budget is exhausted or all points are enclosed. This is the quickhull order, so the most significant features are kept first.
+// The result is an inner approximation of the full hull. Returns false, if the points are (nearly) flat.
+static bool buildSimplifiedHull(const vec3* points, uint32 numPoints, uint32 maxNumVertices, std::vector<vec3>& outVertices, std::vector<indexed_triangle16>& outTriangles)
+{
+	ASSERT(maxNumVertices >= 4);
+
+	struct hull_face
+	{
+		uint32 a, b, c;
+		vec3 normal;
+		float d;
+		bool alive;
+	};
+
+	bounding_box aabb = bounding_box::negativeInfinity();
+	for (uint32 i = 0; i < numPoints; ++i)
+	{
+		aabb.grow(points[i]);
+	}
+
+	vec3 extent = aabb.getRadius();
+	float epsilon = length(extent) * 1e-4f;
+
+	// Initial tetrahedron: The extreme points along the longest axis, the point farthest from their line and the point farthest from the resulting plane.
+	uint32 axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) : ((extent.y > extent.z) ? 1 : 2);
+
+	uint32 i0 = 0, i1 = 0;
+	for (uint32 i = 0; i < numPoints; ++i)
+	{
+		if (points[i].data[axis] < points[i0].data[axis]) { i0 = i; }
+		if (points[i].data[axis] > points[i1].data[axis]) { i1 = i; }
+	}
+
+	vec3 lineDir = points[i1] - points[i0];
+	if (length(lineDir) < epsilon)
+	{
+		return false;
+	}
+
+	uint32 i2 = 0;
+	float maxDistance = 0.f;
+	for (uint32 i = 0; i < numPoints; ++i)
+	{
+		float distance = squaredLength(cross(points[i] - points[i0], lineDir));
+		if (distance > maxDistance) { maxDistance = distance; i2 = i; }
+	}
+
+	vec3 planeNormal = noz(cross(lineDir, points[i2] - points[i0]));
+	if (squaredLength(planeNormal) == 0.f)
+	{
+		return false;
+	}
+
+	uint32 i3 = 0;
+	maxDistance = 0.f;
+	for (uint32 i = 0; i < numPoints; ++i)
+	{
+		float distance = abs(dot(points[i] - points[i0], planeNormal));
+		if (distance > maxDistance) { maxDistance = distance; i3 = i; }
+	}
+
+	if (maxDistance < epsilon)
+	{
+		return false;
+	}
+
+	// Orient the base, such that its normal points away from the fourth point.
+	if (dot(points[i3] - points[i0], planeNormal) > 0.f)
+	{
+		std::swap(i1, i2);
+	}
+
+	std::vector<hull_face> faces;
+	auto addFace = [&](uint32 a, uint32 b, uint32 c)
+	{
+		vec3 normal = noz(cross(points[b] - points[a], points[c] - points[a]));
+		faces.push_back({ a, b, c, normal, dot(normal, points[a]), true });
+	};
+
+	addFace(i0, i1, i2);
+	addFace(i0, i3, i1);
+	addFace(i1, i3, i2);
+	addFace(i2, i3, i0);
+
+	std::vector<bool> onHull(numPoints, false);
+	onHull[i0] = onHull[i1] = onHull[i2] = onHull[i3] = true;
+	uint32 numHullVertices = 4;
+
+	std::vector<std::pair<uint32, uint32>> visibleEdges;
+
+	while (numHullVertices < maxNumVertices)
+	{
+		// Find the point farthest outside of the current hull.
+		uint32 farthest = UINT32_MAX;
+		float farthestDistance = epsilon;
+		for (uint32 i = 0; i < numPoints; ++i)
+		{
+			if (onHull[i])
+			{
+				continue;
+			}
+
+			float distance = -FLT_MAX;
+			for (const hull_face& face : faces)
+			{
+				if (face.alive)
+				{
+					distance = max(distance, dot(face.normal, points[i]) - face.d);
+				}
+			}
+
+			if (distance > farthestDistance)
+			{
+				farthestDistance = distance;
+				farthest = i;
+			}
+		}
+
+		if (farthest == UINT32_MAX)
+		{
+			break;
+		}
+
+		vec3 p = points[farthest];
+
+		// Remove all faces, which see the new point. Edges, which belong to only one removed face, form the horizon.
+		visibleEdges.clear();
+		for (hull_face& face : faces)
+		{
+			if (face.alive && dot(face.normal, p) - face.d > 0.f)
+			{
+				face.alive = false;
+				visibleEdges.push_back({ face.a, face.b });
+				visibleEdges.push_back({ face.b, face.c });
+				visibleEdges.push_back({ face.c, face.a });
+			}
+		}
+
+		// Connect the horizon to the new point. The edges keep the winding of the removed faces.
+		uint32 numVisibleEdges = (uint32)visibleEdges.size();
+		for (uint32 i = 0; i < numVisibleEdges; ++i)
+		{
+			auto [a, b] = visibleEdges[i];
+			bool shared = std::find(visibleEdges.begin(), visibleEdges.end(), std::make_pair(b, a)) != visibleEdges.end();
+			if (!shared)
+			{
+				addFace(a, b, farthest);
+			}
+		}
+
+		onHull[farthest] = true;
+		++numHullVertices;
+	}
+
+	// Compact. Points, which ended up inside the hull, are not referenced by any face anymore.
+	std::vector<uint32> remap(numPoints, UINT32_MAX);
+
+	outVertices.clear();
+	outTriangles.clear();
+
+	auto getIndex = [&](uint32 i)
+	{
+		if (remap[i] == UINT32_MAX)
+		{
+			remap[i] = (uint32)outVertices.size();
+			outVertices.push_back(points[i]);
+		}
+		return (uint16)remap[i];
+	};
+
+	for (const hull_face& face : faces)
+	{
+		if (face.alive)
+		{
+			outTriangles.push_back({ getIndex(face.a), getIndex(face.b), getIndex(face.c) });
+		}
+	}
+
+	return true;
+}
+
 template <typename triangle_t>
-NODISCARD static bounding_hull_geometry hullFromMesh(vec3* vertices, uint32 numVertices, triangle_t* triangles, uint32 numTriangles)
+NODISCARD static bounding_hull_geometry hullFromMesh(vec3* vertices, uint32 numVertices, triangle_t* triangles, uint32 numTriangles, uint32 maxNumVertices)
 {
+	if (maxNumVertices != 0 && numVertices > maxNumVertices)
+	{
+		std::vector<vec3> simplifiedVertices;
+		std::vector<indexed_triangle16> simplifiedTriangles;
+		if (buildSimplifiedHull(vertices, numVertices, maxNumVertices, simplifiedVertices, simplifiedTriangles))
+		{
+			return hullFromMesh(simplifiedVertices.data(), (uint32)simplifiedVertices.size(), simplifiedTriangles.data(), (uint32)simplifiedTriangles.size(), 0);
+		}
+	}
+
 	bounding_hull_geometry hull;
 
 	uint32 numEdges = numVertices + numTriangles - 2; // Euler characteristic for convex polyhedra.
@@ -1392,15 +1573,51 @@ NODISCARD static bounding_hull_geometry hullFromMesh(vec3* vertices, uint32 numV
 
 	ASSERT(edgeIndex == numEdges);
 
+	// Vertex adjacency for hill climbing support queries.
+	hull.adjacencyOffsets.resize(numVertices + 1, 0);
+	for (const bounding_hull_edge& edge : hull.edges)
+	{
+		++hull.adjacencyOffsets[edge.from + 1];
+		++hull.adjacencyOffsets[edge.to + 1];
+	}
+	for (uint32 i = 0; i < numVertices; ++i)
+	{
+		hull.adjacencyOffsets[i + 1] += hull.adjacencyOffsets[i];
+	}
+
+	hull.adjacency.resize(hull.adjacencyOffsets[numVertices]);
+	std::vector<uint32> adjacencyCounter(hull.adjacencyOffsets.begin(), hull.adjacencyOffsets.end() - 1);
+	for (const bounding_hull_edge& edge : hull.edges)
+	{
+		hull.adjacency[adjacencyCounter[edge.from]++] = edge.to;
+		hull.adjacency[adjacencyCounter[edge.to]++] = edge.from;
+	}
+
+	if (numVertices <= BOUNDING_HULL_SIMD_SUPPORT_MAX_NUM_VERTICES)
+	{
+		uint32 numPaddedVertices = bucketize(numVertices, 8u) * 8;
+		hull.vertexX.resize(numPaddedVertices);
+		hull.vertexY.resize(numPaddedVertices);
+		hull.vertexZ.resize(numPaddedVertices);
+
+		for (uint32 i = 0; i < numPaddedVertices; ++i)
+		{
+			vec3 v = vertices[(i < numVertices) ? i : 0];
+			hull.vertexX[i] = v.x;
+			hull.vertexY[i] = v.y;
+			hull.vertexZ[i] = v.z;
+		}
+	}
+
 	return hull;
 }
 
-NODISCARD bounding_hull_geometry bounding_hull_geometry::fromMesh(vec3* vertices, uint32 numVertices, indexed_triangle16* triangles, uint32 numTriangles)
+NODISCARD bounding_hull_geometry bounding_hull_geometry::fromMesh(vec3* vertices, uint32 numVertices, indexed_triangle16* triangles, uint32 numTriangles, uint32 maxNumVertices)
 {
-	return hullFromMesh(vertices, numVertices, triangles, numTriangles);
+	return hullFromMesh(vertices, numVertices, triangles, numTriangles, maxNumVertices);
 }
 
-NODISCARD bounding_hull_geometry bounding_hull_geometry::fromMesh(vec3* vertices, uint32 numVertices, indexed_triangle32* triangles, uint32 numTriangles)
+NODISCARD bounding_hull_geometry bounding_hull_geometry::fromMesh(vec3* vertices, uint32 numVertices, indexed_triangle32* triangles, uint32 numTriangles, uint32 maxNumVertices)
 {
-	return hullFromMesh(vertices, numVertices, triangles, numTriangles);
+	return hullFromMesh(vertices, numVertices, triangles, numTriangles, maxNumVertices);
 }
@@ -83,6 +83,7 @@ struct bounding_torus
 
 union bounding_box_corners
 {
+#if defined(_MSC_VER)
 	struct
 	{
 		vec3 i;
@@ -94,7 +95,8 @@ union bounding_box_corners
 		vec3 yz;
 		vec3 xyz;
 	};
-	vec3 corners[8];
+#endif
+	vec3 corners[8]; // Bit 0 of the index selects the max x, bit 1 the max y, bit 2 the max z coordinate.
 
 	bounding_box_corners() {}
 };
@@ -163,13 +165,13 @@ struct bounding_rectangle
 	NODISCARD static bounding_rectangle fromCenterRadius(vec2 center, vec2 radius);
 };
 
-inline NODISCARD vec4 createPlane(vec3 point, vec3 normal)
+NODISCARD inline vec4 createPlane(vec3 point, vec3 normal)
 {
 	float d = -dot(normal, point);
 	return vec4(normal, d);
 }
 
-inline NODISCARD vec3 createLine(vec2 point, vec2 normal)
+NODISCARD inline vec3 createLine(vec2 point, vec2 normal)
 {
 	float d = -dot(normal, point);
 	return vec3(normal, d);
@@ -205,16 +207,31 @@ struct bounding_hull_face
 	vec3 normal;
 };
 
+// Hulls with at most this many vertices answer support queries with a SIMD brute force search. Larger hulls hill climb over the vertex adjacency.
+#define BOUNDING_HULL_SIMD_SUPPORT_MAX_NUM_VERTICES 32
+
+// Vertex budget for hulls created from imported meshes.
+#define BOUNDING_HULL_DEFAULT_MAX_NUM_VERTICES 64
+
 struct bounding_hull_geometry
 {
 	std::vector<vec3> vertices;
 	std::vector<bounding_hull_edge> edges;
 	std::vector<bounding_hull_face> faces;
 
+	// The neighbors of vertex i are adjacency[adjacencyOffsets[i]] up to adjacency[adjacencyOffsets[i + 1]].
+	std::vector<uint16> adjacency;
+	std::vector<uint32> adjacencyOffsets;
+
+	// Only for small hulls: Vertices in SoA layout, padded to a multiple of 8 with copies of the first vertex.
+	std::vector<float> vertexX, vertexY, vertexZ;
+
 	bounding_box aabb;
 
-	NODISCARD static bounding_hull_geometry fromMesh(vec3* vertices, uint32 numVertices, indexed_triangle16* triangles, uint32 numTriangles);
-	NODISCARD static bounding_hull_geometry fromMesh(vec3* vertices, uint32 numVertices, indexed_triangle32* triangles, uint32 numTriangles);
+	// If maxNumVertices is not 0 and the mesh has more vertices, the mesh is replaced by a hull of at most maxNumVertices of its vertices.
+	// The input mesh must be convex, unless it gets simplified.
+	NODISCARD static bounding_hull_geometry fromMesh(vec3* vertices, uint32 numVertices, indexed_triangle16* triangles, uint32 numTriangles, uint32 maxNumVertices = 0);
+	NODISCARD static bounding_hull_geometry fromMesh(vec3* vertices, uint32 numVertices, indexed_triangle32* triangles, uint32 numTriangles, uint32 maxNumVertices = 0);
 };
 
 // MUST be convex.
@@ -291,12 +308,12 @@ NODISCARD vec3 closestPoint_PointTriangle(const vec3& q, const vec3& a, const ve
 
 // Inline functions:
 
-inline NODISCARD float signedDistanceToPlane(const vec3& p, const vec4& plane)
+NODISCARD inline float signedDistanceToPlane(const vec3& p, const vec4& plane)
 {
 	return dot(vec4(p, 1.f), plane);
 }
 
-inline NODISCARD bool sphereVsSphere(const bounding_sphere& a, const bounding_sphere& b)
+NODISCARD inline bool sphereVsSphere(const bounding_sphere& a, const bounding_sphere& b)
 {
 	vec3 d = a.center - b.center;
 	float dist2 = dot(d, d);
@@ -304,18 +321,18 @@ inline NODISCARD bool sphereVsSphere(const bounding_sphere& a, const bounding_sp
 	return dist2 <= radiusSum * radiusSum;
 }
 
-inline NODISCARD bool sphereVsPlane(const bounding_sphere& s, const vec4& p)
+NODISCARD inline bool sphereVsPlane(const bounding_sphere& s, const vec4& p)
 {
 	return abs(signedDistanceToPlane(s.center, p)) <= s.radius;
 }
 
-inline NODISCARD bool sphereVsCapsule(const bounding_sphere& s, const bounding_capsule& c)
+NODISCARD inline bool sphereVsCapsule(const bounding_sphere& s, const bounding_capsule& c)
 {
 	vec3 closestPoint = closestPoint_PointSegment(s.center, line_segment{ c.positionA, c.positionB });
 	return sphereVsSphere(s, bounding_sphere{ closestPoint, c.radius });
 }
 
-inline NODISCARD bool sphereVsAABB(const bounding_sphere& s, const bounding_box& a)
+NODISCARD inline bool sphereVsAABB(const bounding_sphere& s, const bounding_box& a)
 {
 	vec3 p = closestPoint_PointAABB(s.center, a);
 	vec3 n = p - s.center;
@@ -323,7 +340,7 @@ inline NODISCARD bool sphereVsAABB(const bounding_sphere& s, const bounding_box&
 	return sqDistance <= s.radius * s.radius;
 }
 
-inline NODISCARD bool sphereVsOBB(const bounding_sphere& s, const bounding_oriented_box& o)
+NODISCARD inline bool sphereVsOBB(const bounding_sphere& s, const bounding_oriented_box& o)
 {
 	bounding_box aabb = bounding_box::fromCenterRadius(o.center, o.radius);
 	bounding_sphere s_ = {
@@ -333,21 +350,21 @@ inline NODISCARD bool sphereVsOBB(const bounding_sphere& s, const bounding_orien
 	return sphereVsAABB(s_, aabb);
 }
 
-inline NODISCARD bool capsuleVsCapsule(const bounding_capsule& a, const bounding_capsule& b)
+NODISCARD inline bool capsuleVsCapsule(const bounding_capsule& a, const bounding_capsule& b)
 {
 	vec3 closestPoint1, closestPoint2;
 	closestPoint_SegmentSegment(line_segment{ a.positionA, a.positionB }, line_segment{ b.positionA, b.positionB }, closestPoint1, closestPoint2);
 	return sphereVsSphere(bounding_sphere{ closestPoint1, a.radius }, bounding_sphere{ closestPoint2, b.radius });
 }
 
-inline NODISCARD bool capsuleVsCylinder(const bounding_capsule& a, const bounding_cylinder& b)
+NODISCARD inline bool capsuleVsCylinder(const bounding_capsule& a, const bounding_cylinder& b)
 {
 	vec3 closestPoint1, closestPoint2;
 	closestPoint_SegmentSegment(line_segment{ a.positionA, a.positionB }, line_segment{ b.positionA, b.positionB }, closestPoint1, closestPoint2);
 	return sphereVsCylinder(bounding_sphere{ closestPoint1, a.radius }, b);
 }
 
-inline NODISCARD bool aabbVsAABB(const bounding_box& a, const bounding_box& b)
+NODISCARD inline bool aabbVsAABB(const bounding_box& a, const bounding_box& b)
 {
 	if (a.maxCorner.x < b.minCorner.x || a.minCorner.x > b.maxCorner.x) return false;
 	if (a.maxCorner.y < b.minCorner.y || a.minCorner.y > b.maxCorner.y) return false;
@@ -355,12 +372,12 @@ inline NODISCARD bool aabbVsAABB(const bounding_box& a, const bounding_box& b)
 	return true;
 }
 
-inline NODISCARD bool aabbVsOBB(const bounding_box& a, const bounding_oriented_box& o)
+NODISCARD inline bool aabbVsOBB(const bounding_box& a, const bounding_oriented_box& o)
 {
 	return obbVsOBB(bounding_oriented_box{ quat::identity, a.getCenter(), a.getRadius() }, o);
 }
 
-inline NODISCARD vec3 closestPoint_PointSegment(const vec3& q, const line_segment& l)
+NODISCARD inline vec3 closestPoint_PointSegment(const vec3& q, const line_segment& l)
 {
 	vec3 ab = l.b - l.a;
 	float t = dot(q - l.a, ab) / squaredLength(ab);
@@ -368,7 +385,7 @@ inline NODISCARD vec3 closestPoint_PointSegment(const vec3& q, const line_segmen
 	return l.a + t * ab;
 }
 
-inline NODISCARD vec3 closestPoint_PointAABB(const vec3& q, const bounding_box& aabb)
+NODISCARD inline vec3 closestPoint_PointAABB(const vec3& q, const bounding_box& aabb)
 {
 	vec3 result;
 	for (uint32 i = 0; i < 3; ++i)
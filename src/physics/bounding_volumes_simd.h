@@ -18,6 +18,9 @@ typedef wN_quat<w_float> w_quat;
 typedef wN_mat2<w_float> w_mat2;
 typedef wN_mat3<w_float> w_mat3;
 
+template <typename simd_t> struct wN_line_segment;
+typedef wN_line_segment<w_float> w_line_segment;
+
 #endif
 
 template <typename simd_t>
@@ -68,6 +71,20 @@ struct wN_bounding_oriented_box
 	wN_quat<simd_t> rotation;
 };
 
+// Number of lanes of a wide float type.
+template <typename simd_t>
+static constexpr uint32 simdWidth = sizeof(simd_t) / sizeof(float);
+
+struct bounding_hull_geometry;
+
+template <typename simd_t>
+struct wN_bounding_hull
+{
+	wN_quat<simd_t> rotation;
+	wN_vec3<simd_t> position;
+	const bounding_hull_geometry* geometryPtrs[simdWidth<simd_t>]; // Hulls have varying vertex counts, so the geometry stays per lane.
+};
+
 template <typename simd_t>
 struct wN_line_segment
 {
@@ -75,7 +92,7 @@ struct wN_line_segment
 };
 
 template <typename simd_t>
-inline NODISCARD auto aabbVsAABB(const wN_bounding_box<simd_t>& a, const wN_bounding_box<simd_t>& b)
+NODISCARD inline auto aabbVsAABB(const wN_bounding_box<simd_t>& a, const wN_bounding_box<simd_t>& b)
 {
 	return
 		(a.maxCorner.x >= b.minCorner.x) & (a.minCorner.x <= b.maxCorner.x) &
@@ -84,7 +101,7 @@ inline NODISCARD auto aabbVsAABB(const wN_bounding_box<simd_t>& a, const wN_boun
 }
 
 template <typename simd_t>
-inline NODISCARD wN_vec3<simd_t> closestPoint_PointSegment(const wN_vec3<simd_t>& q, const wN_line_segment<simd_t>& l)
+NODISCARD inline wN_vec3<simd_t> closestPoint_PointSegment(const wN_vec3<simd_t>& q, const wN_line_segment<simd_t>& l)
 {
 	wN_vec3<simd_t> ab = l.b - l.a;
 	simd_t t = dot(q - l.a, ab) / squaredLength(ab);
@@ -93,21 +110,74 @@ inline NODISCARD wN_vec3<simd_t> closestPoint_PointSegment(const wN_vec3<simd_t>
 }
 
 template <typename simd_t>
-inline NODISCARD wN_vec3<simd_t> closestPoint_PointAABB(const wN_vec3<simd_t>& q, const wN_bounding_box<simd_t>& aabb)
+NODISCARD inline wN_vec3<simd_t> closestPoint_PointAABB(const wN_vec3<simd_t>& q, const wN_bounding_box<simd_t>& aabb)
 {
-	wN_vec3<simd_t> result;
-	for (uint32 i = 0; i < 3; ++i)
+	auto clampAxis = [](simd_t v, simd_t lo, simd_t hi)
 	{
-		simd_t v = q.data[i];
-		v = ifThen(v < aabb.minCorner.data[i], aabb.minCorner.data[i], v);
-		v = ifThen(v > aabb.maxCorner.data[i], aabb.maxCorner.data[i], v);
-		result.data[i] = v;
-	}
+		v = ifThen(v < lo, lo, v);
+		v = ifThen(v > hi, hi, v);
+		return v;
+	};
+
+	return wN_vec3<simd_t>(
+		clampAxis(q.x, aabb.minCorner.x, aabb.maxCorner.x),
+		clampAxis(q.y, aabb.minCorner.y, aabb.maxCorner.y),
+		clampAxis(q.z, aabb.minCorner.z, aabb.maxCorner.z));
+}
+
+// Same region tests as the scalar version. All regions are evaluated and blended in reverse order of the scalar early outs.
+template <typename simd_t>
+NODISCARD inline wN_vec3<simd_t> closestPoint_PointTriangle(const wN_vec3<simd_t>& p, const wN_vec3<simd_t>& a, const wN_vec3<simd_t>& b, const wN_vec3<simd_t>& c)
+{
+	simd_t zero = simd_t::zero();
+
+	wN_vec3<simd_t> ab = b - a;
+	wN_vec3<simd_t> ac = c - a;
+	wN_vec3<simd_t> ap = p - a;
+	simd_t d1 = dot(ab, ap);
+	simd_t d2 = dot(ac, ap);
+
+	wN_vec3<simd_t> bp = p - b;
+	simd_t d3 = dot(ab, bp);
+	simd_t d4 = dot(ac, bp);
+
+	wN_vec3<simd_t> cp = p - c;
+	simd_t d5 = dot(ab, cp);
+	simd_t d6 = dot(ac, cp);
+
+	simd_t va = d3 * d6 - d5 * d4;
+	simd_t vb = d5 * d2 - d1 * d6;
+	simd_t vc = d1 * d4 - d3 * d2;
+
+	// Face region.
+	simd_t denom = simd_t(1.f) / (va + vb + vc);
+	wN_vec3<simd_t> result = a + ab * (vb * denom) + ac * (vc * denom);
+
+	// Edge BC.
+	simd_t d43 = d4 - d3;
+	simd_t d56 = d5 - d6;
+	result = ifThen((va <= zero) & (d43 >= zero) & (d56 >= zero), b + (c - b) * (d43 / (d43 + d56)), result);
+
+	// Edge AC.
+	result = ifThen((vb <= zero) & (d2 >= zero) & (d6 <= zero), a + ac * (d2 / (d2 - d6)), result);
+
+	// Vertex C.
+	result = ifThen((d6 >= zero) & (d5 <= d6), c, result);
+
+	// Edge AB.
+	result = ifThen((vc <= zero) & (d1 >= zero) & (d3 <= zero), a + ab * (d1 / (d1 - d3)), result);
+
+	// Vertex B.
+	result = ifThen((d3 >= zero) & (d4 <= d3), b, result);
+
+	// Vertex A.
+	result = ifThen((d1 <= zero) & (d2 <= zero), a, result);
+
 	return result;
 }
 
 template <typename simd_t>
-inline NODISCARD simd_t closestPoint_SegmentSegment(const wN_line_segment<simd_t>& l1, const wN_line_segment<simd_t>& l2, wN_vec3<simd_t>& c1, wN_vec3<simd_t>& c2)
+NODISCARD inline simd_t closestPoint_SegmentSegment(const wN_line_segment<simd_t>& l1, const wN_line_segment<simd_t>& l2, wN_vec3<simd_t>& c1, wN_vec3<simd_t>& c2)
 {
 	w_vec3 d1 = l1.b - l1.a;
 	w_vec3 d2 = l2.b - l2.a;
@@ -3,6 +3,28 @@
 #include "physics.h"
 #include "core/random.h"
 #include "core/cpu_profiling.h"
+#include "scene_queries.h"
+#include "terrain/heightmap_collider.h"
+#include "bounding_volumes_simd.h"
+#include "core/job_system.h"
+#include "snapshot.h"
+
+#if defined(SIMD_AVX_2)
+typedef w8_float cloth_float;
+typedef w8_int cloth_int;
+#else
+typedef w4_float cloth_float;
+typedef w4_int cloth_int;
+#endif
+
+typedef wN_vec3<cloth_float> cloth_vec3;
+typedef wN_quat<cloth_float> cloth_quat;
+
+#define CLOTH_SIMD_WIDTH (uint32)(sizeof(cloth_float) / sizeof(float))
+
+// Colors with many constraints are split over the job system. Smaller ones are solved on the calling thread.
+#define CLOTH_MIN_CONSTRAINTS_PER_JOB 512
+#define CLOTH_MAX_NUM_COLORS 32
 
 cloth_component::cloth_component(float width, float height, uint32 gridSizeX, uint32 gridSizeY, float totalMass, float stiffness, float damping, float gravityFactor)
 	: gridSizeX(gridSizeX), gridSizeY(gridSizeY), width(width), height(height)
@@ -12,15 +34,16 @@ cloth_component::cloth_component(float width, float height, uint32 gridSizeX, ui
 	this->totalMass = totalMass;
 	this->stiffness = stiffness;
 
-	uint32 numParticles = gridSizeX * gridSizeY;
+	numParticles = gridSizeX * gridSizeY;
+	numPaddedParticles = bucketize(numParticles + 1, CLOTH_SIMD_WIDTH) * CLOTH_SIMD_WIDTH; // At least one padding particle.
 
 	float invMassPerParticle = numParticles / totalMass;
 
-	positions.reserve(numParticles);
-	prevPositions.reserve(numParticles);
-	invMasses.reserve(numParticles);
-	velocities.resize(numParticles, vec3(0.f));
-	forceAccumulators.resize(numParticles, vec3(0.f));
+	positions.resize(numPaddedParticles);
+	prevPositions.resize(numPaddedParticles);
+	velocities.resize(numPaddedParticles);
+	forceAccumulators.resize(numPaddedParticles);
+	invMasses.resize(numPaddedParticles, 0.f);
 
 	random_number_generator rng = { 1578123 };
 
@@ -33,13 +56,17 @@ cloth_component::cloth_component(float width, float height, uint32 gridSizeX, ui
 			float relX = x / (float)(gridSizeX - 1);
 			float relY = y / (float)(gridSizeY - 1);
 			
+			uint32 index = y * gridSizeX + x;
+
 			vec3 position = getParticlePosition(relX, relY);
-			positions.push_back(position);
-			prevPositions.push_back(position);
-			invMasses.push_back(invMass);
+			positions.set(index, position);
+			prevPositions.set(index, position);
+			invMasses[index] = invMass;
 		}
 	}
 
+	std::vector<cloth_constraint> constraints;
+
 	for (uint32 y = 0; y < gridSizeY; ++y)
 	{
 		for (uint32 x = 0; x < gridSizeX; ++x)
@@ -48,25 +75,27 @@ cloth_component::cloth_component(float width, float height, uint32 gridSizeX, ui
 
 			// Stretch constraints: direct right and bottom neighbor.
 			if (x < gridSizeX - 1)
-				addConstraint(index, index + 1);
+				addConstraint(constraints, index, index + 1);
 			if (y < gridSizeY - 1)
-				addConstraint(index, index + gridSizeX);
+				addConstraint(constraints, index, index + gridSizeX);
 
 			// Shear constraints: direct diagonal neighbor.
 			if (x < gridSizeX - 1 && y < gridSizeY - 1)
 			{
-				addConstraint(index, index + gridSizeX + 1);
-				addConstraint(index + gridSizeX, index + 1);
+				addConstraint(constraints, index, index + gridSizeX + 1);
+				addConstraint(constraints, index + gridSizeX, index + 1);
 			}
 
 			// Bend constraints: neighbor right and bottom two places away.
 			if (x < gridSizeX - 2)
-				addConstraint(index, index + 2);
+				addConstraint(constraints, index, index + 2);
 			if (y < gridSizeY - 2)
-				addConstraint(index, index + gridSizeX * 2);
+				addConstraint(constraints, index, index + gridSizeX * 2);
 		}
 	}
 
+	colorConstraints(constraints);
+
 	oldTotalMass = totalMass;
 	oldStiffness = stiffness;
 }
@@ -77,11 +106,11 @@ void cloth_component::setWorldPositionOfFixedVertices(const trs& transform, bool
 	{
 		vec3 pivot;
 		if (gridSizeX % 2 == 1)
-			pivot = positions[gridSizeX / 2];
+			pivot = positions.get(gridSizeX / 2);
 		else
-			pivot = (positions[gridSizeX / 2] + positions[gridSizeX / 2 - 1]) * 0.5f;
+			pivot = (positions.get(gridSizeX / 2) + positions.get(gridSizeX / 2 - 1)) * 0.5f;
 
-		vec3 currentAxis = normalize(positions[gridSizeX - 1] - positions[0]);
+		vec3 currentAxis = normalize(positions.get(gridSizeX - 1) - positions.get(0));
 		vec3 newAxis = normalize(transformPosition(transform, getParticlePosition(1.f, 0.f)) - transformPosition(transform, getParticlePosition(0.f, 0.f)));
 
 		vec3 newPivot = transformPosition(transform, getParticlePosition(0.5f, 0.f));
@@ -93,8 +122,8 @@ void cloth_component::setWorldPositionOfFixedVertices(const trs& transform, bool
 		{
 			for (uint32 x = 0; x < gridSizeX; ++x)
 			{
-				vec3& position = positions[y * gridSizeX + x];
-				position = deltaRotation * (position - pivot) + newPivot;
+				uint32 index = y * gridSizeX + x;
+				positions.set(index, deltaRotation * (positions.get(index) - pivot) + newPivot);
 			}
 		}
 	}
@@ -105,7 +134,7 @@ void cloth_component::setWorldPositionOfFixedVertices(const trs& transform, bool
 		float relX = x / (float)(gridSizeX - 1);
 		float relY = 0.f;
 		vec3 localPosition = getParticlePosition(relX, relY);
-		positions[x] = transformPosition(transform, localPosition);
+		positions.set(x, transformPosition(transform, localPosition));
 	}
 }
 
@@ -133,13 +162,15 @@ void cloth_component::applyWindForce(vec3 force)
 			uint32 blIndex = tlIndex + gridSizeX;
 			uint32 brIndex = blIndex + 1;
 
-			vec3& tlForce = forceAccumulators[tlIndex];
-			vec3& trForce = forceAccumulators[trIndex];
-			vec3& blForce = forceAccumulators[blIndex];
-			vec3& brForce = forceAccumulators[brIndex];
+			vec3 tl = positions.get(tlIndex);
+			vec3 tr = positions.get(trIndex);
+			vec3 bl = positions.get(blIndex);
+			vec3 br = positions.get(brIndex);
+
+			vec3 tlForce(0.f), trForce(0.f), blForce(0.f), brForce(0.f);
 
 			{
-				vec3 normal = calculateNormal(positions[tlIndex], positions[blIndex], positions[trIndex]);
+				vec3 normal = calculateNormal(tl, bl, tr);
 				vec3 forceInNormalDir = normal * dot(normalize(normal), force);
 				forceInNormalDir *= 1.f / 3.f;
 				tlForce += forceInNormalDir;
@@ -148,24 +179,75 @@ void cloth_component::applyWindForce(vec3 force)
 			}
 
 			{
-				vec3 normal = calculateNormal(positions[brIndex], positions[trIndex], positions[blIndex]);
+				vec3 normal = calculateNormal(br, tr, bl);
 				vec3 forceInNormalDir = normal * dot(normalize(normal), force);
 				forceInNormalDir *= 1.f / 3.f;
 				brForce += forceInNormalDir;
 				trForce += forceInNormalDir;
 				blForce += forceInNormalDir;
 			}
+
+			forceAccumulators.set(tlIndex, forceAccumulators.get(tlIndex) + tlForce);
+			forceAccumulators.set(trIndex, forceAccumulators.get(trIndex) + trForce);
+			forceAccumulators.set(blIndex, forceAccumulators.get(blIndex) + blForce);
+			forceAccumulators.set(brIndex, forceAccumulators.get(brIndex) + brForce);
+		}
+	}
+}
+
+void cloth_component::writeSnapshot(physics_snapshot_writer& writer) const
+{
+	const cloth_particle_array* arrays[] = { &positions, &prevPositions, &velocities, &forceAccumulators };
+	for (const cloth_particle_array* a : arrays)
+	{
+		writer.writeArray(a->x.data(), numPaddedParticles);
+		writer.writeArray(a->y.data(), numPaddedParticles);
+		writer.writeArray(a->z.data(), numPaddedParticles);
+	}
+}
+
+bool cloth_component::readSnapshot(physics_snapshot_reader& reader)
+{
+	cloth_particle_array* arrays[] = { &positions, &prevPositions, &velocities, &forceAccumulators };
+	for (cloth_particle_array* a : arrays)
+	{
+		if (!reader.readArray(a->x.data(), numPaddedParticles)
+			|| !reader.readArray(a->y.data(), numPaddedParticles)
+			|| !reader.readArray(a->z.data(), numPaddedParticles))
+		{
+			return false;
 		}
 	}
+	return true;
+}
+
+void cloth_component::publishRenderPositions()
+{
+	renderPositions.resize(numParticles);
+	for (uint32 i = 0; i < numParticles; ++i)
+	{
+		renderPositions[i] = positions.get(i);
+	}
 }
 
-struct cloth_constraint_temp
+// Calls solve(begin, end) for all constraints of each color in order. Large colors are split over the job system.
+template <typename solve_func>
+static void solveByColor(const std::vector<uint32>& colorOffsets, const solve_func& solve)
 {
-	vec3 gradient;
-	float inverseScaledGradientSquared;
-};
+	uint32 numColors = (uint32)colorOffsets.size() - 1;
+	for (uint32 color = 0; color < numColors; ++color)
+	{
+		uint32 first = colorOffsets[color];
+		uint32 numBatches = (colorOffsets[color + 1] - first) / CLOTH_SIMD_WIDTH;
+
+		parallelFor(highPriorityJobQueue, numBatches, CLOTH_MIN_CONSTRAINTS_PER_JOB / CLOTH_SIMD_WIDTH, [first, &solve](uint32 begin, uint32 end)
+		{
+			solve(first + begin * CLOTH_SIMD_WIDTH, first + end * CLOTH_SIMD_WIDTH);
+		});
+	}
+}
 
-void cloth_component::simulate(uint32 velocityIterations, uint32 positionIterations, uint32 driftIterations, float dt)
+void cloth_component::simulate(uint32 velocityIterations, uint32 positionIterations, uint32 driftIterations, float dt, const cloth_collision_context* collisionContext)
 {
 	CPU_PROFILE_BLOCK("Simulate cloth");
 
@@ -177,146 +259,466 @@ void cloth_component::simulate(uint32 velocityIterations, uint32 positionIterati
 		oldStiffness = stiffness;
 	}
 
-	float gravityVelocity = GRAVITY * dt * gravityFactor;
-	uint32 numParticles = gridSizeX * gridSizeY;
+	cloth_float zero = cloth_float::zero();
+	cloth_float gravityVelocity = GRAVITY * dt * gravityFactor;
+	cloth_float wideDt = dt;
 
-	for (uint32 i = 0; i < numParticles; ++i)
+	for (uint32 i = 0; i < numPaddedParticles; i += CLOTH_SIMD_WIDTH)
 	{
-		vec3& position = positions[i];
-		vec3& prevPosition = prevPositions[i];
-		float invMass = invMasses[i];
-		vec3& velocity = velocities[i];
-		vec3& force = forceAccumulators[i];
+		cloth_float invMass(invMasses.data() + i);
 
-		if (invMass > 0.f)
-		{
-			velocity.y += gravityVelocity;
-		}
+		cloth_float vx(velocities.x.data() + i);
+		cloth_float vy(velocities.y.data() + i);
+		cloth_float vz(velocities.z.data() + i);
+
+		cloth_float px(positions.x.data() + i);
+		cloth_float py(positions.y.data() + i);
+		cloth_float pz(positions.z.data() + i);
+
+		cloth_float forceFactor = invMass * wideDt;
+
+		vx += cloth_float(forceAccumulators.x.data() + i) * forceFactor;
+		vy += cloth_float(forceAccumulators.y.data() + i) * forceFactor + ifThen(invMass > zero, gravityVelocity, zero);
+		vz += cloth_float(forceAccumulators.z.data() + i) * forceFactor;
 
-		velocity += force * (invMass * dt);
+		px.store(prevPositions.x.data() + i);
+		py.store(prevPositions.y.data() + i);
+		pz.store(prevPositions.z.data() + i);
 
-		prevPosition = position;
-		position += velocity * dt;
-		force = vec3(0.f);
+		(px + vx * wideDt).store(positions.x.data() + i);
+		(py + vy * wideDt).store(positions.y.data() + i);
+		(pz + vz * wideDt).store(positions.z.data() + i);
+
+		vx.store(velocities.x.data() + i);
+		vy.store(velocities.y.data() + i);
+		vz.store(velocities.z.data() + i);
+
+		zero.store(forceAccumulators.x.data() + i);
+		zero.store(forceAccumulators.y.data() + i);
+		zero.store(forceAccumulators.z.data() + i);
 	}
 
 	float invDt = (dt > 1e-5f) ? (1.f / dt) : 1.f;
-	
+	cloth_float wideInvDt = invDt;
+
 	// Solve velocities.
 	if (velocityIterations > 0)
 	{
-		std::vector<cloth_constraint_temp> constraintsTemp;
-		constraintsTemp.reserve(constraints.size());
-
-		for (cloth_constraint& c : constraints)
+		uint32 numConstraints = (uint32)constraintA.size();
+		for (uint32 i = 0; i < numConstraints; i += CLOTH_SIMD_WIDTH)
 		{
-			vec3 prevPositionA = prevPositions[c.a];
-			vec3 prevPositionB = prevPositions[c.b];
+			cloth_int a(constraintA.data() + i);
+			cloth_int b(constraintB.data() + i);
+
+			cloth_float gx = cloth_float(prevPositions.x.data(), b) - cloth_float(prevPositions.x.data(), a);
+			cloth_float gy = cloth_float(prevPositions.y.data(), b) - cloth_float(prevPositions.y.data(), a);
+			cloth_float gz = cloth_float(prevPositions.z.data(), b) - cloth_float(prevPositions.z.data(), a);
 
-			cloth_constraint_temp temp;
-			temp.gradient = prevPositionB - prevPositionA;
-			temp.inverseScaledGradientSquared = (c.inverseMassSum == 0.f) ? 0.f : (1.f / (squaredLength(temp.gradient) * c.inverseMassSum));
-			constraintsTemp.push_back(temp);
+			cloth_float inverseMassSum(constraintInverseMassSum.data() + i);
+			cloth_float inverseScaledGradientSquared = ifThen(inverseMassSum == zero, zero, cloth_float(1.f) / ((gx * gx + gy * gy + gz * gz) * inverseMassSum));
+
+			gx.store(constraintGradients.x.data() + i);
+			gy.store(constraintGradients.y.data() + i);
+			gz.store(constraintGradients.z.data() + i);
+			inverseScaledGradientSquared.store(constraintInverseScaledGradientSquared.data() + i);
 		}
 
 		for (uint32 it = 0; it < velocityIterations; ++it)
 		{
-			solveVelocities(constraintsTemp);
+			solveVelocities();
 		}
 
-		for (uint32 i = 0; i < numParticles; ++i)
+		for (uint32 i = 0; i < numPaddedParticles; i += CLOTH_SIMD_WIDTH)
 		{
-			positions[i] = prevPositions[i] + velocities[i] * dt;
+			(cloth_float(prevPositions.x.data() + i) + cloth_float(velocities.x.data() + i) * wideDt).store(positions.x.data() + i);
+			(cloth_float(prevPositions.y.data() + i) + cloth_float(velocities.y.data() + i) * wideDt).store(positions.y.data() + i);
+			(cloth_float(prevPositions.z.data() + i) + cloth_float(velocities.z.data() + i) * wideDt).store(positions.z.data() + i);
 		}
 	}
 
 	// Solve positions.
 	if (positionIterations > 0)
 	{
+		if (collisionContext)
+		{
+			gatherCollisionShapes(*collisionContext);
+		}
+
 		for (uint32 it = 0; it < positionIterations; ++it)
 		{
 			solvePositions();
+
+			if (collisionContext)
+			{
+				projectParticlesOutOfColliders(*collisionContext);
+			}
 		}
 
-		for (uint32 i = 0; i < numParticles; ++i)
+		for (uint32 i = 0; i < numPaddedParticles; i += CLOTH_SIMD_WIDTH)
 		{
-			velocities[i] = (positions[i] - prevPositions[i]) * invDt;
+			((cloth_float(positions.x.data() + i) - cloth_float(prevPositions.x.data() + i)) * wideInvDt).store(velocities.x.data() + i);
+			((cloth_float(positions.y.data() + i) - cloth_float(prevPositions.y.data() + i)) * wideInvDt).store(velocities.y.data() + i);
+			((cloth_float(positions.z.data() + i) - cloth_float(prevPositions.z.data() + i)) * wideInvDt).store(velocities.z.data() + i);
 		}
 	}
 
 	// Solve drift.
 	if (driftIterations > 0)
 	{
-		for (uint32 i = 0; i < numParticles; ++i)
-		{
-			prevPositions[i] = positions[i];
-		}
+		prevPositions.x = positions.x;
+		prevPositions.y = positions.y;
+		prevPositions.z = positions.z;
 
 		for (uint32 it = 0; it < driftIterations; ++it)
 		{
 			solvePositions();
 		}
 
-		for (uint32 i = 0; i < numParticles; ++i)
+		for (uint32 i = 0; i < numPaddedParticles; i += CLOTH_SIMD_WIDTH)
 		{
-			velocities[i] += (positions[i] - prevPositions[i]) * invDt;
+			(cloth_float(velocities.x.data() + i) + (cloth_float(positions.x.data() + i) - cloth_float(prevPositions.x.data() + i)) * wideInvDt).store(velocities.x.data() + i);
+			(cloth_float(velocities.y.data() + i) + (cloth_float(positions.y.data() + i) - cloth_float(prevPositions.y.data() + i)) * wideInvDt).store(velocities.y.data() + i);
+			(cloth_float(velocities.z.data() + i) + (cloth_float(positions.z.data() + i) - cloth_float(prevPositions.z.data() + i)) * wideInvDt).store(velocities.z.data() + i);
 		}
 	}
 
 	// Damping.
-	float dampingFactor = 1.f / (1.f + dt * damping);
-	for (uint32 i = 0; i < numParticles; ++i)
+	cloth_float dampingFactor = 1.f / (1.f + dt * damping);
+	for (uint32 i = 0; i < numPaddedParticles; i += CLOTH_SIMD_WIDTH)
 	{
-		velocities[i] *= dampingFactor;
+		(cloth_float(velocities.x.data() + i) * dampingFactor).store(velocities.x.data() + i);
+		(cloth_float(velocities.y.data() + i) * dampingFactor).store(velocities.y.data() + i);
+		(cloth_float(velocities.z.data() + i) * dampingFactor).store(velocities.z.data() + i);
 	}
 }
 
-void cloth_component::solveVelocities(const std::vector<cloth_constraint_temp>& constraintsTemp)
+void cloth_component::solveVelocities()
 {
-	for (uint32 i = 0; i < (uint32)constraints.size(); ++i)
+	solveByColor(colorOffsets, [this](uint32 begin, uint32 end)
 	{
-		cloth_constraint& c = constraints[i];
-		const cloth_constraint_temp& temp = constraintsTemp[i];
-		float j = -dot(temp.gradient, velocities[c.a] - velocities[c.b]) * temp.inverseScaledGradientSquared;
-		velocities[c.a] += temp.gradient * (j * invMasses[c.a]);
-		velocities[c.b] -= temp.gradient * (j * invMasses[c.b]);
-	}
+		float* vx = velocities.x.data();
+		float* vy = velocities.y.data();
+		float* vz = velocities.z.data();
+
+		for (uint32 i = begin; i < end; i += CLOTH_SIMD_WIDTH)
+		{
+			cloth_int a(constraintA.data() + i);
+			cloth_int b(constraintB.data() + i);
+
+			cloth_float gx(constraintGradients.x.data() + i);
+			cloth_float gy(constraintGradients.y.data() + i);
+			cloth_float gz(constraintGradients.z.data() + i);
+
+			cloth_float vax(vx, a), vay(vy, a), vaz(vz, a);
+			cloth_float vbx(vx, b), vby(vy, b), vbz(vz, b);
+
+			cloth_float j = -(gx * (vax - vbx) + gy * (vay - vby) + gz * (vaz - vbz)) * cloth_float(constraintInverseScaledGradientSquared.data() + i);
+			cloth_float ja = j * cloth_float(invMasses.data(), a);
+			cloth_float jb = j * cloth_float(invMasses.data(), b);
+
+			(vax + gx * ja).scatter(vx, a);
+			(vay + gy * ja).scatter(vy, a);
+			(vaz + gz * ja).scatter(vz, a);
+
+			(vbx - gx * jb).scatter(vx, b);
+			(vby - gy * jb).scatter(vy, b);
+			(vbz - gz * jb).scatter(vz, b);
+		}
+	});
 }
 
 void cloth_component::solvePositions()
 {
-	for (cloth_constraint& c : constraints)
+	solveByColor(colorOffsets, [this](uint32 begin, uint32 end)
 	{
-		if (c.inverseMassSum > 0.f)
+		cloth_float zero = cloth_float::zero();
+
+		float* px = positions.x.data();
+		float* py = positions.y.data();
+		float* pz = positions.z.data();
+
+		for (uint32 i = begin; i < end; i += CLOTH_SIMD_WIDTH)
 		{
-			vec3 delta = positions[c.b] - positions[c.a];
-			float len = squaredLength(delta);
+			cloth_int a(constraintA.data() + i);
+			cloth_int b(constraintB.data() + i);
+
+			cloth_float pax(px, a), pay(py, a), paz(pz, a);
+			cloth_float pbx(px, b), pby(py, b), pbz(pz, b);
+
+			cloth_float dx = pbx - pax;
+			cloth_float dy = pby - pay;
+			cloth_float dz = pbz - paz;
+			cloth_float len = dx * dx + dy * dy + dz * dz;
+
+			cloth_float restDistance(constraintRestDistance.data() + i);
+			cloth_float inverseMassSum(constraintInverseMassSum.data() + i);
+
+			cloth_float sqRestDistance = restDistance * restDistance;
+			cloth_float sum = sqRestDistance + len;
+
+			// Padding constraints have zero inverse mass sum and get k = 0.
+			cloth_float k = ifThen((inverseMassSum > zero) & (sum > 1e-5f), (sqRestDistance - len) / (inverseMassSum * sum), zero);
+			cloth_float ka = k * cloth_float(invMasses.data(), a);
+			cloth_float kb = k * cloth_float(invMasses.data(), b);
+
+			(pax - dx * ka).scatter(px, a);
+			(pay - dy * ka).scatter(py, a);
+			(paz - dz * ka).scatter(pz, a);
+
+			(pbx + dx * kb).scatter(px, b);
+			(pby + dy * kb).scatter(py, b);
+			(pbz + dz * kb).scatter(pz, b);
+		}
+	});
+}
 
-			float sqRestDistance = c.restDistance * c.restDistance;
-			if (sqRestDistance + len > 1e-5f)
+static cloth_vec3 broadcast(vec3 v)
+{
+	return cloth_vec3(cloth_float(v.x), cloth_float(v.y), cloth_float(v.z));
+}
+
+static cloth_vec3 projectOutOfSphere(const cloth_vec3& p, const cloth_vec3& center, float radius)
+{
+	cloth_vec3 d = p - center;
+	cloth_float sqDistance = squaredLength(d);
+	auto inside = (sqDistance < radius * radius) & (sqDistance > 1e-8f);
+	return ifThen(inside, center + d * (cloth_float(radius) / sqrt(sqDistance)), p);
+}
+
+// Pushes particles inside the box out through the closest face.
+static cloth_vec3 projectOutOfBox(const cloth_vec3& p, vec3 minCorner, vec3 maxCorner)
+{
+	cloth_float zero = cloth_float::zero();
+
+	cloth_float toMin[3], toMax[3];
+	for (uint32 axis = 0; axis < 3; ++axis)
+	{
+		toMin[axis] = p.data[axis] - cloth_float(minCorner.data[axis]);
+		toMax[axis] = cloth_float(maxCorner.data[axis]) - p.data[axis];
+	}
+
+	auto inside = (minimum(toMin[0], toMax[0]) > zero) & (minimum(toMin[1], toMax[1]) > zero) & (minimum(toMin[2], toMax[2]) > zero);
+
+	cloth_vec3 result = p;
+	cloth_float minDistance = FLT_MAX;
+	for (uint32 axis = 0; axis < 3; ++axis)
+	{
+		cloth_vec3 candidate = p;
+		candidate.data[axis] = minCorner.data[axis];
+		result = ifThen(toMin[axis] < minDistance, candidate, result);
+		minDistance = minimum(minDistance, toMin[axis]);
+
+		candidate.data[axis] = maxCorner.data[axis];
+		result = ifThen(toMax[axis] < minDistance, candidate, result);
+		minDistance = minimum(minDistance, toMax[axis]);
+	}
+
+	return ifThen(inside, result, p);
+}
+
+static cloth_vec3 projectOutOfCylinder(const cloth_vec3& p, const bounding_cylinder& cylinder, float thickness)
+{
+	vec3 axis = cylinder.positionB - cylinder.positionA;
+	float axisLength = length(axis);
+	if (axisLength < 1e-5f)
+	{
+		return p;
+	}
+	axis *= 1.f / axisLength;
+
+	float radius = cylinder.radius + thickness;
+
+	cloth_vec3 a = broadcast(cylinder.positionA);
+	cloth_vec3 wideAxis = broadcast(axis);
+
+	cloth_vec3 ap = p - a;
+	cloth_float t = dot(ap, wideAxis);
+	cloth_vec3 radial = ap - wideAxis * t;
+	cloth_float radialLength = length(radial);
+
+	cloth_float toSide = cloth_float(radius) - radialLength;
+	cloth_float toCapA = t + thickness;
+	cloth_float toCapB = cloth_float(axisLength + thickness) - t;
+
+	cloth_float zero = cloth_float::zero();
+	auto inside = (toSide > zero) & (toCapA > zero) & (toCapB > zero);
+
+	cloth_vec3 outOfSide = p + radial * (toSide / radialLength);
+	cloth_vec3 result = ifThen(radialLength > 1e-5f, outOfSide, p);
+	cloth_float minDistance = ifThen(radialLength > 1e-5f, toSide, cloth_float(FLT_MAX));
+
+	result = ifThen(toCapA < minDistance, p - wideAxis * toCapA, result);
+	minDistance = minimum(minDistance, toCapA);
+	result = ifThen(toCapB < minDistance, p + wideAxis * toCapB, result);
+
+	return ifThen(inside, result, p);
+}
+
+void cloth_component::gatherCollisionShapes(const cloth_collision_context& context)
+{
+	collisionColliderIndices.clear();
+
+	if (!context.colliders)
+	{
+		return;
+	}
+
+	// Bounds of the motion of all particles during this step.
+	bounding_box aabb = bounding_box::negativeInfinity();
+	for (uint32 i = 0; i < numParticles; ++i)
+	{
+		aabb.grow(positions.get(i));
+		aabb.grow(prevPositions.get(i));
+	}
+	aabb.minCorner -= vec3(collisionThickness);
+	aabb.maxCorner += vec3(collisionThickness);
+
+	// Sized for all colliders of the scene, so that none are dropped. The vector keeps its capacity between steps.
+	collisionColliderIndices.resize(context.colliders->numColliders);
+	uint32 numColliders = queryCollidersInAABB(*context.colliders, aabb, scene_query_filter{}, collisionColliderIndices.data(), context.colliders->numColliders);
+	collisionColliderIndices.resize(numColliders);
+}
+
+// Projects the particles out of all gathered colliders. Runs over SIMD-wide particle batches, with the colliders in the inner loop.
+// Only positions are changed. The collision response follows from the velocity update after the position iterations. There is no friction.
+void cloth_component::projectParticlesOutOfColliders(const cloth_collision_context& context)
+{
+	if (!collisionColliderIndices.empty())
+	{
+		cloth_float zero = cloth_float::zero();
+
+		for (uint32 i = 0; i < numPaddedParticles; i += CLOTH_SIMD_WIDTH)
+		{
+			cloth_vec3 original(cloth_float(positions.x.data() + i), cloth_float(positions.y.data() + i), cloth_float(positions.z.data() + i));
+			cloth_vec3 p = original;
+
+			for (uint32 colliderIndex : collisionColliderIndices)
+			{
+				const collider_union& collider = context.colliders->worldSpaceColliders[colliderIndex];
+				switch (collider.type)
+				{
+					case collider_type_sphere:
+					{
+						p = projectOutOfSphere(p, broadcast(collider.sphere.center), collider.sphere.radius + collisionThickness);
+					} break;
+					case collider_type_capsule:
+					{
+						wN_line_segment<cloth_float> segment = { broadcast(collider.capsule.positionA), broadcast(collider.capsule.positionB) };
+						p = projectOutOfSphere(p, closestPoint_PointSegment(p, segment), collider.capsule.radius + collisionThickness);
+					} break;
+					case collider_type_cylinder:
+					{
+						p = projectOutOfCylinder(p, collider.cylinder, collisionThickness);
+					} break;
+					case collider_type_aabb:
+					{
+						p = projectOutOfBox(p, collider.aabb.minCorner - vec3(collisionThickness), collider.aabb.maxCorner + vec3(collisionThickness));
+					} break;
+					case collider_type_obb:
+					{
+						const bounding_oriented_box& obb = collider.obb;
+						cloth_quat rotation(cloth_float(obb.rotation.x), cloth_float(obb.rotation.y), cloth_float(obb.rotation.z), cloth_float(obb.rotation.w));
+						cloth_vec3 local = conjugate(rotation) * (p - broadcast(obb.center));
+						vec3 radius = obb.radius + vec3(collisionThickness);
+
+						// Only the offset is rotated back, so that particles outside of the box stay exactly where they are.
+						p += rotation * (projectOutOfBox(local, -radius, radius) - local);
+					} break;
+					default: break; // Hulls are not supported yet.
+				}
+			}
+
+			// Fixed and padding particles never move.
+			cloth_float invMass(invMasses.data() + i);
+			p = ifThen(invMass > zero, p, original);
+
+			p.x.store(positions.x.data() + i);
+			p.y.store(positions.y.data() + i);
+			p.z.store(positions.z.data() + i);
+		}
+	}
+
+	for (uint32 h = 0; h < context.numHeightmaps; ++h)
+	{
+		const heightmap_collider_component& heightmap = *context.heightmaps[h];
+		for (uint32 i = 0; i < numParticles; ++i)
+		{
+			if (invMasses[i] > 0.f)
 			{
-				float k = ((sqRestDistance - len) / (c.inverseMassSum * (sqRestDistance + len)));
-				positions[c.a] -= delta * (k * invMasses[c.a]);
-				positions[c.b] += delta * (k * invMasses[c.b]);
+				float minHeight = heightmap.getHeightAt(vec2(positions.x[i], positions.z[i])) + collisionThickness;
+				positions.y[i] = max(positions.y[i], minHeight);
 			}
 		}
 	}
 }
 
-void cloth_component::addConstraint(uint32 indexA, uint32 indexB)
+void cloth_component::addConstraint(std::vector<cloth_constraint>& constraints, uint32 indexA, uint32 indexB)
 {
 	constraints.push_back(cloth_constraint
 		{ 
 			indexA, 
 			indexB, 
-			length(positions[indexA] - positions[indexB]),
+			length(positions.get(indexA) - positions.get(indexB)),
 			(invMasses[indexA] + invMasses[indexB]) / stiffness,
 		});
 }
 
+// Greedy coloring: Each constraint gets the lowest color, which is not yet used by one of its particles.
+// The grid connectivity is regular, so this ends up with a small, fixed number of colors (around a dozen).
+void cloth_component::colorConstraints(const std::vector<cloth_constraint>& constraints)
+{
+	uint32 numConstraints = (uint32)constraints.size();
+
+	std::vector<uint32> colorMaskPerParticle(numParticles, 0);
+	std::vector<uint8> colorPerConstraint(numConstraints);
+	uint32 numConstraintsPerColor[CLOTH_MAX_NUM_COLORS] = {};
+	uint32 numColors = 0;
+
+	for (uint32 i = 0; i < numConstraints; ++i)
+	{
+		const cloth_constraint& c = constraints[i];
+		uint32 color = indexOfLeastSignificantSetBit(~(colorMaskPerParticle[c.a] | colorMaskPerParticle[c.b]));
+		ASSERT(color < CLOTH_MAX_NUM_COLORS);
+
+		colorMaskPerParticle[c.a] |= (1u << color);
+		colorMaskPerParticle[c.b] |= (1u << color);
+		colorPerConstraint[i] = (uint8)color;
+		++numConstraintsPerColor[color];
+		numColors = max(numColors, color + 1);
+	}
+
+	colorOffsets.resize(numColors + 1);
+	colorOffsets[0] = 0;
+	for (uint32 color = 0; color < numColors; ++color)
+	{
+		colorOffsets[color + 1] = colorOffsets[color] + bucketize(numConstraintsPerColor[color], CLOTH_SIMD_WIDTH) * CLOTH_SIMD_WIDTH;
+	}
+
+	uint32 numPaddedConstraints = colorOffsets[numColors];
+
+	// Padding constraints connect the first padding particle with itself.
+	constraintA.assign(numPaddedConstraints, (int32)numParticles);
+	constraintB.assign(numPaddedConstraints, (int32)numParticles);
+	constraintRestDistance.assign(numPaddedConstraints, 0.f);
+	constraintInverseMassSum.assign(numPaddedConstraints, 0.f);
+
+	constraintGradients.resize(numPaddedConstraints);
+	constraintInverseScaledGradientSquared.resize(numPaddedConstraints, 0.f);
+
+	std::vector<uint32> writeOffsets(colorOffsets.begin(), colorOffsets.end() - 1);
+	for (uint32 i = 0; i < numConstraints; ++i)
+	{
+		const cloth_constraint& c = constraints[i];
+		uint32 index = writeOffsets[colorPerConstraint[i]]++;
+		constraintA[index] = (int32)c.a;
+		constraintB[index] = (int32)c.b;
+		constraintRestDistance[index] = c.restDistance;
+		constraintInverseMassSum[index] = c.inverseMassSum;
+	}
+}
+
 void cloth_component::recalculateProperties()
 {
-	uint32 numParticles = gridSizeX * gridSizeY;
 	float invMassPerParticle = numParticles / totalMass;
 	for (float& invMass : invMasses)
 	{
@@ -325,9 +727,9 @@ void cloth_component::recalculateProperties()
 
 	stiffness = clamp(stiffness, 0.01f, 1.f);
 	float invStiffness = 1.f / stiffness;
-	for (cloth_constraint& c : constraints)
+	for (uint32 i = 0; i < (uint32)constraintA.size(); ++i)
 	{
-		c.inverseMassSum = (invMasses[c.a] + invMasses[c.b]) * invStiffness;
+		constraintInverseMassSum[i] = (invMasses[constraintA[i]] + invMasses[constraintB[i]]) * invStiffness;
 	}
 }
 
@@ -342,7 +744,18 @@ NODISCARD std::tuple<dx_vertex_buffer_group_view, dx_vertex_buffer_group_view, d
 	uint32 numTriangles = (cloth.gridSizeX - 1) * (cloth.gridSizeY - 1) * 2;
 
 	auto [positionVertexBuffer, positionPtr] = dxContext.createDynamicVertexBuffer(sizeof(vec3), numVertices);
-	memcpy(positionPtr, cloth.positions.data(), numVertices * sizeof(vec3));
+	vec3* positions = (vec3*)positionPtr;
+	if (cloth.renderPositions.size() == numVertices)
+	{
+		memcpy(positions, cloth.renderPositions.data(), sizeof(vec3) * numVertices);
+	}
+	else
+	{
+		for (uint32 i = 0; i < numVertices; ++i)
+		{
+			positions[i] = cloth.positions.get(i);
+		}
+	}
 
 	dx_vertex_buffer_group_view vb = skinCloth(positionVertexBuffer, cloth.gridSizeX, cloth.gridSizeY);
 	submesh_info sm;
@@ -2,6 +2,19 @@
 
 #include "bounding_volumes.h"
 
+struct scene_query_context;
+struct heightmap_collider_component;
+struct physics_snapshot_writer;
+struct physics_snapshot_reader;
+
+// Colliders, against which the cloth particles are projected during the position iterations.
+struct cloth_collision_context
+{
+	const scene_query_context* colliders = 0;
+	const heightmap_collider_component* const* heightmaps = 0;
+	uint32 numHeightmaps = 0;
+};
+
 struct cloth_component
 {
 	cloth_component() {}
@@ -15,7 +28,17 @@ struct cloth_component
 
 	void setWorldPositionOfFixedVertices(const trs& transform, bool moveRigid = false);
 	void applyWindForce(vec3 force);
-	void simulate(uint32 velocityIterations, uint32 positionIterations, uint32 driftIterations, float dt);
+	void simulate(uint32 velocityIterations, uint32 positionIterations, uint32 driftIterations, float dt, const cloth_collision_context* collisionContext = 0);
+
+	NODISCARD uint32 getNumParticles() const { return numParticles; }
+
+	// Particle state for physics snapshots (see snapshot.h). The snapshot must have been written by a cloth with the same number of particles.
+	void writeSnapshot(physics_snapshot_writer& writer) const;
+	NODISCARD bool readSnapshot(physics_snapshot_reader& reader);
+
+	// Copies the particle positions to the buffer read by the renderer. Called by the physics step on the main thread, so that rendering never
+	// reads particles, which an asynchronous step is currently simulating.
+	void publishRenderPositions();
 
 	float totalMass;
 	float gravityFactor;
@@ -25,12 +48,24 @@ struct cloth_component
 	uint32 gridSizeX, gridSizeY;
 	float width, height;
 
+	float collisionThickness = 0.02f; // Minimum distance between particles and colliders.
+
 private:
 	float oldTotalMass;
 	float oldStiffness;
 
 	void recalculateProperties();
 
+	// Particle data is stored as structure of arrays, so that the solver can process multiple particles or constraints at once.
+	struct cloth_particle_array
+	{
+		std::vector<float> x, y, z;
+
+		void resize(uint32 count) { x.resize(count, 0.f); y.resize(count, 0.f); z.resize(count, 0.f); }
+		NODISCARD vec3 get(uint32 i) const { return vec3(x[i], y[i], z[i]); }
+		void set(uint32 i, vec3 v) { x[i] = v.x; y[i] = v.y; z[i] = v.z; }
+	};
+
 	struct cloth_constraint
 	{
 		uint32 a, b;
@@ -38,19 +73,44 @@ private:
 		float inverseMassSum;
 	};
 
-	std::vector<vec3> positions;
-	std::vector<vec3> prevPositions;
-	std::vector<vec3> velocities;
-	std::vector<vec3> forceAccumulators;
+	// The particle arrays are padded to a multiple of the SIMD width. Padding particles have zero inverse mass and never move.
+	// The first padding particle serves as the end point of the padding constraints.
+	uint32 numParticles;
+	uint32 numPaddedParticles;
+
+	cloth_particle_array positions;
+	cloth_particle_array prevPositions;
+	cloth_particle_array velocities;
+	cloth_particle_array forceAccumulators;
 	std::vector<float> invMasses;
-	std::vector<cloth_constraint> constraints;
 
-	void solveVelocities(const std::vector<struct cloth_constraint_temp>& constraintsTemp);
+	std::vector<vec3> renderPositions; // numParticles. Written by publishRenderPositions.
+
+	// Constraints sorted by color. Constraints of one color share no particles, so they can be solved simultaneously.
+	// Each color is padded to a multiple of the SIMD width.
+	std::vector<int32> constraintA;
+	std::vector<int32> constraintB;
+	std::vector<float> constraintRestDistance;
+	std::vector<float> constraintInverseMassSum;
+	std::vector<uint32> colorOffsets; // Number of colors + 1.
+
+	// Temporaries of the velocity solver.
+	cloth_particle_array constraintGradients;
+	std::vector<float> constraintInverseScaledGradientSquared;
+
+	// Indices of the world space colliders near the cloth. Gathered once per step.
+	std::vector<uint32> collisionColliderIndices;
+
+	void solveVelocities();
 	void solvePositions();
 
+	void gatherCollisionShapes(const cloth_collision_context& context);
+	void projectParticlesOutOfColliders(const cloth_collision_context& context);
+
 	NODISCARD vec3 getParticlePosition(float relX, float relY);
 
-	void addConstraint(uint32 a, uint32 b);
+	void addConstraint(std::vector<cloth_constraint>& constraints, uint32 a, uint32 b);
+	void colorConstraints(const std::vector<cloth_constraint>& constraints);
 
 	friend struct cloth_render_component;
 };
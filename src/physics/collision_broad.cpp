@@ -3,6 +3,7 @@
 #include "scene/scene.h"
 #include "physics.h"
 #include "core/cpu_profiling.h"
+#include "snapshot.h"
 
 #include "bounding_volumes_simd.h"
 
@@ -84,6 +85,58 @@ void clearBroadphase(escene& scene)
 	}
 }
 
+void writeBroadphaseSnapshot(escene& scene, physics_snapshot_writer& writer)
+{
+	sap_context& context = scene.createOrGetContextVariable<sap_context>();
+	writer.write(context.sortingAxis);
+	writer.writeArray(context.endpoints.data(), (uint32)context.endpoints.size());
+}
+
+bool readBroadphaseSnapshot(escene& scene, physics_snapshot_reader& reader)
+{
+	sap_context& context = scene.createOrGetContextVariable<sap_context>();
+
+	uint32 sortingAxis, numEndpoints;
+	if (!reader.read(sortingAxis))
+	{
+		return false;
+	}
+	const sap_endpoint* endpoints = reader.readArray<sap_endpoint>(numEndpoints);
+	if (!endpoints || numEndpoints != (uint32)context.endpoints.size())
+	{
+		return false;
+	}
+
+	// The endpoints must belong to the same colliders. Only their order may differ.
+	for (uint32 i = 0; i < numEndpoints; ++i)
+	{
+		if (!scene.registry.valid(endpoints[i].entity) || !scene.registry.any_of<sap_endpoint_indirection_component>(endpoints[i].entity))
+		{
+			return false;
+		}
+	}
+
+	context.sortingAxis = sortingAxis;
+	memcpy(context.endpoints.data(), endpoints, sizeof(sap_endpoint) * numEndpoints);
+
+	for (uint32 i = 0; i < numEndpoints; ++i)
+	{
+		const sap_endpoint& ep = endpoints[i];
+		sap_endpoint_indirection_component& in = scene.registry.get<sap_endpoint_indirection_component>(ep.entity);
+
+		if (ep.start)
+		{
+			in.startEndpoint = i;
+		}
+		else
+		{
+			in.endEndpoint = i;
+		}
+	}
+
+	return true;
+}
+
 static uint32 determineOverlapsScalar(const sap_endpoint* endpoints, uint32 numEndpoints, const bounding_box* worldSpaceAABBs, uint32 numColliders, eallocator& arena,
 	collider_pair* outCollisions)
 {
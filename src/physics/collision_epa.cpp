@@ -224,4 +224,48 @@ bool epa_simplex::addNewPointAndUpdate(const gjk_support_point& newPoint)
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+void epa_simplex::initialize(const gjk_simplex& gjkSimplex)
+{
+	ASSERT(gjkSimplex.numPoints == 4);
+
+	numTriangles = 0;
+	numPoints = 0;
+	numEdges = 0;
+	memset(activeTrianglesMask, 0, sizeof(activeTrianglesMask));
+
+	pushPoint(gjkSimplex.a);
+	pushPoint(gjkSimplex.b);
+	pushPoint(gjkSimplex.c);
+	pushPoint(gjkSimplex.d);
+
+	pushTriangle(0, 1, 3, 4, 3, 0, getTriangleInfo(gjkSimplex.a, gjkSimplex.b, gjkSimplex.d));
+	pushTriangle(1, 2, 3, 5, 4, 1, getTriangleInfo(gjkSimplex.b, gjkSimplex.c, gjkSimplex.d));
+	pushTriangle(2, 0, 3, 3, 5, 2, getTriangleInfo(gjkSimplex.c, gjkSimplex.a, gjkSimplex.d));
+	pushTriangle(0, 2, 1, 1, 0, 2, getTriangleInfo(gjkSimplex.a, gjkSimplex.c, gjkSimplex.b));
+
+	pushEdge(0, 1, 0, 3);
+	pushEdge(1, 2, 1, 3);
+	pushEdge(2, 0, 2, 3);
+	pushEdge(0, 3, 2, 0);
+	pushEdge(1, 3, 0, 1);
+	pushEdge(2, 3, 1, 2);
+}
+
+void epa_simplex::getResult(uint32 triangleIndex, epa_result& outResult)
+{
+	epa_triangle& tri = triangles[triangleIndex];
+
+	gjk_support_point& a = points[tri.a];
+	gjk_support_point& b = points[tri.b];
+	gjk_support_point& c = points[tri.c];
+
+	vec3 barycentricCoords = getBarycentricCoordinates(a.minkowski, b.minkowski, c.minkowski, tri.normal * tri.distanceToOrigin);
+	vec3 pointA = barycentricCoords.x * a.shapeAPoint + barycentricCoords.y * b.shapeAPoint + barycentricCoords.z * c.shapeAPoint;
+	vec3 pointB = barycentricCoords.x * a.shapeBPoint + barycentricCoords.y * b.shapeBPoint + barycentricCoords.z * c.shapeBPoint;
+
+	outResult.point = 0.5f * (pointA + pointB);
+	outResult.normal = tri.normal;
+	outResult.penetrationDepth = tri.distanceToOrigin;
+}
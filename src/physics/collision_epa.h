@@ -41,6 +41,13 @@ struct epa_triangle_info
 	float distanceToOrigin;
 };
 
+struct epa_result
+{
+	vec3 point;
+	vec3 normal;
+	float penetrationDepth;
+};
+
 struct epa_simplex
 {
 	// TODO: Find better array sizes.
@@ -62,14 +69,10 @@ struct epa_simplex
 	uint32 findTriangleClosestToOrigin();
 	bool addNewPointAndUpdate(const gjk_support_point& newPoint);
 
-	static epa_triangle_info getTriangleInfo(const gjk_support_point& a, const gjk_support_point& b, const gjk_support_point& c);
-};
+	void initialize(const gjk_simplex& gjkSimplex); // Builds the initial polytope from the tetrahedron found by the GJK.
+	void getResult(uint32 triangleIndex, epa_result& outResult);
 
-struct epa_result
-{
-	vec3 point;
-	vec3 normal;
-	float penetrationDepth;
+	static epa_triangle_info getTriangleInfo(const gjk_support_point& a, const gjk_support_point& b, const gjk_support_point& c);
 };
 
 enum epa_status
@@ -96,27 +99,7 @@ NODISCARD static epa_status epaCollisionInfo(const gjk_simplex& gjkSimplex, cons
 	ASSERT(gjkSimplex.numPoints == 4);
 
 	epa_simplex epaSimplex;
-	epaSimplex.numTriangles = 0;
-	epaSimplex.numPoints = 0;
-	epaSimplex.numEdges = 0;
-	memset(epaSimplex.activeTrianglesMask, 0, sizeof(epaSimplex.activeTrianglesMask));
-
-	epaSimplex.pushPoint(gjkSimplex.a);
-	epaSimplex.pushPoint(gjkSimplex.b);
-	epaSimplex.pushPoint(gjkSimplex.c);
-	epaSimplex.pushPoint(gjkSimplex.d);
-
-	epaSimplex.pushTriangle(0, 1, 3, 4, 3, 0, epa_simplex::getTriangleInfo(gjkSimplex.a, gjkSimplex.b, gjkSimplex.d));
-	epaSimplex.pushTriangle(1, 2, 3, 5, 4, 1, epa_simplex::getTriangleInfo(gjkSimplex.b, gjkSimplex.c, gjkSimplex.d));
-	epaSimplex.pushTriangle(2, 0, 3, 3, 5, 2, epa_simplex::getTriangleInfo(gjkSimplex.c, gjkSimplex.a, gjkSimplex.d));
-	epaSimplex.pushTriangle(0, 2, 1, 1, 0, 2, epa_simplex::getTriangleInfo(gjkSimplex.a, gjkSimplex.c, gjkSimplex.b));
-
-	epaSimplex.pushEdge(0, 1, 0, 3);
-	epaSimplex.pushEdge(1, 2, 1, 3);
-	epaSimplex.pushEdge(2, 0, 2, 3);
-	epaSimplex.pushEdge(0, 3, 2, 0);
-	epaSimplex.pushEdge(1, 3, 0, 1);
-	epaSimplex.pushEdge(2, 3, 1, 2);
+	epaSimplex.initialize(gjkSimplex);
 
 	uint32 closestIndex = 0;
 
@@ -145,18 +128,6 @@ NODISCARD static epa_status epaCollisionInfo(const gjk_simplex& gjkSimplex, cons
 		}
 	}
 
-	epa_triangle& tri = epaSimplex.triangles[closestIndex];
-
-	gjk_support_point& a = epaSimplex.points[tri.a];
-	gjk_support_point& b = epaSimplex.points[tri.b];
-	gjk_support_point& c = epaSimplex.points[tri.c];
-
-	vec3 barycentricCoords = getBarycentricCoordinates(a.minkowski, b.minkowski, c.minkowski, tri.normal * tri.distanceToOrigin);
-	vec3 pointA = barycentricCoords.x * a.shapeAPoint + barycentricCoords.y * b.shapeAPoint + barycentricCoords.z * c.shapeAPoint;
-	vec3 pointB = barycentricCoords.x * a.shapeBPoint + barycentricCoords.y * b.shapeBPoint + barycentricCoords.z * c.shapeBPoint;
-
-	outResult.point = 0.5f * (pointA + pointB);
-	outResult.normal = tri.normal;
-	outResult.penetrationDepth = tri.distanceToOrigin;
+	epaSimplex.getResult(closestIndex, outResult);
 	return returnCode;
 }
\ No newline at end of file
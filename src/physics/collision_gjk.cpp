@@ -1,6 +1,99 @@
 #include "pch.h"
 #include "collision_gjk.h"
 
+#if defined(SIMD_AVX_2)
+typedef w8_float hull_support_float;
+#else
+typedef w4_float hull_support_float;
+#endif
+
+static uint32 getHullSupportVertexIndexSIMD(const bounding_hull_geometry& geometry, vec3 localDir)
+{
+	constexpr uint32 width = sizeof(hull_support_float) / sizeof(float);
+
+	hull_support_float dirX(localDir.x);
+	hull_support_float dirY(localDir.y);
+	hull_support_float dirZ(localDir.z);
+
+	float laneIndices[width];
+	for (uint32 i = 0; i < width; ++i)
+	{
+		laneIndices[i] = (float)i;
+	}
+
+	hull_support_float index(laneIndices);
+	hull_support_float bestIndex = index;
+	hull_support_float bestDistance(-FLT_MAX);
+
+	// The SoA arrays are padded to a multiple of 8 with copies of the first vertex, so there is no remainder loop.
+	uint32 numPaddedVertices = (uint32)geometry.vertexX.size();
+	for (uint32 i = 0; i < numPaddedVertices; i += width)
+	{
+		hull_support_float distance = hull_support_float(&geometry.vertexX[i]) * dirX
+			+ hull_support_float(&geometry.vertexY[i]) * dirY
+			+ hull_support_float(&geometry.vertexZ[i]) * dirZ;
+
+		auto better = distance > bestDistance;
+		bestDistance = ifThen(better, distance, bestDistance);
+		bestIndex = ifThen(better, index, bestIndex);
+		index += hull_support_float((float)width);
+	}
+
+	float distances[width];
+	float indices[width];
+	bestDistance.store(distances);
+	bestIndex.store(indices);
+
+	uint32 best = 0;
+	for (uint32 i = 1; i < width; ++i)
+	{
+		if (distances[i] > distances[best])
+		{
+			best = i;
+		}
+	}
+
+	return (uint32)indices[best];
+}
+
+vec3 getHullSupportVertex(const bounding_hull_geometry& geometry, vec3 localDir, uint32& inOutVertexIndex)
+{
+	uint32 numVertices = (uint32)geometry.vertices.size();
+
+	if (!geometry.vertexX.empty())
+	{
+		inOutVertexIndex = getHullSupportVertexIndexSIMD(geometry, localDir);
+		return geometry.vertices[inOutVertexIndex];
+	}
+
+	uint32 current = (inOutVertexIndex < numVertices) ? inOutVertexIndex : 0;
+	float currentDistance = dot(localDir, geometry.vertices[current]);
+
+	// On a convex hull, a vertex without a better neighbor is the global maximum.
+	bool improved = true;
+	while (improved)
+	{
+		improved = false;
+
+		uint32 begin = geometry.adjacencyOffsets[current];
+		uint32 end = geometry.adjacencyOffsets[current + 1];
+		for (uint32 i = begin; i < end; ++i)
+		{
+			uint32 neighbor = geometry.adjacency[i];
+			float distance = dot(localDir, geometry.vertices[neighbor]);
+			if (distance > currentDistance)
+			{
+				currentDistance = distance;
+				current = neighbor;
+				improved = true;
+			}
+		}
+	}
+
+	inOutVertexIndex = current;
+	return geometry.vertices[current];
+}
+
 gjk_internal_success updateGJKSimplex(gjk_simplex& s, const gjk_support_point& a, vec3& dir)
 {
 	if (s.numPoints == 2)
@@ -205,4 +298,177 @@ gjk_internal_success updateGJKSimplex(gjk_simplex& s, const gjk_support_point& a
 	//ASSERT(false);
 	std::cerr << "GJK ERROR 2\n";
 	return gjk_unexpected_error;
-}
\ No newline at end of file
+}
+
+static vec3 closestPointOnSegmentToOrigin(vec3 a, vec3 b, float* outBarycentricCoords)
+{
+	vec3 ab = b - a;
+	float sqLength = squaredLength(ab);
+	float t = (sqLength > 0.f) ? clamp(-dot(a, ab) / sqLength, 0.f, 1.f) : 0.f;
+
+	outBarycentricCoords[0] = 1.f - t;
+	outBarycentricCoords[1] = t;
+	return a + t * ab;
+}
+
+// Real-Time Collision Detection, 5.1.5, with the query point at the origin.
+static vec3 closestPointOnTriangleToOrigin(vec3 a, vec3 b, vec3 c, float* outBarycentricCoords)
+{
+	vec3 ab = b - a;
+	vec3 ac = c - a;
+
+	float d1 = -dot(ab, a);
+	float d2 = -dot(ac, a);
+	if (d1 <= 0.f && d2 <= 0.f)
+	{
+		outBarycentricCoords[0] = 1.f; outBarycentricCoords[1] = 0.f; outBarycentricCoords[2] = 0.f;
+		return a;
+	}
+
+	float d3 = -dot(ab, b);
+	float d4 = -dot(ac, b);
+	if (d3 >= 0.f && d4 <= d3)
+	{
+		outBarycentricCoords[0] = 0.f; outBarycentricCoords[1] = 1.f; outBarycentricCoords[2] = 0.f;
+		return b;
+	}
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+	{
+		float v = d1 / (d1 - d3);
+		outBarycentricCoords[0] = 1.f - v; outBarycentricCoords[1] = v; outBarycentricCoords[2] = 0.f;
+		return a + v * ab;
+	}
+
+	float d5 = -dot(ab, c);
+	float d6 = -dot(ac, c);
+	if (d6 >= 0.f && d5 <= d6)
+	{
+		outBarycentricCoords[0] = 0.f; outBarycentricCoords[1] = 0.f; outBarycentricCoords[2] = 1.f;
+		return c;
+	}
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+	{
+		float w = d2 / (d2 - d6);
+		outBarycentricCoords[0] = 1.f - w; outBarycentricCoords[1] = 0.f; outBarycentricCoords[2] = w;
+		return a + w * ac;
+	}
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+	{
+		float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		outBarycentricCoords[0] = 0.f; outBarycentricCoords[1] = 1.f - w; outBarycentricCoords[2] = w;
+		return b + w * (c - b);
+	}
+
+	float sum = va + vb + vc;
+	if (sum <= 0.f)
+	{
+		// Degenerate triangle.
+		outBarycentricCoords[2] = 0.f;
+		return closestPointOnSegmentToOrigin(a, b, outBarycentricCoords);
+	}
+
+	float denom = 1.f / sum;
+	float v = vb * denom;
+	float w = vc * denom;
+	outBarycentricCoords[0] = 1.f - v - w; outBarycentricCoords[1] = v; outBarycentricCoords[2] = w;
+	return a + ab * v + ac * w;
+}
+
+vec3 gjkClosestPointToOrigin(const vec3* points, uint32 numPoints, float* outBarycentricCoords)
+{
+	ASSERT(numPoints >= 1 && numPoints <= 4);
+
+	if (numPoints == 1)
+	{
+		outBarycentricCoords[0] = 1.f;
+		return points[0];
+	}
+	if (numPoints == 2)
+	{
+		return closestPointOnSegmentToOrigin(points[0], points[1], outBarycentricCoords);
+	}
+	if (numPoints == 3)
+	{
+		return closestPointOnTriangleToOrigin(points[0], points[1], points[2], outBarycentricCoords);
+	}
+
+	const vec3& a = points[0];
+	const vec3& b = points[1];
+	const vec3& c = points[2];
+	const vec3& d = points[3];
+
+	// Each face, given by three points, together with the point opposite to it.
+	static const uint32 faces[4][4] =
+	{
+		{ 0, 1, 2, 3 },
+		{ 0, 2, 3, 1 },
+		{ 0, 3, 1, 2 },
+		{ 1, 3, 2, 0 },
+	};
+
+	float minSqDistance = FLT_MAX;
+	vec3 result(0.f);
+	bool outsideOfAnyFace = false;
+
+	for (uint32 i = 0; i < 4; ++i)
+	{
+		const vec3& p0 = points[faces[i][0]];
+		const vec3& p1 = points[faces[i][1]];
+		const vec3& p2 = points[faces[i][2]];
+		const vec3& opposite = points[faces[i][3]];
+
+		vec3 n = cross(p1 - p0, p2 - p0);
+		float signOrigin = -dot(p0, n);
+		float signOpposite = dot(opposite - p0, n);
+
+		// Degenerate tetrahedra are treated as if the origin was outside of all faces.
+		bool outside = (signOrigin * signOpposite < 0.f) || (fabsf(signOpposite) < 1e-9f);
+		if (!outside)
+		{
+			continue;
+		}
+
+		outsideOfAnyFace = true;
+
+		float faceCoords[3];
+		vec3 q = closestPointOnTriangleToOrigin(p0, p1, p2, faceCoords);
+		float sqDistance = squaredLength(q);
+		if (sqDistance < minSqDistance)
+		{
+			minSqDistance = sqDistance;
+			result = q;
+
+			outBarycentricCoords[faces[i][0]] = faceCoords[0];
+			outBarycentricCoords[faces[i][1]] = faceCoords[1];
+			outBarycentricCoords[faces[i][2]] = faceCoords[2];
+			outBarycentricCoords[faces[i][3]] = 0.f;
+		}
+	}
+
+	if (!outsideOfAnyFace)
+	{
+		// Origin is inside the tetrahedron.
+		vec3 ab = b - a;
+		vec3 ac = c - a;
+		vec3 ad = d - a;
+		float volume = dot(ab, cross(ac, ad));
+
+		float wb = dot(-a, cross(ac, ad)) / volume;
+		float wc = dot(ab, cross(-a, ad)) / volume;
+		float wd = dot(ab, cross(ac, -a)) / volume;
+
+		outBarycentricCoords[0] = 1.f - wb - wc - wd;
+		outBarycentricCoords[1] = wb;
+		outBarycentricCoords[2] = wc;
+		outBarycentricCoords[3] = wd;
+		return vec3(0.f);
+	}
+
+	return result;
+}
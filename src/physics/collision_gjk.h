@@ -73,51 +73,40 @@ struct obb_support_fn
 	}
 };
 
+// Returns the vertex farthest along the direction. Both are in the local space of the hull.
+// Small hulls are searched with SIMD brute force. Larger hulls hill climb over the vertex adjacency, starting at inOutVertexIndex, which receives the index of the result.
+// Consecutive queries with similar directions, as in GJK and EPA, then only walk a few vertices.
+vec3 getHullSupportVertex(const bounding_hull_geometry& geometry, vec3 localDir, uint32& inOutVertexIndex);
+
 struct hull_support_fn
 {
 	const bounding_hull& h;
+	mutable uint32 lastVertex = 0; // Start of the next hill climb. One support function is created per collider pair, so this caches the result per pair.
 
 	vec3 operator()(vec3 dir) const
 	{
 		dir = conjugate(h.rotation) * dir;
-		vec3 result;
-
-		float maxDist = -FLT_MAX;
-
-		for (const vec3& v : h.geometryPtr->vertices)
-		{
-			float d = dot(dir, v);
-			if (d > maxDist)
-			{
-				maxDist = d;
-				result = v;
-			}
-		}
-
+		vec3 result = getHullSupportVertex(*h.geometryPtr, dir, lastVertex);
 		return h.position + h.rotation * result;
 	};
 };
 
-union extruded_triangle_support_fn
+struct extruded_triangle_support_fn
 {
-	struct
-	{
-		vec3 a, b, c;
-		vec3 d, e, f;
-	};
+	// Triangle a, b, c followed by its copy extruded downwards.
 	vec3 points[6];
 
 	extruded_triangle_support_fn(vec3 a, vec3 b, vec3 c, float extrusion = 10.f)
-		: a(a), b(b), c(c),
-		d(a.x, a.y - extrusion, a.z),
-		e(b.x, b.y - extrusion, b.z),
-		f(c.x, c.y - extrusion, c.z)
+		: points{ a, b, c,
+		vec3(a.x, a.y - extrusion, a.z),
+		vec3(b.x, b.y - extrusion, b.z),
+		vec3(c.x, c.y - extrusion, c.z) }
 	{}
 
 	vec3 operator()(vec3 dir) const
 	{
-		float maxD = dot(a, dir);
-		vec3 result = a;
+		float maxD = dot(points[0], dir);
+		vec3 result = points[0];
 
 		for (uint32 i = 1; i < 6; ++i)
 		{
@@ -221,4 +210,109 @@ NODISCARD static bool gjkIntersectionTest(const shapeA_t& shapeA, const shapeB_t
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+// Returns the point closest to the origin on the simplex spanned by 1 to 4 points, and its barycentric coordinates. Used by gjkRaycast.
+vec3 gjkClosestPointToOrigin(const vec3* points, uint32 numPoints, float* outBarycentricCoords);
+
+struct gjk_raycast_result
+{
+	vec3 point;		// Contact point on shape B.
+	vec3 normal;	// Surface normal of shape B at the contact point. Points against the cast direction.
+	float distance;	// Distance shape A travels along the cast direction until it touches shape B.
+};
+
+// Casts shape A along the normalized direction against the static shape B. Returns true, if the shapes touch before maxDistance is reached.
+// If the shapes already overlap initially, the distance is 0 and the normal is the negative cast direction.
+// This is the GJK based ray cast by van den Bergen ("Ray Casting against General Convex Objects with Application to Continuous Collision Detection").
+// Shape A is translated by t * direction. It touches B, when -t * direction lies on the boundary of the Minkowski difference A - B, so we cast a ray from 
+// the origin in direction -direction against the Minkowski difference and advance conservatively towards the hit.
+template <typename shapeA_t, typename shapeB_t>
+NODISCARD static bool gjkRaycast(const shapeA_t& shapeA, const shapeB_t& shapeB, vec3 direction, float maxDistance, gjk_raycast_result& outResult, uint32 maxNumIterations = 32)
+{
+	const float epsilon = 1e-4f;
+
+	vec3 rayDirection = -direction;
+	float t = 0.f;
+	vec3 x(0.f);
+	vec3 normal(0.f);
+
+	gjk_support_point simplex[4];
+	vec3 points[4];
+	float barycentricCoords[4];
+	uint32 numPoints = 0;
+
+	gjk_support_point initial = support(shapeA, shapeB, direction); // Arbitrary point in the Minkowski difference.
+	vec3 v = x - initial.minkowski;
+
+	for (uint32 iteration = 0; iteration < maxNumIterations && squaredLength(v) > epsilon * epsilon; ++iteration)
+	{
+		gjk_support_point p = support(shapeA, shapeB, v);
+		vec3 w = x - p.minkowski;
+
+		float vDotW = dot(v, w);
+		if (vDotW > 0.f)
+		{
+			float vDotR = dot(v, rayDirection);
+			if (vDotR >= 0.f)
+			{
+				return false;
+			}
+
+			t -= vDotW / vDotR;
+			if (t > maxDistance)
+			{
+				return false;
+			}
+
+			x = t * rayDirection;
+			normal = v;
+		}
+
+		simplex[numPoints++] = p;
+		for (uint32 i = 0; i < numPoints; ++i)
+		{
+			points[i] = x - simplex[i].minkowski;
+		}
+
+		v = gjkClosestPointToOrigin(points, numPoints, barycentricCoords);
+
+		// Remove points, which don't contribute to the closest point.
+		uint32 newNumPoints = 0;
+		for (uint32 i = 0; i < numPoints; ++i)
+		{
+			if (barycentricCoords[i] > 0.f)
+			{
+				simplex[newNumPoints] = simplex[i];
+				barycentricCoords[newNumPoints] = barycentricCoords[i];
+				++newNumPoints;
+			}
+		}
+		numPoints = newNumPoints;
+
+		if (numPoints == 4)
+		{
+			// x is enclosed by the simplex.
+			break;
+		}
+	}
+
+	// The iteration limit was hit before the ray converged. t is still a conservative lower bound, but there is no reliable hit.
+	bool converged = (numPoints == 4) || (squaredLength(v) <= epsilon * epsilon);
+	if (!converged)
+	{
+		outResult.distance = t;
+		return false;
+	}
+
+	vec3 pointB = (numPoints == 0) ? initial.shapeBPoint : vec3(0.f);
+	for (uint32 i = 0; i < numPoints; ++i)
+	{
+		pointB += barycentricCoords[i] * simplex[i].shapeBPoint;
+	}
+
+	outResult.point = pointB;
+	outResult.normal = (squaredLength(normal) > 0.f) ? -normalize(normal) : -direction;
+	outResult.distance = t;
+	return true;
+}
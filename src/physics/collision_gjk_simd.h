@@ -0,0 +1,333 @@
+#pragma once
+
+#include "collision_gjk.h"
+#include "collision_epa.h"
+#include "bounding_volumes_simd.h"
+
+// Lane-parallel GJK and EPA. N shape pairs run through the algorithms in lock-step, while a bit mask tracks which lanes are still active.
+// The support functions are evaluated for all lanes at once. The simplex and polytope updates branch heavily and run per active lane with the scalar code,
+// so a lane takes exactly the same path as it would in the scalar version.
+// Wide support functions receive the mask of active lanes, so that shapes with per-lane work (hulls) can skip finished lanes.
+
+template <typename simd_t>
+struct wN_sphere_support_fn
+{
+	const wN_bounding_sphere<simd_t>& s;
+
+	wN_vec3<simd_t> operator()(const wN_vec3<simd_t>& dir, uint32 laneMask) const
+	{
+		return normalize(dir) * s.radius + s.center;
+	}
+};
+
+template <typename simd_t>
+struct wN_capsule_support_fn
+{
+	const wN_bounding_capsule<simd_t>& c;
+
+	wN_vec3<simd_t> operator()(const wN_vec3<simd_t>& dir, uint32 laneMask) const
+	{
+		simd_t distA = dot(dir, c.positionA);
+		simd_t distB = dot(dir, c.positionB);
+		wN_vec3<simd_t> fartherPoint = ifThen(distA > distB, c.positionA, c.positionB);
+		return normalize(dir) * c.radius + fartherPoint;
+	}
+};
+
+template <typename simd_t>
+struct wN_cylinder_support_fn
+{
+	const wN_bounding_cylinder<simd_t>& c;
+
+	wN_vec3<simd_t> operator()(const wN_vec3<simd_t>& dir, uint32 laneMask) const
+	{
+		simd_t distA = dot(dir, c.positionA);
+		simd_t distB = dot(dir, c.positionB);
+		wN_vec3<simd_t> fartherPoint = ifThen(distA > distB, c.positionA, c.positionB);
+
+		wN_vec3<simd_t> n = c.positionA - c.positionB;
+
+		wN_vec3<simd_t> projectedDir = noz(cross(cross(n, dir), n));
+		return fartherPoint + projectedDir * c.radius;
+	}
+};
+
+template <typename simd_t>
+struct wN_aabb_support_fn
+{
+	const wN_bounding_box<simd_t>& b;
+
+	wN_vec3<simd_t> operator()(const wN_vec3<simd_t>& dir, uint32 laneMask) const
+	{
+		simd_t zero = simd_t::zero();
+		return wN_vec3<simd_t>(
+			ifThen(dir.x < zero, b.minCorner.x, b.maxCorner.x),
+			ifThen(dir.y < zero, b.minCorner.y, b.maxCorner.y),
+			ifThen(dir.z < zero, b.minCorner.z, b.maxCorner.z)
+		);
+	}
+};
+
+template <typename simd_t>
+struct wN_obb_support_fn
+{
+	const wN_bounding_oriented_box<simd_t>& b;
+
+	wN_vec3<simd_t> operator()(const wN_vec3<simd_t>& dir, uint32 laneMask) const
+	{
+		simd_t zero = simd_t::zero();
+		wN_vec3<simd_t> localDir = conjugate(b.rotation) * dir;
+		wN_vec3<simd_t> r(
+			ifThen(localDir.x < zero, -b.radius.x, b.radius.x),
+			ifThen(localDir.y < zero, -b.radius.y, b.radius.y),
+			ifThen(localDir.z < zero, -b.radius.z, b.radius.z)
+		);
+
+		return b.center + b.rotation * r;
+	}
+};
+
+template <typename simd_t>
+struct wN_hull_support_fn
+{
+	const wN_bounding_hull<simd_t>& h;
+	mutable uint32 lastVertex[simdWidth<simd_t>] = {}; // Start of the next hill climb per lane.
+
+	wN_vec3<simd_t> operator()(const wN_vec3<simd_t>& dir, uint32 laneMask) const
+	{
+		constexpr uint32 width = simdWidth<simd_t>;
+
+		// The transformation runs on all lanes. Only the vertex search is per lane, since every lane has its own geometry.
+		wN_vec3<simd_t> localDir = conjugate(h.rotation) * dir;
+
+		float dirX[width], dirY[width], dirZ[width];
+		localDir.store(dirX, dirY, dirZ);
+
+		float resultX[width] = {};
+		float resultY[width] = {};
+		float resultZ[width] = {};
+
+		for (uint32 k = 0; k < width; ++k)
+		{
+			if (laneMask & (1 << k))
+			{
+				vec3 v = getHullSupportVertex(*h.geometryPtrs[k], vec3(dirX[k], dirY[k], dirZ[k]), lastVertex[k]);
+				resultX[k] = v.x;
+				resultY[k] = v.y;
+				resultZ[k] = v.z;
+			}
+		}
+
+		wN_vec3<simd_t> result(simd_t(resultX), simd_t(resultY), simd_t(resultZ));
+		return h.position + h.rotation * result;
+	}
+};
+
+template <typename simd_t>
+struct wN_gjk_support_point
+{
+	wN_vec3<simd_t> shapeAPoint;
+	wN_vec3<simd_t> shapeBPoint;
+	wN_vec3<simd_t> minkowski;
+
+	// Transposes the lanes into simdWidth many scalar support points.
+	void getLanes(gjk_support_point* out)
+	{
+		constexpr uint32 width = simdWidth<simd_t>;
+
+		float aX[width], aY[width], aZ[width];
+		float bX[width], bY[width], bZ[width];
+		float mX[width], mY[width], mZ[width];
+
+		shapeAPoint.store(aX, aY, aZ);
+		shapeBPoint.store(bX, bY, bZ);
+		minkowski.store(mX, mY, mZ);
+
+		for (uint32 k = 0; k < width; ++k)
+		{
+			out[k].shapeAPoint = vec3(aX[k], aY[k], aZ[k]);
+			out[k].shapeBPoint = vec3(bX[k], bY[k], bZ[k]);
+			out[k].minkowski = vec3(mX[k], mY[k], mZ[k]);
+		}
+	}
+};
+
+template <typename shapeA_t, typename shapeB_t, typename simd_t>
+static wN_gjk_support_point<simd_t> support(const shapeA_t& a, const shapeB_t& b, const wN_vec3<simd_t>& dir, uint32 laneMask)
+{
+	wN_gjk_support_point<simd_t> result;
+	result.shapeAPoint = a(dir, laneMask);
+	result.shapeBPoint = b(-dir, laneMask);
+	result.minkowski = result.shapeAPoint - result.shapeBPoint;
+	return result;
+}
+
+// Runs the GJK intersection test for the lanes in laneMask and returns the mask of intersecting lanes.
+// For these, outSimplices (simdWidth many) contains the enclosing tetrahedron, which can be passed on to the EPA.
+// Unlike the scalar version the number of iterations is bounded, since one stuck lane would stall all others. Such lanes are reported as not intersecting.
+template <typename simd_t, typename shapeA_t, typename shapeB_t>
+NODISCARD static uint32 gjkIntersectionTestWide(const shapeA_t& shapeA, const shapeB_t& shapeB, uint32 laneMask, gjk_simplex* outSimplices, uint32 maxNumIterations = 64)
+{
+	gjk_internal_success updateGJKSimplex(gjk_simplex& s, const gjk_support_point& a, vec3& dir);
+
+	constexpr uint32 width = simdWidth<simd_t>;
+	simd_t zero = simd_t::zero();
+
+	wN_vec3<simd_t> dir(1.f, 0.1f, -0.2f); // Arbitrary.
+
+	// First point.
+	wN_gjk_support_point<simd_t> c = support(shapeA, shapeB, dir, laneMask);
+	uint32 active = laneMask & ~toBitMask(dot(c.minkowski, dir) < zero);
+
+	// Second point.
+	dir = -c.minkowski;
+	wN_gjk_support_point<simd_t> b = support(shapeA, shapeB, dir, active);
+	active &= ~toBitMask(dot(b.minkowski, dir) < zero);
+
+	wN_vec3<simd_t> cb = c.minkowski - b.minkowski;
+	dir = cross(cross(cb, -b.minkowski), cb);
+
+	gjk_support_point cLanes[width];
+	gjk_support_point bLanes[width];
+	c.getLanes(cLanes);
+	b.getLanes(bLanes);
+
+	// The search directions are kept per lane, since the simplex update writes them.
+	float dirX[width], dirY[width], dirZ[width];
+	dir.store(dirX, dirY, dirZ);
+
+	for (uint32 k = 0; k < width; ++k)
+	{
+		if (active & (1 << k))
+		{
+			outSimplices[k].c = cLanes[k];
+			outSimplices[k].b = bLanes[k];
+			outSimplices[k].numPoints = 2;
+		}
+	}
+
+	uint32 result = 0;
+
+	for (uint32 iteration = 0; iteration < maxNumIterations && active; ++iteration)
+	{
+		dir = wN_vec3<simd_t>(simd_t(dirX), simd_t(dirY), simd_t(dirZ));
+		active &= ~toBitMask(squaredLength(dir) < 0.0001f);
+
+		wN_gjk_support_point<simd_t> a = support(shapeA, shapeB, dir, active);
+		active &= ~toBitMask(dot(a.minkowski, dir) < zero);
+
+		gjk_support_point aLanes[width];
+		a.getLanes(aLanes);
+
+		for (uint32 k = 0; k < width; ++k)
+		{
+			uint32 bit = (1 << k);
+			if (!(active & bit))
+			{
+				continue;
+			}
+
+			vec3 laneDir(dirX[k], dirY[k], dirZ[k]);
+			gjk_internal_success success = updateGJKSimplex(outSimplices[k], aLanes[k], laneDir);
+			if (success == gjk_stop)
+			{
+				ASSERT(outSimplices[k].numPoints == 3);
+				outSimplices[k].a = aLanes[k];
+				outSimplices[k].numPoints = 4;
+				result |= bit;
+				active &= ~bit;
+			}
+			else if (success == gjk_unexpected_error)
+			{
+				active &= ~bit;
+			}
+			else
+			{
+				dirX[k] = laneDir.x;
+				dirY[k] = laneDir.y;
+				dirZ[k] = laneDir.z;
+			}
+		}
+	}
+
+	return result;
+}
+
+// Runs the EPA for the lanes in laneMask, which must have been reported as intersecting by gjkIntersectionTestWide.
+// epaScratch must point to simdWidth many simplices. They are too large to live on the stack.
+// Like the scalar version, outResults always receives the best approximation, regardless of the returned status.
+template <typename simd_t, typename shapeA_t, typename shapeB_t>
+static void epaCollisionInfoWide(const gjk_simplex* gjkSimplices, const shapeA_t& shapeA, const shapeB_t& shapeB, uint32 laneMask,
+	epa_simplex* epaScratch, epa_result* outResults, epa_status* outStatus, uint32 maxNumIterations = 20)
+{
+	constexpr uint32 width = simdWidth<simd_t>;
+
+	uint32 closestIndex[width] = {};
+	float normalX[width] = {};
+	float normalY[width] = {};
+	float normalZ[width] = {};
+	float distanceToOrigin[width] = {};
+
+	for (uint32 k = 0; k < width; ++k)
+	{
+		if (laneMask & (1 << k))
+		{
+			epaScratch[k].initialize(gjkSimplices[k]);
+			outStatus[k] = epa_max_num_iterations_reached;
+		}
+	}
+
+	uint32 active = laneMask;
+
+	for (uint32 iteration = 0; iteration < maxNumIterations && active; ++iteration)
+	{
+		for (uint32 k = 0; k < width; ++k)
+		{
+			if (active & (1 << k))
+			{
+				closestIndex[k] = epaScratch[k].findTriangleClosestToOrigin();
+				const epa_triangle& tri = epaScratch[k].triangles[closestIndex[k]];
+				normalX[k] = tri.normal.x;
+				normalY[k] = tri.normal.y;
+				normalZ[k] = tri.normal.z;
+				distanceToOrigin[k] = tri.distanceToOrigin;
+			}
+		}
+
+		wN_vec3<simd_t> normal(simd_t(normalX), simd_t(normalY), simd_t(normalZ));
+		wN_gjk_support_point<simd_t> a = support(shapeA, shapeB, normal, active);
+
+		uint32 converged = toBitMask(dot(a.minkowski, normal) - simd_t(distanceToOrigin) < 0.01f);
+
+		gjk_support_point aLanes[width];
+		a.getLanes(aLanes);
+
+		for (uint32 k = 0; k < width; ++k)
+		{
+			uint32 bit = (1 << k);
+			if (!(active & bit))
+			{
+				continue;
+			}
+
+			if (converged & bit)
+			{
+				outStatus[k] = epa_success;
+				active &= ~bit;
+			}
+			else if (!epaScratch[k].addNewPointAndUpdate(aLanes[k]))
+			{
+				outStatus[k] = epa_out_of_memory;
+				active &= ~bit;
+			}
+		}
+	}
+
+	for (uint32 k = 0; k < width; ++k)
+	{
+		if (laneMask & (1 << k))
+		{
+			epaScratch[k].getResult(closestIndex[k], outResults[k]);
+		}
+	}
+}
@@ -4,6 +4,7 @@
 #include "collision_broad.h"
 #include "collision_gjk.h"
 #include "collision_epa.h"
+#include "collision_gjk_simd.h"
 #include "collision_sat.h"
 #include "core/cpu_profiling.h"
 
@@ -31,7 +32,7 @@ typedef wN_bounding_capsule<w_float> w_bounding_capsule;
 typedef wN_bounding_cylinder<w_float> w_bounding_cylinder;
 typedef wN_bounding_box<w_float> w_bounding_box;
 typedef wN_bounding_oriented_box<w_float> w_bounding_oriented_box;
-typedef wN_line_segment<w_float> w_line_segment;
+typedef wN_bounding_hull<w_float> w_bounding_hull;
 
 struct contact_manifold
 {
@@ -104,7 +105,7 @@ static void findStableContactManifold(vertex_penetration_pair* vertices, uint32
 		outContact.contacts[2].penetrationDepth = vertices[resultIndex].penetrationDepth;
 		outContact.contacts[2].point = vertices[resultIndex].vertex;
 
-		// Find fourth point.
+		// Find fourth point, which adds the most area to the triangle. Points outside of the triangle produce a negative area with the edge they lie behind.
 		bestArea = 0.f;
 		resultIndex = 0;
 		for (uint32 i = 0; i < numVertices; ++i)
@@ -115,7 +116,7 @@ static void findStableContactManifold(vertex_penetration_pair* vertices, uint32
 			float area1 = 0.5f * dot(cross(qa, qb), normal);
 			float area2 = 0.5f * dot(cross(qb, qc), normal);
 			float area3 = 0.5f * dot(cross(qc, qa), normal);
-			float area = max(max(area1, area2), area3);
+			float area = -min(min(area1, area2), area3);
 			if (area > bestArea)
 			{
 				resultIndex = i;
@@ -1082,7 +1083,7 @@ static bool intersection(const bounding_box& a, const bounding_box& b, contact_m
 	uint32 minElement = (p.x < p.y) ? ((p.x < p.z) ? 0 : 2) : ((p.y < p.z) ? 1 : 2);
 
 	float s = d.data[minElement] < 0.f ? -1.f : 1.f;
-	float penetration = p.data[minElement] * s;
+	float penetration = p.data[minElement];
 	vec3 normal(0.f);
 	normal.data[minElement] = s;
 
@@ -1097,7 +1098,8 @@ static bool intersection(const bounding_box& a, const bounding_box& b, contact_m
 	float max0 = min(a.maxCorner.data[axis0], b.maxCorner.data[axis0]);
 	float max1 = min(a.maxCorner.data[axis1], b.maxCorner.data[axis1]);
 
-	float depth = centerA.data[minElement] + radiusA.data[minElement] - penetration * 0.5f;
+	// Middle of the overlap along the normal. The touching face of A depends on the side B is on.
+	float depth = centerA.data[minElement] + s * (radiusA.data[minElement] - penetration * 0.5f);
 
 	outContact.contacts[0].penetrationDepth = penetration;
 	outContact.contacts[0].point = vec3(0.f);
@@ -1168,15 +1170,13 @@ static bool intersection(const bounding_box& a, const bounding_hull& h, contact_
 }
 
 // OBB tests.
+static bool obbContactManifold(const bounding_oriented_box& a, const bounding_oriented_box& b, vec3 normal, bool faceCollision, bool bFace, contact_manifold& outContact);
+
 static bool intersection(const bounding_oriented_box& a, const bounding_oriented_box& b, contact_manifold& outContact)
 {
-	union obb_axes
+	struct obb_axes
 	{
-		struct
-		{
-			vec3 x, y, z;
-		};
-		vec3 u[3];
+		vec3 x, y, z;
 	};
 
 	obb_axes axesA = {
@@ -1424,7 +1424,13 @@ static bool intersection(const bounding_oriented_box& a, const bounding_oriented
 	}
 
 	// Normal is now in world space and points from a to b.
+	return obbContactManifold(a, b, normal, faceCollision, bFace, outContact);
+}
 
+// Builds the contact manifold of two intersecting OBBs from the separating axis with minimum penetration. Shared by the scalar and the SIMD test.
+// The world space normal must point from a to b. If faceCollision is false, the axis is an edge-edge axis. Otherwise bFace indicates, which box holds the reference face.
+static bool obbContactManifold(const bounding_oriented_box& a, const bounding_oriented_box& b, vec3 normal, bool faceCollision, bool bFace, contact_manifold& outContact)
+{
 	outContact.collisionNormal = normal;
 
 	if (faceCollision)
@@ -1752,6 +1758,22 @@ static w_bounding_oriented_box loadBoundingVolumeSIMD<w_bounding_oriented_box>(c
 	return result;
 }
 
+template <>
+static w_bounding_hull loadBoundingVolumeSIMD<w_bounding_hull>(const collider_union* worldSpaceColliders, uint16* indices)
+{
+	w_bounding_hull result;
+	w_float dummy;
+	load8(&worldSpaceColliders->hull.rotation.x, indices, sizeof(collider_union),
+		result.rotation.x, result.rotation.y, result.rotation.z, result.rotation.w,
+		result.position.x, result.position.y, result.position.z,
+		dummy);
+	for (uint32 i = 0; i < COLLISION_SIMD_WIDTH; ++i)
+	{
+		result.geometryPtrs[i] = worldSpaceColliders[indices[i]].hull.geometryPtr;
+	}
+	return result;
+}
+
 template <typename collider_t> static const collider_t& loadBoundingVolumeScalar(const collider_union* worldSpaceColliders, uint32 index) { /*static_assert(false);*/ }
 template <> static const bounding_sphere& loadBoundingVolumeScalar<bounding_sphere>(const collider_union* worldSpaceColliders, uint32 index) { return worldSpaceColliders[index].sphere; }
 template <> static const bounding_capsule& loadBoundingVolumeScalar<bounding_capsule>(const collider_union* worldSpaceColliders, uint32 index) { return worldSpaceColliders[index].capsule; }
@@ -2062,12 +2084,357 @@ static uint32 intersectionSIMD(const w_bounding_capsule& a, const w_bounding_cap
 
 
 
+// AABB tests.
+static uint32 intersectionSIMD(const w_bounding_box& a, const w_bounding_box& b, w_collision_contact* outContacts)
+{
+	// Same separating axis test as the scalar version, but with the axis selection done with blends instead of branches.
+
+	w_float zero = w_float::zero();
+	w_float half(0.5f);
+
+	w_vec3 centerA = (a.minCorner + a.maxCorner) * half;
+	w_vec3 centerB = (b.minCorner + b.maxCorner) * half;
+	w_vec3 radiusA = (a.maxCorner - a.minCorner) * half;
+	w_vec3 radiusB = (b.maxCorner - b.minCorner) * half;
+
+	w_vec3 d = centerB - centerA;
+	w_vec3 p = (radiusB + radiusA) - abs(d);
+
+	uint32 separated = toBitMask(p.x < zero) | toBitMask(p.y < zero) | toBitMask(p.z < zero);
+	uint32 mask = ~separated & ((1u << COLLISION_SIMD_WIDTH) - 1);
+
+	if (!mask)
+	{
+		return 0;
+	}
+
+	w_float minElement = ifThen(p.x < p.y, ifThen(p.x < p.z, zero, w_float(2.f)), ifThen(p.y < p.z, w_float(1.f), w_float(2.f)));
+	auto isX = (minElement == 0.f);
+	auto isY = (minElement == 1.f);
+	auto isZ = (minElement == 2.f);
+
+	w_float penetration = ifThen(isX, p.x, ifThen(isY, p.y, p.z));
+	w_float centerMin = ifThen(isX, centerA.x, ifThen(isY, centerA.y, centerA.z));
+	w_float radiusMin = ifThen(isX, radiusA.x, ifThen(isY, radiusA.y, radiusA.z));
+	w_float dMin = ifThen(isX, d.x, ifThen(isY, d.y, d.z));
+
+	w_float s = ifThen(dMin < zero, w_float(-1.f), w_float(1.f));
+	w_vec3 normal(ifThen(isX, s, zero), ifThen(isY, s, zero), ifThen(isZ, s, zero));
+
+	w_float depth = centerMin + s * (radiusMin - penetration * half);
+
+	// Overlap of the two boxes. The contacts are the corners of this region on the contact plane.
+	w_vec3 lo(maximum(a.minCorner.x, b.minCorner.x), maximum(a.minCorner.y, b.minCorner.y), maximum(a.minCorner.z, b.minCorner.z));
+	w_vec3 hi(minimum(a.maxCorner.x, b.maxCorner.x), minimum(a.maxCorner.y, b.maxCorner.y), minimum(a.maxCorner.z, b.maxCorner.z));
+
+	for (uint32 i = 0; i < 4; ++i)
+	{
+		// Same corner order as the scalar test. Axis 0 and 1 are the two axes following the normal axis.
+		w_vec3 end0 = (i & 2) ? hi : lo;
+		w_vec3 end1 = (i & 1) ? hi : lo;
+
+		outContacts[i].point = w_vec3(
+			ifThen(isX, depth, ifThen(isY, end1.x, end0.x)),
+			ifThen(isY, depth, ifThen(isX, end0.y, end1.y)),
+			ifThen(isZ, depth, ifThen(isX, end1.z, end0.z)));
+		outContacts[i].penetrationDepth = penetration;
+		outContacts[i].normal = normal;
+		outContacts[i].mask = mask;
+	}
+
+	return 4;
+}
+
+// OBB tests.
+static bounding_oriented_box getLane(const w_bounding_oriented_box& o, uint32 lane)
+{
+	return bounding_oriented_box{
+		quat(o.rotation.x[lane], o.rotation.y[lane], o.rotation.z[lane], o.rotation.w[lane]),
+		vec3(o.center.x[lane], o.center.y[lane], o.center.z[lane]),
+		vec3(o.radius.x[lane], o.radius.y[lane], o.radius.z[lane]),
+	};
+}
+
+static uint32 intersectionSIMD(const w_bounding_oriented_box& a, const w_bounding_oriented_box& b, w_collision_contact* outContacts)
+{
+	// The separating axis test runs on all lanes and mirrors the scalar test exactly, so that both paths select the same axis.
+	// Building the manifold involves a lot of branching (face clipping vs. edge-edge), so it runs per overlapping lane with the scalar code.
+
+	w_float zero = w_float::zero();
+	w_float one(1.f);
+
+	w_vec3 axesA[3] = {
+		a.rotation * w_vec3(1.f, 0.f, 0.f),
+		a.rotation * w_vec3(0.f, 1.f, 0.f),
+		a.rotation * w_vec3(0.f, 0.f, 1.f),
+	};
+
+	w_vec3 axesB[3] = {
+		b.rotation * w_vec3(1.f, 0.f, 0.f),
+		b.rotation * w_vec3(0.f, 1.f, 0.f),
+		b.rotation * w_vec3(0.f, 0.f, 1.f),
+	};
+
+	// r[i][j] = dot(a_i, b_j).
+	w_float r[3][3];
+	w_float absR[3][3];
+	w_float parallel = zero; // 1 for lanes with (nearly) parallel axes. These skip the edge tests.
+	uint32 parallelMask = 0;
+
+	for (uint32 i = 0; i < 3; ++i)
+	{
+		for (uint32 j = 0; j < 3; ++j)
+		{
+			r[i][j] = dot(axesA[i], axesB[j]);
+			absR[i][j] = abs(r[i][j]) + EPSILON;
+
+			auto isParallel = (absR[i][j] >= 0.99f);
+			parallelMask |= toBitMask(isParallel);
+			parallel = ifThen(isParallel, one, parallel);
+		}
+	}
+
+	w_vec3 tw = b.center - a.center;
+	w_vec3 tl = conjugate(a.rotation) * tw;
+
+	w_float t[3] = { tl.x, tl.y, tl.z };
+	w_float radiusA[3] = { a.radius.x, a.radius.y, a.radius.z };
+	w_float radiusB[3] = { b.radius.x, b.radius.y, b.radius.z };
+
+	uint32 separated = 0;
+
+	w_float minPenetration(FLT_MAX);
+	w_vec3 normal(0.f); // In a's local space.
+	w_float bFace = zero;
+	w_float edge = zero;
+
+	// Test a's faces.
+	for (uint32 i = 0; i < 3; ++i)
+	{
+		w_float ra = radiusA[i];
+		w_float rb = absR[i][0] * radiusB[0] + absR[i][1] * radiusB[1] + absR[i][2] * radiusB[2];
+		w_float penetration = ra + rb - abs(t[i]);
+		separated |= toBitMask(penetration < zero);
+
+		auto better = penetration < minPenetration;
+		minPenetration = ifThen(better, penetration, minPenetration);
+		normal = ifThen(better, w_vec3(i == 0 ? 1.f : 0.f, i == 1 ? 1.f : 0.f, i == 2 ? 1.f : 0.f), normal);
+	}
+
+	// Test b's faces. The normal is b's axis, expressed in a's local space.
+	for (uint32 j = 0; j < 3; ++j)
+	{
+		w_float ra = absR[0][j] * radiusA[0] + absR[1][j] * radiusA[1] + absR[2][j] * radiusA[2];
+		w_float rb = radiusB[j];
+		w_float d = r[0][j] * t[0] + r[1][j] * t[1] + r[2][j] * t[2];
+		w_float penetration = ra + rb - abs(d);
+		separated |= toBitMask(penetration < zero);
+
+		auto better = penetration < minPenetration;
+		minPenetration = ifThen(better, penetration, minPenetration);
+		normal = ifThen(better, w_vec3(r[0][j], r[1][j], r[2][j]), normal);
+		bFace = ifThen(better, one, bFace);
+	}
+
+	const uint32 allLanes = (1u << COLLISION_SIMD_WIDTH) - 1;
+
+	if ((separated & allLanes) == allLanes)
+	{
+		return 0;
+	}
+
+	// Test a_i x b_j.
+	if ((parallelMask & allLanes) != allLanes)
+	{
+		for (uint32 i = 0; i < 3; ++i)
+		{
+			uint32 i1 = (i + 1) % 3;
+			uint32 i2 = (i + 2) % 3;
+
+			for (uint32 j = 0; j < 3; ++j)
+			{
+				uint32 j1 = (j + 1) % 3;
+				uint32 j2 = (j + 2) % 3;
+
+				w_float ra = radiusA[i1] * absR[i2][j] + radiusA[i2] * absR[i1][j];
+				w_float rb = radiusB[j1] * absR[i][j2] + radiusB[j2] * absR[i][j1];
+				w_float penetration = ra + rb - abs(t[i2] * r[i1][j] - t[i1] * r[i2][j]);
+				separated |= toBitMask(penetration < zero) & ~parallelMask;
+
+				w_float n[3];
+				n[i] = zero;
+				n[i1] = -r[i2][j];
+				n[i2] = r[i1][j];
+				w_vec3 edgeNormal(n[0], n[1], n[2]);
+
+				w_float l = one / length(edgeNormal);
+				penetration = ifThen(parallel > zero, w_float(FLT_MAX), penetration * l);
+
+				auto better = penetration < minPenetration;
+				minPenetration = ifThen(better, penetration, minPenetration);
+				normal = ifThen(better, edgeNormal * l, normal);
+				edge = ifThen(better, one, edge);
+			}
+		}
+	}
+
+	uint32 overlapMask = ~separated & allLanes;
+	if (!overlapMask)
+	{
+		return 0;
+	}
+
+	normal = a.rotation * normal;
+	normal = ifThen(dot(normal, tw) < zero, -normal, normal);
+
+	// Build the manifolds per lane and transpose them back into wide contacts.
+	float pointX[4][COLLISION_SIMD_WIDTH] = {};
+	float pointY[4][COLLISION_SIMD_WIDTH] = {};
+	float pointZ[4][COLLISION_SIMD_WIDTH] = {};
+	float penetrationDepth[4][COLLISION_SIMD_WIDTH] = {};
+	uint32 contactMasks[4] = {};
+	uint32 numWideContacts = 0;
+
+	for (uint32 k = 0; k < COLLISION_SIMD_WIDTH; ++k)
+	{
+		if (!(overlapMask & (1 << k)))
+		{
+			continue;
+		}
+
+		bool faceCollision = (edge[k] == 0.f);
+		bool bFaceLane = (bFace[k] != 0.f);
+
+		contact_manifold contact;
+		if (obbContactManifold(getLane(a, k), getLane(b, k), vec3(normal.x[k], normal.y[k], normal.z[k]), faceCollision, bFaceLane, contact))
+		{
+			for (uint32 c = 0; c < contact.numContacts; ++c)
+			{
+				pointX[c][k] = contact.contacts[c].point.x;
+				pointY[c][k] = contact.contacts[c].point.y;
+				pointZ[c][k] = contact.contacts[c].point.z;
+				penetrationDepth[c][k] = contact.contacts[c].penetrationDepth;
+				contactMasks[c] |= (1 << k);
+			}
+			numWideContacts = max(numWideContacts, contact.numContacts);
+		}
+	}
+
+	for (uint32 c = 0; c < numWideContacts; ++c)
+	{
+		outContacts[c].point = w_vec3(w_float(pointX[c]), w_float(pointY[c]), w_float(pointZ[c]));
+		outContacts[c].penetrationDepth = w_float(penetrationDepth[c]);
+		outContacts[c].normal = normal;
+		outContacts[c].mask = contactMasks[c];
+	}
+
+	return numWideContacts;
+}
+
+static uint32 intersectionSIMD(const w_bounding_box& a, const w_bounding_oriented_box& b, w_collision_contact* outContacts)
+{
+	// Like the scalar version, forward to the general case OBB vs OBB.
+	w_float half(0.5f);
+	w_bounding_oriented_box o = { (a.minCorner + a.maxCorner) * half, (a.maxCorner - a.minCorner) * half, w_quat::identity() };
+	return intersectionSIMD(o, b, outContacts);
+}
+
+// Hull tests. These run through the batched GJK, and the penetrating lanes through the batched EPA. Same as the scalar tests, they generate a single contact.
+// Cylinder vs capsule, cylinder, AABB and OBB intentionally have no wide test. Their scalar tests build two-point manifolds for parallel axes and clip
+// cylinders lying on box faces. A single EPA contact per lane would lose these manifolds, and resting cylinders would rock.
+static epa_simplex* getEPAScratch()
+{
+	// The EPA simplices are too large for the stack.
+	static thread_local std::unique_ptr<epa_simplex[]> scratch;
+	if (!scratch)
+	{
+		scratch = std::make_unique<epa_simplex[]>(COLLISION_SIMD_WIDTH);
+	}
+	return scratch.get();
+}
+
+template <typename support_a_t, typename support_b_t>
+static uint32 intersectionGJKSIMD(const support_a_t& supportA, const support_b_t& supportB, w_collision_contact* outContacts)
+{
+	gjk_simplex gjkSimplices[COLLISION_SIMD_WIDTH];
+	uint32 mask = gjkIntersectionTestWide<w_float>(supportA, supportB, (1u << COLLISION_SIMD_WIDTH) - 1, gjkSimplices);
+
+	if (!mask)
+	{
+		return 0;
+	}
+
+	epa_result epa[COLLISION_SIMD_WIDTH];
+	epa_status epaStatus[COLLISION_SIMD_WIDTH];
+	epaCollisionInfoWide<w_float>(gjkSimplices, supportA, supportB, mask, getEPAScratch(), epa, epaStatus);
+
+	// Like in the scalar tests, the EPA result is used even if the EPA did not converge.
+	float pointX[COLLISION_SIMD_WIDTH] = {};
+	float pointY[COLLISION_SIMD_WIDTH] = {};
+	float pointZ[COLLISION_SIMD_WIDTH] = {};
+	float normalX[COLLISION_SIMD_WIDTH] = {};
+	float normalY[COLLISION_SIMD_WIDTH] = {};
+	float normalZ[COLLISION_SIMD_WIDTH] = {};
+	float penetrationDepth[COLLISION_SIMD_WIDTH] = {};
+
+	for (uint32 k = 0; k < COLLISION_SIMD_WIDTH; ++k)
+	{
+		if (mask & (1 << k))
+		{
+			pointX[k] = epa[k].point.x;
+			pointY[k] = epa[k].point.y;
+			pointZ[k] = epa[k].point.z;
+			normalX[k] = epa[k].normal.x;
+			normalY[k] = epa[k].normal.y;
+			normalZ[k] = epa[k].normal.z;
+			penetrationDepth[k] = epa[k].penetrationDepth;
+		}
+	}
+
+	outContacts[0].point = w_vec3(w_float(pointX), w_float(pointY), w_float(pointZ));
+	outContacts[0].penetrationDepth = w_float(penetrationDepth);
+	outContacts[0].normal = w_vec3(w_float(normalX), w_float(normalY), w_float(normalZ));
+	outContacts[0].mask = mask;
+
+	return 1;
+}
+
+static uint32 intersectionSIMD(const w_bounding_sphere& s, const w_bounding_hull& h, w_collision_contact* outContacts)
+{
+	return intersectionGJKSIMD(wN_sphere_support_fn<w_float>{ s }, wN_hull_support_fn<w_float>{ h }, outContacts);
+}
+
+static uint32 intersectionSIMD(const w_bounding_capsule& c, const w_bounding_hull& h, w_collision_contact* outContacts)
+{
+	return intersectionGJKSIMD(wN_capsule_support_fn<w_float>{ c }, wN_hull_support_fn<w_float>{ h }, outContacts);
+}
+
+static uint32 intersectionSIMD(const w_bounding_cylinder& c, const w_bounding_hull& h, w_collision_contact* outContacts)
+{
+	return intersectionGJKSIMD(wN_cylinder_support_fn<w_float>{ c }, wN_hull_support_fn<w_float>{ h }, outContacts);
+}
+
+static uint32 intersectionSIMD(const w_bounding_box& a, const w_bounding_hull& h, w_collision_contact* outContacts)
+{
+	return intersectionGJKSIMD(wN_aabb_support_fn<w_float>{ a }, wN_hull_support_fn<w_float>{ h }, outContacts);
+}
+
+static uint32 intersectionSIMD(const w_bounding_oriented_box& o, const w_bounding_hull& h, w_collision_contact* outContacts)
+{
+	return intersectionGJKSIMD(wN_obb_support_fn<w_float>{ o }, wN_hull_support_fn<w_float>{ h }, outContacts);
+}
+
+static uint32 intersectionSIMD(const w_bounding_hull& a, const w_bounding_hull& b, w_collision_contact* outContacts)
+{
+	return intersectionGJKSIMD(wN_hull_support_fn<w_float>{ a }, wN_hull_support_fn<w_float>{ b }, outContacts);
+}
+
 template <typename collider_a, typename collider_b, typename = void>
 struct simd_intersection_available : std::false_type {};
 
 template <typename collider_a, typename collider_b>
 struct simd_intersection_available<collider_a, collider_b,
-	std::void_t<decltype(intersectionSIMD(std::declval<const collider_a&>(), std::declval<const collider_b&>())) >> : std::true_type {};
+	std::void_t<decltype(intersectionSIMD(std::declval<const collider_a&>(), std::declval<const collider_b&>(), std::declval<w_collision_contact*>())) >> : std::true_type {};
 
 template <typename collider_t> struct scalar_to_wide { using type = void; };
 template <> struct scalar_to_wide<bounding_sphere> { using type = w_bounding_sphere; };
@@ -2075,6 +2442,7 @@ template <> struct scalar_to_wide<bounding_capsule> { using type = w_bounding_ca
 template <> struct scalar_to_wide<bounding_cylinder> { using type = w_bounding_cylinder; };
 template <> struct scalar_to_wide<bounding_box> { using type = w_bounding_box; };
 template <> struct scalar_to_wide<bounding_oriented_box> { using type = w_bounding_oriented_box; };
+template <> struct scalar_to_wide<bounding_hull> { using type = w_bounding_hull; };
 
 
 struct collision_write_context
@@ -2252,13 +2620,14 @@ static void collisionSIMD(const collider_union* worldSpaceColliders, collider_pa
 	{
 		uint32 numValidLanes = clamp(numColliderPairs - i, 0u, COLLISION_SIMD_WIDTH);
 
-		uint16 aIndices[COLLISION_SIMD_WIDTH] = {};
-		uint16 bIndices[COLLISION_SIMD_WIDTH] = {};
+		uint16 aIndices[COLLISION_SIMD_WIDTH];
+		uint16 bIndices[COLLISION_SIMD_WIDTH];
 
 		// TODO: This could be done with SIMD.
-		for (uint32 j = 0; j < numValidLanes; ++j)
+		// Unused lanes repeat the last valid pair, so that they always see colliders of the right type (hulls dereference their geometry).
+		for (uint32 j = 0; j < COLLISION_SIMD_WIDTH; ++j)
 		{
-			collider_pair pair = colliderPairs[i + j];
+			collider_pair pair = colliderPairs[i + min(j, numValidLanes - 1)];
 			aIndices[j] = pair.colliderA;
 			bIndices[j] = pair.colliderB;
 		}
@@ -25,4 +25,4 @@ NODISCARD narrowphase_result narrowphase(const collider_union* worldSpaceCollide
 	collision_contact* outContacts, constraint_body_pair* outBodyPairs, // result.numContacts many.
 	collider_pair* outColliderPairs, uint8* outContactCountPerCollision, // result.numCollisions many.
 	non_collision_interaction* outNonCollisionInteractions,			// result.numNonCollisionInteractions many.
-	bool simd);
\ No newline at end of file
+	bool simd);
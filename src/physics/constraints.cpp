@@ -4,6 +4,7 @@
 #include "collision_narrow.h"
 #include "core/cpu_profiling.h"
 #include "core/math_simd.h"
+#include "core/job_system.h"
 
 
 #define DISTANCE_CONSTRAINT_BETA 0.1f
@@ -16,6 +17,8 @@
 
 #define DT_THRESHOLD 1e-5f
 
+#define MIN_CONSTRAINT_BATCHES_PER_JOB 16
+
 #if CONSTRAINT_SIMD_WIDTH == 4
 typedef w4_float w_float;
 typedef w4_int w_int;
@@ -427,10 +430,10 @@ void solveDistanceVelocityConstraintsSIMD(simd_distance_constraint_solver constr
 		wB += impulseToAngularVelocityB * lambda;
 
 
-		store8(&rbs->invInertia.m22, batch.rbAIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbAIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			dummyA, invMassA, vA.x, vA.y, vA.z, wA.x, wA.y, wA.z);
 
-		store8(&rbs->invInertia.m22, batch.rbBIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbBIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			dummyB, invMassB, vB.x, vB.y, vB.z, wB.x, wB.y, wB.z);
 	}
 }
@@ -617,15 +620,15 @@ NODISCARD simd_ball_constraint_solver initializeBallVelocityConstraintsSIMD(eall
 		bias.y.store(batch.bias[1]);
 		bias.z.store(batch.bias[2]);
 
-		invEffectiveMass.m[0].store(batch.invEffectiveMass[0]);
-		invEffectiveMass.m[1].store(batch.invEffectiveMass[1]);
-		invEffectiveMass.m[2].store(batch.invEffectiveMass[2]);
-		invEffectiveMass.m[3].store(batch.invEffectiveMass[3]);
-		invEffectiveMass.m[4].store(batch.invEffectiveMass[4]);
-		invEffectiveMass.m[5].store(batch.invEffectiveMass[5]);
-		invEffectiveMass.m[6].store(batch.invEffectiveMass[6]);
-		invEffectiveMass.m[7].store(batch.invEffectiveMass[7]);
-		invEffectiveMass.m[8].store(batch.invEffectiveMass[8]);
+		invEffectiveMass.m00.store(batch.invEffectiveMass[0]);
+		invEffectiveMass.m10.store(batch.invEffectiveMass[1]);
+		invEffectiveMass.m20.store(batch.invEffectiveMass[2]);
+		invEffectiveMass.m01.store(batch.invEffectiveMass[3]);
+		invEffectiveMass.m11.store(batch.invEffectiveMass[4]);
+		invEffectiveMass.m21.store(batch.invEffectiveMass[5]);
+		invEffectiveMass.m02.store(batch.invEffectiveMass[6]);
+		invEffectiveMass.m12.store(batch.invEffectiveMass[7]);
+		invEffectiveMass.m22.store(batch.invEffectiveMass[8]);
 	}
 
 	simd_ball_constraint_solver result;
@@ -673,15 +676,15 @@ void solveBallVelocityConstraintsSIMD(simd_ball_constraint_solver constraints, r
 		w_vec3 relGlobalAnchorB(batch.relGlobalAnchorB[0], batch.relGlobalAnchorB[1], batch.relGlobalAnchorB[2]);
 		w_vec3 bias(batch.bias[0], batch.bias[1], batch.bias[2]);
 		w_mat3 invEffectiveMass;
-		invEffectiveMass.m[0] = w_float(batch.invEffectiveMass[0]);
-		invEffectiveMass.m[1] = w_float(batch.invEffectiveMass[1]);
-		invEffectiveMass.m[2] = w_float(batch.invEffectiveMass[2]);
-		invEffectiveMass.m[3] = w_float(batch.invEffectiveMass[3]);
-		invEffectiveMass.m[4] = w_float(batch.invEffectiveMass[4]);
-		invEffectiveMass.m[5] = w_float(batch.invEffectiveMass[5]);
-		invEffectiveMass.m[6] = w_float(batch.invEffectiveMass[6]);
-		invEffectiveMass.m[7] = w_float(batch.invEffectiveMass[7]);
-		invEffectiveMass.m[8] = w_float(batch.invEffectiveMass[8]);
+		invEffectiveMass.m00 = w_float(batch.invEffectiveMass[0]);
+		invEffectiveMass.m10 = w_float(batch.invEffectiveMass[1]);
+		invEffectiveMass.m20 = w_float(batch.invEffectiveMass[2]);
+		invEffectiveMass.m01 = w_float(batch.invEffectiveMass[3]);
+		invEffectiveMass.m11 = w_float(batch.invEffectiveMass[4]);
+		invEffectiveMass.m21 = w_float(batch.invEffectiveMass[5]);
+		invEffectiveMass.m02 = w_float(batch.invEffectiveMass[6]);
+		invEffectiveMass.m12 = w_float(batch.invEffectiveMass[7]);
+		invEffectiveMass.m22 = w_float(batch.invEffectiveMass[8]);
 
 		w_vec3 anchorVelocityA = vA + cross(wA, relGlobalAnchorA);
 		w_vec3 anchorVelocityB = vB + cross(wB, relGlobalAnchorB);
@@ -693,10 +696,10 @@ void solveBallVelocityConstraintsSIMD(simd_ball_constraint_solver constraints, r
 		vB += invMassB * P;
 		wB += invInertiaB * cross(relGlobalAnchorB, P);
 
-		store8(&rbs->invInertia.m22, batch.rbAIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbAIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			invInertiaA.m22, invMassA, vA.x, vA.y, vA.z, wA.x, wA.y, wA.z);
 
-		store8(&rbs->invInertia.m22, batch.rbBIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbBIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			invInertiaB.m22, invMassB, vB.x, vB.y, vB.z, wB.x, wB.y, wB.z);
 	}
 }
@@ -896,7 +899,7 @@ NODISCARD simd_fixed_constraint_solver initializeFixedVelocityConstraintsSIMD(ea
 			translationBias = (globalAnchorB - globalAnchorA) * (w_float(BALL_CONSTRAINT_BETA) * invDt);
 
 			w_quat rotationError = rotationB * initialInvRotationDifference * conjugate(rotationA);
-			rotationBias = rotationError.v * (SLIDER_CONSTRAINT_BETA * 2.f * invDt);
+			rotationBias = w_vec3(rotationError.x, rotationError.y, rotationError.z) * (SLIDER_CONSTRAINT_BETA * 2.f * invDt);
 		}
 
 		relGlobalAnchorA.x.store(batch.relGlobalAnchorA[0]);
@@ -907,29 +910,29 @@ NODISCARD simd_fixed_constraint_solver initializeFixedVelocityConstraintsSIMD(ea
 		relGlobalAnchorB.y.store(batch.relGlobalAnchorB[1]);
 		relGlobalAnchorB.z.store(batch.relGlobalAnchorB[2]);
 
-		invEffectiveTranslationMass.m[0].store(batch.invEffectiveTranslationMass[0]);
-		invEffectiveTranslationMass.m[1].store(batch.invEffectiveTranslationMass[1]);
-		invEffectiveTranslationMass.m[2].store(batch.invEffectiveTranslationMass[2]);
-		invEffectiveTranslationMass.m[3].store(batch.invEffectiveTranslationMass[3]);
-		invEffectiveTranslationMass.m[4].store(batch.invEffectiveTranslationMass[4]);
-		invEffectiveTranslationMass.m[5].store(batch.invEffectiveTranslationMass[5]);
-		invEffectiveTranslationMass.m[6].store(batch.invEffectiveTranslationMass[6]);
-		invEffectiveTranslationMass.m[7].store(batch.invEffectiveTranslationMass[7]);
-		invEffectiveTranslationMass.m[8].store(batch.invEffectiveTranslationMass[8]);
+		invEffectiveTranslationMass.m00.store(batch.invEffectiveTranslationMass[0]);
+		invEffectiveTranslationMass.m10.store(batch.invEffectiveTranslationMass[1]);
+		invEffectiveTranslationMass.m20.store(batch.invEffectiveTranslationMass[2]);
+		invEffectiveTranslationMass.m01.store(batch.invEffectiveTranslationMass[3]);
+		invEffectiveTranslationMass.m11.store(batch.invEffectiveTranslationMass[4]);
+		invEffectiveTranslationMass.m21.store(batch.invEffectiveTranslationMass[5]);
+		invEffectiveTranslationMass.m02.store(batch.invEffectiveTranslationMass[6]);
+		invEffectiveTranslationMass.m12.store(batch.invEffectiveTranslationMass[7]);
+		invEffectiveTranslationMass.m22.store(batch.invEffectiveTranslationMass[8]);
 
 		translationBias.x.store(batch.translationBias[0]);
 		translationBias.y.store(batch.translationBias[1]);
 		translationBias.z.store(batch.translationBias[2]);
 
-		invEffectiveRotationMass.m[0].store(batch.invEffectiveRotationMass[0]);
-		invEffectiveRotationMass.m[1].store(batch.invEffectiveRotationMass[1]);
-		invEffectiveRotationMass.m[2].store(batch.invEffectiveRotationMass[2]);
-		invEffectiveRotationMass.m[3].store(batch.invEffectiveRotationMass[3]);
-		invEffectiveRotationMass.m[4].store(batch.invEffectiveRotationMass[4]);
-		invEffectiveRotationMass.m[5].store(batch.invEffectiveRotationMass[5]);
-		invEffectiveRotationMass.m[6].store(batch.invEffectiveRotationMass[6]);
-		invEffectiveRotationMass.m[7].store(batch.invEffectiveRotationMass[7]);
-		invEffectiveRotationMass.m[8].store(batch.invEffectiveRotationMass[8]);
+		invEffectiveRotationMass.m00.store(batch.invEffectiveRotationMass[0]);
+		invEffectiveRotationMass.m10.store(batch.invEffectiveRotationMass[1]);
+		invEffectiveRotationMass.m20.store(batch.invEffectiveRotationMass[2]);
+		invEffectiveRotationMass.m01.store(batch.invEffectiveRotationMass[3]);
+		invEffectiveRotationMass.m11.store(batch.invEffectiveRotationMass[4]);
+		invEffectiveRotationMass.m21.store(batch.invEffectiveRotationMass[5]);
+		invEffectiveRotationMass.m02.store(batch.invEffectiveRotationMass[6]);
+		invEffectiveRotationMass.m12.store(batch.invEffectiveRotationMass[7]);
+		invEffectiveRotationMass.m22.store(batch.invEffectiveRotationMass[8]);
 
 		rotationBias.x.store(batch.rotationBias[0]);
 		rotationBias.y.store(batch.rotationBias[1]);
@@ -980,15 +983,15 @@ void solveFixedVelocityConstraintsSIMD(simd_fixed_constraint_solver constraints,
 		{
 			w_vec3 rotationBias(batch.rotationBias[0], batch.rotationBias[1], batch.rotationBias[2]);
 			w_mat3 invEffectiveRotationMass;
-			invEffectiveRotationMass.m[0] = w_float(batch.invEffectiveRotationMass[0]);
-			invEffectiveRotationMass.m[1] = w_float(batch.invEffectiveRotationMass[1]);
-			invEffectiveRotationMass.m[2] = w_float(batch.invEffectiveRotationMass[2]);
-			invEffectiveRotationMass.m[3] = w_float(batch.invEffectiveRotationMass[3]);
-			invEffectiveRotationMass.m[4] = w_float(batch.invEffectiveRotationMass[4]);
-			invEffectiveRotationMass.m[5] = w_float(batch.invEffectiveRotationMass[5]);
-			invEffectiveRotationMass.m[6] = w_float(batch.invEffectiveRotationMass[6]);
-			invEffectiveRotationMass.m[7] = w_float(batch.invEffectiveRotationMass[7]);
-			invEffectiveRotationMass.m[8] = w_float(batch.invEffectiveRotationMass[8]);
+			invEffectiveRotationMass.m00 = w_float(batch.invEffectiveRotationMass[0]);
+			invEffectiveRotationMass.m10 = w_float(batch.invEffectiveRotationMass[1]);
+			invEffectiveRotationMass.m20 = w_float(batch.invEffectiveRotationMass[2]);
+			invEffectiveRotationMass.m01 = w_float(batch.invEffectiveRotationMass[3]);
+			invEffectiveRotationMass.m11 = w_float(batch.invEffectiveRotationMass[4]);
+			invEffectiveRotationMass.m21 = w_float(batch.invEffectiveRotationMass[5]);
+			invEffectiveRotationMass.m02 = w_float(batch.invEffectiveRotationMass[6]);
+			invEffectiveRotationMass.m12 = w_float(batch.invEffectiveRotationMass[7]);
+			invEffectiveRotationMass.m22 = w_float(batch.invEffectiveRotationMass[8]);
 
 			w_vec3 Cdot = wB - wA;
 
@@ -1003,15 +1006,15 @@ void solveFixedVelocityConstraintsSIMD(simd_fixed_constraint_solver constraints,
 			w_vec3 relGlobalAnchorB(batch.relGlobalAnchorB[0], batch.relGlobalAnchorB[1], batch.relGlobalAnchorB[2]);
 			w_vec3 translationBias(batch.translationBias[0], batch.translationBias[1], batch.translationBias[2]);
 			w_mat3 invEffectiveTranslationMass;
-			invEffectiveTranslationMass.m[0] = w_float(batch.invEffectiveTranslationMass[0]);
-			invEffectiveTranslationMass.m[1] = w_float(batch.invEffectiveTranslationMass[1]);
-			invEffectiveTranslationMass.m[2] = w_float(batch.invEffectiveTranslationMass[2]);
-			invEffectiveTranslationMass.m[3] = w_float(batch.invEffectiveTranslationMass[3]);
-			invEffectiveTranslationMass.m[4] = w_float(batch.invEffectiveTranslationMass[4]);
-			invEffectiveTranslationMass.m[5] = w_float(batch.invEffectiveTranslationMass[5]);
-			invEffectiveTranslationMass.m[6] = w_float(batch.invEffectiveTranslationMass[6]);
-			invEffectiveTranslationMass.m[7] = w_float(batch.invEffectiveTranslationMass[7]);
-			invEffectiveTranslationMass.m[8] = w_float(batch.invEffectiveTranslationMass[8]);
+			invEffectiveTranslationMass.m00 = w_float(batch.invEffectiveTranslationMass[0]);
+			invEffectiveTranslationMass.m10 = w_float(batch.invEffectiveTranslationMass[1]);
+			invEffectiveTranslationMass.m20 = w_float(batch.invEffectiveTranslationMass[2]);
+			invEffectiveTranslationMass.m01 = w_float(batch.invEffectiveTranslationMass[3]);
+			invEffectiveTranslationMass.m11 = w_float(batch.invEffectiveTranslationMass[4]);
+			invEffectiveTranslationMass.m21 = w_float(batch.invEffectiveTranslationMass[5]);
+			invEffectiveTranslationMass.m02 = w_float(batch.invEffectiveTranslationMass[6]);
+			invEffectiveTranslationMass.m12 = w_float(batch.invEffectiveTranslationMass[7]);
+			invEffectiveTranslationMass.m22 = w_float(batch.invEffectiveTranslationMass[8]);
 
 
 			w_vec3 anchorVelocityA = vA + cross(wA, relGlobalAnchorA);
@@ -1025,10 +1028,10 @@ void solveFixedVelocityConstraintsSIMD(simd_fixed_constraint_solver constraints,
 			wB += invInertiaB * cross(relGlobalAnchorB, P);
 		}
 
-		store8(&rbs->invInertia.m22, batch.rbAIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbAIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			invInertiaA.m22, invMassA, vA.x, vA.y, vA.z, wA.x, wA.y, wA.z);
 
-		store8(&rbs->invInertia.m22, batch.rbBIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbBIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			invInertiaB.m22, invMassB, vB.x, vB.y, vB.z, wB.x, wB.y, wB.z);
 	}
 }
@@ -1380,15 +1383,15 @@ NODISCARD simd_hinge_constraint_solver initializeHingeVelocityConstraintsSIMD(ea
 		translationBias.y.store(batch.translationBias[1]);
 		translationBias.z.store(batch.translationBias[2]);
 
-		invEffectiveTranslationMass.m[0].store(batch.invEffectiveTranslationMass[0]);
-		invEffectiveTranslationMass.m[1].store(batch.invEffectiveTranslationMass[1]);
-		invEffectiveTranslationMass.m[2].store(batch.invEffectiveTranslationMass[2]);
-		invEffectiveTranslationMass.m[3].store(batch.invEffectiveTranslationMass[3]);
-		invEffectiveTranslationMass.m[4].store(batch.invEffectiveTranslationMass[4]);
-		invEffectiveTranslationMass.m[5].store(batch.invEffectiveTranslationMass[5]);
-		invEffectiveTranslationMass.m[6].store(batch.invEffectiveTranslationMass[6]);
-		invEffectiveTranslationMass.m[7].store(batch.invEffectiveTranslationMass[7]);
-		invEffectiveTranslationMass.m[8].store(batch.invEffectiveTranslationMass[8]);
+		invEffectiveTranslationMass.m00.store(batch.invEffectiveTranslationMass[0]);
+		invEffectiveTranslationMass.m10.store(batch.invEffectiveTranslationMass[1]);
+		invEffectiveTranslationMass.m20.store(batch.invEffectiveTranslationMass[2]);
+		invEffectiveTranslationMass.m01.store(batch.invEffectiveTranslationMass[3]);
+		invEffectiveTranslationMass.m11.store(batch.invEffectiveTranslationMass[4]);
+		invEffectiveTranslationMass.m21.store(batch.invEffectiveTranslationMass[5]);
+		invEffectiveTranslationMass.m02.store(batch.invEffectiveTranslationMass[6]);
+		invEffectiveTranslationMass.m12.store(batch.invEffectiveTranslationMass[7]);
+		invEffectiveTranslationMass.m22.store(batch.invEffectiveTranslationMass[8]);
 
 		// Rotation part
 		w_vec3 globalHingeAxisA = rotationA * localHingeAxisA;
@@ -1419,10 +1422,10 @@ NODISCARD simd_hinge_constraint_solver initializeHingeVelocityConstraintsSIMD(ea
 		rotationBias.x.store(batch.rotationBias[0]);
 		rotationBias.y.store(batch.rotationBias[1]);
 
-		invEffectiveRotationMass.m[0].store(batch.invEffectiveRotationMass[0]);
-		invEffectiveRotationMass.m[1].store(batch.invEffectiveRotationMass[1]);
-		invEffectiveRotationMass.m[2].store(batch.invEffectiveRotationMass[2]);
-		invEffectiveRotationMass.m[3].store(batch.invEffectiveRotationMass[3]);
+		invEffectiveRotationMass.m00.store(batch.invEffectiveRotationMass[0]);
+		invEffectiveRotationMass.m10.store(batch.invEffectiveRotationMass[1]);
+		invEffectiveRotationMass.m01.store(batch.invEffectiveRotationMass[2]);
+		invEffectiveRotationMass.m11.store(batch.invEffectiveRotationMass[3]);
 
 		bxa.x.store(batch.bxa[0]);
 		bxa.y.store(batch.bxa[1]);
@@ -1645,10 +1648,10 @@ void solveHingeVelocityConstraintsSIMD(simd_hinge_constraint_solver constraints,
 			w_vec3 cxa(batch.cxa[0], batch.cxa[1], batch.cxa[2]);
 			w_vec2 rotationBias(batch.rotationBias[0], batch.rotationBias[1]);
 			w_mat2 invEffectiveRotationMass;
-			invEffectiveRotationMass.m[0] = w_float(batch.invEffectiveRotationMass[0]);
-			invEffectiveRotationMass.m[1] = w_float(batch.invEffectiveRotationMass[1]);
-			invEffectiveRotationMass.m[2] = w_float(batch.invEffectiveRotationMass[2]);
-			invEffectiveRotationMass.m[3] = w_float(batch.invEffectiveRotationMass[3]);
+			invEffectiveRotationMass.m00 = w_float(batch.invEffectiveRotationMass[0]);
+			invEffectiveRotationMass.m10 = w_float(batch.invEffectiveRotationMass[1]);
+			invEffectiveRotationMass.m01 = w_float(batch.invEffectiveRotationMass[2]);
+			invEffectiveRotationMass.m11 = w_float(batch.invEffectiveRotationMass[3]);
 
 			w_vec3 deltaAngularVelocity = wB - wA;
 
@@ -1668,15 +1671,15 @@ void solveHingeVelocityConstraintsSIMD(simd_hinge_constraint_solver constraints,
 			w_vec3 translationBias(batch.translationBias[0], batch.translationBias[1], batch.translationBias[2]);
 
 			w_mat3 invEffectiveTranslationMass;
-			invEffectiveTranslationMass.m[0] = w_float(batch.invEffectiveTranslationMass[0]);
-			invEffectiveTranslationMass.m[1] = w_float(batch.invEffectiveTranslationMass[1]);
-			invEffectiveTranslationMass.m[2] = w_float(batch.invEffectiveTranslationMass[2]);
-			invEffectiveTranslationMass.m[3] = w_float(batch.invEffectiveTranslationMass[3]);
-			invEffectiveTranslationMass.m[4] = w_float(batch.invEffectiveTranslationMass[4]);
-			invEffectiveTranslationMass.m[5] = w_float(batch.invEffectiveTranslationMass[5]);
-			invEffectiveTranslationMass.m[6] = w_float(batch.invEffectiveTranslationMass[6]);
-			invEffectiveTranslationMass.m[7] = w_float(batch.invEffectiveTranslationMass[7]);
-			invEffectiveTranslationMass.m[8] = w_float(batch.invEffectiveTranslationMass[8]);
+			invEffectiveTranslationMass.m00 = w_float(batch.invEffectiveTranslationMass[0]);
+			invEffectiveTranslationMass.m10 = w_float(batch.invEffectiveTranslationMass[1]);
+			invEffectiveTranslationMass.m20 = w_float(batch.invEffectiveTranslationMass[2]);
+			invEffectiveTranslationMass.m01 = w_float(batch.invEffectiveTranslationMass[3]);
+			invEffectiveTranslationMass.m11 = w_float(batch.invEffectiveTranslationMass[4]);
+			invEffectiveTranslationMass.m21 = w_float(batch.invEffectiveTranslationMass[5]);
+			invEffectiveTranslationMass.m02 = w_float(batch.invEffectiveTranslationMass[6]);
+			invEffectiveTranslationMass.m12 = w_float(batch.invEffectiveTranslationMass[7]);
+			invEffectiveTranslationMass.m22 = w_float(batch.invEffectiveTranslationMass[8]);
 
 			w_vec3 anchorVelocityA = vA + cross(wA, relGlobalAnchorA);
 			w_vec3 anchorVelocityB = vB + cross(wB, relGlobalAnchorB);
@@ -1690,10 +1693,10 @@ void solveHingeVelocityConstraintsSIMD(simd_hinge_constraint_solver constraints,
 			wB += invInertiaB * cross(relGlobalAnchorB, translationP);
 		}
 
-		store8(&rbs->invInertia.m22, batch.rbAIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbAIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			invInertiaA.m22, invMassA, vA.x, vA.y, vA.z, wA.x, wA.y, wA.z);
 
-		store8(&rbs->invInertia.m22, batch.rbBIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbBIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			invInertiaB.m22, invMassB, vB.x, vB.y, vB.z, wB.x, wB.y, wB.z);
 	}
 }
@@ -2134,15 +2137,15 @@ NODISCARD simd_cone_twist_constraint_solver initializeConeTwistVelocityConstrain
 		bias.y.store(batch.bias[1]);
 		bias.z.store(batch.bias[2]);
 
-		invEffectiveMass.m[0].store(batch.invEffectiveMass[0]);
-		invEffectiveMass.m[1].store(batch.invEffectiveMass[1]);
-		invEffectiveMass.m[2].store(batch.invEffectiveMass[2]);
-		invEffectiveMass.m[3].store(batch.invEffectiveMass[3]);
-		invEffectiveMass.m[4].store(batch.invEffectiveMass[4]);
-		invEffectiveMass.m[5].store(batch.invEffectiveMass[5]);
-		invEffectiveMass.m[6].store(batch.invEffectiveMass[6]);
-		invEffectiveMass.m[7].store(batch.invEffectiveMass[7]);
-		invEffectiveMass.m[8].store(batch.invEffectiveMass[8]);
+		invEffectiveMass.m00.store(batch.invEffectiveMass[0]);
+		invEffectiveMass.m10.store(batch.invEffectiveMass[1]);
+		invEffectiveMass.m20.store(batch.invEffectiveMass[2]);
+		invEffectiveMass.m01.store(batch.invEffectiveMass[3]);
+		invEffectiveMass.m11.store(batch.invEffectiveMass[4]);
+		invEffectiveMass.m21.store(batch.invEffectiveMass[5]);
+		invEffectiveMass.m02.store(batch.invEffectiveMass[6]);
+		invEffectiveMass.m12.store(batch.invEffectiveMass[7]);
+		invEffectiveMass.m22.store(batch.invEffectiveMass[8]);
 
 		// Limits and motors
 		w_quat btoa = conjugate(rotationA) * rotationB;
@@ -2491,15 +2494,15 @@ void solveConeTwistVelocityConstraintsSIMD(simd_cone_twist_constraint_solver con
 			w_vec3 bias(batch.bias[0], batch.bias[1], batch.bias[2]);
 
 			w_mat3 invEffectiveMass;
-			invEffectiveMass.m[0] = w_float(batch.invEffectiveMass[0]);
-			invEffectiveMass.m[1] = w_float(batch.invEffectiveMass[1]);
-			invEffectiveMass.m[2] = w_float(batch.invEffectiveMass[2]);
-			invEffectiveMass.m[3] = w_float(batch.invEffectiveMass[3]);
-			invEffectiveMass.m[4] = w_float(batch.invEffectiveMass[4]);
-			invEffectiveMass.m[5] = w_float(batch.invEffectiveMass[5]);
-			invEffectiveMass.m[6] = w_float(batch.invEffectiveMass[6]);
-			invEffectiveMass.m[7] = w_float(batch.invEffectiveMass[7]);
-			invEffectiveMass.m[8] = w_float(batch.invEffectiveMass[8]);
+			invEffectiveMass.m00 = w_float(batch.invEffectiveMass[0]);
+			invEffectiveMass.m10 = w_float(batch.invEffectiveMass[1]);
+			invEffectiveMass.m20 = w_float(batch.invEffectiveMass[2]);
+			invEffectiveMass.m01 = w_float(batch.invEffectiveMass[3]);
+			invEffectiveMass.m11 = w_float(batch.invEffectiveMass[4]);
+			invEffectiveMass.m21 = w_float(batch.invEffectiveMass[5]);
+			invEffectiveMass.m02 = w_float(batch.invEffectiveMass[6]);
+			invEffectiveMass.m12 = w_float(batch.invEffectiveMass[7]);
+			invEffectiveMass.m22 = w_float(batch.invEffectiveMass[8]);
 
 			w_vec3 anchorVelocityA = vA + cross(wA, relGlobalAnchorA);
 			w_vec3 anchorVelocityB = vB + cross(wB, relGlobalAnchorB);
@@ -2513,10 +2516,10 @@ void solveConeTwistVelocityConstraintsSIMD(simd_cone_twist_constraint_solver con
 			wB += invInertiaB * cross(relGlobalAnchorB, translationP);
 		}
 
-		store8(&rbs->invInertia.m22, batch.rbAIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbAIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			invInertiaA.m22, invMassA, vA.x, vA.y, vA.z, wA.x, wA.y, wA.z);
 
-		store8(&rbs->invInertia.m22, batch.rbBIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbBIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			invInertiaB.m22, invMassB, vB.x, vB.y, vB.z, wB.x, wB.y, wB.z);
 	}
 }
@@ -2859,7 +2862,7 @@ NODISCARD simd_slider_constraint_solver initializeSliderVelocityConstraintsSIMD(
 			translationBias = w_vec2(a, b) * (SLIDER_CONSTRAINT_BETA * invDt);
 
 			w_quat rotationError = rotationB * initialInvRotationDifference * conjugate(rotationA);
-			rotationBias = rotationError.v * (SLIDER_CONSTRAINT_BETA * 2.f * invDt);
+			rotationBias = w_vec3(rotationError.x, rotationError.y, rotationError.z) * (SLIDER_CONSTRAINT_BETA * 2.f * invDt);
 		}
 
 		rAuxt.x.store(batch.rAuxt[0]);
@@ -2886,23 +2889,23 @@ NODISCARD simd_slider_constraint_solver initializeSliderVelocityConstraintsSIMD(
 		bitangent.y.store(batch.bitangent[1]);
 		bitangent.z.store(batch.bitangent[2]);
 
-		invEffectiveTranslationMass.m[0].store(batch.invEffectiveTranslationMass[0]);
-		invEffectiveTranslationMass.m[1].store(batch.invEffectiveTranslationMass[1]);
-		invEffectiveTranslationMass.m[2].store(batch.invEffectiveTranslationMass[2]);
-		invEffectiveTranslationMass.m[3].store(batch.invEffectiveTranslationMass[3]);
+		invEffectiveTranslationMass.m00.store(batch.invEffectiveTranslationMass[0]);
+		invEffectiveTranslationMass.m10.store(batch.invEffectiveTranslationMass[1]);
+		invEffectiveTranslationMass.m01.store(batch.invEffectiveTranslationMass[2]);
+		invEffectiveTranslationMass.m11.store(batch.invEffectiveTranslationMass[3]);
 
 		translationBias.x.store(batch.translationBias[0]);
 		translationBias.y.store(batch.translationBias[1]);
 
-		invEffectiveRotationMass.m[0].store(batch.invEffectiveRotationMass[0]);
-		invEffectiveRotationMass.m[1].store(batch.invEffectiveRotationMass[1]);
-		invEffectiveRotationMass.m[2].store(batch.invEffectiveRotationMass[2]);
-		invEffectiveRotationMass.m[3].store(batch.invEffectiveRotationMass[3]);
-		invEffectiveRotationMass.m[4].store(batch.invEffectiveRotationMass[4]);
-		invEffectiveRotationMass.m[5].store(batch.invEffectiveRotationMass[5]);
-		invEffectiveRotationMass.m[6].store(batch.invEffectiveRotationMass[6]);
-		invEffectiveRotationMass.m[7].store(batch.invEffectiveRotationMass[7]);
-		invEffectiveRotationMass.m[8].store(batch.invEffectiveRotationMass[8]);
+		invEffectiveRotationMass.m00.store(batch.invEffectiveRotationMass[0]);
+		invEffectiveRotationMass.m10.store(batch.invEffectiveRotationMass[1]);
+		invEffectiveRotationMass.m20.store(batch.invEffectiveRotationMass[2]);
+		invEffectiveRotationMass.m01.store(batch.invEffectiveRotationMass[3]);
+		invEffectiveRotationMass.m11.store(batch.invEffectiveRotationMass[4]);
+		invEffectiveRotationMass.m21.store(batch.invEffectiveRotationMass[5]);
+		invEffectiveRotationMass.m02.store(batch.invEffectiveRotationMass[6]);
+		invEffectiveRotationMass.m12.store(batch.invEffectiveRotationMass[7]);
+		invEffectiveRotationMass.m22.store(batch.invEffectiveRotationMass[8]);
 
 		rotationBias.x.store(batch.rotationBias[0]);
 		rotationBias.y.store(batch.rotationBias[1]);
@@ -3112,15 +3115,15 @@ void solveSliderVelocityConstraintsSIMD(simd_slider_constraint_solver constraint
 		// Rotation part
 		{
 			w_mat3 invEffectiveRotationMass;
-			invEffectiveRotationMass.m[0] = w_float(batch.invEffectiveRotationMass[0]);
-			invEffectiveRotationMass.m[1] = w_float(batch.invEffectiveRotationMass[1]);
-			invEffectiveRotationMass.m[2] = w_float(batch.invEffectiveRotationMass[2]);
-			invEffectiveRotationMass.m[3] = w_float(batch.invEffectiveRotationMass[3]);
-			invEffectiveRotationMass.m[4] = w_float(batch.invEffectiveRotationMass[4]);
-			invEffectiveRotationMass.m[5] = w_float(batch.invEffectiveRotationMass[5]);
-			invEffectiveRotationMass.m[6] = w_float(batch.invEffectiveRotationMass[6]);
-			invEffectiveRotationMass.m[7] = w_float(batch.invEffectiveRotationMass[7]);
-			invEffectiveRotationMass.m[8] = w_float(batch.invEffectiveRotationMass[8]);
+			invEffectiveRotationMass.m00 = w_float(batch.invEffectiveRotationMass[0]);
+			invEffectiveRotationMass.m10 = w_float(batch.invEffectiveRotationMass[1]);
+			invEffectiveRotationMass.m20 = w_float(batch.invEffectiveRotationMass[2]);
+			invEffectiveRotationMass.m01 = w_float(batch.invEffectiveRotationMass[3]);
+			invEffectiveRotationMass.m11 = w_float(batch.invEffectiveRotationMass[4]);
+			invEffectiveRotationMass.m21 = w_float(batch.invEffectiveRotationMass[5]);
+			invEffectiveRotationMass.m02 = w_float(batch.invEffectiveRotationMass[6]);
+			invEffectiveRotationMass.m12 = w_float(batch.invEffectiveRotationMass[7]);
+			invEffectiveRotationMass.m22 = w_float(batch.invEffectiveRotationMass[8]);
 
 			w_vec3 rotationBias(batch.rotationBias[0], batch.rotationBias[1], batch.rotationBias[2]);
 
@@ -3141,10 +3144,10 @@ void solveSliderVelocityConstraintsSIMD(simd_slider_constraint_solver constraint
 			w_vec3 rBxb(batch.rBxb[0], batch.rBxb[1], batch.rBxb[2]);
 
 			w_mat2 invEffectiveTranslationMass;
-			invEffectiveTranslationMass.m[0] = w_float(batch.invEffectiveTranslationMass[0]);
-			invEffectiveTranslationMass.m[1] = w_float(batch.invEffectiveTranslationMass[1]);
-			invEffectiveTranslationMass.m[2] = w_float(batch.invEffectiveTranslationMass[2]);
-			invEffectiveTranslationMass.m[3] = w_float(batch.invEffectiveTranslationMass[3]);
+			invEffectiveTranslationMass.m00 = w_float(batch.invEffectiveTranslationMass[0]);
+			invEffectiveTranslationMass.m10 = w_float(batch.invEffectiveTranslationMass[1]);
+			invEffectiveTranslationMass.m01 = w_float(batch.invEffectiveTranslationMass[2]);
+			invEffectiveTranslationMass.m11 = w_float(batch.invEffectiveTranslationMass[3]);
 
 			w_vec2 translationBias(batch.translationBias[0], batch.translationBias[1]);
 
@@ -3162,15 +3165,15 @@ void solveSliderVelocityConstraintsSIMD(simd_slider_constraint_solver constraint
 			wB += invInertiaB * (rBxt * translationLambda.x + rBxb * translationLambda.y);
 		}
 
-		store8(&rbs->invInertia.m22, batch.rbAIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbAIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			invInertiaA.m22, invMassA, vA.x, vA.y, vA.z, wA.x, wA.y, wA.z);
 
-		store8(&rbs->invInertia.m22, batch.rbBIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbBIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			invInertiaB.m22, invMassB, vB.x, vB.y, vB.z, wB.x, wB.y, wB.z);
 	}
 }
 
-NODISCARD collision_constraint_solver initializeCollisionVelocityConstraints(eallocator& arena, const rigid_body_global_state* rbs, const collision_contact* contacts, const constraint_body_pair* bodyPairs, uint32 numContacts, float dt)
+NODISCARD collision_constraint_solver initializeCollisionVelocityConstraints(eallocator& arena, const rigid_body_global_state* rbs, const collision_contact* contacts, const constraint_body_pair* bodyPairs, uint32 numContacts, const contact_impulse* cachedImpulses, float dt)
 {
 	CPU_PROFILE_BLOCK("Initialize collision constraints");
 
@@ -3200,6 +3203,23 @@ NODISCARD collision_constraint_solver initializeCollisionVelocityConstraints(eal
 		constraint.tangent = relVelocity - dot(contact.normal, relVelocity) * contact.normal;
 		constraint.tangent = noz(constraint.tangent);
 
+		if (cachedImpulses)
+		{
+			const contact_impulse& cached = cachedImpulses[contactID];
+
+			if (constraint.tangent == vec3(0.f))
+			{
+				// No sliding. Keep the friction direction of the last frame.
+				constraint.tangent = noz(cached.tangentImpulse - dot(contact.normal, cached.tangentImpulse) * contact.normal);
+			}
+
+			float friction = (float)(contact.friction_restitution >> 16) / (float)0xFFFF;
+			float maxFriction = friction * cached.normalImpulse;
+
+			constraint.impulseInNormalDir = cached.normalImpulse;
+			constraint.impulseInTangentDir = clamp(dot(cached.tangentImpulse, constraint.tangent), -maxFriction, maxFriction);
+		}
+
 		{ // Tangent direction
 			vec3 crAt = cross(constraint.relGlobalAnchorA, constraint.tangent);
 			vec3 crBt = cross(constraint.relGlobalAnchorB, constraint.tangent);
@@ -3229,6 +3249,11 @@ NODISCARD collision_constraint_solver initializeCollisionVelocityConstraints(eal
 					float restitution = (float)(contact.friction_restitution & 0xFFFF) / (float)0xFFFF;
 					constraint.bias = -restitution * vRel - 0.1f * (-contact.penetrationDepth - slop) * invDt;
 				}
+				else if (contact.penetrationDepth < 0.f)
+				{
+					// Speculative contact. The bodies may approach each other until they touch, but not further.
+					constraint.bias = contact.penetrationDepth * invDt;
+				}
 			}
 
 			constraint.normalImpulseToAngularVelocityA = rbA.invInertia * crAn;
@@ -3244,6 +3269,43 @@ NODISCARD collision_constraint_solver initializeCollisionVelocityConstraints(eal
 	return result;
 }
 
+void warmStartCollisionVelocityConstraints(collision_constraint_solver constraints, rigid_body_global_state* rbs)
+{
+	CPU_PROFILE_BLOCK("Warm start collision constraints");
+
+	for (uint32 i = 0; i < constraints.count; ++i)
+	{
+		const collision_contact& contact = constraints.contacts[i];
+		const collision_constraint& constraint = constraints.constraints[i];
+		constraint_body_pair pair = constraints.bodyPairs[i];
+
+		auto& rbA = rbs[pair.rbA];
+		auto& rbB = rbs[pair.rbB];
+
+		if (rbA.invMass == 0.f && rbB.invMass == 0.f)
+			continue;
+
+		vec3 P = constraint.impulseInNormalDir * contact.normal + constraint.impulseInTangentDir * constraint.tangent;
+
+		rbA.linearVelocity -= rbA.invMass * P;
+		rbA.angularVelocity -= constraint.normalImpulseToAngularVelocityA * constraint.impulseInNormalDir
+			+ constraint.tangentImpulseToAngularVelocityA * constraint.impulseInTangentDir;
+		rbB.linearVelocity += rbB.invMass * P;
+		rbB.angularVelocity += constraint.normalImpulseToAngularVelocityB * constraint.impulseInNormalDir
+			+ constraint.tangentImpulseToAngularVelocityB * constraint.impulseInTangentDir;
+	}
+}
+
+void getCollisionImpulses(collision_constraint_solver constraints, contact_impulse* outImpulses)
+{
+	for (uint32 i = 0; i < constraints.count; ++i)
+	{
+		const collision_constraint& constraint = constraints.constraints[i];
+		outImpulses[i].tangentImpulse = constraint.impulseInTangentDir * constraint.tangent;
+		outImpulses[i].normalImpulse = constraint.impulseInNormalDir;
+	}
+}
+
 void solveCollisionVelocityConstraints(collision_constraint_solver constraints, rigid_body_global_state* rbs)
 {
 	CPU_PROFILE_BLOCK("Solve collision constraints");
@@ -3312,7 +3374,7 @@ void solveCollisionVelocityConstraints(collision_constraint_solver constraints,
 	}
 }
 
-NODISCARD simd_collision_constraint_solver initializeCollisionVelocityConstraintsSIMD(eallocator& arena, const rigid_body_global_state* rbs, const collision_contact* contacts, const constraint_body_pair* bodyPairs, uint32 numContacts, uint16 dummyRigidBodyIndex, float dt)
+NODISCARD simd_collision_constraint_solver initializeCollisionVelocityConstraintsSIMD(eallocator& arena, const rigid_body_global_state* rbs, const collision_contact* contacts, const constraint_body_pair* bodyPairs, uint32 numContacts, const contact_impulse* cachedImpulses, uint16 dummyRigidBodyIndex, float dt)
 {
 	CPU_PROFILE_BLOCK("Initialize collision constraints SIMD");
 
@@ -3331,7 +3393,7 @@ NODISCARD simd_collision_constraint_solver initializeCollisionVelocityConstraint
 		const simd_constraint_slot& slot = contactSlots[i];
 		simd_collision_constraint_batch& batch = batches[i];
 
-		uint16 contactIndices[CONSTRAINT_SIMD_WIDTH];
+		uint16* contactIndices = batch.contactIndices;
 		for (uint32 j = 0; j < CONSTRAINT_SIMD_WIDTH; ++j)
 		{
 			contactIndices[j] = (uint16)slot.indices[j];
@@ -3393,6 +3455,25 @@ NODISCARD simd_collision_constraint_solver initializeCollisionVelocityConstraint
 		w_vec3 tangent = relVelocity - dot(normal, relVelocity) * normal;
 		tangent = noz(tangent);
 
+		w_float impulseInNormalDir = zero;
+		w_float impulseInTangentDir = zero;
+
+		if (cachedImpulses)
+		{
+			w_vec3 cachedTangentImpulse;
+			w_float cachedNormalImpulse;
+			load4((const float*)cachedImpulses, contactIndices, (uint32)sizeof(contact_impulse),
+				cachedTangentImpulse.x, cachedTangentImpulse.y, cachedTangentImpulse.z, cachedNormalImpulse);
+
+			// If there is no sliding, keep the friction direction of the last frame.
+			w_vec3 cachedTangent = noz(cachedTangentImpulse - dot(normal, cachedTangentImpulse) * normal);
+			tangent = ifThen(squaredLength(tangent) == zero, cachedTangent, tangent);
+
+			w_float maxFriction = friction * cachedNormalImpulse;
+			impulseInNormalDir = cachedNormalImpulse;
+			impulseInTangentDir = clamp(dot(cachedTangentImpulse, tangent), -maxFriction, maxFriction);
+		}
+
 		relGlobalAnchorA.x.store(batch.relGlobalAnchorA[0]);
 		relGlobalAnchorA.y.store(batch.relGlobalAnchorA[1]);
 		relGlobalAnchorA.z.store(batch.relGlobalAnchorA[2]);
@@ -3409,8 +3490,8 @@ NODISCARD simd_collision_constraint_solver initializeCollisionVelocityConstraint
 		tangent.y.store(batch.tangent[1]);
 		tangent.z.store(batch.tangent[2]);
 
-		zero.store(batch.impulseInNormalDir);
-		zero.store(batch.impulseInTangentDir);
+		impulseInNormalDir.store(batch.impulseInNormalDir);
+		impulseInTangentDir.store(batch.impulseInTangentDir);
 		friction.store(batch.friction);
 
 		{ // Tangent direction
@@ -3447,6 +3528,9 @@ NODISCARD simd_collision_constraint_solver initializeCollisionVelocityConstraint
 
 				w_float bounceBias = -restitution * vRel - scale * (-penetrationDepth - slop) * invDt;
 				bias = ifThen((-penetrationDepth < slop) & (vRel < zero), bounceBias, bias);
+
+				// Speculative contacts. The bodies may approach each other until they touch, but not further.
+				bias = ifThen(penetrationDepth < zero, penetrationDepth * invDt, bias);
 			}
 
 			effectiveMassInNormalDir.store(batch.effectiveMassInNormalDir);
@@ -3470,6 +3554,72 @@ NODISCARD simd_collision_constraint_solver initializeCollisionVelocityConstraint
 	return result;
 }
 
+void warmStartCollisionVelocityConstraintsSIMD(simd_collision_constraint_solver constraints, rigid_body_global_state* rbs)
+{
+	CPU_PROFILE_BLOCK("Warm start collision constraints SIMD");
+
+	for (uint32 i = 0; i < constraints.numBatches; ++i)
+	{
+		const simd_collision_constraint_batch& batch = constraints.batches[i];
+
+		// Load body A
+		w_vec3 vA, wA;
+		w_float invMassA;
+		w_float dummyA;
+
+		load8(&rbs->invInertia.m22, batch.rbAIndices, (uint32)sizeof(rigid_body_global_state),
+			dummyA, invMassA, vA.x, vA.y, vA.z, wA.x, wA.y, wA.z);
+
+		// Load body B
+		w_vec3 vB, wB;
+		w_float invMassB;
+		w_float dummyB;
+
+		load8(&rbs->invInertia.m22, batch.rbBIndices, (uint32)sizeof(rigid_body_global_state),
+			dummyB, invMassB, vB.x, vB.y, vB.z, wB.x, wB.y, wB.z);
+
+		// Load constraint
+		w_vec3 normal(batch.normal[0], batch.normal[1], batch.normal[2]);
+		w_vec3 tangent(batch.tangent[0], batch.tangent[1], batch.tangent[2]);
+		w_float impulseInNormalDir(batch.impulseInNormalDir);
+		w_float impulseInTangentDir(batch.impulseInTangentDir);
+
+		w_vec3 tangentImpulseToAngularVelocityA(batch.tangentImpulseToAngularVelocityA[0], batch.tangentImpulseToAngularVelocityA[1], batch.tangentImpulseToAngularVelocityA[2]);
+		w_vec3 tangentImpulseToAngularVelocityB(batch.tangentImpulseToAngularVelocityB[0], batch.tangentImpulseToAngularVelocityB[1], batch.tangentImpulseToAngularVelocityB[2]);
+		w_vec3 normalImpulseToAngularVelocityA(batch.normalImpulseToAngularVelocityA[0], batch.normalImpulseToAngularVelocityA[1], batch.normalImpulseToAngularVelocityA[2]);
+		w_vec3 normalImpulseToAngularVelocityB(batch.normalImpulseToAngularVelocityB[0], batch.normalImpulseToAngularVelocityB[1], batch.normalImpulseToAngularVelocityB[2]);
+
+		w_vec3 P = impulseInNormalDir * normal + impulseInTangentDir * tangent;
+		vA -= invMassA * P;
+		wA -= normalImpulseToAngularVelocityA * impulseInNormalDir + tangentImpulseToAngularVelocityA * impulseInTangentDir;
+		vB += invMassB * P;
+		wB += normalImpulseToAngularVelocityB * impulseInNormalDir + tangentImpulseToAngularVelocityB * impulseInTangentDir;
+
+		store8Except(&rbs->invInertia.m22, batch.rbAIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
+			dummyA, invMassA, vA.x, vA.y, vA.z, wA.x, wA.y, wA.z);
+
+		store8Except(&rbs->invInertia.m22, batch.rbBIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
+			dummyB, invMassB, vB.x, vB.y, vB.z, wB.x, wB.y, wB.z);
+	}
+}
+
+void getCollisionImpulsesSIMD(simd_collision_constraint_solver constraints, contact_impulse* outImpulses)
+{
+	for (uint32 i = 0; i < constraints.numBatches; ++i)
+	{
+		const simd_collision_constraint_batch& batch = constraints.batches[i];
+
+		// Padding lanes duplicate the first lane, so they just write the same values again.
+		for (uint32 j = 0; j < CONSTRAINT_SIMD_WIDTH; ++j)
+		{
+			contact_impulse& out = outImpulses[batch.contactIndices[j]];
+			vec3 tangent(batch.tangent[0][j], batch.tangent[1][j], batch.tangent[2][j]);
+			out.tangentImpulse = batch.impulseInTangentDir[j] * tangent;
+			out.normalImpulse = batch.impulseInNormalDir[j];
+		}
+	}
+}
+
 void solveCollisionVelocityConstraintsSIMD(simd_collision_constraint_solver constraints, rigid_body_global_state* rbs)
 {
 	CPU_PROFILE_BLOCK("Solve collision constraints SIMD");
@@ -3553,14 +3703,116 @@ void solveCollisionVelocityConstraintsSIMD(simd_collision_constraint_solver cons
 		impulseInNormalDir.store(batch.impulseInNormalDir);
 		impulseInTangentDir.store(batch.impulseInTangentDir);
 
-		store8(&rbs->invInertia.m22, batch.rbAIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbAIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			dummyA, invMassA, vA.x, vA.y, vA.z, wA.x, wA.y, wA.z);
 
-		store8(&rbs->invInertia.m22, batch.rbBIndices, (uint32)sizeof(rigid_body_global_state),
+		store8Except(&rbs->invInertia.m22, batch.rbBIndices, constraints.dummyRigidBodyIndex, (uint32)sizeof(rigid_body_global_state),
 			dummyB, invMassB, vB.x, vB.y, vB.z, wB.x, wB.y, wB.z);
 	}
 }
 
+// Assigns a color to each SIMD batch, such that no two batches with the same color share a dynamic rigid body, and sorts the batches by color.
+// The dummy rigid body is ignored here. Many batches of one color reference it, but the SIMD solvers skip its lanes when writing the
+// bodies back (see store8Except), so these batches can still run concurrently.
+template <typename batch_t>
+static constraint_batch_colors colorConstraintBatchesSIMD(eallocator& arena, batch_t* batches, uint32 numBatches, uint32 dummyRigidBodyIndex)
+{
+	CPU_PROFILE_BLOCK("Color constraint batches SIMD");
+
+	constraint_batch_colors result = {};
+
+	if (numBatches == 0)
+	{
+		return result;
+	}
+
+	memory_marker marker = arena.getMarker();
+
+	const uint32 overflowColor = MAX_NUM_CONSTRAINT_COLORS - 1;
+	const uint32 colorableMask = (1u << overflowColor) - 1;
+
+	uint32* colorMaskPerBody = arena.allocate<uint32>(dummyRigidBodyIndex + 1, true);
+	uint8* colorPerBatch = arena.allocate<uint8>(numBatches);
+
+	uint32 numBatchesPerColor[MAX_NUM_CONSTRAINT_COLORS] = {};
+
+	for (uint32 i = 0; i < numBatches; ++i)
+	{
+		const batch_t& batch = batches[i];
+
+		uint32 usedColors = 0;
+		for (uint32 j = 0; j < CONSTRAINT_SIMD_WIDTH; ++j)
+		{
+			uint16 rbA = batch.rbAIndices[j];
+			uint16 rbB = batch.rbBIndices[j];
+			usedColors |= (rbA != dummyRigidBodyIndex) ? colorMaskPerBody[rbA] : 0;
+			usedColors |= (rbB != dummyRigidBodyIndex) ? colorMaskPerBody[rbB] : 0;
+		}
+
+		uint32 color = indexOfLeastSignificantSetBit(~usedColors & colorableMask);
+		if (color == (uint32)-1)
+		{
+			// All colors are taken. This batch ends up in the overflow bucket, which is solved serially after all others.
+			color = overflowColor;
+		}
+		else
+		{
+			for (uint32 j = 0; j < CONSTRAINT_SIMD_WIDTH; ++j)
+			{
+				colorMaskPerBody[batch.rbAIndices[j]] |= (1u << color);
+				colorMaskPerBody[batch.rbBIndices[j]] |= (1u << color);
+			}
+		}
+
+		colorPerBatch[i] = (uint8)color;
+		++numBatchesPerColor[color];
+	}
+
+	exclusivePrefixSum(numBatchesPerColor, result.colorOffsets, MAX_NUM_CONSTRAINT_COLORS);
+	result.colorOffsets[MAX_NUM_CONSTRAINT_COLORS] = numBatches;
+
+	uint32 writeOffsets[MAX_NUM_CONSTRAINT_COLORS];
+	memcpy(writeOffsets, result.colorOffsets, sizeof(writeOffsets));
+
+	batch_t* sortedBatches = arena.allocate<batch_t>(numBatches);
+	for (uint32 i = 0; i < numBatches; ++i)
+	{
+		sortedBatches[writeOffsets[colorPerBatch[i]]++] = batches[i];
+	}
+	memcpy(batches, sortedBatches, sizeof(batch_t) * numBatches);
+
+	arena.resetToMarker(marker);
+
+	return result;
+}
+
+template <typename solver_t>
+static void solveColoredBatchesSIMD(solver_t solver, const constraint_batch_colors& colors, rigid_body_global_state* rbs,
+	void (*solve)(solver_t, rigid_body_global_state*))
+{
+	for (uint32 color = 0; color < MAX_NUM_CONSTRAINT_COLORS; ++color)
+	{
+		uint32 first = colors.colorOffsets[color];
+		uint32 count = colors.colorOffsets[color + 1] - first;
+
+		if (count == 0)
+		{
+			continue;
+		}
+
+		// The overflow bucket has conflicts between its batches, so it must be solved serially.
+		uint32 minBatchesPerJob = (color == MAX_NUM_CONSTRAINT_COLORS - 1) ? count : MIN_CONSTRAINT_BATCHES_PER_JOB;
+
+		parallelFor(highPriorityJobQueue, count, minBatchesPerJob, [solver, first, rbs, solve](uint32 begin, uint32 end)
+		{
+			solver_t range = solver;
+			range.batches += first + begin;
+			range.numBatches = end - begin;
+			solve(range, rbs);
+		});
+	}
+}
+
 void constraint_solver::initialize(eallocator& arena, rigid_body_global_state* rbs,
 	distance_constraint* distanceConstraints, constraint_body_pair* distanceConstraintBodyPairs, uint32 numDistanceConstraints,
 	ball_constraint* ballConstraints, constraint_body_pair* ballConstraintBodyPairs, uint32 numBallConstraints,
@@ -3568,8 +3820,8 @@ void constraint_solver::initialize(eallocator& arena, rigid_body_global_state* r
 	hinge_constraint* hingeConstraints, constraint_body_pair* hingeConstraintBodyPairs, uint32 numHingeConstraints,
 	cone_twist_constraint* coneTwistConstraints, constraint_body_pair* coneTwistConstraintBodyPairs, uint32 numConeTwistConstraints,
 	slider_constraint* sliderConstraints, constraint_body_pair* sliderConstraintBodyPairs, uint32 numSliderConstraints,
-	collision_contact* contacts, constraint_body_pair* collisionBodyPairs, uint32 numContacts, 
-	uint32 dummyRigidBodyIndex, bool simd, float dt)
+	collision_contact* contacts, constraint_body_pair* collisionBodyPairs, uint32 numContacts, const contact_impulse* cachedContactImpulses,
+	uint32 dummyRigidBodyIndex, bool simd, bool parallel, float dt)
 {
 	CPU_PROFILE_BLOCK("Initialize constraints");
 
@@ -3581,7 +3833,35 @@ void constraint_solver::initialize(eallocator& arena, rigid_body_global_state* r
 		hingeConstraintSolverSIMD = initializeHingeVelocityConstraintsSIMD(arena, rbs, hingeConstraints, hingeConstraintBodyPairs, numHingeConstraints, dt);
 		coneTwistConstraintSolverSIMD = initializeConeTwistVelocityConstraintsSIMD(arena, rbs, coneTwistConstraints, coneTwistConstraintBodyPairs, numConeTwistConstraints, dt);
 		sliderConstraintSolverSIMD = initializeSliderVelocityConstraintsSIMD(arena, rbs, sliderConstraints, sliderConstraintBodyPairs, numSliderConstraints, dt);
-		collisionConstraintSolverSIMD = initializeCollisionVelocityConstraintsSIMD(arena, rbs, contacts, collisionBodyPairs, numContacts, dummyRigidBodyIndex, dt);
+		collisionConstraintSolverSIMD = initializeCollisionVelocityConstraintsSIMD(arena, rbs, contacts, collisionBodyPairs, numContacts, cachedContactImpulses, dummyRigidBodyIndex, dt);
+
+		distanceConstraintSolverSIMD.dummyRigidBodyIndex = (uint16)dummyRigidBodyIndex;
+		ballConstraintSolverSIMD.dummyRigidBodyIndex = (uint16)dummyRigidBodyIndex;
+		fixedConstraintSolverSIMD.dummyRigidBodyIndex = (uint16)dummyRigidBodyIndex;
+		hingeConstraintSolverSIMD.dummyRigidBodyIndex = (uint16)dummyRigidBodyIndex;
+		coneTwistConstraintSolverSIMD.dummyRigidBodyIndex = (uint16)dummyRigidBodyIndex;
+		sliderConstraintSolverSIMD.dummyRigidBodyIndex = (uint16)dummyRigidBodyIndex;
+		collisionConstraintSolverSIMD.dummyRigidBodyIndex = (uint16)dummyRigidBodyIndex;
+
+		if (parallel)
+		{
+			distanceConstraintColors = colorConstraintBatchesSIMD(arena, distanceConstraintSolverSIMD.batches, distanceConstraintSolverSIMD.numBatches, dummyRigidBodyIndex);
+			ballConstraintColors = colorConstraintBatchesSIMD(arena, ballConstraintSolverSIMD.batches, ballConstraintSolverSIMD.numBatches, dummyRigidBodyIndex);
+			fixedConstraintColors = colorConstraintBatchesSIMD(arena, fixedConstraintSolverSIMD.batches, fixedConstraintSolverSIMD.numBatches, dummyRigidBodyIndex);
+			hingeConstraintColors = colorConstraintBatchesSIMD(arena, hingeConstraintSolverSIMD.batches, hingeConstraintSolverSIMD.numBatches, dummyRigidBodyIndex);
+			coneTwistConstraintColors = colorConstraintBatchesSIMD(arena, coneTwistConstraintSolverSIMD.batches, coneTwistConstraintSolverSIMD.numBatches, dummyRigidBodyIndex);
+			sliderConstraintColors = colorConstraintBatchesSIMD(arena, sliderConstraintSolverSIMD.batches, sliderConstraintSolverSIMD.numBatches, dummyRigidBodyIndex);
+			collisionConstraintColors = colorConstraintBatchesSIMD(arena, collisionConstraintSolverSIMD.batches, collisionConstraintSolverSIMD.numBatches, dummyRigidBodyIndex);
+
+			if (cachedContactImpulses)
+			{
+				solveColoredBatchesSIMD(collisionConstraintSolverSIMD, collisionConstraintColors, rbs, warmStartCollisionVelocityConstraintsSIMD);
+			}
+		}
+		else if (cachedContactImpulses)
+		{
+			warmStartCollisionVelocityConstraintsSIMD(collisionConstraintSolverSIMD, rbs);
+		}
 	}
 	else
 	{
@@ -3591,18 +3871,34 @@ void constraint_solver::initialize(eallocator& arena, rigid_body_global_state* r
 		hingeConstraintSolver = initializeHingeVelocityConstraints(arena, rbs, hingeConstraints, hingeConstraintBodyPairs, numHingeConstraints, dt);
 		coneTwistConstraintSolver = initializeConeTwistVelocityConstraints(arena, rbs, coneTwistConstraints, coneTwistConstraintBodyPairs, numConeTwistConstraints, dt);
 		sliderConstraintSolver = initializeSliderVelocityConstraints(arena, rbs, sliderConstraints, sliderConstraintBodyPairs, numSliderConstraints, dt);
-		collisionConstraintSolver = initializeCollisionVelocityConstraints(arena, rbs, contacts, collisionBodyPairs, numContacts, dt);
+		collisionConstraintSolver = initializeCollisionVelocityConstraints(arena, rbs, contacts, collisionBodyPairs, numContacts, cachedContactImpulses, dt);
+
+		if (cachedContactImpulses)
+		{
+			warmStartCollisionVelocityConstraints(collisionConstraintSolver, rbs);
+		}
 	}
 
 	this->rbs = rbs;
 	this->simd = simd;
+	this->parallel = simd && parallel; // The parallel solver operates on the SIMD batches.
 }
 
 void constraint_solver::solveOneIteration()
 {
 	CPU_PROFILE_BLOCK("Solve constraints one iteration");
 
-	if (simd)
+	if (parallel)
+	{
+		solveColoredBatchesSIMD(distanceConstraintSolverSIMD, distanceConstraintColors, rbs, solveDistanceVelocityConstraintsSIMD);
+		solveColoredBatchesSIMD(ballConstraintSolverSIMD, ballConstraintColors, rbs, solveBallVelocityConstraintsSIMD);
+		solveColoredBatchesSIMD(fixedConstraintSolverSIMD, fixedConstraintColors, rbs, solveFixedVelocityConstraintsSIMD);
+		solveColoredBatchesSIMD(hingeConstraintSolverSIMD, hingeConstraintColors, rbs, solveHingeVelocityConstraintsSIMD);
+		solveColoredBatchesSIMD(coneTwistConstraintSolverSIMD, coneTwistConstraintColors, rbs, solveConeTwistVelocityConstraintsSIMD);
+		solveColoredBatchesSIMD(sliderConstraintSolverSIMD, sliderConstraintColors, rbs, solveSliderVelocityConstraintsSIMD);
+		solveColoredBatchesSIMD(collisionConstraintSolverSIMD, collisionConstraintColors, rbs, solveCollisionVelocityConstraintsSIMD);
+	}
+	else if (simd)
 	{
 		solveDistanceVelocityConstraintsSIMD(distanceConstraintSolverSIMD, rbs);
 		solveBallVelocityConstraintsSIMD(ballConstraintSolverSIMD, rbs);
@@ -3622,4 +3918,16 @@ void constraint_solver::solveOneIteration()
 		solveSliderVelocityConstraints(sliderConstraintSolver, rbs);
 		solveCollisionVelocityConstraints(collisionConstraintSolver, rbs);
 	}
-}
\ No newline at end of file
+}
+
+void constraint_solver::getContactImpulses(contact_impulse* outImpulses)
+{
+	if (simd)
+	{
+		getCollisionImpulsesSIMD(collisionConstraintSolverSIMD, outImpulses);
+	}
+	else
+	{
+		getCollisionImpulses(collisionConstraintSolver, outImpulses);
+	}
+}
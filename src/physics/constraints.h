@@ -115,6 +115,7 @@ struct simd_distance_constraint_solver
 {
 	simd_distance_constraint_batch* batches;
 	uint32 numBatches;
+	uint16 dummyRigidBodyIndex; // Lanes referencing this body are not written back.
 };
 
 
@@ -160,6 +161,7 @@ struct simd_ball_constraint_solver
 {
 	simd_ball_constraint_batch* batches;
 	uint32 numBatches;
+	uint16 dummyRigidBodyIndex; // Lanes referencing this body are not written back.
 };
 
 
@@ -213,6 +215,7 @@ struct simd_fixed_constraint_solver
 {
 	simd_fixed_constraint_batch* batches;
 	uint32 numBatches;
+	uint16 dummyRigidBodyIndex; // Lanes referencing this body are not written back.
 };
 
 // Hinge constraint.
@@ -326,6 +329,7 @@ struct simd_hinge_constraint_solver
 {
 	simd_hinge_constraint_batch* batches;
 	uint32 numBatches;
+	uint16 dummyRigidBodyIndex; // Lanes referencing this body are not written back.
 };
 
 
@@ -473,6 +477,7 @@ struct simd_cone_twist_constraint_solver
 {
 	simd_cone_twist_constraint_batch* batches;
 	uint32 numBatches;
+	uint16 dummyRigidBodyIndex; // Lanes referencing this body are not written back.
 };
 
 // Slider constraint
@@ -588,10 +593,19 @@ struct simd_slider_constraint_solver
 {
 	simd_slider_constraint_batch* batches;
 	uint32 numBatches;
+	uint16 dummyRigidBodyIndex; // Lanes referencing this body are not written back.
 };
 
 
 // Collision constraint
+
+// Accumulated impulses of one contact point. These are carried over to the next frame to warm start the solver.
+struct contact_impulse
+{
+	vec3 tangentImpulse; // Stored as a vector, since the tangent direction changes between frames.
+	float normalImpulse;
+};
+
 struct collision_constraint
 {
 	vec3 relGlobalAnchorA;
@@ -639,12 +653,14 @@ struct simd_collision_constraint_batch
 
 	uint16 rbAIndices[CONSTRAINT_SIMD_WIDTH];
 	uint16 rbBIndices[CONSTRAINT_SIMD_WIDTH];
+	uint16 contactIndices[CONSTRAINT_SIMD_WIDTH];
 };
 
 struct simd_collision_constraint_solver
 {
 	simd_collision_constraint_batch* batches;
 	uint32 numBatches;
+	uint16 dummyRigidBodyIndex; // Lanes referencing this body are not written back.
 };
 
 NODISCARD distance_constraint_solver initializeDistanceVelocityConstraints(eallocator& arena, const rigid_body_global_state* rbs, const distance_constraint* input, const constraint_body_pair* bodyPairs, uint32 count, float dt);
@@ -665,8 +681,11 @@ void solveConeTwistVelocityConstraints(cone_twist_constraint_solver constraints,
 NODISCARD slider_constraint_solver initializeSliderVelocityConstraints(eallocator& arena, const rigid_body_global_state* rbs, const slider_constraint* input, const constraint_body_pair* bodyPairs, uint32 count, float dt);
 void solveSliderVelocityConstraints(slider_constraint_solver constraints, rigid_body_global_state* rbs);
 
-NODISCARD collision_constraint_solver initializeCollisionVelocityConstraints(eallocator& arena, const rigid_body_global_state* rbs, const collision_contact* contacts, const constraint_body_pair* bodyPairs, uint32 numContacts, float dt);
+// cachedImpulses may be null, in which case the solver starts from zero.
+NODISCARD collision_constraint_solver initializeCollisionVelocityConstraints(eallocator& arena, const rigid_body_global_state* rbs, const collision_contact* contacts, const constraint_body_pair* bodyPairs, uint32 numContacts, const contact_impulse* cachedImpulses, float dt);
+void warmStartCollisionVelocityConstraints(collision_constraint_solver constraints, rigid_body_global_state* rbs);
 void solveCollisionVelocityConstraints(collision_constraint_solver constraints, rigid_body_global_state* rbs);
+void getCollisionImpulses(collision_constraint_solver constraints, contact_impulse* outImpulses);
 
 // SIMD
 NODISCARD simd_distance_constraint_solver initializeDistanceVelocityConstraintsSIMD(eallocator& arena, const rigid_body_global_state* rbs, const distance_constraint* input, const constraint_body_pair* bodyPairs, uint32 count, float dt);
@@ -687,8 +706,20 @@ void solveConeTwistVelocityConstraintsSIMD(simd_cone_twist_constraint_solver con
 NODISCARD simd_slider_constraint_solver initializeSliderVelocityConstraintsSIMD(eallocator& arena, const rigid_body_global_state* rbs, const slider_constraint* input, const constraint_body_pair* bodyPairs, uint32 count, float dt);
 void solveSliderVelocityConstraintsSIMD(simd_slider_constraint_solver constraints, rigid_body_global_state* rbs);
 
-NODISCARD simd_collision_constraint_solver initializeCollisionVelocityConstraintsSIMD(eallocator& arena, const rigid_body_global_state* rbs, const collision_contact* contacts, const constraint_body_pair* bodyPairs, uint32 numContacts, uint16 dummyRigidBodyIndex, float dt);
+NODISCARD simd_collision_constraint_solver initializeCollisionVelocityConstraintsSIMD(eallocator& arena, const rigid_body_global_state* rbs, const collision_contact* contacts, const constraint_body_pair* bodyPairs, uint32 numContacts, const contact_impulse* cachedImpulses, uint16 dummyRigidBodyIndex, float dt);
+void warmStartCollisionVelocityConstraintsSIMD(simd_collision_constraint_solver constraints, rigid_body_global_state* rbs);
 void solveCollisionVelocityConstraintsSIMD(simd_collision_constraint_solver constraints, rigid_body_global_state* rbs);
+void getCollisionImpulsesSIMD(simd_collision_constraint_solver constraints, contact_impulse* outImpulses);
+
+// Parallel solving.
+#define MAX_NUM_CONSTRAINT_COLORS 32 // The last color is an overflow bucket, which is always solved serially.
+
+// The SIMD batches of one constraint type are sorted by color. No two batches of the same color touch the same dynamic rigid body,
+// so all batches of one color can be solved concurrently.
+struct constraint_batch_colors
+{
+	uint32 colorOffsets[MAX_NUM_CONSTRAINT_COLORS + 1];
+};
 
 struct constraint_solver
 {
@@ -699,14 +730,26 @@ struct constraint_solver
 		hinge_constraint* hingeConstraints, constraint_body_pair* hingeConstraintBodyPairs, uint32 numHingeConstraints,
 		cone_twist_constraint* coneTwistConstraints, constraint_body_pair* coneTwistConstraintBodyPairs, uint32 numConeTwistConstraints,
 		slider_constraint* sliderConstraints, constraint_body_pair* sliderConstraintBodyPairs, uint32 numSliderConstraints,
-		collision_contact* contacts, constraint_body_pair* collisionBodyPairs, uint32 numContacts, 
-		uint32 dummyRigidBodyIndex,	bool simd, float dt);
+		collision_contact* contacts, constraint_body_pair* collisionBodyPairs, uint32 numContacts, const contact_impulse* cachedContactImpulses,
+		uint32 dummyRigidBodyIndex,	bool simd, bool parallel, float dt);
 
 	void solveOneIteration();
 
+	// Writes the accumulated impulse of each contact, so that it can be used to warm start the next frame.
+	void getContactImpulses(contact_impulse* outImpulses);
+
 private:
 	rigid_body_global_state* rbs;
 	bool simd;
+	bool parallel;
+
+	constraint_batch_colors distanceConstraintColors;
+	constraint_batch_colors ballConstraintColors;
+	constraint_batch_colors fixedConstraintColors;
+	constraint_batch_colors hingeConstraintColors;
+	constraint_batch_colors coneTwistConstraintColors;
+	constraint_batch_colors sliderConstraintColors;
+	constraint_batch_colors collisionConstraintColors;
 
 	distance_constraint_solver distanceConstraintSolver;
 	simd_distance_constraint_solver distanceConstraintSolverSIMD;
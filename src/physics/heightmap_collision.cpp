@@ -2,6 +2,8 @@
 #include "heightmap_collision.h"
 #include "core/cpu_profiling.h"
 #include "collision_gjk.h"
+#include "bounding_volumes_simd.h"
+#include "core/job_system.h"
 
 static void getAABBIncidentEdge(vec3 aabbRadius, vec3 normal, vec3& outA, vec3& outB)
 {
@@ -426,28 +428,187 @@ static uint32 collideAABBvsTriangle(vec3 center, vec3 radius, vec3 a, vec3 b, ve
 	return 1;
 }
 
-static uint32 intersection(const bounding_sphere& s, const bounding_box& aabb, const heightmap_collider_component& heightmap, eallocator& arena,
-	collision_contact* outContacts)
+// Triangles are gathered from the quad tree in batches of simdWidth and tested against one shape at once.
+// The wide tests only reject separated triangles. Surviving lanes go through the scalar contact generation, so the contacts are the same as before.
+struct heightmap_triangle_batch
+{
+	static constexpr uint32 width = simdWidth<w_float>;
+
+	float coords[3][3][width]; // [vertex][axis][lane].
+	uint32 count = 0;
+
+	void push(vec3 a, vec3 b, vec3 c)
+	{
+		set(0, count, a);
+		set(1, count, b);
+		set(2, count, c);
+		++count;
+	}
+
+	// Fills the unused lanes with copies of the last triangle.
+	void pad()
+	{
+		for (uint32 lane = count; lane < width; ++lane)
+		{
+			for (uint32 v = 0; v < 3; ++v)
+			{
+				set(v, lane, get(v, count - 1));
+			}
+		}
+	}
+
+	NODISCARD w_vec3 get(uint32 v) const
+	{
+		return w_vec3(w_float(coords[v][0]), w_float(coords[v][1]), w_float(coords[v][2]));
+	}
+
+	void set(uint32 v, w_vec3 p)
+	{
+		p.store(coords[v][0], coords[v][1], coords[v][2]);
+	}
+
+	NODISCARD vec3 get(uint32 v, uint32 lane) const
+	{
+		return vec3(coords[v][0][lane], coords[v][1][lane], coords[v][2][lane]);
+	}
+
+	void set(uint32 v, uint32 lane, vec3 p)
+	{
+		coords[v][0][lane] = p.x;
+		coords[v][1][lane] = p.y;
+		coords[v][2][lane] = p.z;
+	}
+
+	NODISCARD uint32 laneMask() const { return (1u << count) - 1; }
+};
+
+template <typename batch_func>
+static void iterateTriangleBatchesInVolume(const heightmap_collider_component& heightmap, const bounding_box& aabb, const batch_func& func)
+{
+	heightmap_triangle_batch batch;
+
+	heightmap.iterateTrianglesInVolume(aabb, [&batch, &func](vec3 a, vec3 b, vec3 c)
+	{
+		batch.push(a, b, c);
+		if (batch.count == heightmap_triangle_batch::width)
+		{
+			func(batch);
+			batch.count = 0;
+		}
+	});
+
+	if (batch.count > 0)
+	{
+		batch.pad();
+		func(batch);
+	}
+}
+
+static w_vec3 broadcast(vec3 v)
+{
+	return w_vec3(w_float(v.x), w_float(v.y), w_float(v.z));
+}
+
+// Separating axis test of an AABB centered at the origin against the triangles of a batch. Mirrors the axes in collideAABBvsTriangle.
+// Returns the mask of lanes, which are not separated.
+static uint32 aabbVsTriangleOverlapMask(vec3 radius, const w_vec3& a, const w_vec3& b, const w_vec3& c)
+{
+	uint32 separated = 0;
+
+	// Box face axes.
+	auto faceAxisSeparated = [](w_float a, w_float b, w_float c, float radius)
+	{
+		w_float minProj = minimum(a, minimum(b, c));
+		w_float maxProj = maximum(a, maximum(b, c));
+		return toBitMask(maxProj < w_float(-radius)) | toBitMask(minProj > w_float(radius));
+	};
+
+	separated |= faceAxisSeparated(a.x, b.x, c.x, radius.x);
+	separated |= faceAxisSeparated(a.y, b.y, c.y, radius.y);
+	separated |= faceAxisSeparated(a.z, b.z, c.z, radius.z);
+
+	// Triangle normal.
+	{
+		w_vec3 n = cross(b - a, c - b);
+		w_float r = abs(n.x) * radius.x + abs(n.y) * radius.y + abs(n.z) * radius.z;
+		separated |= toBitMask(abs(dot(n, a)) > r);
+	}
+
+	// Cross products of box and triangle edges. Both edge vertices project onto the same value, so the edge start and the opposite vertex suffice.
+	const w_vec3* vertices[3] = { &a, &b, &c };
+	for (uint32 i = 0; i < 3; ++i)
+	{
+		const w_vec3& v0 = *vertices[i];
+		const w_vec3& v1 = *vertices[(i + 2) % 3];
+		w_vec3 f = *vertices[(i + 1) % 3] - v0;
+
+		w_float absX = abs(f.x), absY = abs(f.y), absZ = abs(f.z);
+
+		w_float p0[3] = {
+			v0.z * f.y - v0.y * f.z,
+			v0.x * f.z - v0.z * f.x,
+			v0.y * f.x - v0.x * f.y,
+		};
+		w_float p1[3] = {
+			v1.z * f.y - v1.y * f.z,
+			v1.x * f.z - v1.z * f.x,
+			v1.y * f.x - v1.x * f.y,
+		};
+		w_float r[3] = {
+			absZ * radius.y + absY * radius.z,
+			absZ * radius.x + absX * radius.z,
+			absY * radius.x + absX * radius.y,
+		};
+
+		for (uint32 axis = 0; axis < 3; ++axis)
+		{
+			separated |= toBitMask(maximum(p0[axis], p1[axis]) < -r[axis]);
+			separated |= toBitMask(minimum(p0[axis], p1[axis]) > r[axis]);
+		}
+	}
+
+	return ~separated;
+}
+
+static uint32 intersection(const bounding_sphere& s, const bounding_box& aabb, const heightmap_collider_component& heightmap,
+	collision_contact* outContacts, uint32 maxNumContacts)
 {
 	uint32 numContacts = 0;
 
-	heightmap.iterateTrianglesInVolume(aabb, arena, [s, outContacts, &numContacts](vec3 a, vec3 b, vec3 c)
+	w_vec3 center = broadcast(s.center);
+	w_float radiusSq = s.radius * s.radius;
+
+	iterateTriangleBatchesInVolume(heightmap, aabb, [&](const heightmap_triangle_batch& batch)
 	{
-		numContacts += collideSphereVsTriangle(s.center, s.radius, a, b, c, outContacts + numContacts);
+		w_vec3 closest = closestPoint_PointTriangle(center, batch.get(0), batch.get(1), batch.get(2));
+		uint32 hits = toBitMask(squaredLength(closest - center) <= radiusSq) & batch.laneMask();
+
+		for (uint32 lane = 0; lane < batch.width && numContacts < maxNumContacts; ++lane)
+		{
+			if (hits & (1 << lane))
+			{
+				numContacts += collideSphereVsTriangle(s.center, s.radius, batch.get(0, lane), batch.get(1, lane), batch.get(2, lane), outContacts + numContacts);
+			}
+		}
 	});
 
 	// TODO: De-duplicate contacts (for if we hit triangle edges or vertices).
 	return numContacts;
 }
 
-static uint32 intersection(const bounding_capsule& capsule, const bounding_box& aabb, const heightmap_collider_component& heightmap, eallocator& arena,
-	collision_contact* outContacts)
+static uint32 intersection(const bounding_capsule& capsule, const bounding_box& aabb, const heightmap_collider_component& heightmap,
+	collision_contact* outContacts, uint32 maxNumContacts)
 {
 	uint32 numContacts = 0;
 
 	ray r = { capsule.positionA, normalize(capsule.positionB - capsule.positionA) };
 
-	heightmap.iterateTrianglesInVolume(aabb, arena, [r, capsule, outContacts, &numContacts](vec3 a, vec3 b, vec3 c)
+	w_vec3 origin = broadcast(r.origin);
+	w_vec3 direction = broadcast(r.direction);
+	w_line_segment segment = { broadcast(capsule.positionA), broadcast(capsule.positionB) };
+	w_float radiusSq = capsule.radius * capsule.radius;
+
+	auto getReferencePoint = [&r, &capsule](vec3 a, vec3 b, vec3 c)
 	{
 		vec3 triNormal = normalize(cross(b - a, c - a));
 		float d = -dot(triNormal, a);
@@ -459,44 +620,94 @@ static uint32 intersection(const bounding_capsule& capsule, const bounding_box&
 		vec3 trace = r.origin + t * r.direction;
 		vec3 closest = closestPoint_PointTriangle(trace, a, b, c);
 
-		vec3 reference = closestPoint_PointSegment(closest, { capsule.positionA, capsule.positionB });
+		return closestPoint_PointSegment(closest, { capsule.positionA, capsule.positionB });
+	};
+
+	iterateTriangleBatchesInVolume(heightmap, aabb, [&](const heightmap_triangle_batch& batch)
+	{
+		w_vec3 a = batch.get(0);
+		w_vec3 b = batch.get(1);
+		w_vec3 c = batch.get(2);
+
+		// The ray parameter does not depend on the length of the normal, so it is not normalized here.
+		w_vec3 triNormal = cross(b - a, c - a);
+		w_float t = dot(a - origin, triNormal) / dot(direction, triNormal);
 
-		numContacts += collideSphereVsTriangle(reference, capsule.radius, a, b, c, outContacts + numContacts);
+		w_vec3 trace = origin + t * direction;
+		w_vec3 reference = closestPoint_PointSegment(closestPoint_PointTriangle(trace, a, b, c), segment);
+		w_vec3 closest = closestPoint_PointTriangle(reference, a, b, c);
+
+		uint32 hits = toBitMask(squaredLength(closest - reference) <= radiusSq) & batch.laneMask();
+
+		for (uint32 lane = 0; lane < batch.width && numContacts < maxNumContacts; ++lane)
+		{
+			if (hits & (1 << lane))
+			{
+				vec3 la = batch.get(0, lane);
+				vec3 lb = batch.get(1, lane);
+				vec3 lc = batch.get(2, lane);
+				numContacts += collideSphereVsTriangle(getReferencePoint(la, lb, lc), capsule.radius, la, lb, lc, outContacts + numContacts);
+			}
+		}
 	});
 
 	// TODO: De-duplicate contacts (for if we hit triangle edges or vertices).
 	return numContacts;
 }
 
-static uint32 intersection(const bounding_box& box, const bounding_box& aabb, const heightmap_collider_component& heightmap, eallocator& arena,
-	collision_contact* outContacts)
+static uint32 intersection(const bounding_box& box, const bounding_box& aabb, const heightmap_collider_component& heightmap,
+	collision_contact* outContacts, uint32 maxNumContacts)
 {
 	uint32 numContacts = 0;
 
 	vec3 center = box.getCenter();
 	vec3 radius = box.getRadius();
 
-	heightmap.iterateTrianglesInVolume(aabb, arena, [center, radius, outContacts, &numContacts](vec3 a, vec3 b, vec3 c)
+	w_vec3 wideCenter = broadcast(center);
+
+	iterateTriangleBatchesInVolume(heightmap, aabb, [&](const heightmap_triangle_batch& batch)
 	{
-		numContacts += collideAABBvsTriangle(center, radius, a, b, c, outContacts + numContacts);
+		uint32 hits = aabbVsTriangleOverlapMask(radius, batch.get(0) - wideCenter, batch.get(1) - wideCenter, batch.get(2) - wideCenter) & batch.laneMask();
+
+		for (uint32 lane = 0; lane < batch.width && numContacts < maxNumContacts; ++lane)
+		{
+			if (hits & (1 << lane))
+			{
+				numContacts += collideAABBvsTriangle(center, radius, batch.get(0, lane), batch.get(1, lane), batch.get(2, lane), outContacts + numContacts);
+			}
+		}
 	});
 
 	// TODO: De-duplicate contacts (for if we hit triangle edges or vertices).
 	return numContacts;
 }
 
-static uint32 intersection(const bounding_oriented_box& obb, const bounding_box& aabb, const heightmap_collider_component& heightmap, eallocator& arena,
-	collision_contact* outContacts)
+static uint32 intersection(const bounding_oriented_box& obb, const bounding_box& aabb, const heightmap_collider_component& heightmap,
+	collision_contact* outContacts, uint32 maxNumContacts)
 {
 	uint32 numContacts = 0;
 
-	heightmap.iterateTrianglesInVolume(aabb, arena, [obb, outContacts, &numContacts](vec3 a, vec3 b, vec3 c)
+	w_vec3 center = broadcast(obb.center);
+	w_quat invRotation(w_float(-obb.rotation.x), w_float(-obb.rotation.y), w_float(-obb.rotation.z), w_float(obb.rotation.w));
+
+	iterateTriangleBatchesInVolume(heightmap, aabb, [&](const heightmap_triangle_batch& worldSpaceBatch)
 	{
-		a = conjugate(obb.rotation) * (a - obb.center);
-		b = conjugate(obb.rotation) * (b - obb.center);
-		c = conjugate(obb.rotation) * (c - obb.center);
+		// Transform the whole batch into the local space of the box.
+		heightmap_triangle_batch batch = worldSpaceBatch;
+		for (uint32 v = 0; v < 3; ++v)
+		{
+			batch.set(v, invRotation * (batch.get(v) - center));
+		}
 
-		numContacts += collideAABBvsTriangle(vec3(0.f, 0.f, 0.f), obb.radius, a, b, c, outContacts + numContacts);
+		uint32 hits = aabbVsTriangleOverlapMask(obb.radius, batch.get(0), batch.get(1), batch.get(2)) & batch.laneMask();
+
+		for (uint32 lane = 0; lane < batch.width && numContacts < maxNumContacts; ++lane)
+		{
+			if (hits & (1 << lane))
+			{
+				numContacts += collideAABBvsTriangle(vec3(0.f, 0.f, 0.f), obb.radius, batch.get(0, lane), batch.get(1, lane), batch.get(2, lane), outContacts + numContacts);
+			}
+		}
 	});
 
 	// TODO: De-duplicate contacts (for if we hit triangle edges or vertices).
@@ -509,107 +720,173 @@ static uint32 intersection(const bounding_oriented_box& obb, const bounding_box&
 	return numContacts;
 }
 
-NODISCARD narrowphase_result heightmapCollision(const heightmap_collider_component& heightmap,
-	const collider_union* worldSpaceColliders, const bounding_box* worldSpaceAABBs, uint32 numColliders, 
-	collision_contact* outContacts, constraint_body_pair* outBodyPairs, collider_pair* outColliderPairs, uint8* outContactCountPerCollision, 
-	eallocator& arena, uint16 dummyRigidBodyIndex)
+// Writes the contacts of one collider with the heightmap, including the contact below the lowest point of the collider. Returns the number of contacts.
+static uint32 collideWithHeightmap(const heightmap_collider_component& heightmap, const collider_union& collider, bounding_box aabb,
+	collision_contact* outContacts)
 {
-	CPU_PROFILE_BLOCK("Heightmap collisions");
+	aabb.maxCorner.y += 10.f;
 
-	uint32 totalNumContacts = 0;
-	uint32 totalNumCollisions = 0;
+	// One slot is reserved for the lowest point contact.
+	const uint32 maxNumTriangleContacts = HEIGHTMAP_COLLISION_MAX_NUM_CONTACTS_PER_COLLIDER - 1;
 
-	for (uint32 i = 0; i < numColliders; ++i)
-	{
-		const collider_union& collider = worldSpaceColliders[i];
+	uint32 numContacts = 0;
+	vec3 lowestPoint;
 
-		if (collider.objectType != physics_object_type_rigid_body)
-			continue;
+	switch (collider.type)
+	{
+		case collider_type_sphere:
+		{
+			numContacts = intersection(collider.sphere, aabb, heightmap, outContacts, maxNumTriangleContacts);
+			lowestPoint = sphere_support_fn{ collider.sphere }(vec3(0.f, -1.f, 0.f));
+		} break;
+		case collider_type_capsule:
+		{
+			numContacts = intersection(collider.capsule, aabb, heightmap, outContacts, maxNumTriangleContacts);
+			lowestPoint = capsule_support_fn{ collider.capsule }(vec3(0.f, -1.f, 0.f));
+		} break;
+		case collider_type_aabb:
+		{
+			numContacts = intersection(collider.aabb, aabb, heightmap, outContacts, maxNumTriangleContacts);
+			lowestPoint = aabb_support_fn{ collider.aabb }(vec3(0.f, -1.f, 0.f));
+		} break;
+		case collider_type_obb:
+		{
+			numContacts = intersection(collider.obb, aabb, heightmap, outContacts, maxNumTriangleContacts);
+			lowestPoint = obb_support_fn{ collider.obb }(vec3(0.f, -1.f, 0.f));
+		} break;
+		default: return 0;
+	}
 
-		bounding_box aabb = worldSpaceAABBs[i];
-		aabb.maxCorner.y += 10.f;
+	float heightAtLowestPoint = heightmap.getHeightAt(vec2(lowestPoint.x, lowestPoint.z));
+	if (lowestPoint.y < heightAtLowestPoint)
+	{
+		collision_contact& contact = outContacts[numContacts++];
+		contact.normal = vec3(0.f, -1.f, 0.f);
+		contact.point = lowestPoint;
+		contact.penetrationDepth = heightAtLowestPoint - lowestPoint.y;
+	}
 
-		uint32 numContacts = 0;
+	if (numContacts > 0)
+	{
+		float friction = clamp01(sqrt(collider.material.friction * heightmap.material.friction));
+		float restitution = clamp01(max(collider.material.restitution, heightmap.material.restitution));
 
-		collision_contact* contactPtr = outContacts + totalNumContacts;
-		vec3 lowestPoint;
+		uint32 friction_restitution = ((uint32)(friction * 0xFFFF) << 16) | (uint32)(restitution * 0xFFFF);
 
-		switch (collider.type)
+		for (uint32 j = 0; j < numContacts; ++j)
 		{
-			case collider_type_sphere:
-			{
-				numContacts = intersection(collider.sphere, aabb, heightmap, arena, contactPtr);
-				lowestPoint = sphere_support_fn{ collider.sphere }(vec3(0.f, -1.f, 0.f));
-			} break;
-			case collider_type_capsule:
-			{
-				numContacts = intersection(collider.capsule, aabb, heightmap, arena, contactPtr);
-				lowestPoint = capsule_support_fn{ collider.capsule }(vec3(0.f, -1.f, 0.f));
-			} break;
-			case collider_type_aabb:
-			{
-				numContacts = intersection(collider.aabb, aabb, heightmap, arena, contactPtr);
-				lowestPoint = aabb_support_fn{ collider.aabb }(vec3(0.f, -1.f, 0.f));
-			} break;
-			case collider_type_obb:
-			{
-				numContacts = intersection(collider.obb, aabb, heightmap, arena, contactPtr);
-				lowestPoint = obb_support_fn{ collider.obb }(vec3(0.f, -1.f, 0.f));
-			} break;
+			outContacts[j].friction_restitution = friction_restitution;
 		}
+	}
 
-		float heightAtLowestPoint = heightmap.getHeightAt(vec2(lowestPoint.x, lowestPoint.z));
-		if (lowestPoint.y < heightAtLowestPoint)
-		{
-			collision_contact& contact = contactPtr[numContacts++];
-			contact.normal = vec3(0.f, -1.f, 0.f);
-			contact.point = lowestPoint;
-			contact.penetrationDepth = heightAtLowestPoint - lowestPoint.y;
-		}
+	return numContacts;
+}
 
-		if (numContacts > 0)
-		{
-			constraint_body_pair* bodyPairPtr = outBodyPairs + totalNumContacts;
+struct heightmap_collision_record
+{
+	uint16 colliderIndex;
+	uint16 rigidBodyIndex;
+	uint32 numContacts;
+};
+
+// Output of one job, allocated from the step arena. The collisions are bounded by the number of colliders of the job. The contact array always has room for
+// one more collider and grows by doubling, so colliders write their contacts directly into it.
+// The outputs are merged in job order afterwards, so the result is the same as with a serial loop.
+struct heightmap_collision_job_output
+{
+	collision_contact* contacts;
+	uint32 numContacts;
+	uint32 contactCapacity;
+
+	heightmap_collision_record* collisions;
+	uint32 numCollisions;
+};
+
+NODISCARD narrowphase_result heightmapCollision(const heightmap_collider_component& heightmap,
+	const collider_union* worldSpaceColliders, const bounding_box* worldSpaceAABBs, uint32 numColliders, eallocator& arena,
+	collision_contact* outContacts, constraint_body_pair* outBodyPairs, collider_pair* outColliderPairs, uint8* outContactCountPerCollision, 
+	const bool* sleepingPerBody, uint16 dummyRigidBodyIndex)
+{
+	CPU_PROFILE_BLOCK("Heightmap collisions");
+
+	memory_marker marker = arena.getMarker();
 
-			float friction = clamp01(sqrt(collider.material.friction * heightmap.material.friction));
-			float restitution = clamp01(max(collider.material.restitution, heightmap.material.restitution));
+	uint32 numJobs = clamp(bucketize(numColliders, HEIGHTMAP_COLLISION_MIN_NUM_COLLIDERS_PER_JOB), 1u, HEIGHTMAP_COLLISION_MAX_NUM_JOBS);
+	uint32 numCollidersPerJob = bucketize(numColliders, numJobs);
 
-			uint32 friction_restitution = ((uint32)(friction * 0xFFFF) << 16) | (uint32)(restitution * 0xFFFF);
+	heightmap_collision_job_output* jobOutputs = arena.allocate<heightmap_collision_job_output>(numJobs);
 
-			for (uint32 j = 0; j < numContacts; ++j)
+	parallelFor(highPriorityJobQueue, numJobs, 1, [&](uint32 begin, uint32 end)
+	{
+		for (uint32 jobIndex = begin; jobIndex < end; ++jobIndex)
+		{
+			uint32 firstCollider = jobIndex * numCollidersPerJob;
+			uint32 lastCollider = min(firstCollider + numCollidersPerJob, numColliders);
+
+			heightmap_collision_job_output& output = jobOutputs[jobIndex];
+			output.contacts = 0;
+			output.numContacts = 0;
+			output.contactCapacity = 0;
+			output.collisions = arena.allocate<heightmap_collision_record>(lastCollider - firstCollider);
+			output.numCollisions = 0;
+
+			for (uint32 i = firstCollider; i < lastCollider; ++i)
 			{
-				contactPtr[j].friction_restitution = friction_restitution;
-				bodyPairPtr[j] = { collider.objectIndex, dummyRigidBodyIndex };
+				const collider_union& collider = worldSpaceColliders[i];
+
+				if (collider.objectType != physics_object_type_rigid_body || sleepingPerBody[collider.objectIndex])
+					continue;
+
+				if (output.numContacts + HEIGHTMAP_COLLISION_MAX_NUM_CONTACTS_PER_COLLIDER > output.contactCapacity)
+				{
+					uint32 newCapacity = max(output.contactCapacity * 2, output.numContacts + HEIGHTMAP_COLLISION_MAX_NUM_CONTACTS_PER_COLLIDER);
+					collision_contact* newContacts = arena.allocate<collision_contact>(newCapacity);
+					if (output.numContacts > 0)
+					{
+						memcpy(newContacts, output.contacts, sizeof(collision_contact) * output.numContacts);
+					}
+					output.contacts = newContacts;
+					output.contactCapacity = newCapacity;
+				}
+
+				uint32 numContacts = collideWithHeightmap(heightmap, collider, worldSpaceAABBs[i], output.contacts + output.numContacts);
+				output.numContacts += numContacts;
+
+				if (numContacts > 0)
+				{
+					output.collisions[output.numCollisions++] = { (uint16)i, collider.objectIndex, numContacts };
+				}
 			}
+		}
+	});
+
+	uint32 totalNumContacts = 0;
+	uint32 totalNumCollisions = 0;
 
-			ASSERT(numContacts < 256);
-			outContactCountPerCollision[totalNumCollisions] = (uint8)numContacts;
-			outColliderPairs[totalNumCollisions++] = { (uint16)i, UINT16_MAX };
+	for (uint32 jobIndex = 0; jobIndex < numJobs; ++jobIndex)
+	{
+		const heightmap_collision_job_output& output = jobOutputs[jobIndex];
+
+		if (output.numContacts > 0)
+		{
+			memcpy(outContacts + totalNumContacts, output.contacts, sizeof(collision_contact) * output.numContacts);
 		}
 
-#if 0
-		for (uint32 j = 0; j < numContacts; ++j)
+		for (uint32 i = 0; i < output.numCollisions; ++i)
 		{
-			float px = contactPtr[j].point.x;
-			float py = contactPtr[j].point.y;
-			float pz = contactPtr[j].point.z;
-			float nx = contactPtr[j].normal.x;
-			float ny = contactPtr[j].normal.y;
-			float nz = contactPtr[j].normal.z;
-			float pen = contactPtr[j].penetrationDepth;
+			const heightmap_collision_record& collision = output.collisions[i];
 
-			if (isnan(px)) { __debugbreak(); }
-			if (isnan(py)) { __debugbreak(); }
-			if (isnan(pz)) { __debugbreak(); }
-			if (isnan(nx)) { __debugbreak(); }
-			if (isnan(ny)) { __debugbreak(); }
-			if (isnan(nz)) { __debugbreak(); }
-			if (isnan(pen)) { __debugbreak(); }
-		}
-#endif
+			for (uint32 j = 0; j < collision.numContacts; ++j)
+			{
+				outBodyPairs[totalNumContacts++] = { collision.rigidBodyIndex, dummyRigidBodyIndex };
+			}
 
-		totalNumContacts += numContacts;
+			outContactCountPerCollision[totalNumCollisions] = (uint8)collision.numContacts;
+			outColliderPairs[totalNumCollisions++] = { collision.colliderIndex, UINT16_MAX };
+		}
 	}
 
+	arena.resetToMarker(marker);
+
 	return narrowphase_result{ totalNumCollisions, totalNumContacts, 0 };
 }
@@ -4,8 +4,14 @@
 #include "collision_broad.h"
 #include "terrain/heightmap_collider.h"
 
+#define HEIGHTMAP_COLLISION_MIN_NUM_COLLIDERS_PER_JOB 32u
+#define HEIGHTMAP_COLLISION_MAX_NUM_JOBS 16u
+#define HEIGHTMAP_COLLISION_MAX_NUM_CONTACTS_PER_COLLIDER 255 // Contact counts are stored as uint8.
+
+// Collides all awake rigid body colliders with the heightmap. The colliders are distributed over the high priority job queue.
+// The output is identical to a serial loop over the colliders. Temporary job outputs are allocated from the arena and released before returning.
 NODISCARD narrowphase_result heightmapCollision(const heightmap_collider_component& heightmap,
-	const collider_union* worldSpaceColliders, const bounding_box* worldSpaceAABBs, uint32 numColliders,
+	const collider_union* worldSpaceColliders, const bounding_box* worldSpaceAABBs, uint32 numColliders, eallocator& arena,
 	collision_contact* outContacts, constraint_body_pair* outBodyPairs, // result.numContacts many.
 	collider_pair* outColliderPairs, uint8* outContactCountPerCollision, // result.numCollisions many.
-	eallocator& arena, uint16 dummyRigidBodyIndex);
\ No newline at end of file
+	const bool* sleepingPerBody, uint16 dummyRigidBodyIndex);
\ No newline at end of file
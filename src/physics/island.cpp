@@ -2,18 +2,24 @@
 #include "island.h"
 #include "core/cpu_profiling.h"
 
-void buildIslands(eallocator& arena, constraint_body_pair* bodyPairs, uint32 numBodyPairs, uint32 numRigidBodies, uint16 dummyRigidBodyIndex, const constraint_offsets& offsets)
+NODISCARD island_description buildIslands(eallocator& arena, const constraint_body_pair* bodyPairs, uint32 numBodyPairs, uint32 numRigidBodies, uint16 dummyRigidBodyIndex,
+	const bool* isStatic)
 {
 	CPU_PROFILE_BLOCK("Build islands");
 
+	island_description result;
+	result.numIslands = 0;
+
 	uint32 islandCapacity = numBodyPairs;
-	uint16* allIslands = arena.allocate<uint16>(islandCapacity);
+	result.pairsPerIsland = arena.allocate<uint32>(islandCapacity);
+	result.islandPerBody = arena.allocate<uint16>(numRigidBodies);
+	result.islandPairOffsets = arena.allocate<uint32>(numRigidBodies + 1); // There are at most as many islands as there are bodies.
 
 	memory_marker marker = arena.getMarker();
 
 	uint32 count = numRigidBodies + 1; // 1 for the dummy.
 
-	uint16* numConstraintsPerBody = arena.allocate<uint16>(count, true);
+	uint32* numConstraintsPerBody = arena.allocate<uint32>(count, true);
 
 	for (uint32 i = 0; i < numBodyPairs; ++i)
 	{
@@ -22,9 +28,9 @@ void buildIslands(eallocator& arena, constraint_body_pair* bodyPairs, uint32 num
 		++numConstraintsPerBody[pair.rbB];
 	}
 
-	uint16* offsetToFirstConstraintPerBody = arena.allocate<uint16>(count);
+	uint32* offsetToFirstConstraintPerBody = arena.allocate<uint32>(count);
 
-	uint16 currentOffset = 0;
+	uint32 currentOffset = 0;
 	for (uint32 i = 0; i < count; ++i)
 	{
 		offsetToFirstConstraintPerBody[i] = currentOffset;
@@ -34,18 +40,18 @@ void buildIslands(eallocator& arena, constraint_body_pair* bodyPairs, uint32 num
 	struct body_pair_reference
 	{
 		uint16 otherBody;
-		uint16 pairIndex;
+		uint32 pairIndex;
 	};
 
 	body_pair_reference* pairReferences = arena.allocate<body_pair_reference>(numBodyPairs * 2);
-	uint16* counter = arena.allocate<uint16>(count);
-	memcpy(counter, offsetToFirstConstraintPerBody, sizeof(uint16) * count);
+	uint32* counter = arena.allocate<uint32>(count);
+	memcpy(counter, offsetToFirstConstraintPerBody, sizeof(uint32) * count);
 
 	for (uint32 i = 0; i < numBodyPairs; ++i)
 	{
 		constraint_body_pair pair = bodyPairs[i];
-		pairReferences[counter[pair.rbA]++] = { pair.rbB, (uint16)i };
-		pairReferences[counter[pair.rbB]++] = { pair.rbA, (uint16)i };
+		pairReferences[counter[pair.rbA]++] = { pair.rbB, i };
+		pairReferences[counter[pair.rbB]++] = { pair.rbA, i };
 	}
 
 	uint16* rbStack = arena.allocate<uint16>(count);
@@ -58,11 +64,19 @@ void buildIslands(eallocator& arena, constraint_body_pair* bodyPairs, uint32 num
 
 	for (uint16 rbIndexOuter = 0; rbIndexOuter < (uint16)numRigidBodies; ++rbIndexOuter)
 	{
+		if (isStatic[rbIndexOuter])
+		{
+			result.islandPerBody[rbIndexOuter] = INVALID_ISLAND_INDEX;
+			continue;
+		}
+
 		if (alreadyVisited[rbIndexOuter] || rbIndexOuter == dummyRigidBodyIndex)
 			continue;
 
 		// Reset island
 		uint32 islandStart = islandPtr;
+		uint16 islandIndex = (uint16)result.numIslands++;
+		result.islandPairOffsets[islandIndex] = islandStart;
 
 		rbStack[0] = rbIndexOuter;
 		alreadyOnStack[rbIndexOuter] = true;
@@ -76,6 +90,7 @@ void buildIslands(eallocator& arena, constraint_body_pair* bodyPairs, uint32 num
 			ASSERT(rbIndex != dummyRigidBodyIndex);
 			ASSERT(!alreadyVisited[rbIndex]);
 			alreadyVisited[rbIndex] = true;
+			result.islandPerBody[rbIndex] = islandIndex;
 
 			// Push connected bodies
 			uint32 startIndex = offsetToFirstConstraintPerBody[rbIndex];
@@ -84,7 +99,7 @@ void buildIslands(eallocator& arena, constraint_body_pair* bodyPairs, uint32 num
 			{
 				body_pair_reference ref = pairReferences[i];
 				uint16 other = ref.otherBody;
-				if (!alreadyOnStack[other] && other != dummyRigidBodyIndex) // Don't push dummy to stack. We don't want to grow islands over the dummy.
+				if (!alreadyOnStack[other] && !isStatic[other]) // Don't push static bodies (including the dummy) to stack. We don't want to grow islands over them.
 				{
 					alreadyOnStack[other] = true;
 					rbStack[stackPtr++] = other;
@@ -94,7 +109,7 @@ void buildIslands(eallocator& arena, constraint_body_pair* bodyPairs, uint32 num
 				{
 					// Add constraint to island.
 					ASSERT(islandPtr < islandCapacity);
-					allIslands[islandPtr++] = ref.pairIndex;
+					result.pairsPerIsland[islandPtr++] = ref.pairIndex;
 				}
 
 			}
@@ -104,18 +119,14 @@ void buildIslands(eallocator& arena, constraint_body_pair* bodyPairs, uint32 num
 		uint32 islandSize = islandPtr - islandStart;
 		if (islandSize > 0)
 		{
-			uint16* islandPairs = allIslands + islandStart;
+			uint32* islandPairs = result.pairsPerIsland + islandStart;
 			std::sort(islandPairs, islandPairs + islandSize);
 		}
 	}
 
-#if 0
-	ASSERT(islandPtr == islandCapacity);
-	for (uint32 i = 0; i < numRigidBodies; ++i)
-	{
-		ASSERT(alreadyVisited[i]);
-	}
-#endif
+	result.islandPairOffsets[result.numIslands] = islandPtr;
 
 	arena.resetToMarker(marker);
+
+	return result;
 }
@@ -8,4 +8,19 @@ struct constraint_offsets
 	uint32 constraintOffsets[constraint_type_count];
 };
 
-void buildIslands(eallocator& arena, constraint_body_pair* bodyPairs, uint32 numBodyPairs, uint32 numRigidBodies, uint16 dummyRigidBodyIndex, const constraint_offsets& offsets);
+#define INVALID_ISLAND_INDEX 0xFFFF
+
+struct island_description
+{
+	uint16* islandPerBody; // numRigidBodies many. Bodies which don't take part in island building get INVALID_ISLAND_INDEX.
+	uint32 numIslands;
+
+	// Indices into the body pair array, sorted by island. The pairs of island i are in [islandPairOffsets[i], islandPairOffsets[i + 1]).
+	uint32* pairsPerIsland;
+	uint32* islandPairOffsets; // numIslands + 1 many.
+};
+
+// Bodies for which isStatic is true (e.g. the dummy, kinematic or sleeping bodies) don't connect islands and are not part of any island.
+// isStatic must contain numRigidBodies + 1 entries (1 for the dummy).
+NODISCARD island_description buildIslands(eallocator& arena, const constraint_body_pair* bodyPairs, uint32 numBodyPairs, uint32 numRigidBodies, uint16 dummyRigidBodyIndex,
+	const bool* isStatic);
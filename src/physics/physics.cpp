@@ -3,15 +3,26 @@
 #include "collision_broad.h"
 #include "collision_narrow.h"
 #include "heightmap_collision.h"
+#include "island.h"
+#include "scene_queries.h"
+#include "snapshot.h"
 #include "core/cpu_profiling.h"
+#include "core/job_system.h"
+#include "core/hash.h"
 
 #ifndef PHYSICS_ONLY
 #include "core/log.h"
 #endif
 
 #include <unordered_set>
+#include <thread>
 
 static std::vector<bounding_hull_geometry> boundingHullGeometries;
+static std::vector<physics_properties> boundingHullMassProperties; // Per geometry. For unit density, in the geometry's local space.
+
+// Identical geometries are only stored once. Hulls from mesh files are additionally looked up by path, so that the file is only loaded once.
+static std::unordered_multimap<size_t, uint32> boundingHullGeometryIndicesByHash;
+static std::unordered_map<std::string, uint32> boundingHullGeometryIndicesByPath;
 
 struct constraint_context
 {
@@ -48,37 +59,301 @@ struct force_field_global_state
 	vec3 force;
 };
 
+static size_t hashBoundingHullGeometry(const bounding_hull_geometry& geometry)
+{
+	size_t seed = 0;
+	for (const vec3& v : geometry.vertices)
+	{
+		hash_combine(seed, v);
+	}
+	for (const bounding_hull_face& face : geometry.faces)
+	{
+		hash_combine(seed, face.a);
+		hash_combine(seed, face.b);
+		hash_combine(seed, face.c);
+	}
+	return seed;
+}
+
+static bool boundingHullGeometriesEqual(const bounding_hull_geometry& a, const bounding_hull_geometry& b)
+{
+	if (a.vertices.size() != b.vertices.size() || a.faces.size() != b.faces.size())
+	{
+		return false;
+	}
+	if (memcmp(a.vertices.data(), b.vertices.data(), sizeof(vec3) * a.vertices.size()) != 0)
+	{
+		return false;
+	}
+	for (uint32 i = 0; i < (uint32)a.faces.size(); ++i)
+	{
+		const bounding_hull_face& fa = a.faces[i];
+		const bounding_hull_face& fb = b.faces[i];
+		if (fa.a != fb.a || fa.b != fb.b || fa.c != fb.c)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Mass properties for unit density in the geometry's local space. The inertia tensor is given with respect to the center of gravity.
+static physics_properties calculateBoundingHullMassProperties(const bounding_hull_geometry& geom)
+{
+	const float s60 = 1.f / 60.f;
+	const float s120 = 1.f / 120.f;
+
+	// Covariance-matrix of a tetrahedron with v0 = (0, 0, 0), v1 = (1, 0, 0), v2 = (0, 1, 0), v3 = (0, 0, 1).
+	const mat3 Ccanonical(
+		s60, s120, s120,
+		s120, s60, s120,
+		s120, s120, s60
+	);
+
+	uint32 numFaces = (uint32)geom.faces.size();
+
+	float totalMass = 0.f;
+	mat3 totalCovariance = mat3::zero;
+	vec3 totalCOG(0.f);
+
+	for (uint32 i = 0; i < numFaces; ++i)
+	{
+		auto& face = geom.faces[i];
+
+		//vec3 w0 = 0.f;
+		vec3 w1 = geom.vertices[face.a];
+		vec3 w2 = geom.vertices[face.b];
+		vec3 w3 = geom.vertices[face.c];
+
+		mat3 A(
+			w1.x, w2.x, w3.x,
+			w1.y, w2.y, w3.y,
+			w1.z, w2.z, w3.z
+		);
+
+		float detA = determinant(A);
+		mat3 covariance = detA * A * Ccanonical * transpose(A);
+
+		float volume = 1.f / 6.f * detA;
+		float mass = volume;
+		vec3 cog = (w1 + w2 + w3) * 0.25f;
+
+		totalMass += mass;
+		totalCovariance += covariance;
+		totalCOG += cog * mass;
+	}
+
+	totalCOG /= totalMass;
+
+	// This is actually different in the Blow-paper, but this one is correct.
+	mat3 CprimeTotal = totalCovariance - totalMass * outerProduct(totalCOG, totalCOG);
+
+	physics_properties result;
+	result.cog = totalCOG;
+	result.mass = totalMass;
+	result.inertia = mat3::identity * trace(CprimeTotal) - CprimeTotal;
+	return result;
+}
+
+static uint32 findBoundingHullGeometry(const bounding_hull_geometry& geometry, size_t hash)
+{
+	auto range = boundingHullGeometryIndicesByHash.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (boundingHullGeometriesEqual(boundingHullGeometries[it->second], geometry))
+		{
+			return it->second;
+		}
+	}
+	return INVALID_BOUNDING_HULL_INDEX;
+}
+
+static uint32 pushBoundingHullGeometry(bounding_hull_geometry&& geometry, const physics_properties& massProperties, size_t hash)
+{
+	uint32 index = (uint32)boundingHullGeometries.size();
+	boundingHullGeometries.push_back(std::move(geometry));
+	boundingHullMassProperties.push_back(massProperties);
+	boundingHullGeometryIndicesByHash.insert({ hash, index });
+	return index;
+}
+
+NODISCARD uint32 allocateBoundingHullGeometry(bounding_hull_geometry&& geometry)
+{
+	size_t hash = hashBoundingHullGeometry(geometry);
+
+	uint32 index = findBoundingHullGeometry(geometry, hash);
+	if (index != INVALID_BOUNDING_HULL_INDEX)
+	{
+		return index;
+	}
+
+	physics_properties massProperties = calculateBoundingHullMassProperties(geometry);
+	return pushBoundingHullGeometry(std::move(geometry), massProperties, hash);
+}
+
 #ifndef PHYSICS_ONLY
 // This is a bit dirty. PHYSICS_ONLY is defined when building the learning DLL, where we don't need bounding hulls.
 
 #include "geometry/mesh_builder.h"
 #include "asset/model_asset.h"
+#include "asset/io.h"
 
-NODISCARD uint32 allocateBoundingHullGeometry(const std::string& meshFilepath)
+static const uint32 HULL_CACHE_HEADER = 'HULL';
+
+struct hull_cache_header
+{
+	uint32 header = HULL_CACHE_HEADER;
+	uint32 version = 1;
+	uint32 numVertices;
+	uint32 numEdges;
+	uint32 numFaces;
+	uint32 numAdjacency;
+	uint32 numAdjacencyOffsets;
+	uint32 numSOAVertices;
+	bounding_box aabb;
+	physics_properties massProperties;
+};
+
+template <typename T>
+static bool readHullCacheArray(entire_file& file, std::vector<T>& out, uint32 count)
+{
+	T* ptr = file.consume<T>(count);
+	if (count > 0 && !ptr)
+	{
+		return false;
+	}
+	out.assign(ptr, ptr + count);
+	return true;
+}
+
+template <typename T>
+static void writeHullCacheArray(const std::vector<T>& in, FILE* file)
+{
+	fwrite(in.data(), sizeof(T), in.size(), file);
+}
+
+static bool loadBoundingHullFromCache(const fs::path& cacheFilepath, bounding_hull_geometry& outGeometry, physics_properties& outMassProperties)
+{
+	entire_file file = loadFile(cacheFilepath);
+	if (!file.content)
+	{
+		return false;
+	}
+
+	bool valid = false;
+	hull_cache_header* header = file.consume<hull_cache_header>();
+	if (header && header->header == HULL_CACHE_HEADER && header->version == hull_cache_header().version)
+	{
+		valid = readHullCacheArray(file, outGeometry.vertices, header->numVertices)
+			&& readHullCacheArray(file, outGeometry.edges, header->numEdges)
+			&& readHullCacheArray(file, outGeometry.faces, header->numFaces)
+			&& readHullCacheArray(file, outGeometry.adjacency, header->numAdjacency)
+			&& readHullCacheArray(file, outGeometry.adjacencyOffsets, header->numAdjacencyOffsets)
+			&& readHullCacheArray(file, outGeometry.vertexX, header->numSOAVertices)
+			&& readHullCacheArray(file, outGeometry.vertexY, header->numSOAVertices)
+			&& readHullCacheArray(file, outGeometry.vertexZ, header->numSOAVertices);
+
+		outGeometry.aabb = header->aabb;
+		outMassProperties = header->massProperties;
+	}
+
+	freeFile(file);
+	return valid;
+}
+
+static void writeBoundingHullCache(const fs::path& cacheFilepath, const bounding_hull_geometry& geometry, const physics_properties& massProperties)
 {
-	model_asset asset = load3DModelFromFile(meshFilepath);
+	fs::create_directories(cacheFilepath.parent_path());
+
+	FILE* file = fopen(cacheFilepath.string().c_str(), "wb");
+	if (!file)
+	{
+		return;
+	}
+
+	hull_cache_header header;
+	header.numVertices = (uint32)geometry.vertices.size();
+	header.numEdges = (uint32)geometry.edges.size();
+	header.numFaces = (uint32)geometry.faces.size();
+	header.numAdjacency = (uint32)geometry.adjacency.size();
+	header.numAdjacencyOffsets = (uint32)geometry.adjacencyOffsets.size();
+	header.numSOAVertices = (uint32)geometry.vertexX.size();
+	header.aabb = geometry.aabb;
+	header.massProperties = massProperties;
+
+	fwrite(&header, sizeof(header), 1, file);
+	writeHullCacheArray(geometry.vertices, file);
+	writeHullCacheArray(geometry.edges, file);
+	writeHullCacheArray(geometry.faces, file);
+	writeHullCacheArray(geometry.adjacency, file);
+	writeHullCacheArray(geometry.adjacencyOffsets, file);
+	writeHullCacheArray(geometry.vertexX, file);
+	writeHullCacheArray(geometry.vertexY, file);
+	writeHullCacheArray(geometry.vertexZ, file);
+
+	fclose(file);
+}
 
-	if (asset.meshes.empty())
+// The simplified hull and its mass properties are cached in the asset cache, next to the preprocessed meshes.
+NODISCARD uint32 allocateBoundingHullGeometry(const std::string& meshFilepath)
+{
+	auto it = boundingHullGeometryIndicesByPath.find(meshFilepath);
+	if (it != boundingHullGeometryIndicesByPath.end())
 	{
-		return INVALID_BOUNDING_HULL_INDEX;
+		return it->second;
 	}
 
-	mesh_builder builder(mesh_creation_flags_with_positions);
+	fs::path path = meshFilepath;
+
+	fs::path cachedFilename = path;
+	cachedFilename.replace_extension("." + std::to_string(BOUNDING_HULL_DEFAULT_MAX_NUM_VERTICES) + ".hull.cache.bin");
+	fs::path cacheFilepath = L"asset_cache" / cachedFilename;
 
-	for (auto& mesh : asset.meshes)
+	bounding_hull_geometry geometry;
+	physics_properties massProperties;
+
+	bool fromCache = fs::exists(path) && fs::exists(cacheFilepath)
+		&& fs::last_write_time(cacheFilepath) > fs::last_write_time(path)
+		&& loadBoundingHullFromCache(cacheFilepath, geometry, massProperties);
+
+	if (!fromCache)
 	{
-		for (auto& sub : mesh.submeshes)
+		model_asset asset = load3DModelFromFile(path);
+
+		if (asset.meshes.empty())
+		{
+			return INVALID_BOUNDING_HULL_INDEX;
+		}
+
+		mesh_builder builder(mesh_creation_flags_with_positions);
+
+		for (auto& mesh : asset.meshes)
 		{
-			builder.pushMesh(sub, 1.f);
+			for (auto& sub : mesh.submeshes)
+			{
+				builder.pushMesh(sub, 1.f);
+			}
 		}
+
+		geometry = bounding_hull_geometry::fromMesh(
+			builder.getPositions(),
+			builder.getNumVertices(),
+			(indexed_triangle16*)builder.getTriangles(),
+			builder.getNumTriangles(),
+			BOUNDING_HULL_DEFAULT_MAX_NUM_VERTICES);
+		massProperties = calculateBoundingHullMassProperties(geometry);
+
+		writeBoundingHullCache(cacheFilepath, geometry, massProperties);
 	}
 
-	uint32 index = (uint32)boundingHullGeometries.size();
-	boundingHullGeometries.push_back(bounding_hull_geometry::fromMesh(
-		builder.getPositions(),
-		builder.getNumVertices(),
-		(indexed_triangle16*)builder.getTriangles(),
-		builder.getNumTriangles()));
+	size_t hash = hashBoundingHullGeometry(geometry);
+	uint32 index = findBoundingHullGeometry(geometry, hash);
+	if (index == INVALID_BOUNDING_HULL_INDEX)
+	{
+		index = pushBoundingHullGeometry(std::move(geometry), massProperties, hash);
+	}
+
+	boundingHullGeometryIndicesByPath.insert({ meshFilepath, index });
 	return index;
 }
 #endif
@@ -122,6 +397,11 @@ static void addConstraintEdge(eentity& e, constraint_entity_reference_component&
 	}
 
 	++reference.numConstraints;
+
+	if (rigid_body_component* rb = e.getComponentIfExists<rigid_body_component>())
+	{
+		rb->wakeUp();
+	}
 }
 
 NODISCARD distance_constraint_handle addDistanceConstraintFromLocalPoints(eentity& a, eentity& b, vec3 localAnchorA, vec3 localAnchorB, float distance)
@@ -468,6 +748,11 @@ static void removeConstraintEdge(eentity entity, constraint_edge& edge, constrai
 	}
 
 	context.freeConstraintEdge(edge);
+
+	if (rigid_body_component* rb = entity.getComponentIfExists<rigid_body_component>())
+	{
+		rb->wakeUp();
+	}
 }
 
 static void deleteConstraint(entt::registry* registry, entity_handle constraintEntityHandle)
@@ -622,12 +907,13 @@ void testPhysicsInteraction(escene& scene, ray r, float strength)
 
 	if (minRB)
 	{
+		minRB->wakeUp();
 		minRB->torqueAccumulator += torque;
 		minRB->forceAccumulator += force;
 	}
 }
 
-static void getWorldSpaceColliders(escene& scene, bounding_box* outWorldspaceAABBs, collider_union* outWorldSpaceColliders, uint16 dummyRigidBodyIndex)
+void getWorldSpaceColliders(escene& scene, bounding_box* outWorldspaceAABBs, collider_union* outWorldSpaceColliders, uint16 dummyRigidBodyIndex)
 {
 	CPU_PROFILE_BLOCK("Get world space colliders");
 
@@ -840,9 +1126,9 @@ void validate(uint32 line, rigid_body_global_state* rbs, uint32 count)
 		VALIDATE4(line, "RB update", r.rotation);
 		VALIDATE3(line, "RB update", r.localCOGPosition);
 		VALIDATE3(line, "RB update", r.position);
-		VALIDATE3(line, "RB update", r.invInertia.col0);
-		VALIDATE3(line, "RB update", r.invInertia.col1);
-		VALIDATE3(line, "RB update", r.invInertia.col2);
+		VALIDATE3(line, "RB update", r.invInertia.cols[0]);
+		VALIDATE3(line, "RB update", r.invInertia.cols[1]);
+		VALIDATE3(line, "RB update", r.invInertia.cols[2]);
 		VALIDATE1(line, "RB update", r.invMass);
 		VALIDATE3(line, "RB update", r.linearVelocity);
 		VALIDATE3(line, "RB update", r.angularVelocity);
@@ -946,6 +1232,9 @@ struct event_context
 {
 	std::vector<entity_pair> prevFrameTriggerOverlaps;
 	std::vector<collision_entity_pair> prevFrameCollisions;
+
+	std::vector<physics_event> events; // Written by the steps of the running physicsStep call.
+	std::vector<physics_event> publishedEvents; // Events of the last finished physicsStep call. Only touched on the main thread.
 };
 
 static void handleNonCollisionInteractions(escene& scene, 
@@ -988,12 +1277,15 @@ static void handleNonCollisionInteractions(escene& scene,
 	auto prevEnd = context.prevFrameTriggerOverlaps.end();
 	auto thisEnd = triggerOverlaps.end();
 
-	auto triggerEvent = [&scene](entity_pair pair, trigger_event_type type)
+	auto triggerEvent = [&context](entity_pair pair, physics_event_type type)
 	{
-		eentity triggerEntity = { pair.a, scene };
-		eentity otherEntity = { pair.b, scene };
-		const trigger_component& triggerComp = triggerEntity.getComponent<trigger_component>();
-		triggerComp.callback(trigger_event{ triggerEntity, otherEntity, type });
+		physics_event& e = context.events.emplace_back();
+		e.type = type;
+		e.pairID = pair;
+		e.entityA = pair.a;
+		e.entityB = pair.b;
+		e.colliderA = null_entity;
+		e.colliderB = null_entity;
 	};
 
 	while (prevIterator != prevEnd && thisIterator != thisEnd)
@@ -1010,32 +1302,73 @@ static void handleNonCollisionInteractions(escene& scene,
 
 		if (p < t)
 		{
-			triggerEvent(p, trigger_event_leave);
+			triggerEvent(p, physics_event_trigger_leave);
 			++prevIterator;
 		}
 		else
 		{
-			triggerEvent(t, trigger_event_enter);
+			triggerEvent(t, physics_event_trigger_enter);
 			++thisIterator;
 		}
 	}
 
 	while (prevIterator != prevEnd)
 	{
-		triggerEvent(*(prevIterator++), trigger_event_leave);
+		triggerEvent(*(prevIterator++), physics_event_trigger_leave);
 	}
 
 	while (thisIterator != thisEnd)
 	{
-		triggerEvent(*(thisIterator++), trigger_event_enter);
+		triggerEvent(*(thisIterator++), physics_event_trigger_enter);
 	}
 
 	context.prevFrameTriggerOverlaps = std::move(triggerOverlaps);
 }
 
-static void handleCollisionCallbacks(escene& scene, const collider_pair* colliderPairs, uint8* contactCountPerCollision, uint32 numColliderPairs,
-	uint32 numColliders, const collision_contact* contacts, const rigid_body_global_state* rbGlobal, uint32 dummyRigidBodyIndex,
-	const collision_begin_event_func& collisionBeginCallback, const collision_end_event_func& collisionEndCallback)
+struct region_context
+{
+	std::vector<vec3> focusPoints;
+
+	uint32 stepIndex = 0; // Fixed steps taken with regions. Reduced-rate bodies are stepped in the last step of every interval of divisor steps.
+	uint32 frameStartStepIndex = 0;
+	uint32 divisor = 1;
+	bool enabled = false; // Whether the current step is split into region passes.
+	physics_activity_level currentPass = physics_activity_full;
+};
+
+// Bodies outside of the current region pass take part in it as static geometry, like sleeping bodies.
+static bool isOutsideOfRegionPass(escene& scene, const rigid_body_component& rb)
+{
+	const region_context& context = scene.createOrGetContextVariable<region_context>();
+	return context.enabled && rb.activityLevel != context.currentPass;
+}
+
+// Sleeping, static or outside of the current region pass.
+static bool isColliderInactive(escene& scene, entity_handle colliderEntityHandle)
+{
+	eentity colliderEntity = { colliderEntityHandle, scene };
+	if (!colliderEntity.valid())
+	{
+		return false;
+	}
+
+	eentity parentEntity = { colliderEntity.getComponent<collider_component>().parentEntity, scene };
+	if (rigid_body_component* rb = parentEntity.getComponentIfExists<rigid_body_component>())
+	{
+		return rb->isSleeping() || isOutsideOfRegionPass(scene, *rb);
+	}
+
+	return !parentEntity.hasComponent<force_field_component>() && !parentEntity.hasComponent<trigger_component>();
+}
+
+static entity_handle getColliderParentEntity(escene& scene, entity_handle colliderEntityHandle)
+{
+	eentity colliderEntity = { colliderEntityHandle, scene };
+	return colliderEntity.valid() ? colliderEntity.getComponent<collider_component>().parentEntity : null_entity;
+}
+
+static void emitCollisionEvents(escene& scene, const collider_pair* colliderPairs, uint8* contactCountPerCollision, uint32 numColliderPairs,
+	uint32 numColliders, const collision_contact* contacts, const rigid_body_global_state* rbGlobal, uint32 dummyRigidBodyIndex)
 {
 	std::vector<collision_entity_pair> collisions;
 
@@ -1059,130 +1392,1052 @@ static void handleCollisionCallbacks(escene& scene, const collider_pair* collide
 		}
 	}
 
+	event_context& context = scene.createOrGetContextVariable<event_context>();
+
+	// Collisions between inactive colliders are not evaluated by the narrow phase. Keep them alive, so that no end events are reported.
+	// Their contacts are not part of this step.
+	for (collision_entity_pair pair : context.prevFrameCollisions)
+	{
+		if (isColliderInactive(scene, pair.a) && isColliderInactive(scene, pair.b))
+		{
+			pair.contactOffset = 0;
+			pair.numContacts = 0;
+			collisions.push_back(pair);
+		}
+	}
+
 	std::sort(collisions.begin(), collisions.end());
 
-	event_context& context = scene.createOrGetContextVariable<event_context>();
+	auto prevIterator = context.prevFrameCollisions.begin();
+	auto thisIterator = collisions.begin();
+
+	auto prevEnd = context.prevFrameCollisions.end();
+	auto thisEnd = collisions.end();
+
+	auto collisionEvent = [&context, &scene, contacts, rbGlobal, dummyRigidBodyIndex](collision_entity_pair pair, physics_event_type type)
+	{
+		physics_event& e = context.events.emplace_back();
+		e.type = type;
+		e.pairID = pair;
+		e.colliderA = pair.a;
+		e.colliderB = pair.b;
+		e.entityA = getColliderParentEntity(scene, pair.a);
+		e.entityB = getColliderParentEntity(scene, pair.b);
+
+		if (type == physics_event_collision_end || pair.numContacts == 0)
+		{
+			return;
+		}
+
+		const collision_contact* c = contacts + pair.contactOffset;
+		uint32 numContacts = pair.numContacts;
+
+		float norm = 1.f / numContacts;
+
+		vec3 point(0.f);
+		vec3 normal(0.f);
+		float maxPenetrationDepth = 0.f;
+		for (uint32 i = 0; i < numContacts; ++i)
+		{
+			point += c[i].point;
+			normal += c[i].normal;
+			maxPenetrationDepth = max(maxPenetrationDepth, c[i].penetrationDepth);
+		}
+
+		point *= norm;
+		normal *= norm;
+
+		eentity rbAEntity = { e.entityA, scene };
+		eentity rbBEntity = { e.entityB, scene };
+
+		auto& rbAGlobal = rbGlobal[rbAEntity.hasComponent<rigid_body_component>() ? rbAEntity.getComponentIndex<rigid_body_component>() : dummyRigidBodyIndex];
+		auto& rbBGlobal = rbGlobal[rbBEntity.hasComponent<rigid_body_component>() ? rbBEntity.getComponentIndex<rigid_body_component>() : dummyRigidBodyIndex];
+
+		vec3 velA = rbAGlobal.linearVelocity + cross(rbAGlobal.angularVelocity, point - rbAGlobal.position);
+		vec3 velB = rbBGlobal.linearVelocity + cross(rbBGlobal.angularVelocity, point - rbBGlobal.position);
+
+		e.numContacts = numContacts;
+		e.position = point;
+		e.normal = normal;
+		e.relativeVelocity = velB - velA;
+		e.maxPenetrationDepth = maxPenetrationDepth;
+	};
+
+	while (prevIterator != prevEnd && thisIterator != thisEnd)
+	{
+		collision_entity_pair p = *prevIterator;
+		collision_entity_pair t = *thisIterator;
+
+		if (p == t)
+		{
+			collisionEvent(t, physics_event_collision_stay);
+			++prevIterator;
+			++thisIterator;
+			continue;
+		}
+
+		if (p < t)
+		{
+			collisionEvent(p, physics_event_collision_end);
+			++prevIterator;
+		}
+		else
+		{
+			collisionEvent(t, physics_event_collision_begin);
+			++thisIterator;
+		}
+	}
+
+	while (prevIterator != prevEnd)
+	{
+		collisionEvent(*(prevIterator++), physics_event_collision_end);
+	}
 
-	if (collisionBeginCallback || collisionEndCallback)
+	while (thisIterator != thisEnd)
 	{
-		auto prevIterator = context.prevFrameCollisions.begin();
-		auto thisIterator = collisions.begin();
+		collisionEvent(*(thisIterator++), physics_event_collision_begin);
+	}
+
+	context.prevFrameCollisions = std::move(collisions);
+}
 
-		auto prevEnd = context.prevFrameCollisions.end();
-		auto thisEnd = collisions.end();
+// Makes the events of the finished steps visible to getPhysicsEvents and invokes the callback adapters. Main thread only.
+static void publishPhysicsEvents(escene& scene, const physics_settings& settings)
+{
+	event_context& context = scene.createOrGetContextVariable<event_context>();
+	std::swap(context.events, context.publishedEvents);
+	context.events.clear();
 
-		auto beginEvent = [contacts, rbGlobal, &collisionBeginCallback, &scene, dummyRigidBodyIndex](collision_entity_pair pair)
+	for (const physics_event& e : context.publishedEvents)
+	{
+		switch (e.type)
 		{
-			if (collisionBeginCallback)
+			case physics_event_collision_begin:
+			case physics_event_collision_end:
 			{
-				eentity colliderAEntity = { pair.a, scene };
-				eentity colliderBEntity = { pair.b, scene };
+				const collision_begin_event_func& beginCallback = settings.collisionBeginCallback;
+				const collision_end_event_func& endCallback = settings.collisionEndCallback;
+
+				bool isBegin = e.type == physics_event_collision_begin;
+				if ((isBegin && !beginCallback) || (!isBegin && !endCallback))
+				{
+					break;
+				}
+
+				eentity colliderAEntity = { e.colliderA, scene };
+				eentity colliderBEntity = { e.colliderB, scene };
+				if (!colliderAEntity.valid() || !colliderBEntity.valid())
+				{
+					break;
+				}
 
 				const collider_component& colliderA = colliderAEntity.getComponent<collider_component>();
 				const collider_component& colliderB = colliderBEntity.getComponent<collider_component>();
 
-				eentity rbAEntity = { colliderA.parentEntity, scene };
-				eentity rbBEntity = { colliderB.parentEntity, scene };
+				eentity rbAEntity = { e.entityA, scene };
+				eentity rbBEntity = { e.entityB, scene };
 
-				const collision_contact* c = contacts + pair.contactOffset;
-				uint32 numContacts = pair.numContacts;
-				ASSERT(numContacts > 0);
+				if (isBegin)
+				{
+					beginCallback(collision_begin_event{ rbAEntity, rbBEntity, colliderA, colliderB, e.position, e.normal, e.relativeVelocity });
+				}
+				else
+				{
+					endCallback(collision_end_event{ rbAEntity, rbBEntity, colliderA, colliderB });
+				}
+			} break;
 
-				float norm = 1.f / numContacts;
+			case physics_event_trigger_enter:
+			case physics_event_trigger_leave:
+			{
+				eentity triggerEntity = { e.entityA, scene };
+				eentity otherEntity = { e.entityB, scene };
 
-				vec3 point(0.f);
-				vec3 normal(0.f);
-				for (uint32 i = 0; i < numContacts; ++i)
+				const trigger_component* triggerComp = triggerEntity.valid() ? triggerEntity.getComponentIfExists<trigger_component>() : 0;
+				if (triggerComp && triggerComp->callback)
 				{
-					point += c[i].point;
-					normal += c[i].normal;
+					triggerComp->callback(trigger_event{ triggerEntity, otherEntity, e.type == physics_event_trigger_enter ? trigger_event_enter : trigger_event_leave });
 				}
+			} break;
 
-				point *= norm;
-				normal *= norm;
+			default: break;
+		}
+	}
+}
 
+const std::vector<physics_event>& getPhysicsEvents(escene& scene)
+{
+	return scene.createOrGetContextVariable<event_context>().publishedEvents;
+}
 
-				auto& rbAGlobal = rbGlobal[rbAEntity.hasComponent<rigid_body_component>() ? rbAEntity.getComponentIndex<rigid_body_component>() : dummyRigidBodyIndex];
-				auto& rbBGlobal = rbGlobal[rbBEntity.hasComponent<rigid_body_component>() ? rbBEntity.getComponentIndex<rigid_body_component>() : dummyRigidBodyIndex];
+#define CONTACT_CACHE_MAX_DISTANCE 0.02f
+#define CONTACT_CACHE_MIN_NORMAL_DOT 0.95f
 
-				vec3 velA = rbAGlobal.linearVelocity + cross(rbAGlobal.angularVelocity, point - rbAGlobal.position);
-				vec3 velB = rbBGlobal.linearVelocity + cross(rbBGlobal.angularVelocity, point - rbBGlobal.position);
+struct cached_contact
+{
+	vec3 localPoint; // In the local space of the reference body.
+	vec3 normal; // In the direction of the ordered collider pair.
+	contact_impulse impulse;
+};
 
-				collision_begin_event e = { rbAEntity, rbBEntity, colliderA, colliderB, point, normal, velB - velA };
-				collisionBeginCallback(e);
-			}
-		};
+struct cached_manifold
+{
+	entity_pair colliders; // Ordered, so that the key does not depend on the order in which the narrow phase reports the colliders.
+	uint32 firstContact;
+	uint32 numContacts;
 
-		auto endEvent = [&collisionEndCallback, &scene](collision_entity_pair pair)
-		{
-			if (collisionEndCallback)
-			{
-				eentity colliderAEntity = { pair.a, scene };
-				eentity colliderBEntity = { pair.b, scene };
+	bool operator<(const cached_manifold& o) const { return colliders < o.colliders; }
+};
 
-				const collider_component& colliderA = colliderAEntity.getComponent<collider_component>();
-				const collider_component& colliderB = colliderBEntity.getComponent<collider_component>();
+struct contact_cache_context
+{
+	std::vector<cached_manifold> manifolds; // Sorted by collider pair.
+	std::vector<cached_contact> contacts;
+};
 
-				eentity rbAEntity = { colliderA.parentEntity, scene };
-				eentity rbBEntity = { colliderB.parentEntity, scene };
+struct contact_cache_frame
+{
+	cached_manifold* manifolds; // One per collision.
+	cached_contact* contacts; // One per contact.
+	bool* flippedPerCollision;
+	uint32 numCollisions;
+	uint32 numContacts;
+};
 
-				collision_end_event e = { rbAEntity, rbBEntity, colliderA, colliderB };
-				collisionEndCallback(e);
-			}
-		};
+// Matches the contacts of this frame against the cached ones from the last frame and writes their accumulated impulses into outImpulses.
+// Contacts are matched per collider pair by proximity in the local space of one of the bodies.
+static contact_cache_frame getCachedContactImpulses(escene& scene, eallocator& arena, const collider_pair* colliderPairs, const uint8* contactCountPerCollision,
+	uint32 numCollisions, uint32 numColliders, const collision_contact* contacts, const constraint_body_pair* bodyPairs, uint32 numContacts,
+	const rigid_body_global_state* rbGlobal, uint32 dummyRigidBodyIndex, contact_impulse* outImpulses)
+{
+	CPU_PROFILE_BLOCK("Get cached contact impulses");
+
+	contact_cache_context& context = scene.createOrGetContextVariable<contact_cache_context>();
+
+	contact_cache_frame frame;
+	frame.manifolds = arena.allocate<cached_manifold>(numCollisions);
+	frame.contacts = arena.allocate<cached_contact>(numContacts);
+	frame.flippedPerCollision = arena.allocate<bool>(numCollisions);
+	frame.numCollisions = numCollisions;
+	frame.numContacts = numContacts;
+
+	const float maxDistanceSquared = CONTACT_CACHE_MAX_DISTANCE * CONTACT_CACHE_MAX_DISTANCE;
 
-		while (prevIterator != prevEnd && thisIterator != thisEnd)
+	uint32 numMatchedContacts = 0;
+	uint32 contactOffset = 0;
+
+	for (uint32 i = 0; i < numCollisions; ++i)
+	{
+		collider_pair colliderPair = colliderPairs[i];
+		uint32 numContactsInCollision = contactCountPerCollision[i];
+
+		entity_handle a = scene.getEntityFromComponentAtIndex<collider_component>(numColliders - 1 - colliderPair.colliderA).handle;
+		entity_handle b = entt::null; // Heightmap.
+		if (colliderPair.colliderB < numColliders)
 		{
-			collision_entity_pair p = *prevIterator;
-			collision_entity_pair t = *thisIterator;
+			b = scene.getEntityFromComponentAtIndex<collider_component>(numColliders - 1 - colliderPair.colliderB).handle;
+		}
 
-			if (p == t)
-			{
-				++prevIterator;
-				++thisIterator;
-				continue;
-			}
+		bool flipped = (uint32)b < (uint32)a;
+		frame.flippedPerCollision[i] = flipped;
 
-			if (p < t)
-			{
-				endEvent(p);
-				++prevIterator;
-			}
-			else
-			{
-				beginEvent(t);
-				++thisIterator;
-			}
+		cached_manifold& manifold = frame.manifolds[i];
+		manifold.colliders = flipped ? entity_pair{ b, a } : entity_pair{ a, b };
+		manifold.firstContact = contactOffset;
+		manifold.numContacts = numContactsInCollision;
+
+		auto it = std::lower_bound(context.manifolds.begin(), context.manifolds.end(), manifold);
+		const cached_manifold* oldManifold = (it != context.manifolds.end() && it->colliders == manifold.colliders) ? &*it : 0;
+
+		// The reference body is the body of the first collider in the ordered pair, unless that one is static.
+		constraint_body_pair bodies = bodyPairs[contactOffset];
+		uint16 referenceBody = flipped ? bodies.rbB : bodies.rbA;
+		if (referenceBody == dummyRigidBodyIndex)
+		{
+			referenceBody = flipped ? bodies.rbA : bodies.rbB;
 		}
+		ASSERT(referenceBody != dummyRigidBodyIndex);
+
+		const rigid_body_global_state& reference = rbGlobal[referenceBody];
+		quat invRotation = conjugate(reference.rotation);
 
-		if (collisionEndCallback)
+		for (uint32 j = contactOffset; j < contactOffset + numContactsInCollision; ++j)
 		{
-			while (prevIterator != prevEnd)
+			const collision_contact& contact = contacts[j];
+			cached_contact& cached = frame.contacts[j];
+
+			cached.localPoint = invRotation * (contact.point - reference.position);
+			cached.normal = flipped ? -contact.normal : contact.normal;
+			cached.impulse = { vec3(0.f), 0.f };
+
+			if (oldManifold)
 			{
-				endEvent(*(prevIterator++));
+				float bestDistanceSquared = maxDistanceSquared;
+				for (uint32 k = oldManifold->firstContact; k < oldManifold->firstContact + oldManifold->numContacts; ++k)
+				{
+					const cached_contact& old = context.contacts[k];
+					float distanceSquared = squaredLength(old.localPoint - cached.localPoint);
+					if (distanceSquared < bestDistanceSquared && dot(old.normal, cached.normal) > CONTACT_CACHE_MIN_NORMAL_DOT)
+					{
+						bestDistanceSquared = distanceSquared;
+						cached.impulse = old.impulse;
+					}
+				}
+
+				numMatchedContacts += (bestDistanceSquared < maxDistanceSquared);
 			}
-		}
 
-		if (collisionBeginCallback)
-		{
-			while (thisIterator != thisEnd)
+			outImpulses[j] = cached.impulse;
+			if (flipped)
 			{
-				beginEvent(*(thisIterator++));
+				outImpulses[j].tangentImpulse = -outImpulses[j].tangentImpulse;
 			}
 		}
+
+		contactOffset += numContactsInCollision;
 	}
 
-	context.prevFrameCollisions = std::move(collisions);
+	ASSERT(contactOffset == numContacts);
+
+	CPU_PROFILE_STAT("Num warm started contacts", numMatchedContacts);
+
+	return frame;
 }
 
-static void physicsStepInternal(escene& scene, eallocator& arena, const physics_settings& settings, float dt)
+// Writes the solved impulses of this frame into the cache. Manifolds between inactive colliders are not evaluated by the narrow phase,
+// so they are carried over from the last frame.
+static void updateContactCache(escene& scene, const contact_cache_frame& frame, const contact_impulse* solvedImpulses)
 {
-	CPU_PROFILE_BLOCK("Physics step");
+	CPU_PROFILE_BLOCK("Update contact cache");
 
-	uint32 numRigidBodies = scene.numberOfComponentsOfType<rigid_body_component>();
-	uint32 numCloths = scene.numberOfComponentsOfType<cloth_component>();
-	if (numRigidBodies == 0 && numCloths == 0)
-		return;
+	contact_cache_context& context = scene.createOrGetContextVariable<contact_cache_context>();
+
+	std::vector<cached_manifold> manifolds(frame.manifolds, frame.manifolds + frame.numCollisions);
+	std::vector<cached_contact> contacts(frame.contacts, frame.contacts + frame.numContacts);
+
+	for (uint32 i = 0; i < frame.numCollisions; ++i)
+	{
+		const cached_manifold& manifold = frame.manifolds[i];
+		bool flipped = frame.flippedPerCollision[i];
+
+		for (uint32 j = manifold.firstContact; j < manifold.firstContact + manifold.numContacts; ++j)
+		{
+			contacts[j].impulse = solvedImpulses[j];
+			if (flipped)
+			{
+				contacts[j].impulse.tangentImpulse = -contacts[j].impulse.tangentImpulse;
+			}
+		}
+	}
+
+	std::sort(manifolds.begin(), manifolds.end());
+
+	auto isInactive = [&scene](entity_handle colliderEntityHandle)
+	{
+		return colliderEntityHandle == entt::null || isColliderInactive(scene, colliderEntityHandle);
+	};
+
+	uint32 numManifoldsThisFrame = (uint32)manifolds.size();
+	for (const cached_manifold& old : context.manifolds)
+	{
+		if (!std::binary_search(manifolds.begin(), manifolds.begin() + numManifoldsThisFrame, old)
+			&& isInactive(old.colliders.a) && isInactive(old.colliders.b))
+		{
+			cached_manifold carried = old;
+			carried.firstContact = (uint32)contacts.size();
+			contacts.insert(contacts.end(), context.contacts.begin() + old.firstContact, context.contacts.begin() + old.firstContact + old.numContacts);
+			manifolds.push_back(carried);
+		}
+	}
+
+	// Both ranges are sorted.
+	std::inplace_merge(manifolds.begin(), manifolds.begin() + numManifoldsThisFrame, manifolds.end());
+
+	context.manifolds = std::move(manifolds);
+	context.contacts = std::move(contacts);
+}
+
+struct sleep_context
+{
+	uint32 nextSleepingIsland = 1; // 0 is reserved for awake bodies.
+};
+
+// The contexts carry state from one frame to the next, so they are part of physics snapshots.
+void writeSimulationContextSnapshot(escene& scene, physics_snapshot_writer& writer)
+{
+	contact_cache_context& contactCache = scene.createOrGetContextVariable<contact_cache_context>();
+	writer.writeArray(contactCache.manifolds.data(), (uint32)contactCache.manifolds.size());
+	writer.writeArray(contactCache.contacts.data(), (uint32)contactCache.contacts.size());
+
+	event_context& events = scene.createOrGetContextVariable<event_context>();
+	writer.writeArray(events.prevFrameTriggerOverlaps.data(), (uint32)events.prevFrameTriggerOverlaps.size());
+	writer.writeArray(events.prevFrameCollisions.data(), (uint32)events.prevFrameCollisions.size());
+
+	writer.write(scene.createOrGetContextVariable<sleep_context>());
+	writer.write(scene.createOrGetContextVariable<region_context>().stepIndex);
+}
+
+template <typename T>
+static bool readVector(physics_snapshot_reader& reader, std::vector<T>& out)
+{
+	uint32 count;
+	const T* src = reader.readArray<T>(count);
+	if (!src)
+	{
+		return false;
+	}
+	out.assign(src, src + count);
+	return true;
+}
+
+bool readSimulationContextSnapshot(escene& scene, physics_snapshot_reader& reader)
+{
+	contact_cache_context& contactCache = scene.createOrGetContextVariable<contact_cache_context>();
+	event_context& events = scene.createOrGetContextVariable<event_context>();
+	sleep_context& sleep = scene.createOrGetContextVariable<sleep_context>();
+	region_context& regions = scene.createOrGetContextVariable<region_context>();
+
+	return readVector(reader, contactCache.manifolds)
+		&& readVector(reader, contactCache.contacts)
+		&& readVector(reader, events.prevFrameTriggerOverlaps)
+		&& readVector(reader, events.prevFrameCollisions)
+		&& reader.read(sleep)
+		&& reader.read(regions.stepIndex);
+}
+
+// Wakes up sleeping islands, which are touched by external forces, force fields, awake bodies or moving kinematic bodies.
+// Writes the resulting sleep state of each body into outSleepingPerBody (numRigidBodies + 1 many, the dummy is never sleeping).
+static void wakeUpSleepingIslands(escene& scene, const collider_union* worldSpaceColliders, const collider_pair* overlaps, uint32 numOverlaps,
+	const constraint_body_pair* constraintBodyPairs, uint32 numConstraints, uint32 numRigidBodies, eallocator& arena, bool* outSleepingPerBody)
+{
+	CPU_PROFILE_BLOCK("Wake up sleeping islands");
+
+	memory_marker marker = arena.getMarker();
+
+	uint32 dummyRigidBodyIndex = numRigidBodies;
+
+	uint32* sleepingIslandPerBody = arena.allocate<uint32>(numRigidBodies + 1);
+	bool* activePerBody = arena.allocate<bool>(numRigidBodies + 1);
+
+	std::vector<uint32> wokenIslands;
+	uint32 numSleepingBodies = 0;
+
+	{
+		uint32 rbIndex = numRigidBodies - 1; // EnTT iterates back to front
+		for (auto [entityHandle, rb, transform] : scene.group<rigid_body_component, physics_transform1_component>().each())
+		{
+			uint32 index = rbIndex--;
+
+			bool kinematic = rb.invMass == 0.f;
+			bool moving = rb.linearVelocity != vec3(0.f) || rb.angularVelocity != vec3(0.f);
+
+			sleepingIslandPerBody[index] = rb.sleepingIsland;
+			activePerBody[index] = kinematic ? moving : !rb.isSleeping();
+
+			if (rb.isSleeping())
+			{
+				++numSleepingBodies;
+
+				if (rb.forceAccumulator != vec3(0.f) || rb.torqueAccumulator != vec3(0.f))
+				{
+					wokenIslands.push_back(rb.sleepingIsland);
+				}
+			}
+		}
+	}
+
+	sleepingIslandPerBody[dummyRigidBodyIndex] = 0;
+	activePerBody[dummyRigidBodyIndex] = false;
+
+	if (numSleepingBodies > 0)
+	{
+		auto wakeUpIfTouched = [sleepingIslandPerBody, activePerBody, &wokenIslands](uint32 rbA, uint32 rbB)
+		{
+			if (sleepingIslandPerBody[rbA] && activePerBody[rbB])
+			{
+				wokenIslands.push_back(sleepingIslandPerBody[rbA]);
+			}
+			if (sleepingIslandPerBody[rbB] && activePerBody[rbA])
+			{
+				wokenIslands.push_back(sleepingIslandPerBody[rbB]);
+			}
+		};
+
+		// Broad phase overlaps are a conservative estimate, so islands may wake up slightly before the actual contact.
+		for (uint32 i = 0; i < numOverlaps; ++i)
+		{
+			collider_pair pair = overlaps[i];
+			const collider_union& colliderA = worldSpaceColliders[pair.colliderA];
+			const collider_union& colliderB = worldSpaceColliders[pair.colliderB];
+
+			if (colliderA.objectType == physics_object_type_rigid_body && colliderB.objectType == physics_object_type_rigid_body)
+			{
+				wakeUpIfTouched(colliderA.objectIndex, colliderB.objectIndex);
+			}
+			else if (colliderA.objectType == physics_object_type_rigid_body && colliderB.objectType == physics_object_type_force_field
+				&& sleepingIslandPerBody[colliderA.objectIndex])
+			{
+				wokenIslands.push_back(sleepingIslandPerBody[colliderA.objectIndex]);
+			}
+			else if (colliderB.objectType == physics_object_type_rigid_body && colliderA.objectType == physics_object_type_force_field
+				&& sleepingIslandPerBody[colliderB.objectIndex])
+			{
+				wokenIslands.push_back(sleepingIslandPerBody[colliderB.objectIndex]);
+			}
+		}
+
+		for (uint32 i = 0; i < numConstraints; ++i)
+		{
+			constraint_body_pair pair = constraintBodyPairs[i];
+			wakeUpIfTouched(pair.rbA, pair.rbB);
+		}
+
+		if (!wokenIslands.empty())
+		{
+			std::sort(wokenIslands.begin(), wokenIslands.end());
+			wokenIslands.erase(std::unique(wokenIslands.begin(), wokenIslands.end()), wokenIslands.end());
+
+			uint32 rbIndex = numRigidBodies - 1; // EnTT iterates back to front
+			for (auto [entityHandle, rb, transform] : scene.group<rigid_body_component, physics_transform1_component>().each())
+			{
+				uint32 index = rbIndex--;
+
+				if (rb.isSleeping() && std::binary_search(wokenIslands.begin(), wokenIslands.end(), rb.sleepingIsland))
+				{
+					rb.wakeUp();
+					sleepingIslandPerBody[index] = 0;
+				}
+			}
+		}
+	}
+
+	for (uint32 i = 0; i < numRigidBodies + 1; ++i)
+	{
+		outSleepingPerBody[i] = sleepingIslandPerBody[i] != 0;
+	}
+
+	CPU_PROFILE_STAT("Num woken islands", (uint32)wokenIslands.size());
+
+	arena.resetToMarker(marker);
+}
+
+// Removes overlaps, in which both colliders are static or belong to sleeping rigid bodies. These can't generate any new contacts.
+static uint32 removeSleepingOverlaps(const collider_union* worldSpaceColliders, collider_pair* overlaps, uint32 numOverlaps, const bool* sleepingPerBody)
+{
+	CPU_PROFILE_BLOCK("Remove sleeping overlaps");
+
+	auto isInactive = [sleepingPerBody](const collider_union& collider)
+	{
+		return collider.objectType == physics_object_type_static_collider
+			|| (collider.objectType == physics_object_type_rigid_body && sleepingPerBody[collider.objectIndex]);
+	};
+
+	uint32 numRemainingOverlaps = 0;
+	for (uint32 i = 0; i < numOverlaps; ++i)
+	{
+		collider_pair pair = overlaps[i];
+		if (!isInactive(worldSpaceColliders[pair.colliderA]) || !isInactive(worldSpaceColliders[pair.colliderB]))
+		{
+			overlaps[numRemainingOverlaps++] = pair;
+		}
+	}
+
+	return numRemainingOverlaps;
+}
+
+struct pending_focus_points
+{
+	entt::registry* registry;
+	std::vector<vec3> points;
+};
+
+static std::vector<pending_focus_points> pendingFocusPoints;
+static std::mutex focusPointMutex;
+
+void setPhysicsFocusPoints(escene& scene, const vec3* points, uint32 count)
+{
+	std::lock_guard<std::mutex> lock(focusPointMutex);
+
+	auto it = std::find_if(pendingFocusPoints.begin(), pendingFocusPoints.end(), [&scene](const pending_focus_points& p) { return p.registry == &scene.registry; });
+	if (it == pendingFocusPoints.end())
+	{
+		it = pendingFocusPoints.insert(pendingFocusPoints.end(), { &scene.registry, {} });
+	}
+	it->points.assign(points, points + count);
+}
+
+// Called at the beginning of each step, on the thread running the step.
+static void applyPendingFocusPoints(escene& scene, region_context& context)
+{
+	std::lock_guard<std::mutex> lock(focusPointMutex);
+
+	auto it = std::find_if(pendingFocusPoints.begin(), pendingFocusPoints.end(), [&scene](const pending_focus_points& p) { return p.registry == &scene.registry; });
+	if (it != pendingFocusPoints.end())
+	{
+		context.focusPoints = std::move(it->points);
+		pendingFocusPoints.erase(it);
+	}
+}
+
+static physics_activity_level getActivityLevel(const std::vector<vec3>& focusPoints, const physics_settings& settings, vec3 position)
+{
+	if (focusPoints.empty())
+	{
+		return physics_activity_full;
+	}
+
+	// Distance to the cell instead of the position, so that all bodies in a cell share the same level.
+	vec3 cellMin = floor(position / settings.regionCellSize) * settings.regionCellSize;
+	vec3 cellMax = cellMin + vec3(settings.regionCellSize);
+
+	float minDistanceSquared = FLT_MAX;
+	for (vec3 p : focusPoints)
+	{
+		vec3 d = max(max(cellMin - p, p - cellMax), vec3(0.f));
+		minDistanceSquared = min(minDistanceSquared, squaredLength(d));
+	}
+
+	if (minDistanceSquared <= settings.fullRateDistance * settings.fullRateDistance)
+	{
+		return physics_activity_full;
+	}
+	if (minDistanceSquared <= settings.reducedRateDistance * settings.reducedRateDistance)
+	{
+		return physics_activity_reduced;
+	}
+	return physics_activity_frozen;
+}
+
+physics_activity_level getPhysicsActivityLevel(escene& scene, const physics_settings& settings, vec3 position)
+{
+	if (!settings.enableRegions)
+	{
+		return physics_activity_full;
+	}
+	return getActivityLevel(scene.createOrGetContextVariable<region_context>().focusPoints, settings, position);
+}
+
+// A reduced-rate body is at the state of the beginning of the current interval, which lags up to divisor - 1 steps behind the rest of the world.
+// When it is promoted to full rate, it continues from there, so it only loses these steps instead of jumping. Its displayed transform continues 
+// from where the reduced-rate interpolation showed it at the beginning of the frame.
+static void promoteReducedRateBody(rigid_body_component& rb, physics_transform0_component& transform0, const physics_transform1_component& transform1,
+	const region_context& context)
+{
+	ASSERT(rb.activityLevel == physics_activity_reduced);
+
+	uint32 intervalStartStepIndex = context.stepIndex - context.stepIndex % context.divisor;
+	float t = 0.f;
+	if (context.frameStartStepIndex > intervalStartStepIndex)
+	{
+		t = (float)(context.frameStartStepIndex - intervalStartStepIndex) / (float)context.divisor;
+	}
+	transform0 = lerp(transform0, transform1, t);
+
+	rb.activityLevel = physics_activity_full;
+}
+
+// Assigns the activity level of their cell to all rigid bodies. Bodies only enter the reduced rate at the beginning of an interval, since the 
+// reduced-rate step at its end covers the whole interval.
+static void classifyRegionBodies(escene& scene, const physics_settings& settings, const region_context& context)
+{
+	CPU_PROFILE_BLOCK("Classify region bodies");
+
+	bool intervalStart = (context.stepIndex % context.divisor) == 0;
+
+	uint32 numBodiesPerLevel[3] = {};
+	for (auto [entityHandle, rb, transform0, transform1] : scene.view<rigid_body_component, physics_transform0_component, physics_transform1_component>().each())
+	{
+		physics_activity_level level = getActivityLevel(context.focusPoints, settings, rb.getGlobalCOGPosition(transform1));
+		if (level == physics_activity_reduced && rb.activityLevel != physics_activity_reduced)
+		{
+			if (intervalStart)
+			{
+				// Held in place until the reduced-rate step at the end of the interval.
+				transform0 = transform1;
+				rb.activityLevel = level;
+			}
+		}
+		else if (level == physics_activity_full && rb.activityLevel == physics_activity_reduced)
+		{
+			promoteReducedRateBody(rb, transform0, transform1, context);
+		}
+		else
+		{
+			rb.activityLevel = level;
+		}
+		++numBodiesPerLevel[rb.activityLevel];
+	}
+
+	CPU_PROFILE_STAT("Num full-rate bodies", numBodiesPerLevel[physics_activity_full]);
+	CPU_PROFILE_STAT("Num reduced-rate bodies", numBodiesPerLevel[physics_activity_reduced]);
+	CPU_PROFILE_STAT("Num frozen bodies", numBodiesPerLevel[physics_activity_frozen]);
+}
+
+// Marks all bodies, which are not simulated in this region pass, in inOutSleepingPerBody. They take part as static geometry, like sleeping bodies.
+// In the full-rate pass, bodies with external forces and bodies touching or constrained to an awake full-rate body are promoted to full rate first.
+// This cascades through stacks and chains, so interactions across cell boundaries are always resolved at full rate.
+static void selectRegionPassBodies(escene& scene, physics_activity_level pass, const collider_union* worldSpaceColliders, const collider_pair* overlaps, uint32 numOverlaps,
+	const constraint_body_pair* constraintBodyPairs, uint32 numConstraints, uint32 numRigidBodies, eallocator& arena, bool* inOutSleepingPerBody)
+{
+	CPU_PROFILE_BLOCK("Select region pass bodies");
+
+	const region_context& context = scene.createOrGetContextVariable<region_context>();
+
+	memory_marker marker = arena.getMarker();
+
+	uint32 dummyRigidBodyIndex = numRigidBodies;
+
+	physics_activity_level* levelPerBody = arena.allocate<physics_activity_level>(numRigidBodies);
+
+	uint32 rbIndex = numRigidBodies - 1; // EnTT iterates back to front
+	for (auto [entityHandle, rb, transform] : scene.group<rigid_body_component, physics_transform1_component>().each())
+	{
+		uint32 index = rbIndex--;
+
+		// Forces are given per step, so they must not accumulate over the steps of a reduced-rate body.
+		bool hasForces = rb.forceAccumulator != vec3(0.f) || rb.torqueAccumulator != vec3(0.f);
+		levelPerBody[index] = (pass == physics_activity_full && hasForces) ? physics_activity_full : rb.activityLevel;
+	}
+
+	uint32 numPromotedBodies = 0;
+
+	if (pass == physics_activity_full)
+	{
+		auto promoteIfTouched = [levelPerBody, inOutSleepingPerBody, dummyRigidBodyIndex, &numPromotedBodies](uint32 rbA, uint32 rbB)
+		{
+			if (rbA == dummyRigidBodyIndex || rbB == dummyRigidBodyIndex)
+			{
+				return false;
+			}
+
+			bool activeA = levelPerBody[rbA] == physics_activity_full && !inOutSleepingPerBody[rbA];
+			bool activeB = levelPerBody[rbB] == physics_activity_full && !inOutSleepingPerBody[rbB];
+			if (activeA == activeB)
+			{
+				return false;
+			}
+
+			uint32 other = activeA ? rbB : rbA;
+			if (levelPerBody[other] == physics_activity_full)
+			{
+				return false; // Sleeping.
+			}
+
+			levelPerBody[other] = physics_activity_full;
+			++numPromotedBodies;
+			return true;
+		};
+
+		bool changed = true;
+		while (changed)
+		{
+			changed = false;
+
+			for (uint32 i = 0; i < numOverlaps; ++i)
+			{
+				collider_pair pair = overlaps[i];
+				const collider_union& colliderA = worldSpaceColliders[pair.colliderA];
+				const collider_union& colliderB = worldSpaceColliders[pair.colliderB];
+
+				if (colliderA.objectType == physics_object_type_rigid_body && colliderB.objectType == physics_object_type_rigid_body)
+				{
+					changed |= promoteIfTouched(colliderA.objectIndex, colliderB.objectIndex);
+				}
+			}
+
+			for (uint32 i = 0; i < numConstraints; ++i)
+			{
+				constraint_body_pair pair = constraintBodyPairs[i];
+				changed |= promoteIfTouched(pair.rbA, pair.rbB);
+			}
+		}
+	}
+
+	uint32 numBodiesInPass = 0;
+
+	rbIndex = numRigidBodies - 1; // EnTT iterates back to front
+	for (auto [entityHandle, rb, transform] : scene.group<rigid_body_component, physics_transform1_component>().each())
+	{
+		uint32 index = rbIndex--;
+
+		if (rb.activityLevel == physics_activity_reduced && levelPerBody[index] == physics_activity_full)
+		{
+			eentity entity = { entityHandle, scene };
+			promoteReducedRateBody(rb, entity.getComponent<physics_transform0_component>(), transform, context);
+		}
+		rb.activityLevel = levelPerBody[index];
+		if (rb.activityLevel != pass)
+		{
+			inOutSleepingPerBody[index] = true;
+		}
+		else
+		{
+			++numBodiesInPass;
+		}
+	}
+
+	CPU_PROFILE_STAT("Num bodies promoted to full rate", numPromotedBodies);
+	CPU_PROFILE_STAT("Num bodies in region pass", numBodiesInPass);
+
+	arena.resetToMarker(marker);
+}
+
+// Updates the sleep timers of all awake bodies and puts islands to sleep, in which all bodies have been at rest for long enough.
+// Bodies marked in sleepingPerBody (sleeping or outside of the current region pass) are treated as static.
+static void putRestingIslandsToSleep(escene& scene, const constraint_body_pair* bodyPairs, uint32 numBodyPairs, uint32 numRigidBodies, const bool* sleepingPerBody,
+	eallocator& arena, const physics_settings& settings, float dt)
+{
+	CPU_PROFILE_BLOCK("Put resting islands to sleep");
+
+	memory_marker marker = arena.getMarker();
+
+	uint32 dummyRigidBodyIndex = numRigidBodies;
+
+	bool* isStatic = arena.allocate<bool>(numRigidBodies + 1);
+	float* sleepTimerPerBody = arena.allocate<float>(numRigidBodies);
+
+	const float linearThresholdSquared = settings.sleepLinearVelocityThreshold * settings.sleepLinearVelocityThreshold;
+	const float angularThresholdSquared = settings.sleepAngularVelocityThreshold * settings.sleepAngularVelocityThreshold;
+
+	uint32 rbIndex = numRigidBodies - 1; // EnTT iterates back to front
+	for (auto [entityHandle, rb, transform] : scene.group<rigid_body_component, physics_transform1_component>().each())
+	{
+		uint32 index = rbIndex--;
+
+		// Kinematic, already sleeping and currently not simulated bodies don't connect islands.
+		isStatic[index] = rb.invMass == 0.f || sleepingPerBody[index];
+
+		if (!isStatic[index])
+		{
+			bool resting = squaredLength(rb.linearVelocity) < linearThresholdSquared && squaredLength(rb.angularVelocity) < angularThresholdSquared;
+			rb.sleepTimer = resting ? (rb.sleepTimer + dt) : 0.f;
+		}
+
+		sleepTimerPerBody[index] = rb.sleepTimer;
+	}
+
+	isStatic[dummyRigidBodyIndex] = true;
+
+	island_description islands = buildIslands(arena, bodyPairs, numBodyPairs, numRigidBodies, (uint16)dummyRigidBodyIndex, isStatic);
+
+	bool* islandCanSleep = arena.allocate<bool>(islands.numIslands);
+	for (uint32 i = 0; i < islands.numIslands; ++i)
+	{
+		islandCanSleep[i] = true;
+	}
+
+	for (uint32 i = 0; i < numRigidBodies; ++i)
+	{
+		uint16 island = islands.islandPerBody[i];
+		if (island != INVALID_ISLAND_INDEX)
+		{
+			islandCanSleep[island] &= sleepTimerPerBody[i] >= settings.timeToSleep;
+		}
+	}
+
+	sleep_context& context = scene.createOrGetContextVariable<sleep_context>();
+
+	uint32* sleepingIslandPerIsland = arena.allocate<uint32>(islands.numIslands);
+	uint32 numFallingAsleep = 0;
+	for (uint32 i = 0; i < islands.numIslands; ++i)
+	{
+		if (islandCanSleep[i])
+		{
+			if (context.nextSleepingIsland == 0)
+			{
+				context.nextSleepingIsland = 1;
+			}
+			sleepingIslandPerIsland[i] = context.nextSleepingIsland++;
+			++numFallingAsleep;
+		}
+	}
+
+	if (numFallingAsleep > 0)
+	{
+		rbIndex = numRigidBodies - 1; // EnTT iterates back to front
+		for (auto [entityHandle, rb, transform] : scene.group<rigid_body_component, physics_transform1_component>().each())
+		{
+			uint16 island = islands.islandPerBody[rbIndex--];
+			if (island != INVALID_ISLAND_INDEX && islandCanSleep[island])
+			{
+				rb.sleepingIsland = sleepingIslandPerIsland[island];
+				rb.linearVelocity = vec3(0.f);
+				rb.angularVelocity = vec3(0.f);
+			}
+		}
+	}
+
+	CPU_PROFILE_STAT("Num islands", islands.numIslands);
+	CPU_PROFILE_STAT("Num islands falling asleep", numFallingAsleep);
+
+	arena.resetToMarker(marker);
+}
+
+struct ccd_state
+{
+	vec3* motionPerCollider; // Linear motion of each collider during this step. Zero for colliders without a rigid body.
+	bool* sweptPerCollider;
+	uint32 numSweptColliders;
+};
+
+// Grows the bounding boxes of fast moving colliders along their motion, so that the broad phase finds everything in their path.
+static ccd_state sweepFastColliders(escene& scene, const collider_union* worldSpaceColliders, bounding_box* worldSpaceAABBs, uint32 numColliders, uint32 numRigidBodies,
+	eallocator& arena, const physics_settings& settings, float dt)
+{
+	CPU_PROFILE_BLOCK("Sweep fast colliders");
+
+	ccd_state result;
+	result.motionPerCollider = arena.allocate<vec3>(numColliders);
+	result.sweptPerCollider = arena.allocate<bool>(numColliders, true);
+	result.numSweptColliders = 0;
+
+	for (uint32 i = 0; i < numColliders; ++i)
+	{
+		result.motionPerCollider[i] = vec3(0.f);
+
+		const collider_union& collider = worldSpaceColliders[i];
+		if (collider.objectType != physics_object_type_rigid_body)
+		{
+			continue;
+		}
+
+		const rigid_body_component& rb = scene.getComponentAtIndex<rigid_body_component>(numRigidBodies - 1 - collider.objectIndex);
+		if (rb.isSleeping())
+		{
+			continue;
+		}
+
+		vec3 motion = rb.linearVelocity * dt;
+		result.motionPerCollider[i] = motion;
+
+		bounding_box& aabb = worldSpaceAABBs[i];
+		vec3 radius = aabb.getRadius();
+		float threshold = settings.ccdMotionThreshold * min(radius.x, min(radius.y, radius.z));
+
+		if (rb.continuousCollision || squaredLength(motion) > threshold * threshold)
+		{
+			aabb.grow(aabb.minCorner + motion);
+			aabb.grow(aabb.maxCorner + motion);
+			result.sweptPerCollider[i] = true;
+			++result.numSweptColliders;
+		}
+	}
+
+	return result;
+}
+
+// Must be called before the narrow phase, since the narrow phase overwrites the overlap buffer.
+static uint32 getSpeculativeContactCandidates(const collider_union* worldSpaceColliders, const collider_pair* overlaps, uint32 numOverlaps, const ccd_state& ccd,
+	collider_pair* outCandidates)
+{
+	uint32 numCandidates = 0;
+	for (uint32 i = 0; i < numOverlaps; ++i)
+	{
+		collider_pair pair = overlaps[i];
+		if (!ccd.sweptPerCollider[pair.colliderA] && !ccd.sweptPerCollider[pair.colliderB])
+		{
+			continue;
+		}
+
+		physics_object_type typeA = worldSpaceColliders[pair.colliderA].objectType;
+		physics_object_type typeB = worldSpaceColliders[pair.colliderB].objectType;
+		bool solidA = typeA == physics_object_type_rigid_body || typeA == physics_object_type_static_collider;
+		bool solidB = typeB == physics_object_type_rigid_body || typeB == physics_object_type_static_collider;
+
+		if (solidA && solidB)
+		{
+			outCandidates[numCandidates++] = pair;
+		}
+	}
+	return numCandidates;
+}
+
+static uint32 getColliderPairKey(collider_pair pair)
+{
+	uint32 a = min((uint32)pair.colliderA, (uint32)pair.colliderB);
+	uint32 b = max((uint32)pair.colliderA, (uint32)pair.colliderB);
+	return (a << 16) | b;
+}
+
+// Candidates, which didn't collide in the narrow phase, are swept against each other with their relative motion. If they touch during this step,
+// a contact with negative penetration depth (the separation along the normal) is generated. The solver lets the bodies approach until they touch.
+static uint32 addSpeculativeContacts(const collider_union* worldSpaceColliders, const collider_pair* candidates, uint32 numCandidates,
+	const collider_pair* collidingPairs, uint32 numCollisions, const ccd_state& ccd, eallocator& arena,
+	collision_contact* outContacts, constraint_body_pair* outBodyPairs)
+{
+	CPU_PROFILE_BLOCK("Speculative contacts");
+
+	memory_marker marker = arena.getMarker();
+
+	// Colliding pairs already got regular contacts from the narrow phase.
+	uint32* collidingKeys = arena.allocate<uint32>(numCollisions);
+	for (uint32 i = 0; i < numCollisions; ++i)
+	{
+		collidingKeys[i] = getColliderPairKey(collidingPairs[i]);
+	}
+	std::sort(collidingKeys, collidingKeys + numCollisions);
+
+	uint32 numContacts = 0;
+
+	for (uint32 i = 0; i < numCandidates; ++i)
+	{
+		collider_pair pair = candidates[i];
+		if (std::binary_search(collidingKeys, collidingKeys + numCollisions, getColliderPairKey(pair)))
+		{
+			continue;
+		}
+
+		vec3 relativeMotion = ccd.motionPerCollider[pair.colliderA] - ccd.motionPerCollider[pair.colliderB];
+		float distance = length(relativeMotion);
+		if (distance < 1e-5f)
+		{
+			continue;
+		}
+
+		vec3 direction = relativeMotion / distance;
+
+		const collider_union& colliderA = worldSpaceColliders[pair.colliderA];
+		const collider_union& colliderB = worldSpaceColliders[pair.colliderB];
+
+		gjk_raycast_result hit;
+		if (!sweepCollider(colliderA, colliderB, direction, distance, hit) || hit.distance <= 0.f)
+		{
+			continue;
+		}
+
+		vec3 normal = -hit.normal; // From A to B.
+		float separation = hit.distance * dot(direction, normal);
+
+		physics_material propsA = colliderA.material;
+		physics_material propsB = colliderB.material;
+
+		float friction = clamp01(sqrt(propsA.friction * propsB.friction));
+		float restitution = clamp01(max(propsA.restitution, propsB.restitution));
+
+		collision_contact& contact = outContacts[numContacts];
+		contact.point = hit.point;
+		contact.normal = normal;
+		contact.penetrationDepth = -separation;
+		contact.friction_restitution = ((uint32)(friction * 0xFFFF) << 16) | (uint32)(restitution * 0xFFFF);
+
+		outBodyPairs[numContacts] = { colliderA.objectIndex, colliderB.objectIndex };
+		++numContacts;
+	}
+
+	arena.resetToMarker(marker);
+
+	return numContacts;
+}
+
+// If regionPass is set, only the bodies of this activity level are simulated (see stepPhysicsRegions).
+static void physicsStepInternal(escene& scene, eallocator& arena, const physics_settings& settings, float dt, const physics_activity_level* regionPass = 0)
+{
+	CPU_PROFILE_BLOCK("Physics step");
+
+	uint32 numRigidBodies = scene.numberOfComponentsOfType<rigid_body_component>();
+	uint32 numCloths = scene.numberOfComponentsOfType<cloth_component>();
+	if (numRigidBodies == 0 && numCloths == 0)
+		return;
 
 	uint32 numForceFields = scene.numberOfComponentsOfType<force_field_component>();
 	uint32 numTriggers = scene.numberOfComponentsOfType<trigger_component>();
@@ -1212,16 +2467,68 @@ static void physicsStepInternal(escene& scene, eallocator& arena, const physics_
 	VALIDATE(worldSpaceColliders, numColliders);
 	VALIDATE(worldSpaceAABBs, numColliders);
 
+	// Vehicle wheels. Their forces are accumulated before the sleeping islands are determined, so that vehicles with input wake up.
+	applyRaycastVehicleForces(scene, arena, worldSpaceColliders, worldSpaceAABBs, numColliders, regionPass, dt);
+
+	// Continuous collision detection
+	ccd_state ccd = {};
+	if (settings.enableCCD)
+	{
+		ccd = sweepFastColliders(scene, worldSpaceColliders, worldSpaceAABBs, numColliders, numRigidBodies, arena, settings, dt);
+	}
+
 	// Broad phase
 	uint32 numBroadphaseOverlaps = broadphase(scene, worldSpaceAABBs, arena, overlappingColliderPairs, settings.simdBroadPhase);
 
-	non_collision_interaction* nonCollisionInteractions = arena.allocate<non_collision_interaction>(numBroadphaseOverlaps);
-	collision_contact* contacts = arena.allocate<collision_contact>(numBroadphaseOverlaps * 4 + 5000); // Each collision can have up to 4 contact points.
-	constraint_body_pair* allConstraintBodyPairs = arena.allocate<constraint_body_pair>(numConstraints + numBroadphaseOverlaps * 4 + 5000);
-	collider_pair* collidingColliderPairs = overlappingColliderPairs; // We reuse this buffer.
-	uint8* contactCountPerCollision = arena.allocate<uint8>(numColliders * numColliders + 5000);
+	non_collision_interaction* nonCollisionInteractions = arena.allocate<non_collision_interaction>(numBroadphaseOverlaps);
+	collision_contact* contacts = arena.allocate<collision_contact>(numBroadphaseOverlaps * 4 + 5000); // Each collision can have up to 4 contact points.
+	constraint_body_pair* allConstraintBodyPairs = arena.allocate<constraint_body_pair>(numConstraints + numBroadphaseOverlaps * 4 + 5000);
+	collider_pair* collidingColliderPairs = overlappingColliderPairs; // We reuse this buffer.
+	uint8* contactCountPerCollision = arena.allocate<uint8>(numColliders * numColliders + 5000);
+
+	constraint_body_pair* collisionBodyPairs = allConstraintBodyPairs + numConstraints;
+
+	constraint_body_pair* distanceConstraintBodyPairs = allConstraintBodyPairs + 0;
+	constraint_body_pair* ballConstraintBodyPairs = distanceConstraintBodyPairs + numDistanceConstraints;
+	constraint_body_pair* fixedConstraintBodyPairs = ballConstraintBodyPairs + numBallConstraints;
+	constraint_body_pair* hingeConstraintBodyPairs = fixedConstraintBodyPairs + numFixedConstraints;
+	constraint_body_pair* coneTwistConstraintBodyPairs = hingeConstraintBodyPairs + numHingeConstraints;
+	constraint_body_pair* sliderConstraintBodyPairs = coneTwistConstraintBodyPairs + numConeTwistConstraints;
+
+	getConstraintBodyPairs<distance_constraint>(scene, distanceConstraintBodyPairs);
+	getConstraintBodyPairs<ball_constraint>(scene, ballConstraintBodyPairs);
+	getConstraintBodyPairs<fixed_constraint>(scene, fixedConstraintBodyPairs);
+	getConstraintBodyPairs<hinge_constraint>(scene, hingeConstraintBodyPairs);
+	getConstraintBodyPairs<cone_twist_constraint>(scene, coneTwistConstraintBodyPairs);
+	getConstraintBodyPairs<slider_constraint>(scene, sliderConstraintBodyPairs);
+
+	// Sleeping. Articulations fall asleep and wake up as a whole.
+	// Bodies, which are not simulated in this region pass, are marked as sleeping as well. Both are treated as static geometry in this step.
+	wakeUpArticulations(scene);
+	bool* sleepingPerBody = arena.allocate<bool>(numRigidBodies + 1, true);
+	if (settings.enableSleeping)
+	{
+		wakeUpSleepingIslands(scene, worldSpaceColliders, overlappingColliderPairs, numBroadphaseOverlaps, allConstraintBodyPairs, numConstraints, 
+			numRigidBodies, arena, sleepingPerBody);
+	}
+	if (regionPass)
+	{
+		selectRegionPassBodies(scene, *regionPass, worldSpaceColliders, overlappingColliderPairs, numBroadphaseOverlaps, allConstraintBodyPairs, numConstraints,
+			numRigidBodies, arena, sleepingPerBody);
+	}
+	if (settings.enableSleeping || regionPass)
+	{
+		numBroadphaseOverlaps = removeSleepingOverlaps(worldSpaceColliders, overlappingColliderPairs, numBroadphaseOverlaps, sleepingPerBody);
+	}
 
-	constraint_body_pair* collisionBodyPairs = allConstraintBodyPairs + numConstraints;
+	collider_pair* speculativeContactCandidates = 0;
+	uint32 numSpeculativeContactCandidates = 0;
+	if (ccd.numSweptColliders > 0)
+	{
+		speculativeContactCandidates = arena.allocate<collider_pair>(numBroadphaseOverlaps);
+		numSpeculativeContactCandidates = getSpeculativeContactCandidates(worldSpaceColliders, overlappingColliderPairs, numBroadphaseOverlaps, ccd,
+			speculativeContactCandidates);
+	}
 
 	// Narrow phase
 	narrowphase_result narrowPhaseResult = narrowphase(worldSpaceColliders, overlappingColliderPairs, numBroadphaseOverlaps, arena,
@@ -1230,17 +2537,26 @@ static void physicsStepInternal(escene& scene, eallocator& arena, const physics_
 	// Heightmap collisions
 	for (auto [entityHandle, heightmap] : scene.view<heightmap_collider_component>().each())
 	{
-		narrowphase_result heightmapCollisionResult = heightmapCollision(heightmap, worldSpaceColliders, worldSpaceAABBs, numColliders,
+		narrowphase_result heightmapCollisionResult = heightmapCollision(heightmap, worldSpaceColliders, worldSpaceAABBs, numColliders, arena,
 			contacts + narrowPhaseResult.numContacts, collisionBodyPairs + narrowPhaseResult.numContacts,
 			collidingColliderPairs + narrowPhaseResult.numCollisions, contactCountPerCollision + narrowPhaseResult.numCollisions,
-			arena, (uint16)dummyRigidBodyIndex);
+			sleepingPerBody, (uint16)dummyRigidBodyIndex);
 
 		narrowPhaseResult.numCollisions += heightmapCollisionResult.numCollisions;
 		narrowPhaseResult.numContacts += heightmapCollisionResult.numContacts;
 		narrowPhaseResult.numNonCollisionInteractions += heightmapCollisionResult.numNonCollisionInteractions;
 	}
 
-	VALIDATE(contacts, narrowPhaseResult.numContacts);
+	// Speculative contacts are appended after the regular contacts. They don't belong to any collision, so they don't trigger callbacks and are not cached.
+	uint32 numSpeculativeContacts = 0;
+	if (numSpeculativeContactCandidates > 0)
+	{
+		numSpeculativeContacts = addSpeculativeContacts(worldSpaceColliders, speculativeContactCandidates, numSpeculativeContactCandidates,
+			collidingColliderPairs, narrowPhaseResult.numCollisions, ccd, arena,
+			contacts + narrowPhaseResult.numContacts, collisionBodyPairs + narrowPhaseResult.numContacts);
+	}
+
+	VALIDATE(contacts, narrowPhaseResult.numContacts + numSpeculativeContacts);
 
 	vec3 globalForceField = getForceFieldStates(scene, ffGlobal);
 
@@ -1252,30 +2568,23 @@ static void physicsStepInternal(escene& scene, eallocator& arena, const physics_
 	CPU_PROFILE_STAT("Num broadphase overlaps", numBroadphaseOverlaps);
 	CPU_PROFILE_STAT("Num narrowphase collisions", narrowPhaseResult.numCollisions);
 	CPU_PROFILE_STAT("Num narrowphase contacts", narrowPhaseResult.numContacts);
+	CPU_PROFILE_STAT("Num speculative contacts", numSpeculativeContacts);
 
-	//  Apply global forces (including gravity) and air drag and integrate forces
-	{
-		CPU_PROFILE_BLOCK("Integrate rigid body forces");
+	// Articulations integrate their forces in joint space and only hand the resulting velocities to the rigid bodies.
+	articulation_step* articulationStep = integrateArticulationForces(scene, arena, sleepingPerBody, globalForceField, dt);
 
-		uint32 rbIndex = numRigidBodies - 1; // EnTT iterates back to front
-		for (auto [entityHandle, rb, transform] : scene.group<rigid_body_component, physics_transform1_component>().each())
-		{
-			rigid_body_global_state& global = rbGlobal[rbIndex--];
-			rb.forceAccumulator += globalForceField;
-			rb.applyGravityAndIntegrateForces(global, transform, dt);
-		}
-	}
+	//  Apply global forces (including gravity) and air drag and integrate forces
+	integrateRigidBodyForces(scene, rbGlobal, sleepingPerBody, numRigidBodies, globalForceField, dt);
 
 	// Kinematic rigid body. This is used in collision constraint solving, when a collider has no rigid body.
 	memset(&rbGlobal[dummyRigidBodyIndex], 0, sizeof(rigid_body_global_state));
 
 	VALIDATE(rbGlobal, numRigidBodies);
 
-	handleCollisionCallbacks(scene, collidingColliderPairs, contactCountPerCollision, narrowPhaseResult.numCollisions, numColliders, contacts, rbGlobal, dummyRigidBodyIndex,
-		settings.collisionBeginCallback, settings.collisionEndCallback);
+	emitCollisionEvents(scene, collidingColliderPairs, contactCountPerCollision, narrowPhaseResult.numCollisions, numColliders, contacts, rbGlobal, dummyRigidBodyIndex);
 
 	// Collect constraints
-	uint32 numContacts = narrowPhaseResult.numContacts;
+	uint32 numContacts = narrowPhaseResult.numContacts + numSpeculativeContacts;
 
 	distance_constraint* distanceConstraints = scene.raw<distance_constraint>();
 	ball_constraint* ballConstraints = scene.raw<ball_constraint>();
@@ -1284,19 +2593,16 @@ static void physicsStepInternal(escene& scene, eallocator& arena, const physics_
 	cone_twist_constraint* coneTwistConstraints = scene.raw<cone_twist_constraint>();
 	slider_constraint* sliderConstraints = scene.raw<slider_constraint>();
 
-	constraint_body_pair* distanceConstraintBodyPairs = allConstraintBodyPairs + 0;
-	constraint_body_pair* ballConstraintBodyPairs = distanceConstraintBodyPairs + numDistanceConstraints;
-	constraint_body_pair* fixedConstraintBodyPairs = ballConstraintBodyPairs + numBallConstraints;
-	constraint_body_pair* hingeConstraintBodyPairs = fixedConstraintBodyPairs + numFixedConstraints;
-	constraint_body_pair* coneTwistConstraintBodyPairs = hingeConstraintBodyPairs + numHingeConstraints;
-	constraint_body_pair* sliderConstraintBodyPairs = coneTwistConstraintBodyPairs + numConeTwistConstraints;
-
-	getConstraintBodyPairs<distance_constraint>(scene, distanceConstraintBodyPairs);
-	getConstraintBodyPairs<ball_constraint>(scene, ballConstraintBodyPairs);
-	getConstraintBodyPairs<fixed_constraint>(scene, fixedConstraintBodyPairs);
-	getConstraintBodyPairs<hinge_constraint>(scene, hingeConstraintBodyPairs);
-	getConstraintBodyPairs<cone_twist_constraint>(scene, coneTwistConstraintBodyPairs);
-	getConstraintBodyPairs<slider_constraint>(scene, sliderConstraintBodyPairs);
+	// Warm starting
+	contact_impulse* contactImpulses = 0;
+	contact_cache_frame contactCacheFrame;
+	if (settings.warmStartCollisions)
+	{
+		contactImpulses = arena.allocate<contact_impulse>(numContacts);
+		contactCacheFrame = getCachedContactImpulses(scene, arena, collidingColliderPairs, contactCountPerCollision, narrowPhaseResult.numCollisions, numColliders,
+			contacts, collisionBodyPairs, narrowPhaseResult.numContacts, rbGlobal, dummyRigidBodyIndex, contactImpulses);
+		memset(contactImpulses + narrowPhaseResult.numContacts, 0, sizeof(contact_impulse) * numSpeculativeContacts);
+	}
 
 	// Solve constraints
 	constraint_solver constraintSolver;
@@ -1307,8 +2613,8 @@ static void physicsStepInternal(escene& scene, eallocator& arena, const physics_
 		hingeConstraints, hingeConstraintBodyPairs, numHingeConstraints,
 		coneTwistConstraints, coneTwistConstraintBodyPairs, numConeTwistConstraints,
 		sliderConstraints, sliderConstraintBodyPairs, numSliderConstraints,
-		contacts, collisionBodyPairs, numContacts,
-		dummyRigidBodyIndex, settings.simdConstraintSolver, dt);
+		contacts, collisionBodyPairs, numContacts, contactImpulses,
+		dummyRigidBodyIndex, settings.simdConstraintSolver, settings.parallelConstraintSolver, dt);
 
 	{
 		CPU_PROFILE_BLOCK("Solve constraints");
@@ -1319,74 +2625,461 @@ static void physicsStepInternal(escene& scene, eallocator& arena, const physics_
 		}
 	}
 
+	if (settings.warmStartCollisions)
+	{
+		constraintSolver.getContactImpulses(contactImpulses);
+		updateContactCache(scene, contactCacheFrame, contactImpulses);
+	}
+
 	// Integrate velocities
+	integrateRigidBodyVelocities(scene, rbGlobal, sleepingPerBody, numRigidBodies, dt);
+
+	integrateArticulationVelocities(scene, articulationStep, dt);
+
+	VALIDATE(rbGlobal, numRigidBodies);
+
+	if (settings.enableSleeping)
 	{
-		CPU_PROFILE_BLOCK("Integrate rigid body velocities");
+		putRestingIslandsToSleep(scene, allConstraintBodyPairs, numConstraints + numContacts, numRigidBodies, sleepingPerBody, arena, settings, dt);
+	}
 
-		uint32 rbIndex = numRigidBodies - 1; // EnTT iterates back to front
-		for (auto [entityHandle, rb, transform] : scene.group<rigid_body_component, physics_transform1_component>().each())
+	// Cloth. This needs to get integrated with the rest of the system.
+	// The cloths are independent of each other, so they are simulated in parallel. They are not affected by the simulation regions.
+	if (numCloths > 0 && (!regionPass || *regionPass == physics_activity_full))
+	{
+		cloth_component** cloths = arena.allocate<cloth_component*>(numCloths);
+		uint32 clothIndex = 0;
+		for (auto [entityHandle, cloth] : scene.view<cloth_component>().each())
 		{
-			rigid_body_global_state& global = rbGlobal[rbIndex--];
+			cloths[clothIndex++] = &cloth;
+		}
 
-			rb.integrateVelocity(global, transform, dt);
+		// Cloths collide with the colliders as they were at the beginning of the step.
+		scene_query_context clothColliders = buildSceneQueryContext(scene, arena, worldSpaceColliders, worldSpaceAABBs, numColliders);
+
+		uint32 numHeightmaps = scene.numberOfComponentsOfType<heightmap_collider_component>();
+		const heightmap_collider_component** heightmaps = arena.allocate<const heightmap_collider_component*>(numHeightmaps);
+		uint32 heightmapIndex = 0;
+		for (auto [entityHandle, heightmap] : scene.view<heightmap_collider_component>().each())
+		{
+			heightmaps[heightmapIndex++] = &heightmap;
 		}
+
+		cloth_collision_context clothCollisionContext = { &clothColliders, heightmaps, numHeightmaps };
+
+		parallelFor(highPriorityJobQueue, numCloths, 1, [cloths, globalForceField, &clothCollisionContext, &settings, dt](uint32 begin, uint32 end)
+		{
+			for (uint32 i = begin; i < end; ++i)
+			{
+				cloths[i]->applyWindForce(globalForceField);
+				cloths[i]->simulate(settings.numClothVelocityIterations, settings.numClothPositionIterations, settings.numClothDriftIterations, dt,
+					&clothCollisionContext);
+			}
+		});
 	}
 
-	VALIDATE(rbGlobal, numRigidBodies);
+	arena.resetToMarker(marker);
+}
 
-	// Cloth. This needs to get integrated with the rest of the system
+enum physics_command_type
+{
+	physics_command_force,
+	physics_command_force_at_point,
+	physics_command_torque,
+	physics_command_impulse,
+	physics_command_impulse_at_point,
+};
 
-	for (auto [entityHandle, cloth] : scene.view<cloth_component>().each())
+struct physics_command
+{
+	entt::registry* registry;
+	entity_handle entity;
+	physics_command_type type;
+	vec3 value;
+	vec3 point;
+};
+
+static std::vector<physics_command> physicsCommands;
+static std::vector<physics_command> physicsCommandsToApply;
+static std::mutex physicsCommandMutex;
+
+static void queuePhysicsCommand(escene& scene, entity_handle entity, physics_command_type type, vec3 value, vec3 point = vec3(0.f))
+{
+	std::lock_guard<std::mutex> lock(physicsCommandMutex);
+	physicsCommands.push_back({ &scene.registry, entity, type, value, point });
+}
+
+void queueForce(escene& scene, entity_handle entity, vec3 force) { queuePhysicsCommand(scene, entity, physics_command_force, force); }
+void queueForceAtPoint(escene& scene, entity_handle entity, vec3 force, vec3 point) { queuePhysicsCommand(scene, entity, physics_command_force_at_point, force, point); }
+void queueTorque(escene& scene, entity_handle entity, vec3 torque) { queuePhysicsCommand(scene, entity, physics_command_torque, torque); }
+void queueImpulse(escene& scene, entity_handle entity, vec3 impulse) { queuePhysicsCommand(scene, entity, physics_command_impulse, impulse); }
+void queueImpulseAtPoint(escene& scene, entity_handle entity, vec3 impulse, vec3 point) { queuePhysicsCommand(scene, entity, physics_command_impulse_at_point, impulse, point); }
+
+// Called at the beginning of each step, on the thread running the step. Commands for other scenes stay in the queue.
+static void applyQueuedPhysicsCommands(escene& scene)
+{
 	{
-		cloth.applyWindForce(globalForceField);
-		cloth.simulate(settings.numClothVelocityIterations, settings.numClothPositionIterations, settings.numClothDriftIterations, dt);
+		std::lock_guard<std::mutex> lock(physicsCommandMutex);
+		if (physicsCommands.empty())
+		{
+			return;
+		}
+
+		physicsCommandsToApply.clear();
+		auto it = std::partition(physicsCommands.begin(), physicsCommands.end(), [&scene](const physics_command& c) { return c.registry != &scene.registry; });
+		physicsCommandsToApply.insert(physicsCommandsToApply.end(), it, physicsCommands.end());
+		physicsCommands.erase(it, physicsCommands.end());
 	}
 
-	arena.resetToMarker(marker);
+	for (const physics_command& command : physicsCommandsToApply)
+	{
+		eentity entity = { command.entity, scene };
+		if (!entity.valid())
+		{
+			continue;
+		}
+
+		rigid_body_component* rb = entity.getComponentIfExists<rigid_body_component>();
+		physics_transform1_component* transform = entity.getComponentIfExists<physics_transform1_component>();
+		if (!rb || !transform)
+		{
+			continue;
+		}
+
+		rb->wakeUp();
+
+		vec3 r = command.point - rb->getGlobalCOGPosition(*transform);
+
+		switch (command.type)
+		{
+			case physics_command_force:
+			{
+				rb->forceAccumulator += command.value;
+			} break;
+
+			case physics_command_force_at_point:
+			{
+				rb->forceAccumulator += command.value;
+				rb->torqueAccumulator += cross(r, command.value);
+			} break;
+
+			case physics_command_torque:
+			{
+				rb->torqueAccumulator += command.value;
+			} break;
+
+			case physics_command_impulse:
+			{
+				rb->linearVelocity += command.value * rb->invMass;
+			} break;
+
+			case physics_command_impulse_at_point:
+			{
+				mat3 rot = quaternionToMat3(transform->rotation);
+				mat3 invInertia = rot * rb->invInertia * transpose(rot);
+
+				rb->linearVelocity += command.value * rb->invMass;
+				rb->angularVelocity += invInertia * cross(r, command.value);
+			} break;
+		}
+	}
 }
 
-void physicsStep(escene& scene, eallocator& arena, float& timer, const physics_settings& settings, float dt)
+static void publishClothRenderPositions(escene& scene)
 {
-	if (settings.fixedFrameRate)
+	for (auto [entityHandle, cloth] : scene.view<cloth_component>().each())
 	{
-		const float physicsFixedTimeStep = 1.f / (float)settings.frameRate;
-		const uint32 maxPhysicsIterationsPerFrame = settings.maxPhysicsIterationsPerFrame;
+		cloth.publishRenderPositions();
+	}
+}
+
+// Consumes up to maxPhysicsIterationsPerFrame fixed steps from the timer. Returns the number of steps to simulate.
+static uint32 advancePhysicsTimer(float& timer, const physics_settings& settings, float dt)
+{
+	const float physicsFixedTimeStep = 1.f / (float)settings.frameRate;
+
+	timer += dt;
+	uint32 numSteps = 0;
+	while (timer >= physicsFixedTimeStep && numSteps < settings.maxPhysicsIterationsPerFrame)
+	{
+		timer -= physicsFixedTimeStep;
+		++numSteps;
+	}
+
+	if (timer >= physicsFixedTimeStep)
+	{
+		timer = fmod(timer, physicsFixedTimeStep);
+
+#ifndef PHYSICS_ONLY
+		LOG_WARNING("Dropping physics frames");
+#endif
+	}
+
+	return numSteps;
+}
+
+// One fixed step with simulation regions. Full-rate bodies (including promoted ones) are stepped first. In the last step of every interval of 
+// reducedRateDivisor steps, the reduced-rate bodies are then stepped over the whole interval with the larger time step. They catch up with the rest 
+// of the world there and never run ahead of it, so a body promoted mid-interval continues from a past state (see promoteReducedRateBody). 
+// They are displayed one interval behind, interpolated between their last two states. Frozen bodies are not stepped at all.
+static void stepPhysicsRegions(escene& scene, eallocator& arena, const physics_settings& settings, float dt)
+{
+	region_context& context = scene.createOrGetContextVariable<region_context>();
+	applyPendingFocusPoints(scene, context);
+
+	uint32 divisor = max(settings.reducedRateDivisor, 1u);
+	context.divisor = divisor;
+	bool reducedRateStep = ((context.stepIndex + 1) % divisor) == 0;
+
+	classifyRegionBodies(scene, settings, context);
+
+	context.enabled = true;
+	context.currentPass = physics_activity_full;
+	physics_activity_level pass = physics_activity_full;
+	physicsStepInternal(scene, arena, settings, dt, &pass);
 
-		timer += dt;
-		uint32 physicsIterations = 0;
-		if (timer >= physicsFixedTimeStep)
+	if (reducedRateStep)
+	{
+		uint32 numReducedRateBodies = 0;
+		for (auto [entityHandle, rb, transform0, transform1] : scene.view<rigid_body_component, physics_transform0_component, physics_transform1_component>().each())
 		{
-			for (auto [entityHandle, transform0, transform1] : scene.group(component_group<physics_transform0_component, physics_transform1_component>).each())
+			if (rb.activityLevel == physics_activity_reduced)
 			{
 				transform0 = transform1;
+				++numReducedRateBodies;
 			}
+		}
+
+		if (numReducedRateBodies > 0)
+		{
+			context.currentPass = physics_activity_reduced;
+			pass = physics_activity_reduced;
+			physicsStepInternal(scene, arena, settings, dt * (float)divisor, &pass);
+		}
+	}
+
+	context.enabled = false;
+	context.currentPass = physics_activity_full;
+	++context.stepIndex;
+}
+
+static void runFixedPhysicsSteps(escene& scene, eallocator& arena, const physics_settings& settings, uint32 numSteps)
+{
+	if (numSteps == 0)
+	{
+		return;
+	}
+
+	const float physicsFixedTimeStep = 1.f / (float)settings.frameRate;
+
+	if (settings.enableRegions)
+	{
+		region_context& context = scene.createOrGetContextVariable<region_context>();
+		context.frameStartStepIndex = context.stepIndex;
 
-			while (timer >= physicsFixedTimeStep && physicsIterations++ < maxPhysicsIterationsPerFrame)
+		// Reduced-rate bodies keep the state before their last step, because they are interpolated over several steps.
+		for (auto [entityHandle, rb, transform0, transform1] : scene.view<rigid_body_component, physics_transform0_component, physics_transform1_component>().each())
+		{
+			if (rb.activityLevel != physics_activity_reduced)
 			{
-				physicsStepInternal(scene, arena, settings, physicsFixedTimeStep);
-				timer -= physicsFixedTimeStep;
+				transform0 = transform1;
 			}
 		}
+	}
+	else
+	{
+		for (auto [entityHandle, transform0, transform1] : scene.group(component_group<physics_transform0_component, physics_transform1_component>).each())
+		{
+			transform0 = transform1;
+		}
+	}
 
-		if (timer >= physicsFixedTimeStep)
+	for (uint32 i = 0; i < numSteps; ++i)
+	{
+		applyQueuedPhysicsCommands(scene);
+		if (settings.enableRegions)
+		{
+			stepPhysicsRegions(scene, arena, settings, physicsFixedTimeStep);
+		}
+		else
 		{
-			timer = fmod(timer, physicsFixedTimeStep);
+			physicsStepInternal(scene, arena, settings, physicsFixedTimeStep);
+		}
+	}
+}
 
-#ifndef PHYSICS_ONLY
-			LOG_WARNING("Dropping physics frames");
-#endif
+static void interpolatePhysicsTransforms(escene& scene, const physics_settings& settings, float physicsInterpolationT)
+{
+	ASSERT(physicsInterpolationT >= 0.f && physicsInterpolationT <= 1.f);
+
+	if (settings.enableRegions)
+	{
+		// Reduced-rate bodies were last stepped at the end of the previous interval of reducedRateDivisor steps and are displayed one interval behind.
+		const region_context& context = scene.createOrGetContextVariable<region_context>();
+		uint32 divisor = max(settings.reducedRateDivisor, 1u);
+		uint32 stepsIntoInterval = context.stepIndex % divisor;
+		float reducedRateT = ((float)stepsIntoInterval + physicsInterpolationT) / (float)divisor;
+
+		for (auto [entityHandle, transform, rb, physicsTransform0, physicsTransform1] : 
+			scene.view<transform_component, rigid_body_component, physics_transform0_component, physics_transform1_component>().each())
+		{
+			float t = (rb.activityLevel == physics_activity_reduced) ? reducedRateT : physicsInterpolationT;
+			transform = lerp(physicsTransform0, physicsTransform1, t);
 		}
+		return;
+	}
 
-		float physicsInterpolationT = timer / physicsFixedTimeStep;
-		ASSERT(physicsInterpolationT >= 0.f && physicsInterpolationT <= 1.f);
+	for (auto [entityHandle, transform, physicsTransform0, physicsTransform1] : scene.group(component_group<transform_component, physics_transform0_component, physics_transform1_component>).each())
+	{
+		transform = lerp(physicsTransform0, physicsTransform1, physicsInterpolationT);
+	}
+}
+
+// The asynchronous step simulates the fixed steps of one frame in a job, followed by the continuation passed to physicsStep. See physics_settings::asyncStepping
+// for what the rest of the frame may access in the meantime. The physics transforms are not double-buffered: only the step touches them while it runs, and
+// they are read at the next sync point, after the step has finished.
+struct physics_async_step
+{
+	escene* scene = 0; // Null until the first step after a scene change or after synchronous stepping, which runs inline.
+	physics_settings settings;
+	uint32 numSteps = 0;
+
+	// The interpolation factor belonging to the results of the running step. Used for display at the next sync point.
+	float physicsInterpolationT = 1.f;
+
+	eallocator arena; // The step can not use the frame arena, because it is reset while the step runs.
+	bool arenaInitialized = false;
+
+	job_handle job;
+	std::atomic<bool> running = false; // Set until the step and its continuation are finished.
+};
+
+static physics_async_step asyncStep;
+
+struct physics_async_step_data
+{
+	physics_async_step* step;
+};
+
+void waitForPhysicsStep()
+{
+	if (!asyncStep.running.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	CPU_PROFILE_BLOCK("Wait for physics step");
+
+	// The job executes other jobs while waiting. The flag catches the case, where the job slot has been reused by the time we wait, and covers the continuation.
+	asyncStep.job.waitForCompletion();
+	while (asyncStep.running.load(std::memory_order_acquire))
+	{
+		if (!highPriorityJobQueue.executeNextJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+static void physicsStepAsync(escene& scene, float& timer, const physics_settings& settings, float dt, job_handle continuation)
+{
+	waitForPhysicsStep();
+
+	physics_async_step& step = asyncStep;
+	if (!step.arenaInitialized)
+	{
+		step.arena.initialize();
+		step.arenaInitialized = true;
+	}
+
+	// The first step in a scene runs inline. It creates the storages, groups and context variables, which the step accesses, before any step overlaps
+	// with the rest of the frame. Creating them concurrently would modify the registry under the feet of the main thread.
+	bool runInline = (step.scene != &scene);
+	if (runInline)
+	{
+		step.scene = &scene;
+		step.physicsInterpolationT = 1.f;
+	}
+
+	// Sync point. Display the results of the last step and publish its events and cloth particles, before the next step takes ownership of them.
+	interpolatePhysicsTransforms(scene, settings, step.physicsInterpolationT);
+	publishPhysicsEvents(scene, settings);
+	publishClothRenderPositions(scene);
+
+	const float physicsFixedTimeStep = 1.f / (float)settings.frameRate;
+
+	step.numSteps = advancePhysicsTimer(timer, settings, dt);
+	step.physicsInterpolationT = timer / physicsFixedTimeStep;
 
-		for (auto [entityHandle, transform, physicsTransform0, physicsTransform1] : scene.group(component_group<transform_component, physics_transform0_component, physics_transform1_component>).each())
+	bool stepInJob = (step.numSteps > 0) && !runInline;
+	if (!stepInJob)
+	{
+		runFixedPhysicsSteps(scene, step.arena, settings, step.numSteps);
+		step.arena.reset();
+
+		if (continuation.index == -1)
+		{
+			return;
+		}
+	}
+
+	step.settings = settings;
+	step.running.store(true, std::memory_order_release);
+
+	job_handle finish = highPriorityJobQueue.createJob<physics_async_step_data>([](physics_async_step_data& data, job_handle)
+	{
+		data.step->running.store(false, std::memory_order_release);
+	}, { &step });
+
+	// None of the jobs is submitted yet, so their handles are still valid when the continuations are attached.
+	job_handle first = continuation;
+	if (stepInJob)
+	{
+		first = highPriorityJobQueue.createJob<physics_async_step_data>([](physics_async_step_data& data, job_handle)
+		{
+			physics_async_step& step = *data.step;
+
+			runFixedPhysicsSteps(*step.scene, step.arena, step.settings, step.numSteps);
+			step.arena.reset();
+		}, { &step });
+
+		if (continuation.index != -1)
 		{
-			transform = lerp(physicsTransform0, physicsTransform1, physicsInterpolationT);
+			continuation.submitAfter(first);
 		}
 	}
+
+	finish.submitAfter((continuation.index != -1) ? continuation : first);
+
+	step.job = first;
+	step.job.submitNow();
+}
+
+void physicsStep(escene& scene, eallocator& arena, float& timer, const physics_settings& settings, float dt, job_handle continuation)
+{
+	if (settings.fixedFrameRate && settings.asyncStepping)
+	{
+		physicsStepAsync(scene, timer, settings, dt, continuation);
+		return;
+	}
+
+	// Synchronous stepping after asynchronous stepping has been switched off. The next asynchronous step runs inline again.
+	waitForPhysicsStep();
+	asyncStep.scene = 0;
+
+	if (settings.fixedFrameRate)
+	{
+		const float physicsFixedTimeStep = 1.f / (float)settings.frameRate;
+
+		uint32 numSteps = advancePhysicsTimer(timer, settings, dt);
+		runFixedPhysicsSteps(scene, arena, settings, numSteps);
+
+		float physicsInterpolationT = timer / physicsFixedTimeStep;
+		interpolatePhysicsTransforms(scene, settings, physicsInterpolationT);
+	}
 	else
 	{
+		applyQueuedPhysicsCommands(scene);
 		physicsStepInternal(scene, arena, settings, dt);
 
 		for (auto [entityHandle, transform, physicsTransform1] : scene.group(component_group<transform_component, physics_transform1_component>).each())
@@ -1394,6 +3087,14 @@ void physicsStep(escene& scene, eallocator& arena, float& timer, const physics_s
 			transform = physicsTransform1;
 		}
 	}
+
+	publishPhysicsEvents(scene, settings);
+	publishClothRenderPositions(scene);
+
+	if (continuation.index != -1)
+	{
+		continuation.submitNow();
+	}
 }
 
 // This function returns the inertia tensors with respect to the center of gravity, so with a coordinate system centered at the COG.
@@ -1505,59 +3206,13 @@ NODISCARD physics_properties collider_union::calculatePhysicsProperties()
 
 		case collider_type_hull:
 		{
-			const bounding_hull_geometry& geom = boundingHullGeometries[hull.geometryIndex];
-
-			const float s60 = 1.f / 60.f;
-			const float s120 = 1.f / 120.f;
-
-			// Covariance-matrix of a tetrahedron with v0 = (0, 0, 0), v1 = (1, 0, 0), v2 = (0, 1, 0), v3 = (0, 0, 1).
-			const mat3 Ccanonical(
-				s60, s120, s120,
-				s120, s60, s120,
-				s120, s120, s60
-			);
-
-			uint32 numFaces = (uint32)geom.faces.size();
-
-			float totalMass = 0.f;
-			mat3 totalCovariance = mat3::zero;
-			vec3 totalCOG(0.f);
-
-			for (uint32 i = 0; i < numFaces; ++i)
-			{
-				auto& face = geom.faces[i];
-
-				//vec3 w0 = 0.f;
-				vec3 w1 = hull.position + hull.rotation * geom.vertices[face.a];
-				vec3 w2 = hull.position + hull.rotation * geom.vertices[face.b];
-				vec3 w3 = hull.position + hull.rotation * geom.vertices[face.c];
-
-				mat3 A(
-					w1.x, w2.x, w3.x,
-					w1.y, w2.y, w3.y,
-					w1.z, w2.z, w3.z
-				);
-
-				float detA = determinant(A);
-				mat3 covariance = detA * A * Ccanonical * transpose(A);
-
-				float volume = 1.f / 6.f * detA;
-				float mass = volume;
-				vec3 cog = (w1 + w2 + w3) * 0.25f;
-
-				totalMass += mass;
-				totalCovariance += covariance;
-				totalCOG += cog * mass;
-			}
-
-			totalCOG /= totalMass;
-
-			// This is actually different in the Blow-paper, but this one is correct.
-			mat3 CprimeTotal = totalCovariance - totalMass * outerProduct(totalCOG, totalCOG);
+			// Precomputed per geometry, so that spawning many hulls of the same geometry doesn't integrate over the faces every time.
+			const physics_properties& unit = boundingHullMassProperties[hull.geometryIndex];
+			mat3 rot = quaternionToMat3(hull.rotation);
 
-			result.cog = totalCOG;
-			result.mass = totalMass * material.density;
-			result.inertia = mat3::identity * trace(CprimeTotal) - CprimeTotal;
+			result.cog = hull.position + hull.rotation * unit.cog;
+			result.mass = unit.mass * material.density;
+			result.inertia = rot * unit.inertia * transpose(rot);
 			result.inertia *= material.density;
 		} break;
 
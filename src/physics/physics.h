@@ -2,11 +2,14 @@
 
 #include "core/math.h"
 #include "core/memory.h"
+#include "core/job_system.h"
 #include "bounding_volumes.h"
 #include "scene/scene.h"
 #include "constraints.h"
 #include "rigid_body.h"
 #include "cloth.h"
+#include "articulation.h"
+#include "raycast_vehicle.h"
 
 #define GRAVITY -9.81f
 
@@ -209,7 +212,10 @@ struct trigger_component
 
 #define INVALID_BOUNDING_HULL_INDEX -1
 
+// Identical geometries are deduplicated by content, so colliders created from the same mesh or hull share one geometry and its precomputed mass properties.
+// Hulls built from mesh files are cached in the asset cache.
 NODISCARD uint32 allocateBoundingHullGeometry(const std::string& meshFilepath);
+NODISCARD uint32 allocateBoundingHullGeometry(bounding_hull_geometry&& geometry); // For programmatically created hulls. Also available in PHYSICS_ONLY builds.
 
 struct distance_constraint_handle { entity_handle entity; };
 struct ball_constraint_handle { entity_handle entity; };
@@ -376,6 +382,36 @@ struct collision_end_event
 typedef std::function<void(const collision_begin_event&)> collision_begin_event_func;
 typedef std::function<void(const collision_end_event&)> collision_end_event_func;
 
+enum physics_event_type : uint32
+{
+	physics_event_collision_begin,
+	physics_event_collision_stay,
+	physics_event_collision_end,
+	physics_event_trigger_enter,
+	physics_event_trigger_leave,
+};
+
+// Collision and trigger events of all steps of one physicsStep call, stored contiguously in the order in which they happened.
+// Plain data, so consumers (audio, scripting, gameplay) can read the whole stream once after the step, from any thread.
+struct physics_event
+{
+	physics_event_type type;
+	uint32 numContacts; // Collision begin and stay only. Zero for stay events of sleeping or static pairs, which are not evaluated.
+
+	uint64 pairID; // Identifies the pair across its begin, stay and end events. Built from the collider entities (trigger and other entity for trigger events).
+
+	entity_handle entityA; // Rigid body or static entity owning the collider. Trigger entity for trigger events.
+	entity_handle entityB; // Rigid body or static entity owning the collider. Entity entering or leaving the trigger for trigger events.
+	entity_handle colliderA; // Null for trigger events.
+	entity_handle colliderB; // Null for trigger events.
+
+	// Contact summary. Collision begin and stay only.
+	vec3 position; // Average of the contact points.
+	vec3 normal; // Average of the contact normals, from A to B.
+	vec3 relativeVelocity; // Velocity of B relative to A at the contact position.
+	float maxPenetrationDepth;
+};
+
 struct physics_settings
 {
 	bool fixedFrameRate = true;
@@ -391,10 +427,68 @@ struct physics_settings
 	bool simdBroadPhase = true;
 	bool simdNarrowPhase = true;
 	bool simdConstraintSolver = true;
-
+	bool parallelConstraintSolver = true;
+
+	// Carries the accumulated contact impulses over to the next frame. This drastically reduces the number of solver iterations needed for stable stacking.
+	bool warmStartCollisions = true;
+
+	// Islands of bodies, which stay below these velocities for timeToSleep seconds, are put to sleep and excluded from simulation until woken up.
+	bool enableSleeping = true;
+	float sleepLinearVelocityThreshold = 0.1f;
+	float sleepAngularVelocityThreshold = 0.1f;
+	float timeToSleep = 0.5f;
+
+	// Continuous collision detection with speculative contacts. Bodies, which move farther than ccdMotionThreshold times the smallest half extent 
+	// of their bounding box in one step (or which are flagged as continuousCollision), get their bounding box swept along their motion in the 
+	// broad phase. Colliders in their path generate contacts before they are touched, so fast bodies don't tunnel through thin geometry.
+	bool enableCCD = true;
+	float ccdMotionThreshold = 1.f;
+
+	// Simulation regions for large worlds. Space is divided into a grid of regionCellSize sized cells. Cells within fullRateDistance of a focus point
+	// (see setPhysicsFocusPoints) are simulated every step, cells within reducedRateDistance once every reducedRateDivisor steps with a correspondingly 
+	// larger time step (and displayed one interval behind, interpolated in between), all others are frozen in place. Bodies touching or constrained to a full-rate body are simulated 
+	// at full rate, so that interactions across cell boundaries are resolved. Without focus points everything is simulated at full rate.
+	// Only used with fixedFrameRate. Cloths are always simulated at full rate.
+	bool enableRegions = false;
+	float regionCellSize = 32.f;
+	float fullRateDistance = 64.f;
+	float reducedRateDistance = 256.f;
+	uint32 reducedRateDivisor = 4;
+
+	// Runs the fixed steps of a frame in a job, which overlaps with the rest of the frame (e.g. rendering). Only used with fixedFrameRate.
+	// The displayed transforms and the events are one frame behind the simulation. The first step in a scene runs inline.
+	// Between physicsStep and waitForPhysicsStep, the step owns the simulation state. The rest of the frame may only
+	// - read transform_component (written at the sync point in physicsStep) and components, which the simulation does not use (meshes, lights, animations, ...),
+	// - write components, which the simulation does not read. This excludes transform_component of entities with a collider or force field,
+	// - queue forces and impulses, and read the render positions of cloths.
+	// It must not create or destroy entities, add or remove components, create new groups, touch any physics component or context variable, or call
+	// other physics functions.
+	// Work which needs more (e.g. scripting) is passed to physicsStep as continuation and runs after the step, before waitForPhysicsStep returns.
+	bool asyncStepping = false;
+
+	// Optional adapter on top of the event stream (see getPhysicsEvents). Invoked on the main thread, after the steps of the frame, 
+	// together with the trigger_component callbacks.
 	collision_begin_event_func collisionBeginCallback;
 	collision_end_event_func collisionEndCallback;
 };
 
+// Internal. Writes the world space colliders in reverse order of the collider components (world space collider i belongs to collider component numColliders - 1 - i).
+void getWorldSpaceColliders(escene& scene, bounding_box* outWorldspaceAABBs, collider_union* outWorldSpaceColliders, uint16 dummyRigidBodyIndex);
+
 void testPhysicsInteraction(escene& scene, ray r, float strength = 1000.f);
-void physicsStep(escene& scene, eallocator& arena, float& timer, const physics_settings& settings, float dt);
\ No newline at end of file
+// The continuation is submitted after the steps of this frame are simulated. Pass a job, which was created but not submitted yet.
+void physicsStep(escene& scene, eallocator& arena, float& timer, const physics_settings& settings, float dt, job_handle continuation = {});
+
+// Events of the last physicsStep call. Valid until the next call.
+NODISCARD const std::vector<physics_event>& getPhysicsEvents(escene& scene);
+
+// Blocks until a running asynchronous physics step is finished. Afterwards the scene can be modified safely. Returns immediately if no step is running.
+void waitForPhysicsStep();
+
+// Queued forces and impulses are applied to the rigid body at the beginning of the next physics step. Unlike writing to the rigid body directly,
+// this is safe while an asynchronous step is running and can be called from any thread. Points are in global space.
+void queueForce(escene& scene, entity_handle entity, vec3 force);
+void queueForceAtPoint(escene& scene, entity_handle entity, vec3 force, vec3 point);
+void queueTorque(escene& scene, entity_handle entity, vec3 torque);
+void queueImpulse(escene& scene, entity_handle entity, vec3 impulse);
+void queueImpulseAtPoint(escene& scene, entity_handle entity, vec3 impulse, vec3 point);
\ No newline at end of file
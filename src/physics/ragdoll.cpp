@@ -7,8 +7,46 @@
 #include "geometry/mesh_builder.h"
 #endif
 
-void humanoid_ragdoll::initialize(escene& scene, vec3 initialHipPosition, float initialRotation)
+eentity humanoid_ragdoll::* const humanoid_ragdoll::bodyPartMembers[numBodyParts] =
 {
+	&humanoid_ragdoll::torso,
+	&humanoid_ragdoll::head,
+	&humanoid_ragdoll::leftUpperArm,
+	&humanoid_ragdoll::leftLowerArm,
+	&humanoid_ragdoll::rightUpperArm,
+	&humanoid_ragdoll::rightLowerArm,
+	&humanoid_ragdoll::leftUpperLeg,
+	&humanoid_ragdoll::leftLowerLeg,
+	&humanoid_ragdoll::leftFoot,
+	&humanoid_ragdoll::leftToes,
+	&humanoid_ragdoll::rightUpperLeg,
+	&humanoid_ragdoll::rightLowerLeg,
+	&humanoid_ragdoll::rightFoot,
+	&humanoid_ragdoll::rightToes,
+};
+
+eentity humanoid_ragdoll::* const humanoid_ragdoll::bodyPartParentMembers[numBodyParts] =
+{
+	&humanoid_ragdoll::torsoParent,
+	&humanoid_ragdoll::headParent,
+	&humanoid_ragdoll::leftUpperArmParent,
+	&humanoid_ragdoll::leftLowerArmParent,
+	&humanoid_ragdoll::rightUpperArmParent,
+	&humanoid_ragdoll::rightLowerArmParent,
+	&humanoid_ragdoll::leftUpperLegParent,
+	&humanoid_ragdoll::leftLowerLegParent,
+	&humanoid_ragdoll::leftFootParent,
+	&humanoid_ragdoll::leftToesParent,
+	&humanoid_ragdoll::rightUpperLegParent,
+	&humanoid_ragdoll::rightLowerLegParent,
+	&humanoid_ragdoll::rightFootParent,
+	&humanoid_ragdoll::rightToesParent,
+};
+
+void humanoid_ragdoll::initialize(escene& scene, vec3 initialHipPosition, float initialRotation, bool articulated)
+{
+	this->articulated = articulated;
+
 	float scale = 0.42f; // This file is completely hardcoded. I initially screwed up the scaling a bit, so this factor brings everything to the correct scale (and therefore weight).
 
 	bool ragdollKinematic = false;
@@ -106,30 +144,93 @@ void humanoid_ragdoll::initialize(escene& scene, vec3 initialHipPosition, float
 		.addComponent<collider_component>(collider_component::asCapsule({ scale * vec3(-0.0587f, 0.f, 0.f), scale * vec3(0.0587f, 0.f, 0.f), scale * 0.1f }, material))
 		.addComponent<rigid_body_component>(ragdollKinematic, ragdollGravityFactor);
 
-	neckConstraint = addConeTwistConstraintFromGlobalPoints(torso, head, transformPosition(torsoTransform, scale * vec3(0.f, 1.2f, 0.f)), vec3(0.f, 1.f, 0.f), deg2rad(50.f), deg2rad(90.f));
-	leftShoulderConstraint = addConeTwistConstraintFromGlobalPoints(torso, leftUpperArm, transformPosition(torsoTransform, scale * vec3(-0.4f, 1.f, 0.f)), vec3(-1.f, 0.f, 0.f), deg2rad(130.f), deg2rad(90.f));
-	leftElbowConstraint = addHingeConstraintFromGlobalPoints(leftUpperArm, leftLowerArm, transformPosition(leftUpperArmTransform, scale * vec3(0.f, -0.42f, 0.f)), normalize(vec3(1.f, 0.f, 1.f)), deg2rad(-5.f), deg2rad(85.f));
-	rightShoulderConstraint = addConeTwistConstraintFromGlobalPoints(torso, rightUpperArm, transformPosition(torsoTransform, scale * vec3(0.4f, 1.f, 0.f)), vec3(1.f, 0.f, 0.f), deg2rad(130.f), deg2rad(90.f));
-	rightElbowConstraint = addHingeConstraintFromGlobalPoints(rightUpperArm, rightLowerArm, transformPosition(rightUpperArmTransform, scale * vec3(0.f, -0.42f, 0.f)), normalize(vec3(1.f, 0.f, -1.f)), deg2rad(-5.f), deg2rad(85.f));
-	
-	leftHipConstraint = addConeTwistConstraintFromGlobalPoints(torso, leftUpperLeg, transformPosition(torsoTransform, scale * vec3(-0.3f, -0.25f, 0.f)), transformDirection(leftUpperLegTransform, vec3(0.f, -1.f, 0.f)), -1.f, deg2rad(30.f));
-	leftKneeConstraint = addHingeConstraintFromGlobalPoints(leftUpperLeg, leftLowerLeg, transformPosition(leftUpperLegTransform, scale * vec3(0.f, -0.6f, 0.f)), vec3(1.f, 0.f, 0.f), deg2rad(-90.f), deg2rad(5.f));
-	leftAnkleConstraint = addConeTwistConstraintFromGlobalPoints(leftLowerLeg, leftFoot, transformPosition(leftLowerLegTransform, scale * vec3(0.f, -0.52f, 0.f)), transformDirection(leftLowerLegTransform, vec3(0.f, -1.f, 0.f)), deg2rad(75.f), deg2rad(20.f));
-	leftToesConstraint = addHingeConstraintFromGlobalPoints(leftFoot, leftToes, transformPosition(leftFootTransform, scale * vec3(0.f, 0.f, -0.36f)), vec3(1.f, 0.f, 0.f), deg2rad(-45.f), deg2rad(45.f));
-
-	rightHipConstraint = addConeTwistConstraintFromGlobalPoints(torso, rightUpperLeg, transformPosition(torsoTransform, scale * vec3(0.3f, -0.25f, 0.f)), transformDirection(rightUpperLegTransform, vec3(0.f, -1.f, 0.f)), -1.f, deg2rad(30.f));
-	rightKneeConstraint = addHingeConstraintFromGlobalPoints(rightUpperLeg, rightLowerLeg, transformPosition(rightUpperLegTransform, scale * vec3(0.f, -0.6f, 0.f)), vec3(1.f, 0.f, 0.f), deg2rad(-90.f), deg2rad(5.f));
-	rightAnkleConstraint = addConeTwistConstraintFromGlobalPoints(rightLowerLeg, rightFoot, transformPosition(rightLowerLegTransform, scale * vec3(0.f, -0.52f, 0.f)), transformDirection(rightLowerLegTransform, vec3(0.f, -1.f, 0.f)), deg2rad(75.f), deg2rad(20.f));
-	rightToesConstraint = addHingeConstraintFromGlobalPoints(rightFoot, rightToes, transformPosition(rightFootTransform, scale * vec3(0.f, 0.f, -0.36f)), vec3(1.f, 0.f, 0.f), deg2rad(-45.f), deg2rad(45.f));
+	if (articulated)
+	{
+		struct joint_desc
+		{
+			eentity* parent;
+			eentity* child;
+			vec3 anchor;
+			vec3 axis;
+			float limit0;
+			float limit1;
+		};
+
+		// Same anchors, axes and limits as the constraints below, in the order of coneTwistConstraints and hingeConstraints.
+		const joint_desc sphericalJointDescs[] =
+		{
+			{ &torso, &head, transformPosition(torsoTransform, scale * vec3(0.f, 1.2f, 0.f)), vec3(0.f, 1.f, 0.f), deg2rad(50.f), deg2rad(90.f) },
+			{ &torso, &leftUpperArm, transformPosition(torsoTransform, scale * vec3(-0.4f, 1.f, 0.f)), vec3(-1.f, 0.f, 0.f), deg2rad(130.f), deg2rad(90.f) },
+			{ &torso, &rightUpperArm, transformPosition(torsoTransform, scale * vec3(0.4f, 1.f, 0.f)), vec3(1.f, 0.f, 0.f), deg2rad(130.f), deg2rad(90.f) },
+			{ &torso, &leftUpperLeg, transformPosition(torsoTransform, scale * vec3(-0.3f, -0.25f, 0.f)), transformDirection(leftUpperLegTransform, vec3(0.f, -1.f, 0.f)), -1.f, deg2rad(30.f) },
+			{ &leftLowerLeg, &leftFoot, transformPosition(leftLowerLegTransform, scale * vec3(0.f, -0.52f, 0.f)), transformDirection(leftLowerLegTransform, vec3(0.f, -1.f, 0.f)), deg2rad(75.f), deg2rad(20.f) },
+			{ &torso, &rightUpperLeg, transformPosition(torsoTransform, scale * vec3(0.3f, -0.25f, 0.f)), transformDirection(rightUpperLegTransform, vec3(0.f, -1.f, 0.f)), -1.f, deg2rad(30.f) },
+			{ &rightLowerLeg, &rightFoot, transformPosition(rightLowerLegTransform, scale * vec3(0.f, -0.52f, 0.f)), transformDirection(rightLowerLegTransform, vec3(0.f, -1.f, 0.f)), deg2rad(75.f), deg2rad(20.f) },
+		};
+
+		const joint_desc hingeJointDescs[] =
+		{
+			{ &leftUpperArm, &leftLowerArm, transformPosition(leftUpperArmTransform, scale * vec3(0.f, -0.42f, 0.f)), normalize(vec3(1.f, 0.f, 1.f)), deg2rad(-5.f), deg2rad(85.f) },
+			{ &rightUpperArm, &rightLowerArm, transformPosition(rightUpperArmTransform, scale * vec3(0.f, -0.42f, 0.f)), normalize(vec3(1.f, 0.f, -1.f)), deg2rad(-5.f), deg2rad(85.f) },
+			{ &leftUpperLeg, &leftLowerLeg, transformPosition(leftUpperLegTransform, scale * vec3(0.f, -0.6f, 0.f)), vec3(1.f, 0.f, 0.f), deg2rad(-90.f), deg2rad(5.f) },
+			{ &leftFoot, &leftToes, transformPosition(leftFootTransform, scale * vec3(0.f, 0.f, -0.36f)), vec3(1.f, 0.f, 0.f), deg2rad(-45.f), deg2rad(45.f) },
+			{ &rightUpperLeg, &rightLowerLeg, transformPosition(rightUpperLegTransform, scale * vec3(0.f, -0.6f, 0.f)), vec3(1.f, 0.f, 0.f), deg2rad(-90.f), deg2rad(5.f) },
+			{ &rightFoot, &rightToes, transformPosition(rightFootTransform, scale * vec3(0.f, 0.f, -0.36f)), vec3(1.f, 0.f, 0.f), deg2rad(-45.f), deg2rad(45.f) },
+		};
+
+		// Links must be added parents first. The spherical joints of the ankles need the knees, so the hinges are added in between.
+		torso.addComponent<articulation_component>(torso.handle);
+		articulation_component& articulation = torso.getComponent<articulation_component>();
+
+		for (uint32 i : { 0, 1, 2, 3, 5 })
+		{
+			const joint_desc& d = sphericalJointDescs[i];
+			sphericalJoints[i] = articulation.addSphericalJoint(*d.parent, *d.child, d.anchor, d.axis, d.limit0, d.limit1);
+		}
+		for (uint32 i : { 0, 1, 2, 4 })
+		{
+			const joint_desc& d = hingeJointDescs[i];
+			hingeJoints[i] = articulation.addHingeJoint(*d.parent, *d.child, d.anchor, d.axis, d.limit0, d.limit1);
+		}
+		for (uint32 i : { 4, 6 })
+		{
+			const joint_desc& d = sphericalJointDescs[i];
+			sphericalJoints[i] = articulation.addSphericalJoint(*d.parent, *d.child, d.anchor, d.axis, d.limit0, d.limit1);
+		}
+		for (uint32 i : { 3, 5 })
+		{
+			const joint_desc& d = hingeJointDescs[i];
+			hingeJoints[i] = articulation.addHingeJoint(*d.parent, *d.child, d.anchor, d.axis, d.limit0, d.limit1);
+		}
+	}
+	else
+	{
+		neckConstraint = addConeTwistConstraintFromGlobalPoints(torso, head, transformPosition(torsoTransform, scale * vec3(0.f, 1.2f, 0.f)), vec3(0.f, 1.f, 0.f), deg2rad(50.f), deg2rad(90.f));
+		leftShoulderConstraint = addConeTwistConstraintFromGlobalPoints(torso, leftUpperArm, transformPosition(torsoTransform, scale * vec3(-0.4f, 1.f, 0.f)), vec3(-1.f, 0.f, 0.f), deg2rad(130.f), deg2rad(90.f));
+		leftElbowConstraint = addHingeConstraintFromGlobalPoints(leftUpperArm, leftLowerArm, transformPosition(leftUpperArmTransform, scale * vec3(0.f, -0.42f, 0.f)), normalize(vec3(1.f, 0.f, 1.f)), deg2rad(-5.f), deg2rad(85.f));
+		rightShoulderConstraint = addConeTwistConstraintFromGlobalPoints(torso, rightUpperArm, transformPosition(torsoTransform, scale * vec3(0.4f, 1.f, 0.f)), vec3(1.f, 0.f, 0.f), deg2rad(130.f), deg2rad(90.f));
+		rightElbowConstraint = addHingeConstraintFromGlobalPoints(rightUpperArm, rightLowerArm, transformPosition(rightUpperArmTransform, scale * vec3(0.f, -0.42f, 0.f)), normalize(vec3(1.f, 0.f, -1.f)), deg2rad(-5.f), deg2rad(85.f));
+
+		leftHipConstraint = addConeTwistConstraintFromGlobalPoints(torso, leftUpperLeg, transformPosition(torsoTransform, scale * vec3(-0.3f, -0.25f, 0.f)), transformDirection(leftUpperLegTransform, vec3(0.f, -1.f, 0.f)), -1.f, deg2rad(30.f));
+		leftKneeConstraint = addHingeConstraintFromGlobalPoints(leftUpperLeg, leftLowerLeg, transformPosition(leftUpperLegTransform, scale * vec3(0.f, -0.6f, 0.f)), vec3(1.f, 0.f, 0.f), deg2rad(-90.f), deg2rad(5.f));
+		leftAnkleConstraint = addConeTwistConstraintFromGlobalPoints(leftLowerLeg, leftFoot, transformPosition(leftLowerLegTransform, scale * vec3(0.f, -0.52f, 0.f)), transformDirection(leftLowerLegTransform, vec3(0.f, -1.f, 0.f)), deg2rad(75.f), deg2rad(20.f));
+		leftToesConstraint = addHingeConstraintFromGlobalPoints(leftFoot, leftToes, transformPosition(leftFootTransform, scale * vec3(0.f, 0.f, -0.36f)), vec3(1.f, 0.f, 0.f), deg2rad(-45.f), deg2rad(45.f));
+
+		rightHipConstraint = addConeTwistConstraintFromGlobalPoints(torso, rightUpperLeg, transformPosition(torsoTransform, scale * vec3(0.3f, -0.25f, 0.f)), transformDirection(rightUpperLegTransform, vec3(0.f, -1.f, 0.f)), -1.f, deg2rad(30.f));
+		rightKneeConstraint = addHingeConstraintFromGlobalPoints(rightUpperLeg, rightLowerLeg, transformPosition(rightUpperLegTransform, scale * vec3(0.f, -0.6f, 0.f)), vec3(1.f, 0.f, 0.f), deg2rad(-90.f), deg2rad(5.f));
+		rightAnkleConstraint = addConeTwistConstraintFromGlobalPoints(rightLowerLeg, rightFoot, transformPosition(rightLowerLegTransform, scale * vec3(0.f, -0.52f, 0.f)), transformDirection(rightLowerLegTransform, vec3(0.f, -1.f, 0.f)), deg2rad(75.f), deg2rad(20.f));
+		rightToesConstraint = addHingeConstraintFromGlobalPoints(rightFoot, rightToes, transformPosition(rightFootTransform, scale * vec3(0.f, 0.f, -0.36f)), vec3(1.f, 0.f, 0.f), deg2rad(-45.f), deg2rad(45.f));
+	}
 
 	quat rotation(vec3(0.f, 1.f, 0.f), initialRotation);
-	for (uint32 i = 0; i < arraysize(bodyParts); ++i)
+	for (uint32 i = 0; i < numBodyParts; ++i)
 	{
-		transform_component& transform = bodyParts[i].getComponent<transform_component>();
+		eentity& part = bodyPart(i);
+		transform_component& transform = part.getComponent<transform_component>();
 		transform.rotation = rotation * transform.rotation;
 		transform.position = rotation * transform.position + initialHipPosition;
 
-		bodyParts[i].getComponent<physics_transform0_component>() = bodyParts[i].getComponent<physics_transform1_component>() = transform;
+		part.getComponent<physics_transform0_component>() = part.getComponent<physics_transform1_component>() = transform;
 	}
 
 #if 0
@@ -248,9 +349,9 @@ void humanoid_ragdoll::initialize(escene& scene, vec3 initialHipPosition, float
 #endif
 }
 
-humanoid_ragdoll humanoid_ragdoll::create(escene& scene, vec3 initialHipPosition, float initialRotation)
+humanoid_ragdoll humanoid_ragdoll::create(escene& scene, vec3 initialHipPosition, float initialRotation, bool articulated)
 {
 	humanoid_ragdoll ragdoll;
-	ragdoll.initialize(scene, initialHipPosition, initialRotation);
+	ragdoll.initialize(scene, initialHipPosition, initialRotation, articulated);
 	return ragdoll;
 }
\ No newline at end of file
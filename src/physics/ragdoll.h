@@ -7,52 +7,49 @@ struct humanoid_ragdoll
 {
 	humanoid_ragdoll() {}
 
-	void initialize(escene& scene, vec3 initialHipPosition, float initialRotation = 0.f);
-	static humanoid_ragdoll create(escene& scene, vec3 initialHipPosition, float initialRotation = 0.f);
+	// If articulated is set, the body parts are joined by an articulation_component on the torso instead of constraints. The joints then have the same
+	// anchors, axes and limits as the constraints, and their indices are stored in sphericalJoints and hingeJoints. The constraint handles stay invalid.
+	void initialize(escene& scene, vec3 initialHipPosition, float initialRotation = 0.f, bool articulated = false);
+	static humanoid_ragdoll create(escene& scene, vec3 initialHipPosition, float initialRotation = 0.f, bool articulated = false);
 
-	union
-	{
-		struct
-		{
-			eentity torso;
-			eentity head;
-			eentity leftUpperArm;
-			eentity leftLowerArm;
-			eentity rightUpperArm;
-			eentity rightLowerArm;
-			eentity leftUpperLeg;
-			eentity leftLowerLeg;
-			eentity leftFoot;
-			eentity leftToes;
-			eentity rightUpperLeg;
-			eentity rightLowerLeg;
-			eentity rightFoot;
-			eentity rightToes;
-		};
-		eentity bodyParts[14];
-	};
+	// The body parts are not aliased with an array, because GCC and Clang do not allow members with constructors in anonymous structs.
+	// Use bodyPart(i) and bodyPartParent(i) to iterate over them in declaration order.
+	eentity torso;
+	eentity head;
+	eentity leftUpperArm;
+	eentity leftLowerArm;
+	eentity rightUpperArm;
+	eentity rightLowerArm;
+	eentity leftUpperLeg;
+	eentity leftLowerLeg;
+	eentity leftFoot;
+	eentity leftToes;
+	eentity rightUpperLeg;
+	eentity rightLowerLeg;
+	eentity rightFoot;
+	eentity rightToes;
 
-	union
-	{
-		struct
-		{
-			eentity torsoParent;
-			eentity headParent;
-			eentity leftUpperArmParent;
-			eentity leftLowerArmParent;
-			eentity rightUpperArmParent;
-			eentity rightLowerArmParent;
-			eentity leftUpperLegParent;
-			eentity leftLowerLegParent;
-			eentity leftFootParent;
-			eentity leftToesParent;
-			eentity rightUpperLegParent;
-			eentity rightLowerLegParent;
-			eentity rightFootParent;
-			eentity rightToesParent;
-		};
-		eentity bodyPartParents[14];
-	};
+	eentity torsoParent;
+	eentity headParent;
+	eentity leftUpperArmParent;
+	eentity leftLowerArmParent;
+	eentity rightUpperArmParent;
+	eentity rightLowerArmParent;
+	eentity leftUpperLegParent;
+	eentity leftLowerLegParent;
+	eentity leftFootParent;
+	eentity leftToesParent;
+	eentity rightUpperLegParent;
+	eentity rightLowerLegParent;
+	eentity rightFootParent;
+	eentity rightToesParent;
+
+	static const uint32 numBodyParts = 14;
+	static eentity humanoid_ragdoll::* const bodyPartMembers[numBodyParts];
+	static eentity humanoid_ragdoll::* const bodyPartParentMembers[numBodyParts];
+
+	NODISCARD eentity& bodyPart(uint32 i) { return this->*bodyPartMembers[i]; }
+	NODISCARD eentity& bodyPartParent(uint32 i) { return this->*bodyPartParentMembers[i]; }
 
 	union
 	{
@@ -79,4 +76,10 @@ struct humanoid_ragdoll
 			hinge_constraint_handle hingeConstraints[6];
 		};
 	};
+
+	// Joint indices into the articulation of the torso. In the same order as coneTwistConstraints and hingeConstraints.
+	uint32 sphericalJoints[7];
+	uint32 hingeJoints[6];
+
+	bool articulated = false;
 };
@@ -0,0 +1,461 @@
+#include "pch.h"
+#include "raycast_vehicle.h"
+#include "physics.h"
+#include "scene_queries.h"
+#include "terrain/heightmap_collider.h"
+#include "core/math_simd.h"
+#include "core/soa.h"
+#include "core/job_system.h"
+#include "core/cpu_profiling.h"
+
+#define RAYCAST_VEHICLE_SIMD_WIDTH 8
+
+#define HEIGHTMAP_RAYCAST_ITERATIONS 4
+#define HEIGHTMAP_NORMAL_EPSILON 0.1f
+
+#define MIN_WHEEL_BATCHES_PER_JOB 16
+
+#if RAYCAST_VEHICLE_SIMD_WIDTH == 4
+typedef w4_float w_float;
+#elif RAYCAST_VEHICLE_SIMD_WIDTH == 8 && defined(SIMD_AVX_2)
+typedef w8_float w_float;
+#elif RAYCAST_VEHICLE_SIMD_WIDTH == 16 && defined(SIMD_AVX_512)
+typedef w16_float w_float;
+#endif
+
+typedef wN_vec3<w_float> w_vec3;
+
+uint32 raycast_vehicle_component::addWheel(vec3 localAttachment, float radius, bool steered, bool driven)
+{
+	ASSERT(numWheels < RAYCAST_VEHICLE_MAX_NUM_WHEELS);
+
+	raycast_wheel& wheel = wheels[numWheels];
+	wheel = raycast_wheel();
+	wheel.localAttachment = localAttachment;
+	wheel.radius = radius;
+	wheel.steered = steered;
+	wheel.driven = driven;
+	wheel.suspensionLength = wheel.suspensionRestLength;
+
+	return numWheels++;
+}
+
+raycast_vehicle_component raycast_vehicle_component::fourWheels(float halfTrackWidth, float halfWheelBase, float attachmentHeight, float wheelRadius,
+	bool frontWheelDrive, bool rearWheelDrive)
+{
+	raycast_vehicle_component result;
+	for (uint32 i = 0; i < 4; ++i)
+	{
+		float side = (i & 1) ? 1.f : -1.f;
+		bool front = (i & 2) != 0;
+
+		vec3 localAttachment(side * halfTrackWidth, attachmentHeight, front ? halfWheelBase : -halfWheelBase);
+		result.addWheel(localAttachment, wheelRadius, front, front ? frontWheelDrive : rearWheelDrive);
+	}
+	return result;
+}
+
+// Positive steering turns right, which is a negative rotation around the up axis (+x is left).
+static float getSteeringAngle(const raycast_vehicle_component& vehicle, const raycast_wheel& wheel)
+{
+	return wheel.steered ? (-vehicle.steering * vehicle.maxSteeringAngle) : 0.f;
+}
+
+trs raycast_vehicle_component::getWheelLocalTransform(uint32 wheelIndex) const
+{
+	ASSERT(wheelIndex < numWheels);
+
+	const raycast_wheel& wheel = wheels[wheelIndex];
+	vec3 position = wheel.localAttachment - vec3(0.f, wheel.suspensionLength, 0.f);
+	quat rotation = quat(vec3(0.f, 1.f, 0.f), getSteeringAngle(*this, wheel)) * quat(vec3(1.f, 0.f, 0.f), wheel.rotation);
+	return trs(position, rotation);
+}
+
+// Wheels of all updated vehicles, flattened and padded to a multiple of the SIMD width.
+struct raycast_wheel_batch
+{
+	// Input.
+	soa_vec3 up; // Chassis up axis. The rays are cast in the opposite direction.
+	soa_vec3 forward; // Heading of the wheel, including steering.
+	soa_vec3 normal; // Ground normal. Up, if the wheel is in the air.
+	soa_vec3 pointVelocity; // Velocity of the chassis at the contact point.
+	soa_float hitDistance; // Distance from the attachment to the ground. Equals the ray length, if the wheel is in the air.
+	soa_float rayLength;
+	soa_float radius;
+	soa_float restLength;
+	soa_float stiffness;
+	soa_float damping;
+	soa_float friction;
+	soa_float corneringStiffness;
+	soa_float driveForce;
+	soa_float brakeForce;
+	soa_float rollingResistance;
+
+	// Output.
+	soa_vec3 force;
+	soa_float suspensionLength;
+	soa_float longitudinalVelocity;
+};
+
+struct raycast_vehicle_reference
+{
+	entity_handle entity;
+	raycast_vehicle_component* vehicle;
+	rigid_body_component* rb;
+	const physics_transform1_component* transform;
+	uint32 firstWheel;
+};
+
+static soa_vec3 allocateSOAVec3(eallocator& arena, uint32 count)
+{
+	return { arena.allocate<float>(count, true), arena.allocate<float>(count, true), arena.allocate<float>(count, true) };
+}
+
+static void writeSOAVec3(soa_vec3 v, uint32 index, vec3 value)
+{
+	v.x[index] = value.x;
+	v.y[index] = value.y;
+	v.z[index] = value.z;
+}
+
+static vec3 readSOAVec3(soa_vec3 v, uint32 index)
+{
+	return vec3(v.x[index], v.y[index], v.z[index]);
+}
+
+static float getHeightmapHeightAt(const heightmap_collider_component* const* heightmaps, uint32 numHeightmaps, vec2 coord)
+{
+	float result = -FLT_MAX;
+	for (uint32 i = 0; i < numHeightmaps; ++i)
+	{
+		result = max(result, heightmaps[i]->getHeightAt(coord));
+	}
+	return result;
+}
+
+// The heightmap is not part of the scene query context, so the wheel rays are intersected with the sampled height field instead of its triangles.
+// The intersection is refined with a few secant iterations, which is plenty for the short suspension rays.
+static bool raycastHeightmaps(const heightmap_collider_component* const* heightmaps, uint32 numHeightmaps, const ray& r, float maxDistance,
+	float& outDistance, vec3& outNormal)
+{
+	auto heightAboveGround = [heightmaps, numHeightmaps, &r](float t)
+	{
+		vec3 p = r.origin + r.direction * t;
+		float height = getHeightmapHeightAt(heightmaps, numHeightmaps, vec2(p.x, p.z));
+		return (height == -FLT_MAX) ? FLT_MAX : (p.y - height);
+	};
+
+	float t0 = 0.f;
+	float t1 = maxDistance;
+	float f0 = heightAboveGround(t0);
+	float f1 = heightAboveGround(t1);
+
+	// Ray ends above the ground, or starts outside of the heightmap.
+	if (f1 > 0.f || f0 == FLT_MAX)
+	{
+		return false;
+	}
+
+	float t = 0.f;
+	if (f0 > 0.f)
+	{
+		for (uint32 i = 0; i < HEIGHTMAP_RAYCAST_ITERATIONS; ++i)
+		{
+			t = t0 + (t1 - t0) * f0 / (f0 - f1);
+			float f = heightAboveGround(t);
+			if (f > 0.f)
+			{
+				t0 = t;
+				f0 = f;
+			}
+			else
+			{
+				t1 = t;
+				f1 = f;
+			}
+		}
+	}
+
+	vec3 p = r.origin + r.direction * t;
+	vec2 coord(p.x, p.z);
+	float hx0 = getHeightmapHeightAt(heightmaps, numHeightmaps, coord - vec2(HEIGHTMAP_NORMAL_EPSILON, 0.f));
+	float hx1 = getHeightmapHeightAt(heightmaps, numHeightmaps, coord + vec2(HEIGHTMAP_NORMAL_EPSILON, 0.f));
+	float hz0 = getHeightmapHeightAt(heightmaps, numHeightmaps, coord - vec2(0.f, HEIGHTMAP_NORMAL_EPSILON));
+	float hz1 = getHeightmapHeightAt(heightmaps, numHeightmaps, coord + vec2(0.f, HEIGHTMAP_NORMAL_EPSILON));
+
+	outDistance = t;
+	outNormal = (hx0 == -FLT_MAX || hx1 == -FLT_MAX || hz0 == -FLT_MAX || hz1 == -FLT_MAX)
+		? vec3(0.f, 1.f, 0.f)
+		: normalize(vec3(hx0 - hx1, 2.f * HEIGHTMAP_NORMAL_EPSILON, hz0 - hz1));
+	return true;
+}
+
+// Suspension force along the chassis' up axis, tire forces in the ground plane, clamped to the friction circle.
+static void computeWheelForces(const raycast_wheel_batch& wheels, uint32 offset)
+{
+	w_vec3 up(wheels.up, offset);
+	w_vec3 forward(wheels.forward, offset);
+	w_vec3 normal(wheels.normal, offset);
+	w_vec3 v(wheels.pointVelocity, offset);
+
+	w_float hitDistance = wheels.hitDistance + offset;
+	w_float rayLength = wheels.rayLength + offset;
+	w_float radius = wheels.radius + offset;
+	w_float restLength = wheels.restLength + offset;
+
+	w_float zero = w_float::zero();
+	auto grounded = hitDistance < rayLength;
+
+	w_float length = clamp(hitDistance - radius, zero, restLength);
+	w_float compression = restLength - length;
+	w_float compressionVelocity = -dot(v, up);
+
+	w_float stiffness = wheels.stiffness + offset;
+	w_float damping = wheels.damping + offset;
+	w_float normalLoad = maximum(fmadd(damping, compressionVelocity, stiffness * compression), zero);
+	normalLoad = ifThen(grounded, normalLoad, zero);
+
+	w_vec3 lateral = noz(cross(normal, forward));
+	w_vec3 longitudinal = cross(lateral, normal);
+
+	w_float longitudinalVelocity = dot(v, longitudinal);
+	w_float lateralVelocity = dot(v, lateral);
+
+	// Braking and rolling resistance fade out linearly at low speeds, so that they don't flip direction every step on a standing vehicle.
+	w_float resistance = fmadd(w_float(wheels.rollingResistance + offset), normalLoad, w_float(wheels.brakeForce + offset));
+	w_float longitudinalForce = w_float(wheels.driveForce + offset) - resistance * clamp(longitudinalVelocity * 2.f, w_float(-1.f), w_float(1.f));
+	w_float lateralForce = -lateralVelocity * w_float(wheels.corneringStiffness + offset);
+
+	w_float maxTireForce = w_float(wheels.friction + offset) * normalLoad;
+	w_float tireForce = sqrt(fmadd(longitudinalForce, longitudinalForce, lateralForce * lateralForce));
+	w_float scale = ifThen(tireForce > maxTireForce, maxTireForce / tireForce, w_float(1.f));
+
+	w_vec3 force = up * normalLoad + (longitudinal * longitudinalForce + lateral * lateralForce) * scale;
+	force = ifThen(grounded, force, w_vec3::zero());
+
+	force.store(wheels.force.x + offset, wheels.force.y + offset, wheels.force.z + offset);
+	ifThen(grounded, length, restLength).store(wheels.suspensionLength + offset);
+	longitudinalVelocity.store(wheels.longitudinalVelocity + offset);
+}
+
+void applyRaycastVehicleForces(escene& scene, eallocator& arena, const collider_union* worldSpaceColliders, const bounding_box* worldSpaceAABBs,
+	uint32 numColliders, const physics_activity_level* regionPass, float dt)
+{
+	uint32 numVehicles = scene.numberOfComponentsOfType<raycast_vehicle_component>();
+	if (numVehicles == 0)
+	{
+		return;
+	}
+
+	CPU_PROFILE_BLOCK("Raycast vehicles");
+
+	memory_marker marker = arena.getMarker();
+
+	raycast_vehicle_reference* vehicles = arena.allocate<raycast_vehicle_reference>(numVehicles);
+	uint32 numActiveVehicles = 0;
+	uint32 numWheels = 0;
+
+	for (auto [entityHandle, vehicle, rb, transform] : scene.view<raycast_vehicle_component, rigid_body_component, physics_transform1_component>().each())
+	{
+		bool hasInput = vehicle.throttle != 0.f || vehicle.brake != 0.f;
+		if ((rb.isSleeping() && !hasInput) || rb.invMass == 0.f || vehicle.numWheels == 0)
+		{
+			continue;
+		}
+		if (regionPass && rb.activityLevel != *regionPass)
+		{
+			continue;
+		}
+
+		vehicles[numActiveVehicles++] = { entityHandle, &vehicle, &rb, &transform, numWheels };
+		numWheels += vehicle.numWheels;
+	}
+
+	if (numWheels == 0)
+	{
+		arena.resetToMarker(marker);
+		return;
+	}
+
+	uint32 numPaddedWheels = alignTo(numWheels, RAYCAST_VEHICLE_SIMD_WIDTH);
+
+	// Padding wheels are zero-initialized, which makes them airborne (hitDistance == rayLength) and forceless.
+	raycast_wheel_batch wheels;
+	wheels.up = allocateSOAVec3(arena, numPaddedWheels);
+	wheels.forward = allocateSOAVec3(arena, numPaddedWheels);
+	wheels.normal = allocateSOAVec3(arena, numPaddedWheels);
+	wheels.pointVelocity = allocateSOAVec3(arena, numPaddedWheels);
+	wheels.hitDistance = arena.allocate<float>(numPaddedWheels, true);
+	wheels.rayLength = arena.allocate<float>(numPaddedWheels, true);
+	wheels.radius = arena.allocate<float>(numPaddedWheels, true);
+	wheels.restLength = arena.allocate<float>(numPaddedWheels, true);
+	wheels.stiffness = arena.allocate<float>(numPaddedWheels, true);
+	wheels.damping = arena.allocate<float>(numPaddedWheels, true);
+	wheels.friction = arena.allocate<float>(numPaddedWheels, true);
+	wheels.corneringStiffness = arena.allocate<float>(numPaddedWheels, true);
+	wheels.driveForce = arena.allocate<float>(numPaddedWheels, true);
+	wheels.brakeForce = arena.allocate<float>(numPaddedWheels, true);
+	wheels.rollingResistance = arena.allocate<float>(numPaddedWheels, true);
+	wheels.force = allocateSOAVec3(arena, numPaddedWheels);
+	wheels.suspensionLength = arena.allocate<float>(numPaddedWheels, true);
+	wheels.longitudinalVelocity = arena.allocate<float>(numPaddedWheels, true);
+
+	raycast_query* queries = arena.allocate<raycast_query>(numWheels);
+	scene_query_hit* hits = arena.allocate<scene_query_hit>(numWheels);
+	uint32* vehicleIndexPerWheel = arena.allocate<uint32>(numWheels);
+
+	// Gather wheel parameters and build the wheel rays.
+	for (uint32 vehicleIndex = 0; vehicleIndex < numActiveVehicles; ++vehicleIndex)
+	{
+		const raycast_vehicle_reference& ref = vehicles[vehicleIndex];
+		const raycast_vehicle_component& vehicle = *ref.vehicle;
+		const trs& transform = *ref.transform;
+
+		uint32 numDrivenWheels = 0;
+		for (uint32 i = 0; i < vehicle.numWheels; ++i)
+		{
+			numDrivenWheels += vehicle.wheels[i].driven;
+		}
+
+		float driveForcePerWheel = (numDrivenWheels > 0) ? (clamp(vehicle.throttle, -1.f, 1.f) * vehicle.maxDriveForce / numDrivenWheels) : 0.f;
+		float brakeForcePerWheel = clamp(vehicle.brake, 0.f, 1.f) * vehicle.maxBrakeForce / vehicle.numWheels;
+
+		vec3 up = transform.rotation * vec3(0.f, 1.f, 0.f);
+
+		for (uint32 i = 0; i < vehicle.numWheels; ++i)
+		{
+			const raycast_wheel& wheel = vehicle.wheels[i];
+			uint32 w = ref.firstWheel + i;
+
+			float steeringAngle = getSteeringAngle(vehicle, wheel);
+			vec3 forward = transform.rotation * vec3(sin(steeringAngle), 0.f, cos(steeringAngle));
+
+			float rayLength = wheel.suspensionRestLength + wheel.radius;
+
+			writeSOAVec3(wheels.up, w, up);
+			writeSOAVec3(wheels.forward, w, forward);
+			wheels.rayLength[w] = rayLength;
+			wheels.radius[w] = wheel.radius;
+			wheels.restLength[w] = wheel.suspensionRestLength;
+			wheels.stiffness[w] = wheel.suspensionStiffness;
+			wheels.damping[w] = wheel.suspensionDamping;
+			wheels.friction[w] = wheel.frictionCoefficient;
+			wheels.corneringStiffness[w] = wheel.corneringStiffness;
+			wheels.driveForce[w] = wheel.driven ? driveForcePerWheel : 0.f;
+			wheels.brakeForce[w] = brakeForcePerWheel;
+			wheels.rollingResistance[w] = vehicle.rollingResistance;
+
+			raycast_query& query = queries[w];
+			query.r.origin = transformPosition(transform, wheel.localAttachment);
+			query.r.direction = -up;
+			query.maxDistance = rayLength;
+			query.filter.ignoreEntity = ref.entity;
+
+			vehicleIndexPerWheel[w] = vehicleIndex;
+		}
+	}
+
+	// All wheel rays are cast in one batch.
+	if (numColliders > 0)
+	{
+		scene_query_context context = buildSceneQueryContext(scene, arena, worldSpaceColliders, worldSpaceAABBs, numColliders);
+		raycast(context, queries, numWheels, hits);
+	}
+	else
+	{
+		for (uint32 w = 0; w < numWheels; ++w)
+		{
+			hits[w] = scene_query_hit();
+		}
+	}
+
+	uint32 numHeightmaps = scene.numberOfComponentsOfType<heightmap_collider_component>();
+	const heightmap_collider_component** heightmaps = arena.allocate<const heightmap_collider_component*>(numHeightmaps);
+	numHeightmaps = 0;
+	for (auto [entityHandle, heightmap] : scene.view<heightmap_collider_component>().each())
+	{
+		heightmaps[numHeightmaps++] = &heightmap;
+	}
+
+	// Resolve the closest ground hit per wheel and the chassis velocity at the contact point.
+	parallelFor(highPriorityJobQueue, numWheels, 256, [&](uint32 begin, uint32 end)
+	{
+		for (uint32 w = begin; w < end; ++w)
+		{
+			const raycast_query& query = queries[w];
+			const scene_query_hit& hit = hits[w];
+
+			float distance = query.maxDistance;
+			vec3 normal = -query.r.direction;
+
+			if (hit.hit())
+			{
+				distance = hit.distance;
+				normal = hit.normal;
+			}
+
+			float heightmapDistance;
+			vec3 heightmapNormal;
+			if (numHeightmaps > 0 && raycastHeightmaps(heightmaps, numHeightmaps, query.r, distance, heightmapDistance, heightmapNormal))
+			{
+				distance = heightmapDistance;
+				normal = heightmapNormal;
+			}
+
+			const raycast_vehicle_reference& ref = vehicles[vehicleIndexPerWheel[w]];
+			const raycast_wheel& wheel = ref.vehicle->wheels[w - ref.firstWheel];
+			vec3 localContact = wheel.localAttachment - vec3(0.f, distance, 0.f);
+
+			wheels.hitDistance[w] = distance;
+			writeSOAVec3(wheels.normal, w, normal);
+			writeSOAVec3(wheels.pointVelocity, w, ref.rb->getGlobalPointVelocity(*ref.transform, localContact));
+		}
+	});
+
+	// Suspension and tire forces in SIMD batches.
+	uint32 numBatches = numPaddedWheels / RAYCAST_VEHICLE_SIMD_WIDTH;
+	parallelFor(highPriorityJobQueue, numBatches, MIN_WHEEL_BATCHES_PER_JOB, [&wheels](uint32 begin, uint32 end)
+	{
+		for (uint32 batch = begin; batch < end; ++batch)
+		{
+			computeWheelForces(wheels, batch * RAYCAST_VEHICLE_SIMD_WIDTH);
+		}
+	});
+
+	// Apply the wheel forces to the chassis and update the wheel state. Every vehicle only writes its own components.
+	parallelFor(highPriorityJobQueue, numActiveVehicles, 64, [&wheels, vehicles, dt](uint32 begin, uint32 end)
+	{
+		for (uint32 vehicleIndex = begin; vehicleIndex < end; ++vehicleIndex)
+		{
+			const raycast_vehicle_reference& ref = vehicles[vehicleIndex];
+			raycast_vehicle_component& vehicle = *ref.vehicle;
+			rigid_body_component& rb = *ref.rb;
+			const trs& transform = *ref.transform;
+
+			vec3 globalCOG = rb.getGlobalCOGPosition(transform);
+
+			vec3 force(0.f);
+			vec3 torque(0.f);
+			for (uint32 i = 0; i < vehicle.numWheels; ++i)
+			{
+				raycast_wheel& wheel = vehicle.wheels[i];
+				uint32 w = ref.firstWheel + i;
+
+				vec3 wheelForce = readSOAVec3(wheels.force, w);
+				vec3 contact = transformPosition(transform, wheel.localAttachment - vec3(0.f, wheels.hitDistance[w], 0.f));
+
+				force += wheelForce;
+				torque += cross(contact - globalCOG, wheelForce);
+
+				wheel.grounded = wheels.hitDistance[w] < wheels.rayLength[w];
+				wheel.suspensionLength = wheels.suspensionLength[w];
+				wheel.rotation = fmod(wheel.rotation + wheels.longitudinalVelocity[w] / wheel.radius * dt, 2.f * M_PI);
+			}
+
+			rb.forceAccumulator += force;
+			rb.torqueAccumulator += torque;
+		}
+	});
+
+	arena.resetToMarker(marker);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "core/math.h"
+#include "core/memory.h"
+#include "scene/scene.h"
+#include "rigid_body.h"
+
+#define RAYCAST_VEHICLE_MAX_NUM_WHEELS 6
+
+// Lightweight vehicle for traffic and AI cars. The chassis is an ordinary rigid body; the wheels are not simulated as bodies, but as rays cast
+// down from their suspension attachments. Suspension and tire forces are computed from the ray hits and applied to the chassis.
+// All wheels of all vehicles are queried in one batch (against colliders and heightmaps) and their forces are evaluated in SIMD batches,
+// so a vehicle costs about as much as a single rigid body. The gear-driven vehicle in vehicle.h remains the high fidelity alternative.
+// The component sits on the chassis entity, which needs a rigid body. In the chassis' local space, +z is forward and +y is up.
+
+struct raycast_wheel
+{
+	vec3 localAttachment; // Top of the suspension travel in the chassis' local space.
+	float radius = 0.4f;
+	float suspensionRestLength = 0.4f;
+	float suspensionStiffness = 30000.f; // N/m.
+	float suspensionDamping = 3000.f; // Ns/m.
+	float frictionCoefficient = 1.2f; // Maximum tire force relative to the normal load.
+	float corneringStiffness = 4000.f; // Lateral force per m/s of sideways slip.
+
+	bool steered = false;
+	bool driven = false;
+
+	// State. Written by the physics step.
+	float suspensionLength; // Current length of the suspension. Equals the rest length when the wheel is in the air.
+	float rotation = 0.f; // Spin angle around the axle, for rendering.
+	bool grounded = false;
+};
+
+struct raycast_vehicle_component
+{
+	raycast_vehicle_component() {}
+
+	// Adds a wheel at the given position in the chassis' local space. Returns its index.
+	uint32 addWheel(vec3 localAttachment, float radius, bool steered, bool driven);
+
+	// Four wheels in the usual car layout. Front wheels are steered, the driven axle is selectable.
+	NODISCARD static raycast_vehicle_component fourWheels(float halfTrackWidth, float halfWheelBase, float attachmentHeight, float wheelRadius,
+		bool frontWheelDrive = false, bool rearWheelDrive = true);
+
+	// Local transform of a wheel's center relative to the chassis, including steering and spin. Use this for rendering wheel meshes.
+	NODISCARD trs getWheelLocalTransform(uint32 wheelIndex) const;
+
+	raycast_wheel wheels[RAYCAST_VEHICLE_MAX_NUM_WHEELS];
+	uint32 numWheels = 0;
+
+	// Input.
+	float throttle = 0.f; // [-1, 1].
+	float steering = 0.f; // [-1, 1]. Positive steers right.
+	float brake = 0.f; // [0, 1].
+
+	float maxSteeringAngle = deg2rad(35.f);
+	float maxDriveForce = 4000.f; // Summed over all driven wheels.
+	float maxBrakeForce = 8000.f; // Summed over all wheels.
+	float rollingResistance = 0.015f; // Relative to the normal load.
+};
+
+struct collider_union;
+
+// Internal. Called by the physics step before the sleeping islands are determined, so that vehicles with input wake up.
+// Sleeping vehicles without input are skipped. In region passes, only vehicles with the pass' activity level are updated.
+void applyRaycastVehicleForces(escene& scene, eallocator& arena, const collider_union* worldSpaceColliders, const bounding_box* worldSpaceAABBs,
+	uint32 numColliders, const physics_activity_level* regionPass, float dt);
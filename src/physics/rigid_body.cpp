@@ -1,6 +1,25 @@
 #include "pch.h"
 #include "rigid_body.h"
 #include "physics.h"
+#include "core/math_simd.h"
+#include "core/job_system.h"
+#include "core/cpu_profiling.h"
+
+#define RIGID_BODY_SIMD_WIDTH 8
+
+#define MIN_RIGID_BODY_BATCHES_PER_JOB 32
+
+#if RIGID_BODY_SIMD_WIDTH == 4
+typedef w4_float w_float;
+#elif RIGID_BODY_SIMD_WIDTH == 8 && defined(SIMD_AVX_2)
+typedef w8_float w_float;
+#elif RIGID_BODY_SIMD_WIDTH == 16 && defined(SIMD_AVX_512)
+typedef w16_float w_float;
+#endif
+
+typedef wN_vec3<w_float> w_vec3;
+typedef wN_quat<w_float> w_quat;
+typedef wN_mat3<w_float> w_mat3;
 
 rigid_body_component::rigid_body_component(bool kinematic, float gravityFactor, float linearDamping, float angularDamping)
 {
@@ -23,6 +42,11 @@ rigid_body_component::rigid_body_component(bool kinematic, float gravityFactor,
 	this->angularVelocity = vec3(0.f);
 	this->forceAccumulator = vec3(0.f);
 	this->torqueAccumulator = vec3(0.f);
+	this->continuousCollision = false;
+	this->articulated = false;
+	this->sleepTimer = 0.f;
+	this->sleepingIsland = 0;
+	this->activityLevel = physics_activity_full;
 }
 
 void rigid_body_component::recalculateProperties(entt::registry* registry, const physics_reference_component& reference)
@@ -84,49 +108,282 @@ NODISCARD vec3 rigid_body_component::getGlobalPointVelocity(const trs& transform
 	return linearVelocity + cross(angularVelocity, globalP - globalCOG);
 }
 
-void rigid_body_component::applyGravityAndIntegrateForces(rigid_body_global_state& global, const trs& transform, float dt)
+void rigid_body_component::wakeUp()
 {
-	global.rotation = transform.rotation;
-	global.position = transform.position + transform.rotation * localCOGPosition;
+	sleepTimer = 0.f;
+	sleepingIsland = 0;
+}
+
+// Component pointers in rigid body index order. Valid from the force to the velocity integration of one step. Only the allocation persists 
+// (in the registry's context, so that it is reused across steps).
+struct rigid_body_integration_context
+{
+	std::vector<rigid_body_component*> rbs;
+	std::vector<physics_transform1_component*> transforms;
+};
 
-	mat3 rot = quaternionToMat3(global.rotation);
-	global.invInertia = rot * invInertia * transpose(rot);
-	global.invMass = invMass;
+// Per-body inputs of the force integration, which are not part of the global state.
+struct rigid_body_force_input
+{
+	vec3 force;
+	vec3 torque;
+	float gravityFactor;
+	float linearDamping;
 
-	if (invMass > 0.f)
+	float angularDamping;
+	float active; // 1 if the body is simulated in this step, 0 otherwise.
+	float integrateForces; // 1 if the body is active and not articulated.
+	float padding[5];
+};
+
+// Output of the velocity integration. Rotation and origin of the entity.
+struct rigid_body_integrated_pose
+{
+	quat rotation;
+	vec3 position;
+	float padding;
+};
+
+// The kernels load and store the global states with the same transposing gathers as the constraint solver. Indices are relative to the first body
+// of the batch. Lanes past the last body repeat it, so they compute and store the same values and nothing is accessed out of bounds.
+static void getBatchIndices(uint32 count, uint16* outIndices)
+{
+	for (uint32 lane = 0; lane < RIGID_BODY_SIMD_WIDTH; ++lane)
 	{
-		forceAccumulator.y += (GRAVITY / invMass * gravityFactor);
+		outIndices[lane] = (uint16)min(lane, count - 1);
 	}
+}
+
+// Expects the local inverse inertia and the origin of the entity in the global states and replaces them with the world space inverse inertia
+// and the center of gravity.
+static void integrateForcesSIMD(rigid_body_global_state* rbs, const rigid_body_force_input* inputs, const uint16* indices, float dt)
+{
+	const uint32 stride = (uint32)sizeof(rigid_body_global_state);
 
-	vec3 linearAcceleration = forceAccumulator * invMass;
-	vec3 angularAcceleration = global.invInertia * torqueAccumulator;
+	w_quat rotation;
+	w_vec3 localCOGPosition;
+	w_vec3 position;
+	w_mat3 localInvInertia;
+	w_float invMass;
+	w_vec3 linearVelocity;
+	w_vec3 angularVelocity;
+	w_float dummy0, dummy1; // The outputs of a load must not alias.
+
+	load8(&rbs->rotation.x, indices, stride,
+		rotation.x, rotation.y, rotation.z, rotation.w,
+		localCOGPosition.x, localCOGPosition.y, localCOGPosition.z,
+		position.x);
+	load8(&rbs->position.y, indices, stride,
+		position.y, position.z,
+		localInvInertia.m00, localInvInertia.m10, localInvInertia.m20,
+		localInvInertia.m01, localInvInertia.m11, localInvInertia.m21);
+	load4(&rbs->invInertia.m02, indices, stride,
+		localInvInertia.m02, localInvInertia.m12, localInvInertia.m22,
+		invMass);
+	load8(&rbs->invInertia.m22, indices, stride,
+		dummy0, dummy1,
+		linearVelocity.x, linearVelocity.y, linearVelocity.z,
+		angularVelocity.x, angularVelocity.y, angularVelocity.z);
+
+	w_vec3 force, torque;
+	w_float gravityFactor, linearDamping, angularDamping;
+	w_float activeMask, integrateForcesMask;
+
+	const uint32 inputStride = (uint32)sizeof(rigid_body_force_input);
+	load8(&inputs->force.x, indices, inputStride,
+		force.x, force.y, force.z,
+		torque.x, torque.y, torque.z,
+		gravityFactor, linearDamping);
+	load4(&inputs->angularDamping, indices, inputStride,
+		angularDamping, activeMask, integrateForcesMask, dummy0);
+
+	w_float zero = w_float::zero();
+	w_float dtW = dt;
+
+	auto active = activeMask > zero;
+	auto integrateForces = integrateForcesMask > zero;
+
+	w_vec3 cogPosition = position + rotation * localCOGPosition;
+
+	w_mat3 rot = quaternionToMat3(rotation);
+	w_mat3 invInertia = rot * localInvInertia * transpose(rot);
+
+	force.y = force.y + ifThen(invMass > zero, w_float(GRAVITY) / invMass * gravityFactor, zero);
 
 	// Semi-implicit Euler integration
-	linearVelocity += linearAcceleration * dt;
-	angularVelocity += angularAcceleration * dt;
+	w_vec3 integratedLinearVelocity = linearVelocity + force * (invMass * dtW);
+	w_vec3 integratedAngularVelocity = angularVelocity + (invInertia * torque) * dtW;
+
+	w_float one = 1.f;
+	integratedLinearVelocity = integratedLinearVelocity * (one / fmadd(dtW, linearDamping, one));
+	integratedAngularVelocity = integratedAngularVelocity * (one / fmadd(dtW, angularDamping, one));
+
+	linearVelocity = ifThen(integrateForces, integratedLinearVelocity, linearVelocity);
+	angularVelocity = ifThen(integrateForces, integratedAngularVelocity, angularVelocity);
+
+	// Inactive bodies act as static geometry.
+	linearVelocity = ifThen(active, linearVelocity, w_vec3::zero());
+	angularVelocity = ifThen(active, angularVelocity, w_vec3::zero());
+	invMass = ifThen(active, invMass, zero);
+	invInertia = w_mat3(
+		ifThen(active, invInertia.m00, zero), ifThen(active, invInertia.m01, zero), ifThen(active, invInertia.m02, zero),
+		ifThen(active, invInertia.m10, zero), ifThen(active, invInertia.m11, zero), ifThen(active, invInertia.m12, zero),
+		ifThen(active, invInertia.m20, zero), ifThen(active, invInertia.m21, zero), ifThen(active, invInertia.m22, zero));
+
+	store8(&rbs->position.x, indices, stride,
+		cogPosition.x, cogPosition.y, cogPosition.z,
+		invInertia.m00, invInertia.m10, invInertia.m20,
+		invInertia.m01, invInertia.m11);
+	store4(&rbs->invInertia.m21, indices, stride,
+		invInertia.m21, invInertia.m02, invInertia.m12, invInertia.m22);
+	store8(&rbs->invInertia.m22, indices, stride,
+		invInertia.m22, invMass,
+		linearVelocity.x, linearVelocity.y, linearVelocity.z,
+		angularVelocity.x, angularVelocity.y, angularVelocity.z);
+}
+
+static void integrateVelocitiesSIMD(const rigid_body_global_state* rbs, rigid_body_integrated_pose* outPoses, const uint16* indices, float dt)
+{
+	const uint32 stride = (uint32)sizeof(rigid_body_global_state);
+
+	w_quat rotation;
+	w_vec3 localCOGPosition;
+	w_vec3 cogPosition;
+	w_vec3 linearVelocity;
+	w_vec3 angularVelocity;
+	w_float dummy0, dummy1; // The outputs of a load must not alias.
+
+	load8(&rbs->rotation.x, indices, stride,
+		rotation.x, rotation.y, rotation.z, rotation.w,
+		localCOGPosition.x, localCOGPosition.y, localCOGPosition.z,
+		cogPosition.x);
+	load4(&rbs->position.y, indices, stride,
+		cogPosition.y, cogPosition.z, dummy0, dummy1);
+	load8(&rbs->invInertia.m22, indices, stride,
+		dummy0, dummy1,
+		linearVelocity.x, linearVelocity.y, linearVelocity.z,
+		angularVelocity.x, angularVelocity.y, angularVelocity.z);
+
+	w_float dtW = dt;
+	w_float half = 0.5f;
 
-	linearVelocity *= 1.f / (1.f + dt * linearDamping);
-	angularVelocity *= 1.f / (1.f + dt * angularDamping);
+	w_quat deltaRot(angularVelocity.x * half, angularVelocity.y * half, angularVelocity.z * half, w_float::zero());
+	deltaRot = deltaRot * rotation;
 
-	global.linearVelocity = linearVelocity;
-	global.angularVelocity = angularVelocity;
-	global.localCOGPosition = localCOGPosition;
+	rotation = normalize(rotation + deltaRot * dtW);
+	cogPosition = cogPosition + linearVelocity * dtW;
+
+	w_vec3 position = cogPosition - rotation * localCOGPosition;
+
+	store8(&outPoses->rotation.x, indices, (uint32)sizeof(rigid_body_integrated_pose),
+		rotation.x, rotation.y, rotation.z, rotation.w,
+		position.x, position.y, position.z,
+		dummy0);
 }
 
-void rigid_body_component::integrateVelocity(const rigid_body_global_state& global, trs& transform, float dt)
+void integrateRigidBodyForces(escene& scene, rigid_body_global_state* rbGlobal, const bool* sleepingPerBody, uint32 numRigidBodies, vec3 globalForceField, float dt)
 {
-	linearVelocity = global.linearVelocity;
-	angularVelocity = global.angularVelocity;
+	CPU_PROFILE_BLOCK("Integrate rigid body forces");
+
+	rigid_body_integration_context& context = createOrGetContextVariable<rigid_body_integration_context>(scene.registry);
+	context.rbs.resize(numRigidBodies);
+	context.transforms.resize(numRigidBodies);
+
+	uint32 rbIndex = numRigidBodies - 1; // EnTT iterates back to front
+	for (auto [entityHandle, rb, transform] : scene.group<rigid_body_component, physics_transform1_component>().each())
+	{
+		uint32 index = rbIndex--;
+		context.rbs[index] = &rb;
+		context.transforms[index] = &transform;
+	}
+
+	uint32 numBatches = alignTo(numRigidBodies, RIGID_BODY_SIMD_WIDTH) / RIGID_BODY_SIMD_WIDTH;
+
+	// Copy, integrate and write the solver state batch by batch, so that every batch stays in cache.
+	parallelFor(highPriorityJobQueue, numBatches, MIN_RIGID_BODY_BATCHES_PER_JOB, [&context, rbGlobal, sleepingPerBody, numRigidBodies, globalForceField, dt](uint32 begin, uint32 end)
+	{
+		for (uint32 batch = begin; batch < end; ++batch)
+		{
+			uint32 offset = batch * RIGID_BODY_SIMD_WIDTH;
+			uint32 count = min(numRigidBodies - offset, (uint32)RIGID_BODY_SIMD_WIDTH);
+
+			rigid_body_force_input inputs[RIGID_BODY_SIMD_WIDTH];
+
+			for (uint32 lane = 0; lane < count; ++lane)
+			{
+				uint32 i = offset + lane;
+				const rigid_body_component& rb = *context.rbs[i];
+				const physics_transform1_component& transform = *context.transforms[i];
+				bool active = !sleepingPerBody[i];
 
-	quat deltaRot(0.5f * angularVelocity.x, 0.5f * angularVelocity.y, 0.5f * angularVelocity.z, 0.f);
-	deltaRot = deltaRot * global.rotation;
+				rigid_body_global_state& global = rbGlobal[i];
+				global.rotation = transform.rotation;
+				global.localCOGPosition = rb.localCOGPosition;
+				global.position = transform.position;
+				global.invInertia = rb.invInertia;
+				global.invMass = rb.invMass;
+				global.linearVelocity = rb.linearVelocity;
+				global.angularVelocity = rb.angularVelocity;
 
-	quat rotation = normalize(global.rotation + (deltaRot * dt));
-	vec3 position = global.position + linearVelocity * dt;
+				rigid_body_force_input& input = inputs[lane];
+				input.force = active ? (rb.forceAccumulator + globalForceField) : rb.forceAccumulator;
+				input.torque = rb.torqueAccumulator;
+				input.gravityFactor = rb.gravityFactor;
+				input.linearDamping = rb.linearDamping;
+				input.angularDamping = rb.angularDamping;
+				input.active = active ? 1.f : 0.f;
+				input.integrateForces = (active && !rb.articulated) ? 1.f : 0.f;
+			}
 
-	forceAccumulator = vec3(0.f, 0.f, 0.f);
-	torqueAccumulator = vec3(0.f, 0.f, 0.f);
+			uint16 indices[RIGID_BODY_SIMD_WIDTH];
+			getBatchIndices(count, indices);
 
-	transform.rotation = rotation;
-	transform.position = position - rotation * localCOGPosition;
-}
\ No newline at end of file
+			integrateForcesSIMD(rbGlobal + offset, inputs, indices, dt);
+		}
+	});
+}
+
+void integrateRigidBodyVelocities(escene& scene, const rigid_body_global_state* rbGlobal, const bool* sleepingPerBody, uint32 numRigidBodies, float dt)
+{
+	CPU_PROFILE_BLOCK("Integrate rigid body velocities");
+
+	rigid_body_integration_context& context = createOrGetContextVariable<rigid_body_integration_context>(scene.registry);
+	ASSERT(context.rbs.size() == numRigidBodies);
+
+	uint32 numBatches = alignTo(numRigidBodies, RIGID_BODY_SIMD_WIDTH) / RIGID_BODY_SIMD_WIDTH;
+
+	parallelFor(highPriorityJobQueue, numBatches, MIN_RIGID_BODY_BATCHES_PER_JOB, [&context, rbGlobal, sleepingPerBody, numRigidBodies, dt](uint32 begin, uint32 end)
+	{
+		for (uint32 batch = begin; batch < end; ++batch)
+		{
+			uint32 offset = batch * RIGID_BODY_SIMD_WIDTH;
+			uint32 count = min(numRigidBodies - offset, (uint32)RIGID_BODY_SIMD_WIDTH);
+
+			uint16 indices[RIGID_BODY_SIMD_WIDTH];
+			getBatchIndices(count, indices);
+
+			rigid_body_integrated_pose poses[RIGID_BODY_SIMD_WIDTH];
+			integrateVelocitiesSIMD(rbGlobal + offset, poses, indices, dt);
+
+			for (uint32 lane = 0; lane < count; ++lane)
+			{
+				uint32 i = offset + lane;
+				if (sleepingPerBody[i])
+				{
+					continue;
+				}
+
+				rigid_body_component& rb = *context.rbs[i];
+				physics_transform1_component& transform = *context.transforms[i];
+
+				rb.linearVelocity = rbGlobal[i].linearVelocity;
+				rb.angularVelocity = rbGlobal[i].angularVelocity;
+				rb.forceAccumulator = vec3(0.f, 0.f, 0.f);
+				rb.torqueAccumulator = vec3(0.f, 0.f, 0.f);
+
+				transform.rotation = poses[lane].rotation;
+				transform.position = poses[lane].position;
+			}
+		}
+	});
+}
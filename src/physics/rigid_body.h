@@ -15,6 +15,14 @@ struct rigid_body_global_state
 	vec3 angularVelocity;
 };
 
+// Simulation rate of a body, as determined by the simulation regions (see physics_settings).
+enum physics_activity_level : uint8
+{
+	physics_activity_full,
+	physics_activity_reduced,
+	physics_activity_frozen,
+};
+
 struct rigid_body_component
 {
 	rigid_body_component() : rigid_body_component(true, 1.f) {}
@@ -23,8 +31,10 @@ struct rigid_body_component
 	NODISCARD vec3 getGlobalCOGPosition(const trs& transform) const;
 	NODISCARD vec3 getGlobalPointVelocity(const trs& transform, vec3 localP) const;
 
-	void applyGravityAndIntegrateForces(rigid_body_global_state& global, const trs& transform, float dt);
-	void integrateVelocity(const rigid_body_global_state& global, trs& transform, float dt);
+	// Sleeping bodies are frozen in place and treated as static until they are woken up. This happens automatically when forces are applied,
+	// or when an awake body comes close. Call this manually after teleporting a body or changing its constraints.
+	void wakeUp();
+	NODISCARD bool isSleeping() const { return sleepingIsland != 0; }
 
 	// In entity's local space.
 	vec3 localCOGPosition;
@@ -41,6 +51,13 @@ struct rigid_body_component
 
 	vec3 forceAccumulator;
 	vec3 torqueAccumulator;
+
+	bool continuousCollision; // Always use continuous collision detection for this body. Other bodies only use it when moving fast.
+	bool articulated; // Link of an articulation (see articulation.h). Forces are integrated by the articulation.
+
+	float sleepTimer; // Time the body has been at rest.
+	uint32 sleepingIsland; // All bodies in an island fall asleep and wake up together. 0 if awake.
+	physics_activity_level activityLevel; // Updated by the simulation regions every step.
 };
 
 struct physics_transform0_component : trs 
@@ -53,4 +70,15 @@ struct physics_transform1_component : trs
 {
 	physics_transform1_component() {}
 	physics_transform1_component(const trs& t) : trs(t) {}
-};
\ No newline at end of file
+};
+
+// Internal. Called by the physics step.
+// The integration runs as SIMD kernels directly on the global states, which the components are copied to before the force integration and written 
+// back from after the velocity integration. Index i refers to the i-th body of the rigid body group.
+
+// Applies gravity and the global force field, integrates forces and damping and writes the global states for the constraint solver.
+// Inactive bodies (sleeping or not part of the current region pass) are written as static bodies.
+void integrateRigidBodyForces(escene& scene, rigid_body_global_state* rbGlobal, const bool* sleepingPerBody, uint32 numRigidBodies, vec3 globalForceField, float dt);
+
+// Integrates the solved velocities and writes velocities and transforms back to the components. Inactive bodies are not touched.
+void integrateRigidBodyVelocities(escene& scene, const rigid_body_global_state* rbGlobal, const bool* sleepingPerBody, uint32 numRigidBodies, float dt);
@@ -0,0 +1,638 @@
+#include "pch.h"
+#include "scene_queries.h"
+#include "core/cpu_profiling.h"
+#include "core/job_system.h"
+
+#define SCENE_QUERY_BVH_MAX_LEAF_SIZE 4
+#define SCENE_QUERY_BVH_STACK_SIZE 64
+#define SCENE_QUERY_MIN_BATCH_SIZE 32
+
+NODISCARD bounding_box scene_query_shape::getAABB() const
+{
+	switch (type)
+	{
+		case collider_type_sphere: return bounding_box::fromCenterRadius(sphere.center, sphere.radius);
+		case collider_type_capsule:
+		{
+			vec3 radius(capsule.radius);
+			return bounding_box::fromMinMax(min(capsule.positionA, capsule.positionB) - radius, max(capsule.positionA, capsule.positionB) + radius);
+		}
+		case collider_type_obb: return obb.getAABB();
+	}
+
+	ASSERT(false);
+	return bounding_box::everything();
+}
+
+static void buildBVHNode(scene_query_context& context, const vec3* centers, uint32 nodeIndex, uint32 first, uint32 count)
+{
+	scene_query_bvh_node& node = context.nodes[nodeIndex];
+
+	node.aabb = bounding_box::negativeInfinity();
+	bounding_box centerBounds = bounding_box::negativeInfinity();
+	for (uint32 i = first; i < first + count; ++i)
+	{
+		uint16 primitive = context.primitiveIndices[i];
+		node.aabb.grow(context.worldSpaceAABBs[primitive].minCorner);
+		node.aabb.grow(context.worldSpaceAABBs[primitive].maxCorner);
+		centerBounds.grow(centers[primitive]);
+	}
+
+	if (count <= SCENE_QUERY_BVH_MAX_LEAF_SIZE)
+	{
+		node.firstChildOrPrimitive = first;
+		node.numPrimitives = count;
+		return;
+	}
+
+	// Median split along the axis with the largest extent.
+	vec3 extent = centerBounds.maxCorner - centerBounds.minCorner;
+	uint32 axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) : ((extent.y > extent.z) ? 1 : 2);
+
+	uint32 half = count / 2;
+	uint16* begin = context.primitiveIndices + first;
+	std::nth_element(begin, begin + half, begin + count, [centers, axis](uint16 a, uint16 b)
+	{
+		return centers[a].data[axis] < centers[b].data[axis];
+	});
+
+	uint32 leftChild = context.numNodes;
+	context.numNodes += 2;
+
+	node.firstChildOrPrimitive = leftChild;
+	node.numPrimitives = 0;
+
+	buildBVHNode(context, centers, leftChild, first, half);
+	buildBVHNode(context, centers, leftChild + 1, first + half, count - half);
+}
+
+NODISCARD scene_query_context buildSceneQueryContext(escene& scene, eallocator& arena, const collider_union* worldSpaceColliders, const bounding_box* worldSpaceAABBs, uint32 numColliders)
+{
+	CPU_PROFILE_BLOCK("Build scene query context");
+
+	scene_query_context context;
+	context.worldSpaceColliders = worldSpaceColliders;
+	context.worldSpaceAABBs = worldSpaceAABBs;
+	context.numColliders = numColliders;
+	context.colliderEntities = arena.allocate<entity_handle>(numColliders);
+	context.parentEntities = arena.allocate<entity_handle>(numColliders);
+	context.primitiveIndices = arena.allocate<uint16>(numColliders);
+	context.nodes = arena.allocate<scene_query_bvh_node>(max(2 * numColliders, 1u));
+	context.numNodes = 0;
+
+	for (uint32 i = 0; i < numColliders; ++i)
+	{
+		// World space colliders are stored in reverse order compared to the collider components.
+		eentity colliderEntity = scene.getEntityFromComponentAtIndex<collider_component>(numColliders - 1 - i);
+		context.colliderEntities[i] = colliderEntity.handle;
+		context.parentEntities[i] = colliderEntity.getComponent<collider_component>().parentEntity;
+		context.primitiveIndices[i] = (uint16)i;
+	}
+
+	if (numColliders > 0)
+	{
+		memory_marker marker = arena.getMarker();
+
+		vec3* centers = arena.allocate<vec3>(numColliders);
+		for (uint32 i = 0; i < numColliders; ++i)
+		{
+			centers[i] = worldSpaceAABBs[i].getCenter();
+		}
+
+		context.numNodes = 1;
+		buildBVHNode(context, centers, 0, 0, numColliders);
+
+		arena.resetToMarker(marker);
+	}
+
+	return context;
+}
+
+NODISCARD scene_query_context buildSceneQueryContext(escene& scene, eallocator& arena)
+{
+	uint32 numColliders = scene.numberOfComponentsOfType<collider_component>();
+	uint32 numRigidBodies = scene.numberOfComponentsOfType<rigid_body_component>();
+
+	bounding_box* worldSpaceAABBs = arena.allocate<bounding_box>(numColliders);
+	collider_union* worldSpaceColliders = arena.allocate<collider_union>(numColliders);
+	getWorldSpaceColliders(scene, worldSpaceAABBs, worldSpaceColliders, (uint16)numRigidBodies);
+
+	return buildSceneQueryContext(scene, arena, worldSpaceColliders, worldSpaceAABBs, numColliders);
+}
+
+static bool passesFilter(const scene_query_context& context, uint32 colliderIndex, const scene_query_filter& filter)
+{
+	const collider_union& collider = context.worldSpaceColliders[colliderIndex];
+	return (filter.objectTypes & (1 << collider.objectType)) != 0
+		&& context.parentEntities[colliderIndex] != filter.ignoreEntity;
+}
+
+// Unlike ray::intersectAABB, this also reports a hit if the origin is inside the box.
+static bool rayVsNode(vec3 origin, vec3 direction, vec3 invDirection, const bounding_box& aabb, float maxDistance)
+{
+	float tmin = 0.f;
+	float tmax = maxDistance;
+
+	for (uint32 axis = 0; axis < 3; ++axis)
+	{
+		float o = origin.data[axis];
+		float lo = aabb.minCorner.data[axis];
+		float hi = aabb.maxCorner.data[axis];
+
+		if (direction.data[axis] == 0.f)
+		{
+			// The ray is parallel to this slab. Handled explicitly, since (lo - o) * inf is NaN if the origin lies on the slab plane.
+			if (o < lo || o > hi)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		float t1 = (lo - o) * invDirection.data[axis];
+		float t2 = (hi - o) * invDirection.data[axis];
+
+		tmin = max(tmin, min(t1, t2));
+		tmax = min(tmax, max(t1, t2));
+	}
+
+	return tmin <= tmax;
+}
+
+// Calls func(colliderIndex, currentMaxDistance) for all colliders, whose (padded) AABB is hit by the ray. func returns the new max distance.
+template <typename func_t>
+static void traverseRay(const scene_query_context& context, vec3 origin, vec3 direction, float maxDistance, vec3 padding, const func_t& func)
+{
+	if (context.numNodes == 0)
+	{
+		return;
+	}
+
+	vec3 invDirection = vec3(1.f / direction.x, 1.f / direction.y, 1.f / direction.z); // Inf for zero components, which rayVsNode does not use.
+
+	uint32 stack[SCENE_QUERY_BVH_STACK_SIZE];
+	uint32 stackPtr = 0;
+	stack[stackPtr++] = 0;
+
+	while (stackPtr > 0)
+	{
+		const scene_query_bvh_node& node = context.nodes[stack[--stackPtr]];
+
+		bounding_box aabb = bounding_box::fromMinMax(node.aabb.minCorner - padding, node.aabb.maxCorner + padding);
+		if (!rayVsNode(origin, direction, invDirection, aabb, maxDistance))
+		{
+			continue;
+		}
+
+		if (node.numPrimitives > 0)
+		{
+			for (uint32 i = 0; i < node.numPrimitives; ++i)
+			{
+				maxDistance = func(context.primitiveIndices[node.firstChildOrPrimitive + i], maxDistance);
+			}
+		}
+		else
+		{
+			ASSERT(stackPtr + 2 <= SCENE_QUERY_BVH_STACK_SIZE);
+			stack[stackPtr++] = node.firstChildOrPrimitive;
+			stack[stackPtr++] = node.firstChildOrPrimitive + 1;
+		}
+	}
+}
+
+static vec3 getBoxNormal(vec3 localPoint, vec3 radius)
+{
+	vec3 p = localPoint / radius;
+	vec3 a = vec3(fabsf(p.x), fabsf(p.y), fabsf(p.z));
+
+	if (a.x > a.y && a.x > a.z)
+	{
+		return vec3(p.x < 0.f ? -1.f : 1.f, 0.f, 0.f);
+	}
+	if (a.y > a.z)
+	{
+		return vec3(0.f, p.y < 0.f ? -1.f : 1.f, 0.f);
+	}
+	return vec3(0.f, 0.f, p.z < 0.f ? -1.f : 1.f);
+}
+
+static bool raycastHull(const ray& r, const bounding_hull& hull, float& outT, vec3& outNormal)
+{
+	const bounding_hull_geometry& geometry = *hull.geometryPtr;
+	ray localR = { conjugate(hull.rotation) * (r.origin - hull.position), conjugate(hull.rotation) * r.direction };
+
+	float minT = FLT_MAX;
+	bool result = false;
+
+	for (const bounding_hull_face& face : geometry.faces)
+	{
+		float t;
+		bool frontFacing;
+		if (localR.intersectTriangle(geometry.vertices[face.a], geometry.vertices[face.b], geometry.vertices[face.c], t, frontFacing) && t < minT)
+		{
+			minT = t;
+			outNormal = hull.rotation * face.normal;
+			result = true;
+		}
+	}
+
+	outT = minT;
+	return result;
+}
+
+static bool raycastCollider(const ray& r, const collider_union& collider, float& outT, vec3& outNormal)
+{
+	switch (collider.type)
+	{
+		case collider_type_sphere:
+		{
+			if (!r.intersectSphere(collider.sphere, outT))
+			{
+				return false;
+			}
+			outNormal = noz(r.origin + outT * r.direction - collider.sphere.center);
+		} break;
+
+		case collider_type_capsule:
+		{
+			if (!r.intersectCapsule(collider.capsule, outT))
+			{
+				return false;
+			}
+			vec3 point = r.origin + outT * r.direction;
+			vec3 closest = closestPoint_PointSegment(point, line_segment{ collider.capsule.positionA, collider.capsule.positionB });
+			outNormal = noz(point - closest);
+		} break;
+
+		case collider_type_cylinder:
+		{
+			if (!r.intersectCylinder(collider.cylinder, outT))
+			{
+				return false;
+			}
+			vec3 point = r.origin + outT * r.direction;
+			vec3 axis = collider.cylinder.positionB - collider.cylinder.positionA;
+			float height = length(axis);
+			axis /= height;
+
+			float h = dot(point - collider.cylinder.positionA, axis);
+			vec3 radial = point - (collider.cylinder.positionA + h * axis);
+
+			float distanceToCap = min(h, height - h);
+			float distanceToSide = fabsf(length(radial) - collider.cylinder.radius);
+			outNormal = (distanceToSide < distanceToCap) ? noz(radial) : ((h < 0.5f * height) ? -axis : axis);
+		} break;
+
+		case collider_type_aabb:
+		{
+			if (!r.intersectAABB(collider.aabb, outT))
+			{
+				return false;
+			}
+			vec3 point = r.origin + outT * r.direction;
+			outNormal = getBoxNormal(point - collider.aabb.getCenter(), collider.aabb.getRadius());
+		} break;
+
+		case collider_type_obb:
+		{
+			if (!r.intersectOBB(collider.obb, outT))
+			{
+				return false;
+			}
+			vec3 point = r.origin + outT * r.direction;
+			vec3 localPoint = conjugate(collider.obb.rotation) * (point - collider.obb.center);
+			outNormal = collider.obb.rotation * getBoxNormal(localPoint, collider.obb.radius);
+		} break;
+
+		case collider_type_hull:
+		{
+			if (!raycastHull(r, collider.hull, outT, outNormal))
+			{
+				return false;
+			}
+		} break;
+
+		default: return false;
+	}
+
+	if (outT <= 0.f)
+	{
+		// Origin is inside the collider.
+		outT = 0.f;
+		outNormal = -r.direction;
+	}
+	return true;
+}
+
+void raycast(const scene_query_context& context, const raycast_query* queries, uint32 numQueries, scene_query_hit* outHits)
+{
+	CPU_PROFILE_BLOCK("Raycast batch");
+
+	parallelFor(highPriorityJobQueue, numQueries, SCENE_QUERY_MIN_BATCH_SIZE, [&](uint32 begin, uint32 end)
+	{
+		for (uint32 queryIndex = begin; queryIndex < end; ++queryIndex)
+		{
+			const raycast_query& query = queries[queryIndex];
+			scene_query_hit& hit = outHits[queryIndex];
+			hit = scene_query_hit{};
+
+			traverseRay(context, query.r.origin, query.r.direction, query.maxDistance, vec3(0.f), [&](uint32 colliderIndex, float maxDistance)
+			{
+				if (!passesFilter(context, colliderIndex, query.filter))
+				{
+					return maxDistance;
+				}
+
+				float t;
+				vec3 normal;
+				if (!raycastCollider(query.r, context.worldSpaceColliders[colliderIndex], t, normal) || t > maxDistance)
+				{
+					return maxDistance;
+				}
+
+				hit.entity = context.parentEntities[colliderIndex];
+				hit.colliderEntity = context.colliderEntities[colliderIndex];
+				hit.point = query.r.origin + t * query.r.direction;
+				hit.normal = normal;
+				hit.distance = t;
+				return t;
+			});
+
+			if (hit.hit())
+			{
+				hit.fraction = (query.maxDistance > 0.f && query.maxDistance < FLT_MAX) ? (hit.distance / query.maxDistance) : 0.f;
+			}
+		}
+	});
+}
+
+template <typename query_support_t>
+static bool sweepAgainstCollider(const query_support_t& querySupport, const collider_union& collider, vec3 direction, float maxDistance, gjk_raycast_result& outResult)
+{
+	switch (collider.type)
+	{
+		case collider_type_sphere: return gjkRaycast(querySupport, sphere_support_fn{ collider.sphere }, direction, maxDistance, outResult);
+		case collider_type_capsule: return gjkRaycast(querySupport, capsule_support_fn{ collider.capsule }, direction, maxDistance, outResult);
+		case collider_type_cylinder: return gjkRaycast(querySupport, cylinder_support_fn{ collider.cylinder }, direction, maxDistance, outResult);
+		case collider_type_aabb: return gjkRaycast(querySupport, aabb_support_fn{ collider.aabb }, direction, maxDistance, outResult);
+		case collider_type_obb: return gjkRaycast(querySupport, obb_support_fn{ collider.obb }, direction, maxDistance, outResult);
+		case collider_type_hull: return gjkRaycast(querySupport, hull_support_fn{ collider.hull }, direction, maxDistance, outResult);
+	}
+	return false;
+}
+
+static bool sweepCollider(const scene_query_shape& shape, const collider_union& collider, vec3 direction, float maxDistance, gjk_raycast_result& outResult)
+{
+	if (shape.type == collider_type_sphere && (collider.type == collider_type_sphere || collider.type == collider_type_capsule))
+	{
+		// Sphere vs. sphere and sphere vs. capsule sweeps are ray casts against the inflated collider.
+		ray r = { shape.sphere.center, direction };
+		float radius = shape.sphere.radius;
+
+		float t;
+		vec3 closest;
+		if (collider.type == collider_type_sphere)
+		{
+			if (!r.intersectSphere(collider.sphere.center, collider.sphere.radius + radius, t))
+			{
+				return false;
+			}
+			closest = collider.sphere.center;
+		}
+		else
+		{
+			if (!r.intersectCapsule(bounding_capsule{ collider.capsule.positionA, collider.capsule.positionB, collider.capsule.radius + radius }, t))
+			{
+				return false;
+			}
+			closest = closestPoint_PointSegment(r.origin + t * direction, line_segment{ collider.capsule.positionA, collider.capsule.positionB });
+		}
+
+		if (t > maxDistance)
+		{
+			return false;
+		}
+
+		vec3 center = r.origin + t * direction;
+		float colliderRadius = (collider.type == collider_type_sphere) ? collider.sphere.radius : collider.capsule.radius;
+
+		outResult.distance = t;
+		outResult.normal = (t > 0.f) ? noz(center - closest) : -direction;
+		outResult.point = closest + outResult.normal * colliderRadius;
+		return true;
+	}
+
+	switch (shape.type)
+	{
+		case collider_type_sphere: return sweepAgainstCollider(sphere_support_fn{ shape.sphere }, collider, direction, maxDistance, outResult);
+		case collider_type_capsule: return sweepAgainstCollider(capsule_support_fn{ shape.capsule }, collider, direction, maxDistance, outResult);
+		case collider_type_obb: return sweepAgainstCollider(obb_support_fn{ shape.obb }, collider, direction, maxDistance, outResult);
+	}
+
+	ASSERT(false);
+	return false;
+}
+
+NODISCARD bool sweepCollider(const collider_union& shape, const collider_union& collider, vec3 direction, float maxDistance, gjk_raycast_result& outResult)
+{
+	switch (shape.type)
+	{
+		case collider_type_sphere: return sweepAgainstCollider(sphere_support_fn{ shape.sphere }, collider, direction, maxDistance, outResult);
+		case collider_type_capsule: return sweepAgainstCollider(capsule_support_fn{ shape.capsule }, collider, direction, maxDistance, outResult);
+		case collider_type_cylinder: return sweepAgainstCollider(cylinder_support_fn{ shape.cylinder }, collider, direction, maxDistance, outResult);
+		case collider_type_aabb: return sweepAgainstCollider(aabb_support_fn{ shape.aabb }, collider, direction, maxDistance, outResult);
+		case collider_type_obb: return sweepAgainstCollider(obb_support_fn{ shape.obb }, collider, direction, maxDistance, outResult);
+		case collider_type_hull: return sweepAgainstCollider(hull_support_fn{ shape.hull }, collider, direction, maxDistance, outResult);
+	}
+
+	ASSERT(false);
+	return false;
+}
+
+void sweep(const scene_query_context& context, const sweep_query* queries, uint32 numQueries, scene_query_hit* outHits)
+{
+	CPU_PROFILE_BLOCK("Sweep batch");
+
+	parallelFor(highPriorityJobQueue, numQueries, SCENE_QUERY_MIN_BATCH_SIZE, [&](uint32 begin, uint32 end)
+	{
+		for (uint32 queryIndex = begin; queryIndex < end; ++queryIndex)
+		{
+			const sweep_query& query = queries[queryIndex];
+			scene_query_hit& hit = outHits[queryIndex];
+			hit = scene_query_hit{};
+
+			// Sweep the center of the shape's bounding box through the tree, whose nodes are padded by the box's radius.
+			bounding_box shapeAABB = query.shape.getAABB();
+
+			traverseRay(context, shapeAABB.getCenter(), query.direction, query.maxDistance, shapeAABB.getRadius(), [&](uint32 colliderIndex, float maxDistance)
+			{
+				if (!passesFilter(context, colliderIndex, query.filter))
+				{
+					return maxDistance;
+				}
+
+				gjk_raycast_result result;
+				if (!sweepCollider(query.shape, context.worldSpaceColliders[colliderIndex], query.direction, maxDistance, result))
+				{
+					return maxDistance;
+				}
+
+				hit.entity = context.parentEntities[colliderIndex];
+				hit.colliderEntity = context.colliderEntities[colliderIndex];
+				hit.point = result.point;
+				hit.normal = result.normal;
+				hit.distance = result.distance;
+				return result.distance;
+			});
+
+			if (hit.hit())
+			{
+				hit.fraction = (query.maxDistance > 0.f) ? (hit.distance / query.maxDistance) : 0.f;
+			}
+		}
+	});
+}
+
+static bool overlapCollider(const scene_query_shape& shape, const collider_union& collider)
+{
+	switch (shape.type)
+	{
+		case collider_type_sphere:
+		{
+			const bounding_sphere& s = shape.sphere;
+			switch (collider.type)
+			{
+				case collider_type_sphere: return sphereVsSphere(s, collider.sphere);
+				case collider_type_capsule: return sphereVsCapsule(s, collider.capsule);
+				case collider_type_cylinder: return sphereVsCylinder(s, collider.cylinder);
+				case collider_type_aabb: return sphereVsAABB(s, collider.aabb);
+				case collider_type_obb: return sphereVsOBB(s, collider.obb);
+				case collider_type_hull: return sphereVsHull(s, collider.hull);
+			}
+		} break;
+
+		case collider_type_capsule:
+		{
+			const bounding_capsule& c = shape.capsule;
+			switch (collider.type)
+			{
+				case collider_type_sphere: return sphereVsCapsule(collider.sphere, c);
+				case collider_type_capsule: return capsuleVsCapsule(c, collider.capsule);
+				case collider_type_cylinder: return capsuleVsCylinder(c, collider.cylinder);
+				case collider_type_aabb: return capsuleVsAABB(c, collider.aabb);
+				case collider_type_obb: return capsuleVsOBB(c, collider.obb);
+				case collider_type_hull: return capsuleVsHull(c, collider.hull);
+			}
+		} break;
+
+		case collider_type_obb:
+		{
+			const bounding_oriented_box& o = shape.obb;
+			switch (collider.type)
+			{
+				case collider_type_sphere: return sphereVsOBB(collider.sphere, o);
+				case collider_type_capsule: return capsuleVsOBB(collider.capsule, o);
+				case collider_type_cylinder: return cylinderVsOBB(collider.cylinder, o);
+				case collider_type_aabb: return aabbVsOBB(collider.aabb, o);
+				case collider_type_obb: return obbVsOBB(o, collider.obb);
+				case collider_type_hull: return obbVsHull(o, collider.hull);
+			}
+		} break;
+	}
+
+	ASSERT(false);
+	return false;
+}
+
+// Calls func(colliderIndex) for all colliders, whose AABB overlaps the box. Traversal stops, when func returns false.
+template <typename func_t>
+static void traverseAABB(const scene_query_context& context, const bounding_box& aabb, const func_t& func)
+{
+	if (context.numNodes == 0)
+	{
+		return;
+	}
+
+	uint32 stack[SCENE_QUERY_BVH_STACK_SIZE];
+	uint32 stackPtr = 0;
+	stack[stackPtr++] = 0;
+
+	while (stackPtr > 0)
+	{
+		const scene_query_bvh_node& node = context.nodes[stack[--stackPtr]];
+		if (!aabbVsAABB(node.aabb, aabb))
+		{
+			continue;
+		}
+
+		if (node.numPrimitives == 0)
+		{
+			ASSERT(stackPtr + 2 <= SCENE_QUERY_BVH_STACK_SIZE);
+			stack[stackPtr++] = node.firstChildOrPrimitive;
+			stack[stackPtr++] = node.firstChildOrPrimitive + 1;
+			continue;
+		}
+
+		for (uint32 i = 0; i < node.numPrimitives; ++i)
+		{
+			uint32 colliderIndex = context.primitiveIndices[node.firstChildOrPrimitive + i];
+			if (aabbVsAABB(context.worldSpaceAABBs[colliderIndex], aabb) && !func(colliderIndex))
+			{
+				return;
+			}
+		}
+	}
+}
+
+void overlap(const scene_query_context& context, const overlap_query* queries, uint32 numQueries, entity_handle* outEntities, uint32 maxHitsPerQuery, uint32* outNumHits)
+{
+	CPU_PROFILE_BLOCK("Overlap batch");
+
+	parallelFor(highPriorityJobQueue, numQueries, SCENE_QUERY_MIN_BATCH_SIZE, [&](uint32 begin, uint32 end)
+	{
+		for (uint32 queryIndex = begin; queryIndex < end; ++queryIndex)
+		{
+			const overlap_query& query = queries[queryIndex];
+			entity_handle* hits = outEntities + queryIndex * maxHitsPerQuery;
+			uint32 numHits = 0;
+
+			if (maxHitsPerQuery > 0)
+			{
+				traverseAABB(context, query.shape.getAABB(), [&](uint32 colliderIndex)
+				{
+					if (passesFilter(context, colliderIndex, query.filter)
+						&& overlapCollider(query.shape, context.worldSpaceColliders[colliderIndex]))
+					{
+						entity_handle entity = context.parentEntities[colliderIndex];
+						if (std::find(hits, hits + numHits, entity) == hits + numHits)
+						{
+							hits[numHits++] = entity;
+						}
+					}
+					return numHits < maxHitsPerQuery;
+				});
+			}
+
+			outNumHits[queryIndex] = numHits;
+		}
+	});
+}
+
+NODISCARD uint32 queryCollidersInAABB(const scene_query_context& context, const bounding_box& aabb, const scene_query_filter& filter, uint32* outColliderIndices, uint32 maxNumColliders)
+{
+	uint32 numColliders = 0;
+
+	if (maxNumColliders > 0)
+	{
+		traverseAABB(context, aabb, [&](uint32 colliderIndex)
+		{
+			if (passesFilter(context, colliderIndex, filter))
+			{
+				outColliderIndices[numColliders++] = colliderIndex;
+			}
+			return numColliders < maxNumColliders;
+		});
+	}
+
+	return numColliders;
+}
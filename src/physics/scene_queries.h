@@ -0,0 +1,154 @@
+#pragma once
+
+#include "physics.h"
+#include "collision_gjk.h"
+
+// Scene queries (ray casts, shape sweeps and overlap tests) against the colliders of the custom physics world.
+// Queries are answered in batches against a scene_query_context, which holds the world space colliders and a bounding volume hierarchy over them.
+// The context is a snapshot: It is allocated from the given arena and becomes invalid when the arena is reset or the scene's colliders change.
+
+enum scene_query_object_type_flags : uint32
+{
+	scene_query_object_type_rigid_body = (1 << physics_object_type_rigid_body),
+	scene_query_object_type_static_collider = (1 << physics_object_type_static_collider),
+	scene_query_object_type_force_field = (1 << physics_object_type_force_field),
+	scene_query_object_type_trigger = (1 << physics_object_type_trigger),
+
+	scene_query_object_type_default = scene_query_object_type_rigid_body | scene_query_object_type_static_collider,
+	scene_query_object_type_all = scene_query_object_type_default | scene_query_object_type_force_field | scene_query_object_type_trigger,
+};
+
+struct scene_query_filter
+{
+	uint32 objectTypes = scene_query_object_type_default;
+	entity_handle ignoreEntity = entt::null; // Colliders of this entity are ignored. Useful to exclude the querying object itself.
+};
+
+// Shape used by sweeps and overlap tests. Only spheres, capsules and (oriented) boxes are supported as query shapes.
+struct scene_query_shape
+{
+	union
+	{
+		bounding_sphere sphere;
+		bounding_capsule capsule;
+		bounding_oriented_box obb;
+	};
+
+	collider_type type;
+
+	NODISCARD static scene_query_shape asSphere(bounding_sphere s)
+	{
+		scene_query_shape result;
+		result.sphere = s;
+		result.type = collider_type_sphere;
+		return result;
+	}
+
+	NODISCARD static scene_query_shape asCapsule(bounding_capsule c)
+	{
+		scene_query_shape result;
+		result.capsule = c;
+		result.type = collider_type_capsule;
+		return result;
+	}
+
+	NODISCARD static scene_query_shape asOBB(bounding_oriented_box b)
+	{
+		scene_query_shape result;
+		result.obb = b;
+		result.type = collider_type_obb;
+		return result;
+	}
+
+	NODISCARD bounding_box getAABB() const;
+};
+
+struct raycast_query
+{
+	ray r; // Direction must be normalized.
+	float maxDistance = FLT_MAX;
+	scene_query_filter filter;
+};
+
+struct sweep_query
+{
+	scene_query_shape shape;
+	vec3 direction; // Must be normalized.
+	float maxDistance;
+	scene_query_filter filter;
+};
+
+struct overlap_query
+{
+	scene_query_shape shape;
+	scene_query_filter filter;
+};
+
+struct scene_query_hit
+{
+	entity_handle entity = entt::null;			// Entity owning the hit collider (the rigid body, trigger, ...). entt::null, if nothing was hit.
+	entity_handle colliderEntity = entt::null;
+
+	vec3 point;
+	vec3 normal;		// Surface normal of the hit collider. Points against the query direction.
+	float distance;		// Distance along the query direction.
+	float fraction;		// distance / maxDistance.
+
+	NODISCARD bool hit() const { return entity != entt::null; }
+};
+
+struct scene_query_bvh_node
+{
+	bounding_box aabb;
+	uint32 firstChildOrPrimitive; // Inner nodes: Index of first child (second child follows directly). Leaves: Offset into the primitive indices.
+	uint32 numPrimitives; // 0 for inner nodes.
+};
+
+struct scene_query_context
+{
+	const collider_union* worldSpaceColliders;
+	const bounding_box* worldSpaceAABBs;
+	entity_handle* colliderEntities;
+	entity_handle* parentEntities;
+	uint32 numColliders;
+
+	scene_query_bvh_node* nodes;
+	uint16* primitiveIndices;
+	uint32 numNodes;
+};
+
+// Gathers the world space colliders of the scene and builds the acceleration structure.
+NODISCARD scene_query_context buildSceneQueryContext(escene& scene, eallocator& arena);
+
+// Builds the acceleration structure from world space colliders, which have already been computed (e.g. by the physics step).
+// The arrays must stay valid as long as the context is used.
+NODISCARD scene_query_context buildSceneQueryContext(escene& scene, eallocator& arena, const collider_union* worldSpaceColliders, const bounding_box* worldSpaceAABBs, uint32 numColliders);
+
+// Batched queries. The batches are distributed over the high priority job queue. outHits must have space for numQueries results.
+void raycast(const scene_query_context& context, const raycast_query* queries, uint32 numQueries, scene_query_hit* outHits);
+void sweep(const scene_query_context& context, const sweep_query* queries, uint32 numQueries, scene_query_hit* outHits);
+
+// Writes up to maxHitsPerQuery overlapping entities per query to outEntities[queryIndex * maxHitsPerQuery + i]. The number of hits of each query is written to outNumHits.
+// Every entity is reported only once per query, even if multiple of its colliders overlap the shape.
+void overlap(const scene_query_context& context, const overlap_query* queries, uint32 numQueries, entity_handle* outEntities, uint32 maxHitsPerQuery, uint32* outNumHits);
+
+// Writes the indices (into context.worldSpaceColliders) of up to maxNumColliders colliders, whose AABBs overlap the box. Returns the number of colliders written.
+// Unlike the batched queries, this runs on the calling thread, so it can be used from within jobs.
+NODISCARD uint32 queryCollidersInAABB(const scene_query_context& context, const bounding_box& aabb, const scene_query_filter& filter, uint32* outColliderIndices, uint32 maxNumColliders);
+
+// Casts the world space collider shape along the normalized direction against the world space collider. Also used for continuous collision detection.
+NODISCARD bool sweepCollider(const collider_union& shape, const collider_union& collider, vec3 direction, float maxDistance, gjk_raycast_result& outResult);
+
+NODISCARD inline scene_query_hit raycast(const scene_query_context& context, const raycast_query& query)
+{
+	scene_query_hit result;
+	raycast(context, &query, 1, &result);
+	return result;
+}
+
+NODISCARD inline scene_query_hit sweep(const scene_query_context& context, const sweep_query& query)
+{
+	scene_query_hit result;
+	sweep(context, &query, 1, &result);
+	return result;
+}
@@ -0,0 +1,267 @@
+#include "pch.h"
+#include "snapshot.h"
+#include "physics.h"
+#include "collision_broad.h"
+#include "core/cpu_profiling.h"
+
+#define PHYSICS_SNAPSHOT_VERSION 3
+
+// Components are stored in the order of their pools together with the owning entities, so that a restore can verify that it writes into the same bodies.
+template <typename component_t>
+static void writeComponents(escene& scene, physics_snapshot_writer& writer)
+{
+	static_assert(std::is_trivially_copyable_v<component_t>);
+
+	auto& storage = scene.registry.storage<component_t>();
+	uint32 count = (uint32)storage.size();
+	writer.writeArray(storage.data(), count);
+
+	uint8* dest = writer.allocate(sizeof(component_t) * count);
+	for (uint32 i = 0; i < count; ++i)
+	{
+		memcpy(dest + sizeof(component_t) * i, &scene.getComponentAtIndex<component_t>(i), sizeof(component_t));
+	}
+}
+
+// Only checks, does not modify the scene.
+template <typename component_t>
+static const uint8* validateComponents(escene& scene, physics_snapshot_reader& reader)
+{
+	auto& storage = scene.registry.storage<component_t>();
+	uint32 count;
+	const entity_handle* entities = reader.readArray<entity_handle>(count);
+	if (!entities || count != (uint32)storage.size() || (count && memcmp(entities, storage.data(), sizeof(entity_handle) * count) != 0))
+	{
+		return 0;
+	}
+	return reader.consume(sizeof(component_t) * count);
+}
+
+template <typename component_t>
+static void readComponents(escene& scene, const uint8* src)
+{
+	uint32 count = (uint32)scene.registry.storage<component_t>().size();
+	for (uint32 i = 0; i < count; ++i)
+	{
+		memcpy(&scene.getComponentAtIndex<component_t>(i), src + sizeof(component_t) * i, sizeof(component_t));
+	}
+}
+
+void savePhysicsSnapshot(escene& scene, physics_snapshot& snapshot)
+{
+	CPU_PROFILE_BLOCK("Save physics snapshot");
+
+	waitForPhysicsStep();
+
+	snapshot.size = 0;
+	physics_snapshot_writer writer = { snapshot };
+
+	writer.write((uint32)PHYSICS_SNAPSHOT_VERSION);
+
+	writeComponents<rigid_body_component>(scene, writer);
+	writeComponents<physics_transform0_component>(scene, writer);
+	writeComponents<physics_transform1_component>(scene, writer);
+
+	auto& clothStorage = scene.registry.storage<cloth_component>();
+	uint32 numCloths = (uint32)clothStorage.size();
+	writer.writeArray(clothStorage.data(), numCloths);
+	for (uint32 i = 0; i < numCloths; ++i)
+	{
+		writer.write(scene.getComponentAtIndex<cloth_component>(i).getNumParticles());
+	}
+
+	auto& articulationStorage = scene.registry.storage<articulation_component>();
+	uint32 numArticulations = (uint32)articulationStorage.size();
+	writer.writeArray(articulationStorage.data(), numArticulations);
+	for (uint32 i = 0; i < numArticulations; ++i)
+	{
+		writer.write(scene.getComponentAtIndex<articulation_component>(i).getNumLinks());
+	}
+
+	writeBroadphaseSnapshot(scene, writer);
+	writeSimulationContextSnapshot(scene, writer);
+
+	for (uint32 i = 0; i < numCloths; ++i)
+	{
+		scene.getComponentAtIndex<cloth_component>(i).writeSnapshot(writer);
+	}
+	for (uint32 i = 0; i < numArticulations; ++i)
+	{
+		scene.getComponentAtIndex<articulation_component>(i).writeSnapshot(writer);
+	}
+}
+
+bool restorePhysicsSnapshot(escene& scene, const physics_snapshot& snapshot)
+{
+	CPU_PROFILE_BLOCK("Restore physics snapshot");
+
+	waitForPhysicsStep();
+
+	physics_snapshot_reader reader = { snapshot.data.data(), snapshot.size };
+
+	uint32 version;
+	if (!reader.read(version) || version != PHYSICS_SNAPSHOT_VERSION)
+	{
+		return false;
+	}
+
+	// Validate everything, which depends on the set of entities, before anything is written.
+	const uint8* rigidBodies = validateComponents<rigid_body_component>(scene, reader);
+	const uint8* transforms0 = rigidBodies ? validateComponents<physics_transform0_component>(scene, reader) : 0;
+	const uint8* transforms1 = transforms0 ? validateComponents<physics_transform1_component>(scene, reader) : 0;
+	if (!transforms1)
+	{
+		return false;
+	}
+
+	auto& clothStorage = scene.registry.storage<cloth_component>();
+	uint32 numCloths;
+	const entity_handle* clothEntities = reader.readArray<entity_handle>(numCloths);
+	if (!clothEntities || numCloths != (uint32)clothStorage.size() || (numCloths && memcmp(clothEntities, clothStorage.data(), sizeof(entity_handle) * numCloths) != 0))
+	{
+		return false;
+	}
+	for (uint32 i = 0; i < numCloths; ++i)
+	{
+		uint32 numParticles;
+		if (!reader.read(numParticles) || numParticles != scene.getComponentAtIndex<cloth_component>(i).getNumParticles())
+		{
+			return false;
+		}
+	}
+
+	auto& articulationStorage = scene.registry.storage<articulation_component>();
+	uint32 numArticulations;
+	const entity_handle* articulationEntities = reader.readArray<entity_handle>(numArticulations);
+	if (!articulationEntities || numArticulations != (uint32)articulationStorage.size()
+		|| (numArticulations && memcmp(articulationEntities, articulationStorage.data(), sizeof(entity_handle) * numArticulations) != 0))
+	{
+		return false;
+	}
+	for (uint32 i = 0; i < numArticulations; ++i)
+	{
+		uint32 numLinks;
+		if (!reader.read(numLinks) || numLinks != scene.getComponentAtIndex<articulation_component>(i).getNumLinks())
+		{
+			return false;
+		}
+	}
+
+	// The broad phase validates its endpoints before it writes them.
+	if (!readBroadphaseSnapshot(scene, reader))
+	{
+		return false;
+	}
+
+	readComponents<rigid_body_component>(scene, rigidBodies);
+	readComponents<physics_transform0_component>(scene, transforms0);
+	readComponents<physics_transform1_component>(scene, transforms1);
+
+	// From here on the snapshot can only fail if it is truncated.
+	bool result = readSimulationContextSnapshot(scene, reader);
+	for (uint32 i = 0; i < numCloths && result; ++i)
+	{
+		result = scene.getComponentAtIndex<cloth_component>(i).readSnapshot(reader);
+	}
+	for (uint32 i = 0; i < numArticulations && result; ++i)
+	{
+		result = scene.getComponentAtIndex<articulation_component>(i).readSnapshot(reader);
+	}
+	ASSERT(result);
+
+	// Show the restored state right away instead of the interpolated state of the last rendered frame.
+	for (auto [entityHandle, transform, physicsTransform1] : scene.group(component_group<transform_component, physics_transform1_component>).each())
+	{
+		transform = physicsTransform1;
+	}
+
+	return result;
+}
+
+// FNV-1a.
+static uint64 hashBytes(uint64 hash, const void* data, uint64 size)
+{
+	const uint8* bytes = (const uint8*)data;
+	for (uint64 i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+uint64 hashPhysicsState(escene& scene)
+{
+	uint64 hash = 0xCBF29CE484222325ull;
+
+	// Field by field, so that padding bytes do not influence the result.
+	for (auto [entityHandle, rb, transform] : scene.group<rigid_body_component, physics_transform1_component>().each())
+	{
+		const trs& t = transform;
+		hash = hashBytes(hash, &t.rotation, sizeof(t.rotation));
+		hash = hashBytes(hash, &t.position, sizeof(t.position));
+		hash = hashBytes(hash, &rb.linearVelocity, sizeof(rb.linearVelocity));
+		hash = hashBytes(hash, &rb.angularVelocity, sizeof(rb.angularVelocity));
+		hash = hashBytes(hash, &rb.sleepTimer, sizeof(rb.sleepTimer));
+		hash = hashBytes(hash, &rb.sleepingIsland, sizeof(rb.sleepingIsland));
+	}
+
+	physics_snapshot stateSnapshot;
+	physics_snapshot_writer writer = { stateSnapshot };
+	for (auto [entityHandle, cloth] : scene.view<cloth_component>().each())
+	{
+		cloth.writeSnapshot(writer);
+	}
+	for (auto [entityHandle, articulation] : scene.view<articulation_component>().each())
+	{
+		articulation.writeSnapshot(writer);
+	}
+	hash = hashBytes(hash, stateSnapshot.data.data(), stateSnapshot.size);
+
+	return hash;
+}
+
+bool testPhysicsDeterminism(escene& scene, eallocator& arena, const physics_settings& settings, float dt, uint32 numWarmupSteps, uint32 numTestSteps)
+{
+	CPU_PROFILE_BLOCK("Test physics determinism");
+
+	physics_settings testSettings = settings;
+	testSettings.fixedFrameRate = false;
+	float timer = 0.f;
+
+	for (uint32 i = 0; i < numWarmupSteps; ++i)
+	{
+		physicsStep(scene, arena, timer, testSettings, dt);
+	}
+
+	physics_snapshot snapshot;
+	savePhysicsSnapshot(scene, snapshot);
+	uint64 snapshotHash = hashPhysicsState(scene);
+
+	for (uint32 i = 0; i < numTestSteps; ++i)
+	{
+		physicsStep(scene, arena, timer, testSettings, dt);
+	}
+	uint64 firstRunHash = hashPhysicsState(scene);
+
+	if (!restorePhysicsSnapshot(scene, snapshot))
+	{
+		return false;
+	}
+
+	// The restore itself must be exact.
+	physics_snapshot restored;
+	savePhysicsSnapshot(scene, restored);
+	if (hashPhysicsState(scene) != snapshotHash || restored.size != snapshot.size || memcmp(restored.data.data(), snapshot.data.data(), snapshot.size) != 0)
+	{
+		return false;
+	}
+
+	for (uint32 i = 0; i < numTestSteps; ++i)
+	{
+		physicsStep(scene, arena, timer, testSettings, dt);
+	}
+	uint64 secondRunHash = hashPhysicsState(scene);
+
+	return firstRunHash == secondRunHash;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "core/math.h"
+#include "core/memory.h"
+#include "scene/scene.h"
+
+// Snapshots of the complete simulation state of the custom physics world, e.g. for rollback netcode or replays.
+// A snapshot contains the rigid body state, both physics transforms, the contact cache (accumulated impulses for warm starting), the sleep, event and region step state,
+// the sweep-and-prune endpoint order, the cloth particles and the articulation joints. It is one contiguous buffer of plain data. Restoring it and stepping again yields bit-exact results.
+// Rigid body components are copied as a whole, so their configuration (mass, inertia, damping, ...) is restored as well. Colliders and constraints are not part
+// of the snapshot. Restoring is only valid as long as the set of physics entities has not changed since the snapshot was taken. This is checked and reported
+// through the return value.
+
+struct physics_snapshot
+{
+	std::vector<uint8> data; // Only grows, so that saving repeatedly into the same snapshot does not allocate.
+	uint64 size = 0;
+};
+
+struct physics_snapshot_writer
+{
+	physics_snapshot& snapshot;
+
+	uint8* allocate(uint64 numBytes)
+	{
+		uint64 offset = snapshot.size;
+		if (offset + numBytes > snapshot.data.size())
+		{
+			snapshot.data.resize(max(offset + numBytes, (uint64)snapshot.data.size() * 2));
+		}
+		snapshot.size += numBytes;
+		return snapshot.data.data() + offset;
+	}
+
+	template <typename T>
+	void write(const T& v)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		memcpy(allocate(sizeof(T)), &v, sizeof(T));
+	}
+
+	// Writes the count followed by the elements.
+	template <typename T>
+	void writeArray(const T* v, uint32 count)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		write(count);
+		memcpy(allocate(sizeof(T) * count), v, sizeof(T) * count);
+	}
+};
+
+struct physics_snapshot_reader
+{
+	const uint8* data;
+	uint64 size;
+	uint64 offset = 0;
+
+	NODISCARD const uint8* consume(uint64 numBytes)
+	{
+		if (offset + numBytes > size)
+		{
+			return 0;
+		}
+		const uint8* result = data + offset;
+		offset += numBytes;
+		return result;
+	}
+
+	template <typename T>
+	NODISCARD bool read(T& v)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		const uint8* src = consume(sizeof(T));
+		if (!src)
+		{
+			return false;
+		}
+		memcpy(&v, src, sizeof(T));
+		return true;
+	}
+
+	// Reads an array written by writeArray. Returns 0 if the buffer is too short.
+	template <typename T>
+	NODISCARD const T* readArray(uint32& outCount)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		if (!read(outCount))
+		{
+			return 0;
+		}
+		return (const T*)consume(sizeof(T) * outCount);
+	}
+
+	// Like readArray, but fails if the number of elements does not match the expected count.
+	template <typename T>
+	NODISCARD bool readArray(T* out, uint32 expectedCount)
+	{
+		uint32 count;
+		const T* src = readArray<T>(count);
+		if (!src || count != expectedCount)
+		{
+			return false;
+		}
+		memcpy(out, src, sizeof(T) * count);
+		return true;
+	}
+};
+
+struct physics_settings;
+
+// Overwrites the snapshot with the current state of the scene.
+void savePhysicsSnapshot(escene& scene, physics_snapshot& snapshot);
+
+// Returns false and leaves the scene untouched if the snapshot does not match the physics entities of the scene.
+NODISCARD bool restorePhysicsSnapshot(escene& scene, const physics_snapshot& snapshot);
+
+// Hash over the simulated state (transforms, velocities, sleep state, cloth particles and articulation joints). Equal hashes mean bit-identical simulations.
+NODISCARD uint64 hashPhysicsState(escene& scene);
+
+// Determinism test: Steps numWarmupSteps, snapshots, steps numTestSteps, rewinds to the snapshot and steps numTestSteps again.
+// Returns true if the restore was exact and both runs end in the same state. The simulation is stepped with a fixed dt and without the frame rate accumulator.
+// Collision callbacks in the settings fire in both runs. All steps run within this call, so with CPU profiling enabled, the number of steps must stay small enough
+// for the profile recordings of a single frame.
+NODISCARD bool testPhysicsDeterminism(escene& scene, eallocator& arena, const physics_settings& settings, float dt, uint32 numWarmupSteps = 8, uint32 numTestSteps = 8);
+
+// Internal. Implemented next to the respective state.
+void writeSimulationContextSnapshot(escene& scene, physics_snapshot_writer& writer);
+NODISCARD bool readSimulationContextSnapshot(escene& scene, physics_snapshot_reader& reader);
+void writeBroadphaseSnapshot(escene& scene, physics_snapshot_writer& writer);
+NODISCARD bool readBroadphaseSnapshot(escene& scene, physics_snapshot_reader& reader);
@@ -1,7 +1,9 @@
 #include "pch.h"
 
 #include "px_physics_engine.h"
+#include "px_tasks.h"
 #include <core/log.h>
+#include <core/cpu_profiling.h>
 #include <scene/scene.h>
 #include <px/physics/px_collider_component.h>
 #include <px/features/cloth/px_clothing_factory.h>
@@ -16,7 +18,7 @@
 #include <scene/scene.h>
 
 px_physics_engine* px_physics_engine::engine = nullptr;
-std::queue<collision_handling_data> px_physics_engine::collisionQueue;
+px_collision_event_queue px_physics_engine::collisionQueue;
 std::mutex px_physics_engine::sync;
 
 px_collision_contact_callback collisionCallback;
@@ -55,6 +57,63 @@ physx::PxFilterFlags contactReportFilterShader(
 	return physx::PxFilterFlag::eNOTIFY;
 }
 
+px_collision_event_queue::px_collision_event_queue()
+{
+	for (uint32 i = 0; i < capacity; ++i)
+	{
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+bool px_collision_event_queue::push(const collision_handling_data& event)
+{
+	uint32 index = writeIndex.load(std::memory_order_relaxed);
+	while (true)
+	{
+		slot& s = slots[index & indexMask];
+		uint32 sequence = s.sequence.load(std::memory_order_acquire);
+		int32 difference = (int32)(sequence - index);
+
+		if (difference == 0)
+		{
+			// Slot is free. Claim it by advancing the write index.
+			if (writeIndex.compare_exchange_weak(index, index + 1, std::memory_order_relaxed))
+			{
+				s.event = event;
+				s.sequence.store(index + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (difference < 0)
+		{
+			// The consumer has not yet read this slot from the last round -> full.
+			numDropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+		{
+			// Another producer claimed the slot first.
+			index = writeIndex.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+uint32 px_collision_event_queue::drain(collision_handling_data* out, uint32 maxCount)
+{
+	uint32 count = 0;
+	while (count < maxCount)
+	{
+		slot& s = slots[readIndex & indexMask];
+		if (s.sequence.load(std::memory_order_acquire) != readIndex + 1)
+			break;
+
+		out[count++] = s.event;
+		s.sequence.store(readIndex + capacity, std::memory_order_release);
+		++readIndex;
+	}
+	return count;
+}
+
 px_physics::~px_physics()
 {
 	if (!released)
@@ -89,7 +148,7 @@ void px_physics::initialize()
 	if (!PxInitExtensions(*physics, pvd))
 		LOG_ERROR("Physics> Failed to initialize extensions.");
 
-	dispatcher = PxDefaultCpuDispatcherCreate(nbCPUDispatcherThreads);
+	dispatcher = new px_job_dispatcher(highPriorityJobQueue);
 
 	PxSceneDesc sceneDesc(toleranceScale);
 	sceneDesc.gravity = gravity;
@@ -172,6 +231,9 @@ void px_physics::release()
 	PX_RELEASE(scene)
 	PX_RELEASE(cudaContextManager)
 
+	delete dispatcher;
+	dispatcher = nullptr;
+
 #if PX_ENABLE_RAYCAST_CCD
 	delete raycastCCD;
 	raycastCCD = nullptr;
@@ -193,10 +255,12 @@ px_physics_engine::px_physics_engine(application* application) noexcept
 	physics = new px_physics();
 	physics->initialize();
 	allocator.initialize(MB(256));
+	scratchBlock = allocator.allocate(scratchBlockSize, 16U);
 }
 
 px_physics_engine::~px_physics_engine()
 {
+	disconnectWriteback();
 	releaseActors();
 	if (!released)
 		release();
@@ -233,52 +297,227 @@ void px_physics_engine::start()
 
 void px_physics_engine::update(float dt)
 {
-	float stepSize = 1.0f / frameRate;
+	CPU_PROFILE_BLOCK("PhysX update");
+
+	const float fixedTimeStep = 1.0f / frameRate;
+	const uint32 substeps = std::max(numSubsteps, 1u);
+	const float substepSize = fixedTimeStep / (float)substeps;
 
+	timer += dt;
+	uint32 numSteps = 0;
+	while (timer >= fixedTimeStep && numSteps < maxPhysicsIterationsPerFrame)
+	{
+		timer -= fixedTimeStep;
+		++numSteps;
+	}
+
+	if (timer >= fixedTimeStep)
+	{
+		timer = fmod(timer, fixedTimeStep);
+		LOG_WARNING("Physics> Dropping PhysX frames");
+	}
+
+	escene* scene = app->getCurrentScene();
+	if (writebackDirty || writebackScene != scene)
+		rebuildWriteback(scene);
+
+	if (numSteps > 0)
+	{
+		// The actors which are active in any step of this frame get written back.
+		++writebackFrameIndex;
+		numActiveWritebackIndices = 0;
+	}
+
+	for (uint32 step = 0; step < numSteps; ++step)
+	{
+		for (uint32 substep = 0; substep < substeps; ++substep)
+		{
+			simulateStep(substepSize);
+		}
+
+		PxActor** activeActors = physics->scene->getActiveActors(nbActiveActors);
+		captureActivePoses(activeActors, nbActiveActors);
+
+#if PX_ENABLE_RAYCAST_CCD
+		physics->raycastCCD->doRaycastCCD(true);
+#endif
+	}
+
+	// Without a step in this frame, the transforms are only moved further between the last two poses.
+	writeTransforms(timer / fixedTimeStep);
+}
+
+void px_physics_engine::simulateStep(float stepSize)
+{
 	physics->scene->lockWrite();
 	physics->scene->getTaskManager()->startSimulation();
 
-	void* scratchMemBlock = allocator.allocate(MB(16), 16U, true);
-
+	// PhysX only uses the scratch block as temporary memory during the step, so it is neither cleared nor reallocated.
 #if PX_GPU_BROAD_PHASE
-	physics->scene->simulate(stepSize, NULL, scratchMemBlock, MB(16));
+	physics->scene->simulate(stepSize, NULL, scratchBlock, scratchBlockSize);
 #else
-	physics->scene->collide(std::max(dt, stepSize), NULL, scratchMemBlock, MB(16));
+	physics->scene->collide(stepSize, NULL, scratchBlock, scratchBlockSize);
 	physics->scene->fetchCollision(true);
 	physics->scene->advance();
 #endif
 
+	// The simulation runs on the high priority workers, and this is usually called from one of them. Help out instead of blocking.
+	while (!physics->scene->checkResults(false))
+	{
+		if (!highPriorityJobQueue.executeNextJob())
+			std::this_thread::yield();
+	}
+
 	physics->scene->fetchResults(true);
 
 	physics->scene->flushSimulation();
 	physics->scene->getTaskManager()->stopSimulation();
 	physics->scene->unlockWrite();
 
-	PxActor** activeActors = physics->scene->getActiveActors(nbActiveActors);
+	++stepIndex;
+}
 
-	auto scene = &app->scene.getCurrentScene();
+void px_physics_engine::rebuildWriteback(escene* scene)
+{
+	CPU_PROFILE_BLOCK("PhysX rebuild writeback");
 
-	for (size_t i = 0; i < nbActiveActors; i++)
+	if (writebackScene != scene)
+		disconnectWriteback();
+
+	// Connecting is idempotent. It is repeated on every rebuild, since the registry of a scene is replaced when it is reset.
+	scene->registry.on_construct<transform_component>().connect<&px_physics_engine::markWritebackDirty>(*this);
+	scene->registry.on_destroy<transform_component>().connect<&px_physics_engine::markWritebackDirty>(*this);
+
+	writeback.clear();
+
+	for (auto& [ractor, rb] : actors_map)
 	{
-		if (auto rb = activeActors[i]->is<PxRigidDynamic>())
+		PxRigidDynamic* actor = ractor->is<PxRigidDynamic>();
+		if (!actor || !actor->userData)
+			continue;
+
+		px_actor_user_data* userData = static_cast<px_actor_user_data*>(actor->userData);
+		userData->writebackIndex = -1;
+
+		// Character controllers move their transforms themselves.
+		if (actor->getRigidBodyFlags() & PxRigidBodyFlag::eKINEMATIC)
+			continue;
+
+		eentity entity = { userData->handle, &scene->registry };
+		transform_component* transform = entity.getComponentIfExists<transform_component>();
+		if (!transform)
+			continue;
+
+		const PxTransform pose = actor->getGlobalPose();
+
+		userData->writebackIndex = (uint32)writeback.size();
+		writeback.push_back({ actor, entity.handle, transform, pose, pose, 0, 0 });
+	}
+
+	activeWritebackIndices.resize(writeback.size());
+	numActiveWritebackIndices = 0;
+
+	writebackScene = scene;
+	writebackDirty = false;
+}
+
+void px_physics_engine::markWritebackDirty(entt::registry& registry, entity_handle entity)
+{
+	writebackDirty = true;
+}
+
+void px_physics_engine::disconnectWriteback()
+{
+	if (!writebackScene)
+		return;
+
+	writebackScene->registry.on_construct<transform_component>().disconnect<&px_physics_engine::markWritebackDirty>(*this);
+	writebackScene->registry.on_destroy<transform_component>().disconnect<&px_physics_engine::markWritebackDirty>(*this);
+	writebackScene = nullptr;
+}
+
+void px_physics_engine::captureActivePoses(PxActor** activeActors, uint32 numActiveActors)
+{
+	CPU_PROFILE_BLOCK("PhysX capture active poses");
+
+	std::atomic<uint32> numListed{ numActiveWritebackIndices };
+
+	// Every actor owns its slot, so the chunks never write to the same memory.
+	parallelFor(highPriorityJobQueue, numActiveActors, 512, [this, activeActors, &numListed](uint32 begin, uint32 end)
+	{
+		for (uint32 i = begin; i < end; ++i)
+		{
+			PxRigidDynamic* actor = activeActors[i]->is<PxRigidDynamic>();
+			if (!actor || !actor->userData)
+				continue;
+
+			uint32 index = static_cast<px_actor_user_data*>(actor->userData)->writebackIndex;
+			if (index == -1)
+				continue;
+
+			px_actor_writeback& slot = writeback[index];
+			slot.pose0 = slot.pose1;
+			slot.pose1 = actor->getGlobalPose();
+			slot.lastActiveStep = stepIndex;
+
+			if (slot.lastListedFrame != writebackFrameIndex)
+			{
+				slot.lastListedFrame = writebackFrameIndex;
+				activeWritebackIndices[numListed++] = index;
+			}
+		}
+	});
+
+	numActiveWritebackIndices = numListed;
+}
+
+void px_physics_engine::writeTransforms(float interpolationT)
+{
+	CPU_PROFILE_BLOCK("PhysX write transforms");
+
+	ASSERT(interpolationT >= 0.f && interpolationT <= 1.f);
+
+	// Transforms were constructed or destroyed during the steps (e.g. by contact callbacks). The cache is rebuilt next frame, until then the 
+	// listed actors look up their transforms once.
+	if (writebackDirty)
+	{
+		entt::registry& registry = writebackScene->registry;
+		for (uint32 i = 0; i < numActiveWritebackIndices; ++i)
 		{
-			entity_handle* handle = static_cast<entity_handle*>(activeActors[i]->userData);
-			eentity renderObject = { *handle, &scene->registry };
-			const auto transform = &renderObject.getComponent<transform_component>();
-
-			const auto& pxt = rb->getGlobalPose();
-			const auto& pos = pxt.p;
-			const auto& rot = pxt.q.getConjugate();
-			transform->position = createVec3(pos);
-			transform->rotation = createQuat(rot);
+			px_actor_writeback& slot = writeback[activeWritebackIndices[i]];
+			slot.transform = registry.valid(slot.entity) ? registry.try_get<transform_component>(slot.entity) : nullptr;
 		}
 	}
 
-#if PX_ENABLE_RAYCAST_CCD
-	physics->raycastCCD->doRaycastCCD(true);
-#endif
+	// Every slot owns its transform, so the chunks never write to the same memory.
+	parallelFor(highPriorityJobQueue, numActiveWritebackIndices, 512, [this, interpolationT](uint32 begin, uint32 end)
+	{
+		for (uint32 i = begin; i < end; ++i)
+		{
+			const px_actor_writeback& slot = writeback[activeWritebackIndices[i]];
+
+			transform_component* transform = slot.transform;
+			if (!transform)
+				continue;
 
-	allocator.reset();
+			// Actors which came to rest in an earlier step of the frame stay at their last pose.
+			const float t = (slot.lastActiveStep == stepIndex) ? interpolationT : 1.f;
+
+			const vec3 position0 = createVec3(slot.pose0.p);
+			const vec3 position1 = createVec3(slot.pose1.p);
+			const quat rotation0 = createQuat(slot.pose0.q.getConjugate());
+			quat rotation1 = createQuat(slot.pose1.q.getConjugate());
+
+			// Interpolate along the shorter arc.
+			if (dot(rotation0.v4, rotation1.v4) < 0.f)
+			{
+				rotation1.v4 *= -1.f;
+			}
+
+			transform->position = lerp(position0, position1, t);
+			transform->rotation = lerp(rotation0, rotation1, t);
+		}
+	});
 }
 
 void px_physics_engine::resetActorsVelocityAndInertia()
@@ -329,6 +568,7 @@ void px_physics_engine::addActor(px_rigidbody_component* actor, PxRigidActor* ra
 
 	actors.emplace(actor);
 	actors_map.insert(std::make_pair(ractor, actor));
+	writebackDirty = true;
 	sync.unlock();
 }
 
@@ -338,6 +578,7 @@ void px_physics_engine::removeActor(px_rigidbody_component* actor)
 	actors.erase(actor);
 	actors_map.erase(actor->getRigidActor());
 	physics->scene->removeActor(*actor->getRigidActor());
+	writebackDirty = true;
 	sync.unlock();
 }
 
@@ -356,6 +597,10 @@ void px_physics_engine::releaseActors() noexcept
 	sync.lock();
 	actors.clear();
 	actors_map.clear();
+	writeback.clear();
+	activeWritebackIndices.clear();
+	numActiveWritebackIndices = 0;
+	writebackDirty = true;
 	physics->scene->flushSimulation();
 	sync.unlock();
 }
@@ -467,7 +712,7 @@ void px_collision_contact_callback::onContact(const PxContactPairHeader& pairHea
 			{
 				rb1->onCollisionEnter(rb2);
 				rb2->onCollisionEnter(rb1);
-				px_physics_engine::collisionQueue.emplace(rb1->handle, rb2->handle);
+				px_physics_engine::collisionQueue.push({ rb1->handle, rb2->handle });
 			}
 		}
 	}
@@ -47,6 +47,8 @@
 
 struct application;
 struct eallocator;
+struct escene;
+struct transform_component;
 
 using namespace physx;
 
@@ -66,12 +68,70 @@ struct px_allocator_callback : PxAllocatorCallback
 	}
 };
 
+// Stored in PxActor::userData. The entity handle must stay the first member, because the handle is also read through a plain uint32 pointer.
+struct px_actor_user_data
+{
+	uint32 handle;
+	uint32 writebackIndex = -1; // Index into px_physics_engine::writeback. -1 if the actor has no slot.
+};
+
+// Dense per-actor state of the transform writeback.
+struct px_actor_writeback
+{
+	PxRigidDynamic* actor;
+	entity_handle entity;
+
+	// Constructing or destroying any transform_component can move the pool, so it marks the writeback dirty (see markWritebackDirty).
+	transform_component* transform;
+
+	// Poses after the second to last and the last simulation step, in which the actor was active.
+	PxTransform pose0;
+	PxTransform pose1;
+
+	uint32 lastActiveStep;
+	uint32 lastListedFrame;
+};
+
 struct collision_handling_data
 {
 	uint32_t id1;
 	uint32_t id2;
 };
 
+// Bounded lock-free queue of collision events. Any number of PhysX callback threads push, the scripting update is the only consumer.
+// The memory is allocated once. Events which do not fit are dropped and counted.
+struct px_collision_event_queue
+{
+	static constexpr uint32 capacity = 1 << 14;
+
+	px_collision_event_queue();
+
+	// Producers. Returns false if the queue is full.
+	bool push(const collision_handling_data& event);
+
+	// Consumer. Moves up to maxCount events into out and returns the number of moved events.
+	NODISCARD uint32 drain(collision_handling_data* out, uint32 maxCount);
+
+	// Consumer. Returns the number of dropped events since the last call.
+	NODISCARD uint32 resetNumDropped() { return numDropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+	static constexpr uint32 indexMask = capacity - 1;
+
+	struct slot
+	{
+		// Equals the write index, for which the slot is free, or that index + 1 once the event is written.
+		std::atomic<uint32> sequence;
+		collision_handling_data event;
+	};
+
+	slot slots[capacity];
+
+	alignas(64) std::atomic<uint32> writeIndex = 0;
+	alignas(64) uint32 readIndex = 0;
+	std::atomic<uint32> numDropped = 0;
+};
+
 template<typename HitType>
 class DynamicHitBuffer : public PxHitCallback<HitType>
 {
@@ -417,6 +477,7 @@ struct px_CCD_contact_modification : PxCCDContactModifyCallback
 };
 
 class px_physics_engine;
+struct px_job_dispatcher;
 
 struct px_physics
 {
@@ -453,13 +514,11 @@ struct px_physics
 	px_query_filter queryFilter;
 
 	PxTolerancesScale toleranceScale;
-	PxDefaultCpuDispatcher* dispatcher = nullptr;
+	px_job_dispatcher* dispatcher = nullptr;
 
 private:
 	bool released = false;
 
-	const uint32_t nbCPUDispatcherThreads = 4;
-
 	friend class px_physics_engine;
 };
 
@@ -513,10 +572,16 @@ public:
 	static void release();
 
 	void start();
+
+	// Advances the simulation by all fixed steps, which fit into dt, and writes the interpolated transforms.
 	void update(float dt);
 
 	void resetActorsVelocityAndInertia();
 
+	// Writes the poses of the actors, which were active in the last frame's simulation steps, to their transform components.
+	// interpolationT blends between the poses of the last two steps, like the custom path's physics_transform0/1. Called by update.
+	void writeTransforms(float interpolationT);
+
 	void addActor(px_rigidbody_component* actor, PxRigidActor* ractor, bool addToScene);
 	void removeActor(px_rigidbody_component* actor);
 
@@ -527,6 +592,8 @@ public:
 	void releaseActors() noexcept;
 
 	float frameRate = 60.0f;
+	uint32 numSubsteps = 1; // Simulation calls per fixed step of 1 / frameRate.
+	uint32 maxPhysicsIterationsPerFrame = 4; // Fixed steps beyond this are dropped.
 
 	uint32_t nbActiveActors{};
 
@@ -538,7 +605,7 @@ public:
 
 	std::set<px_rigidbody_component*> actors;
 	std::unordered_map<PxRigidActor*, px_rigidbody_component*> actors_map;
-	static std::queue<collision_handling_data> collisionQueue;
+	static px_collision_event_queue collisionQueue;
 
 	// Raycasting
 	px_raycast_info raycast(px_rigidbody_component* rb, const vec3& dir, int maxDist = PX_NB_MAX_RAYCAST_DISTANCE, bool hitTriggers = true, uint32_t layerMask = 0, int maxHits = PX_NB_MAX_RAYCAST_HITS);
@@ -619,10 +686,32 @@ public:
 	}
 
 private:
+	void simulateStep(float stepSize);
+
+	void rebuildWriteback(escene* scene);
+	void markWritebackDirty(entt::registry& registry, entity_handle entity);
+	void disconnectWriteback();
+	void captureActivePoses(PxActor** activeActors, uint32 numActiveActors);
+
 	px_physics* physics = nullptr;
 
 	application* app = nullptr;
 
+	// Dense actor -> transform cache of the writeback. Rebuilt when actors are added or removed, or the scene changes.
+	std::vector<px_actor_writeback> writeback;
+	std::vector<uint32> activeWritebackIndices;
+	uint32 numActiveWritebackIndices = 0;
+	uint32 writebackFrameIndex = 0;
+	escene* writebackScene = nullptr;
+	bool writebackDirty = true;
+
+	float timer = 0.f;
+	uint32 stepIndex = 0;
+
+	// Temporary memory of the simulation. Allocated once and reused by every step.
+	static constexpr uint32 scratchBlockSize = MB(16);
+	void* scratchBlock = nullptr;
+
 	eallocator allocator;
 
 	bool released = false;
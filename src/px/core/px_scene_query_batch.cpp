@@ -0,0 +1,181 @@
+#include "pch.h"
+#include "px/core/px_scene_query_batch.h"
+#include "core/job_system.h"
+#include "core/cpu_profiling.h"
+
+void px_scene_query_batch::initialize(uint32 maxQueries, uint32 maxHitsPerQuery)
+{
+	ASSERT(maxHitsPerQuery > 0 && maxHitsPerQuery <= PX_CONTACT_BUFFER_SIZE);
+
+	this->maxHitsPerQuery = maxHitsPerQuery;
+	queries.resize(maxQueries);
+	numHitsPerQuery.resize(maxQueries);
+	hits.resize(maxQueries * maxHitsPerQuery);
+	numQueries = 0;
+}
+
+uint32 px_scene_query_batch::addQuery(px_scene_query_type type, const PxGeometry* geometry, const PxTransform& pose, const vec3& direction, float maxDistance,
+	bool closestOnly, bool hitTriggers, uint32 layerMask)
+{
+	if (numQueries == (uint32)queries.size())
+		return -1;
+
+	uint32 index = numQueries++;
+
+	query& q = queries[index];
+	q.type = type;
+	q.closestOnly = closestOnly;
+	q.hitTriggers = hitTriggers;
+	q.layerMask = layerMask;
+	if (geometry)
+		q.geometry.storeAny(*geometry);
+	q.pose = pose;
+	q.direction = createPxVec3(direction).getNormalized();
+	q.maxDistance = maxDistance;
+
+	numHitsPerQuery[index] = 0;
+
+	return index;
+}
+
+uint32 px_scene_query_batch::addRaycast(const vec3& origin, const vec3& direction, float maxDistance, bool closestOnly, bool hitTriggers, uint32 layerMask)
+{
+	return addQuery(px_scene_query_type::Raycast, 0, PxTransform(createPxVec3(origin)), direction, maxDistance, closestOnly, hitTriggers, layerMask);
+}
+
+uint32 px_scene_query_batch::addOverlapSphere(const vec3& center, float radius, bool hitTriggers, uint32 layerMask)
+{
+	const PxSphereGeometry geometry(radius);
+	return addQuery(px_scene_query_type::Overlap, &geometry, PxTransform(createPxVec3(center)), vec3(0.f), 0.f, false, hitTriggers, layerMask);
+}
+
+uint32 px_scene_query_batch::addOverlapBox(const vec3& center, const vec3& halfExtents, const quat& rotation, bool hitTriggers, uint32 layerMask)
+{
+	const PxBoxGeometry geometry(createPxVec3(halfExtents));
+	return addQuery(px_scene_query_type::Overlap, &geometry, PxTransform(createPxVec3(center), createPxQuat(rotation)), vec3(0.f), 0.f, false, hitTriggers, layerMask);
+}
+
+uint32 px_scene_query_batch::addOverlapCapsule(const vec3& center, float radius, float halfHeight, const quat& rotation, bool hitTriggers, uint32 layerMask)
+{
+	const PxCapsuleGeometry geometry(radius, halfHeight);
+	return addQuery(px_scene_query_type::Overlap, &geometry, PxTransform(createPxVec3(center), createPxQuat(rotation)), vec3(0.f), 0.f, false, hitTriggers, layerMask);
+}
+
+uint32 px_scene_query_batch::addSweepSphere(const vec3& center, float radius, const vec3& direction, float maxDistance, bool closestOnly, bool hitTriggers, uint32 layerMask)
+{
+	const PxSphereGeometry geometry(radius);
+	return addQuery(px_scene_query_type::Sweep, &geometry, PxTransform(createPxVec3(center)), direction, maxDistance, closestOnly, hitTriggers, layerMask);
+}
+
+uint32 px_scene_query_batch::addSweepBox(const vec3& center, const vec3& halfExtents, const quat& rotation, const vec3& direction, float maxDistance, bool closestOnly, bool hitTriggers, uint32 layerMask)
+{
+	const PxBoxGeometry geometry(createPxVec3(halfExtents));
+	return addQuery(px_scene_query_type::Sweep, &geometry, PxTransform(createPxVec3(center), createPxQuat(rotation)), direction, maxDistance, closestOnly, hitTriggers, layerMask);
+}
+
+uint32 px_scene_query_batch::addSweepCapsule(const vec3& center, float radius, float halfHeight, const quat& rotation, const vec3& direction, float maxDistance, bool closestOnly, bool hitTriggers, uint32 layerMask)
+{
+	const PxCapsuleGeometry geometry(radius, halfHeight);
+	return addQuery(px_scene_query_type::Sweep, &geometry, PxTransform(createPxVec3(center), createPxQuat(rotation)), direction, maxDistance, closestOnly, hitTriggers, layerMask);
+}
+
+// With closestOnly, the query filter turns the hits into blocking hits, so PhysX reports the closest one in buffer.block instead of the touches.
+// Both are read through getAnyHit. getNbAnyHits does not count the blocking hit, so it is added here.
+template <typename hit_t>
+static uint32 collectHits(const DynamicHitBuffer<hit_t>& buffer, px_scene_query_hit* out, uint32 maxHits, bool closestOnly)
+{
+	uint32 numHits = buffer.getNbTouches() + (buffer.hasBlock ? 1 : 0);
+	if (numHits == 0)
+		return 0;
+
+	auto convert = [](const hit_t& hit)
+	{
+		px_scene_query_hit result = {};
+		result.entity = (hit.shape && hit.shape->userData) ? *static_cast<uint32*>(hit.shape->userData) : (uint32)-1;
+
+		if constexpr (std::is_base_of_v<PxLocationHit, hit_t>)
+		{
+			result.distance = hit.distance;
+			result.position = createVec3(hit.position);
+			result.normal = createVec3(hit.normal);
+		}
+		return result;
+	};
+
+	if constexpr (std::is_base_of_v<PxLocationHit, hit_t>)
+	{
+		if (closestOnly)
+		{
+			uint32 closest = 0;
+			for (uint32 i = 1; i < numHits; ++i)
+			{
+				if (buffer.getAnyHit(i).distance < buffer.getAnyHit(closest).distance)
+					closest = i;
+			}
+			out[0] = convert(buffer.getAnyHit(closest));
+			return 1;
+		}
+	}
+
+	numHits = min(numHits, maxHits);
+	for (uint32 i = 0; i < numHits; ++i)
+	{
+		out[i] = convert(buffer.getAnyHit(i));
+	}
+	return numHits;
+}
+
+void px_scene_query_batch::executeQuery(uint32 index, PxScene* scene, PxQueryFilterCallback* queryFilter)
+{
+	const query& q = queries[index];
+	px_scene_query_hit* out = hits.data() + index * maxHitsPerQuery;
+
+	const uint32 layerMask = q.layerMask;
+	const bool hitTriggers = q.hitTriggers;
+	PX_SCENE_QUERY_SETUP(q.closestOnly);
+
+	uint32 numHits = 0;
+	switch (q.type)
+	{
+		case px_scene_query_type::Raycast:
+		{
+			DynamicHitBuffer<PxRaycastHit> buffer;
+			scene->raycast(q.pose.p, q.direction, q.maxDistance, buffer, hitFlags, filterData, queryFilter);
+			numHits = collectHits(buffer, out, maxHitsPerQuery, q.closestOnly);
+		} break;
+		case px_scene_query_type::Overlap:
+		{
+			DynamicHitBuffer<PxOverlapHit> buffer;
+			scene->overlap(q.geometry.any(), q.pose, buffer, filterData, queryFilter);
+			numHits = collectHits(buffer, out, maxHitsPerQuery, false);
+		} break;
+		case px_scene_query_type::Sweep:
+		{
+			DynamicHitBuffer<PxSweepHit> buffer;
+			scene->sweep(q.geometry.any(), q.pose, q.direction, q.maxDistance, buffer, hitFlags, filterData, queryFilter);
+			numHits = collectHits(buffer, out, maxHitsPerQuery, q.closestOnly);
+		} break;
+	}
+
+	numHitsPerQuery[index] = numHits;
+}
+
+void px_scene_query_batch::execute()
+{
+	CPU_PROFILE_BLOCK("PhysX scene query batch");
+
+	px_physics* adapter = px_physics_engine::get()->getPhysicsAdapter();
+	PxScene* scene = adapter->scene;
+	PxQueryFilterCallback* queryFilter = &adapter->queryFilter;
+
+	// Every query writes only its own range of the result arrays.
+	parallelFor(highPriorityJobQueue, numQueries, 32, [this, scene, queryFilter](uint32 begin, uint32 end)
+	{
+		PxSceneReadLock lock(*scene);
+
+		for (uint32 i = begin; i < end; ++i)
+		{
+			executeQuery(i, scene, queryFilter);
+		}
+	});
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "px/core/px_physics_engine.h"
+
+enum class px_scene_query_type : uint8
+{
+	Raycast,
+	Overlap,
+	Sweep
+};
+
+struct px_scene_query_hit
+{
+	uint32 entity; // Handle stored in the shape's userData. -1 if the shape has none.
+	float distance; // Unused for overlaps.
+	vec3 position; // Unused for overlaps.
+	vec3 normal; // Unused for overlaps.
+};
+
+// Collects ray, overlap and sweep queries, executes them in parallel on the job system and returns the hits in flat arrays.
+// All memory is allocated in initialize, so queries can be issued every frame without heap allocations.
+// Filtering (layerMask, hitTriggers) works like in the px_physics_engine query helpers.
+struct px_scene_query_batch
+{
+	px_scene_query_batch() = default;
+	px_scene_query_batch(uint32 maxQueries, uint32 maxHitsPerQuery = 8) { initialize(maxQueries, maxHitsPerQuery); }
+
+	void initialize(uint32 maxQueries, uint32 maxHitsPerQuery = 8);
+
+	// Removes all queries and their results. Keeps the memory.
+	void clear() noexcept { numQueries = 0; }
+
+	// The add functions return the index of the query, or -1 if the batch is full.
+	// If closestOnly is set, a raycast or sweep only reports the closest hit.
+	NODISCARD uint32 addRaycast(const vec3& origin, const vec3& direction, float maxDistance, bool closestOnly = true, bool hitTriggers = false, uint32 layerMask = 0);
+
+	NODISCARD uint32 addOverlapSphere(const vec3& center, float radius, bool hitTriggers = false, uint32 layerMask = 0);
+	NODISCARD uint32 addOverlapBox(const vec3& center, const vec3& halfExtents, const quat& rotation, bool hitTriggers = false, uint32 layerMask = 0);
+	NODISCARD uint32 addOverlapCapsule(const vec3& center, float radius, float halfHeight, const quat& rotation, bool hitTriggers = false, uint32 layerMask = 0);
+
+	NODISCARD uint32 addSweepSphere(const vec3& center, float radius, const vec3& direction, float maxDistance, bool closestOnly = true, bool hitTriggers = false, uint32 layerMask = 0);
+	NODISCARD uint32 addSweepBox(const vec3& center, const vec3& halfExtents, const quat& rotation, const vec3& direction, float maxDistance, bool closestOnly = true, bool hitTriggers = false, uint32 layerMask = 0);
+	NODISCARD uint32 addSweepCapsule(const vec3& center, float radius, float halfHeight, const quat& rotation, const vec3& direction, float maxDistance, bool closestOnly = true, bool hitTriggers = false, uint32 layerMask = 0);
+
+	// Runs all queries against the scene, which is read-locked by every worker. Blocks until all queries are done.
+	// Must not be called while the simulation writes to the scene.
+	void execute();
+
+	NODISCARD uint32 getNumQueries() const noexcept { return numQueries; }
+	NODISCARD uint32 getNumHits(uint32 query) const noexcept { return numHitsPerQuery[query]; }
+	NODISCARD const px_scene_query_hit* getHits(uint32 query) const noexcept { return hits.data() + query * maxHitsPerQuery; }
+
+private:
+	struct query
+	{
+		px_scene_query_type type;
+		bool closestOnly;
+		bool hitTriggers;
+		uint32 layerMask;
+
+		PxGeometryHolder geometry; // Unused for raycasts.
+		PxTransform pose; // Origin of raycasts.
+		PxVec3 direction;
+		float maxDistance;
+	};
+
+	NODISCARD uint32 addQuery(px_scene_query_type type, const PxGeometry* geometry, const PxTransform& pose, const vec3& direction, float maxDistance,
+		bool closestOnly, bool hitTriggers, uint32 layerMask);
+
+	void executeQuery(uint32 index, PxScene* scene, PxQueryFilterCallback* queryFilter);
+
+	std::vector<query> queries;
+	std::vector<uint32> numHitsPerQuery;
+	std::vector<px_scene_query_hit> hits; // maxHitsPerQuery entries per query.
+
+	uint32 numQueries = 0;
+	uint32 maxHitsPerQuery = 0;
+};
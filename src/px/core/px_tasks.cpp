@@ -1,2 +1,21 @@
 #include "pch.h"
-#include "px/core/px_tasks.h"
\ No newline at end of file
+#include "px/core/px_tasks.h"
+
+void px_job_dispatcher::submitTask(physx::PxBaseTask& task)
+{
+	struct px_task_data
+	{
+		physx::PxBaseTask* task;
+	};
+
+	queue.createJob<px_task_data>([](px_task_data& data, job_handle)
+	{
+		data.task->run();
+		data.task->release();
+	}, { &task }).submitNow();
+}
+
+uint32_t px_job_dispatcher::getWorkerCount() const
+{
+	return queue.getNumThreads();
+}
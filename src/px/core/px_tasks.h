@@ -1,47 +1,16 @@
 #pragma once
 
-#include <functional>
 #include "px/core/px_physics_engine.h"
+#include "core/job_system.h"
 
-namespace helper
+// Runs PhysX tasks on the engine's job system instead of a separate PhysX thread pool, so that physics and engine work share the same workers.
+struct px_job_dispatcher : physx::PxCpuDispatcher
 {
-	template <int... Is>
-	struct index {};
+	px_job_dispatcher(job_queue& queue) : queue(queue) {}
 
-	template <int N, int... Is>
-	struct gen_seq : gen_seq<N - 1, N - 1, Is...> {};
-
-	template <int... Is>
-	struct gen_seq<0, Is...> : index<Is...> {};
-}
-
-template<typename Func, typename... Args>
-struct px_task : physx::PxLightCpuTask
-{
-	px_task() = default;
-
-	px_task(std::function<Func(Args...)> f, Args&&... ars)
-		: func(f),
-		args(std::forward<Args>(ars)...) {}
-	~px_task() {}
-
-	virtual const char* getName() const { return "PhysX Task"; }
-	virtual void run() { call(args); }
+	void submitTask(physx::PxBaseTask& task) override;
+	uint32_t getWorkerCount() const override;
 
 private:
-	template <typename... Args, int... Is>
-	void call(std::tuple<Args...>& tup, helper::index<Is...>)
-	{
-		func(std::get<Is>(tup)...);
-	}
-
-	template <typename... Args>
-	void call(std::tuple<Args...>& tup)
-	{
-		call(tup, helper::gen_seq<sizeof...(Args)>{});
-	}
-
-protected:
-	std::tuple<Args...> args;
-	std::function<Func(Args...)> func;
-};
\ No newline at end of file
+	job_queue& queue;
+};
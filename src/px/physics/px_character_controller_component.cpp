@@ -6,9 +6,7 @@ px_capsule_cct_component::px_capsule_cct_component(eentity* entt) noexcept : px_
 {
 	type = px_cct_type::px_capsule;
 	createCharacterController();
-	uint32_t* handle = new uint32_t[1];
-	handle[0] = (uint32_t)entity->handle;
-	controller->getActor()->userData = handle;
+	controller->getActor()->userData = new px_actor_user_data{ (uint32)entity->handle };
 	px_physics_engine::get()->addActor(this, controller->getActor(), false);
 }
 
@@ -44,9 +42,7 @@ px_capsule_cct_component::px_capsule_cct_component(eentity* entt, float h, float
 	mass = m;
 	type = px_cct_type::px_capsule;
 	createCharacterController();
-	uint32_t* handle = new uint32_t[1];
-	handle[0] = (uint32_t)entity->handle;
-	controller->getActor()->userData = handle;
+	controller->getActor()->userData = new px_actor_user_data{ (uint32)entity->handle };
 	px_physics_engine::get()->addActor(this, controller->getActor(), false);
 }
 
@@ -60,9 +56,7 @@ px_box_cct_component::px_box_cct_component(eentity* entt) noexcept : px_cct_comp
 {
 	type = px_cct_type::px_box;
 	createCharacterController();
-	uint32_t* handle = new uint32_t[1];
-	handle[0] = (uint32_t)entity->handle;
-	controller->getActor()->userData = handle;
+	controller->getActor()->userData = new px_actor_user_data{ (uint32)entity->handle };
 	px_physics_engine::get()->addActor(this, controller->getActor(), false);
 }
 
@@ -71,9 +65,7 @@ px_box_cct_component::px_box_cct_component(eentity* entt, float hh, float hs, fl
 	mass = m;
 	type = px_cct_type::px_box;
 	createCharacterController();
-	uint32_t* handle = new uint32_t[1];
-	handle[0] = (uint32_t)entity->handle;
-	controller->getActor()->userData = handle;
+	controller->getActor()->userData = new px_actor_user_data{ (uint32)entity->handle };
 	px_physics_engine::get()->addActor(this, controller->getActor(), false);
 }
 
@@ -122,9 +122,7 @@ void px_rigidbody_component::onCollisionStay(px_rigidbody_component* collision)
 void px_rigidbody_component::createPhysics(bool addToScene)
 {
 	actor = createActor();
-	uint32_t* h = new uint32_t[1];
-	h[0] = (uint32_t)handle;
-	actor->userData = h;
+	actor->userData = new px_actor_user_data{ (uint32)handle };
 
 	px_physics_engine::get()->addActor(this, actor, addToScene);
 
@@ -95,6 +95,8 @@ void escene::cloneTo(escene& target)
 		force_field_component,
 		trigger_component,
 		cloth_component,
+		articulation_component,
+		raycast_vehicle_component,
 		physics_reference_component,
 		sap_endpoint_indirection_component,
 		constraint_entity_reference_component,
@@ -143,7 +145,12 @@ eentity escene::copyEntity(eentity src)
 	for (collider_component& collider : collider_component_iterator(src))
 		dest.addComponent<collider_component>(collider);
 
-	if (auto* c = src.getComponentIfExists<rigid_body_component>()) { dest.addComponent<rigid_body_component>(*c); }
+	if (auto* c = src.getComponentIfExists<rigid_body_component>())
+	{
+		// The copy is not part of the articulation.
+		rigid_body_component& rb = dest.addComponent<rigid_body_component>(*c);
+		rb.articulated = false;
+	}
 	if (auto* c = src.getComponentIfExists<force_field_component>()) { dest.addComponent<force_field_component>(*c); }
 	if (auto* c = src.getComponentIfExists<trigger_component>()) { dest.addComponent<trigger_component>(*c); }
 	if (auto* c = src.getComponentIfExists<cloth_component>()) { dest.addComponent<cloth_component>(*c); }
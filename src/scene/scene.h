@@ -330,7 +330,7 @@ struct eentity
 		return handle != entt::null;
 	}
 
-	inline NODISCARD bool valid() const
+	NODISCARD inline bool valid() const
 	{
 		return registry->valid(handle);
 	}
@@ -355,7 +355,7 @@ struct eentity
 };
 
 template <typename context_t, typename... args>
-inline NODISCARD context_t& createOrGetContextVariable(entt::registry& registry, args&&... a)
+NODISCARD inline context_t& createOrGetContextVariable(entt::registry& registry, args&&... a)
 {
 	auto& c = registry.ctx();
 	context_t* context = c.find<context_t>();
@@ -366,21 +366,21 @@ inline NODISCARD context_t& createOrGetContextVariable(entt::registry& registry,
 }
 
 template <typename context_t>
-inline NODISCARD context_t& getContextVariable(entt::registry& registry)
+NODISCARD inline context_t& getContextVariable(entt::registry& registry)
 {
 	auto& c = registry.ctx();
 	return *c.find<context_t>();
 }
 
 template <typename context_t>
-inline NODISCARD context_t* tryGetContextVariable(entt::registry& registry)
+NODISCARD inline context_t* tryGetContextVariable(entt::registry& registry)
 {
 	auto& c = registry.ctx();
 	return c.find<context_t>();
 }
 
 template <typename context_t>
-inline NODISCARD bool doesContextVariableExist(entt::registry& registry)
+NODISCARD inline bool doesContextVariableExist(entt::registry& registry)
 {
 	auto& c = registry.ctx();
 	return c.contains<context_t>();
@@ -78,6 +78,7 @@ namespace YAML
 			n["Gravity factor"] = c.gravityFactor;
 			n["Linear damping"] = c.linearDamping;
 			n["Angular damping"] = c.angularDamping;
+			n["Continuous collision"] = c.continuousCollision;
 			return n;
 		}
 
@@ -92,6 +93,7 @@ namespace YAML
 			YAML_LOAD(n, c.gravityFactor, "Gravity factor");
 			YAML_LOAD(n, c.linearDamping, "Linear damping");
 			YAML_LOAD(n, c.angularDamping, "Angular damping");
+			YAML_LOAD(n, c.continuousCollision, "Continuous collision");
 
 			return true;
 		}
@@ -15,6 +15,7 @@ typedef void (CORECLR_DELEGATE_CALLTYPE* start_fn)();
 typedef void (CORECLR_DELEGATE_CALLTYPE* scr_fn)();
 typedef void (CORECLR_DELEGATE_CALLTYPE* update_fn)(float);
 typedef void (CORECLR_DELEGATE_CALLTYPE* handle_collisions_fn)(int, int);
+typedef void (CORECLR_DELEGATE_CALLTYPE* handle_collisions_batch_fn)(intptr_t, int);
 typedef void (CORECLR_DELEGATE_CALLTYPE* handle_trs_fn)(intptr_t, int);
 typedef void (CORECLR_DELEGATE_CALLTYPE* handle_input_fn)(intptr_t);
 
@@ -38,6 +39,8 @@ struct enative_scripting_linker
 	void update(float dt);
 
 	void handle_coll(int id1, int id2);
+	// events points to count pairs of 32-bit entity ids.
+	void handle_colls(intptr_t events, int count);
 	void process_trs(intptr_t ptr, int id);
 
 	void init_src();
@@ -11,13 +11,15 @@
 #define TERRAIN_LOD_0_VERTICES_PER_DIMENSION 129u
 #endif
 
+#define HEIGHTMAP_COLLIDER_TRAVERSAL_STACK_SIZE 64
+
 struct heightmap_collider_chunk
 {
 	void setHeights(uint16* heights);
 
 	template <typename callback_func>
 	void iterateTrianglesInVolume(uint32 volMinX, uint32 volMinZ, uint32 volMaxX, uint32 volMaxZ,
-		uint32 volMinY, uint32 volMaxY, float chunkScale, float heightScale, vec3 chunkMinCorner, eallocator& arena, const callback_func& func) const;
+		uint32 volMinY, uint32 volMaxY, float chunkScale, float heightScale, vec3 chunkMinCorner, const callback_func& func) const;
 
 	float getHeightAt(vec2 coord, float heightScale, float heightOffset) const;
 
@@ -34,23 +36,24 @@ private:
 
 template <typename callback_func>
 void heightmap_collider_chunk::iterateTrianglesInVolume(uint32 volMinX, uint32 volMinZ, uint32 volMaxX, uint32 volMaxZ,
-	uint32 volMinY, uint32 volMaxY, float chunkScale, float heightScale, vec3 chunkMinCorner, eallocator& arena, const callback_func& func) const
+	uint32 volMinY, uint32 volMaxY, float chunkScale, float heightScale, vec3 chunkMinCorner, const callback_func& func) const
 {
 	if (!heights)
 		return;
 
-	memory_marker marker = arena.getMarker();
-
 	struct stack_entry
 	{
 		uint16 mipLevel;
 		uint16 x, z;
 	};
 
-	stack_entry* stack = arena.allocate<stack_entry>(1024);
+	// Each level replaces one entry by four, so the stack never holds more than 3 * numMips + 1 entries.
+	// Keeping it local (instead of on an arena) makes the traversal safe to run on multiple threads.
+	stack_entry stack[HEIGHTMAP_COLLIDER_TRAVERSAL_STACK_SIZE];
 	uint32 stackSize = 0;
 
 	uint32 numMips = (uint32)mips.size();
+	ASSERT(3 * numMips + 1 <= HEIGHTMAP_COLLIDER_TRAVERSAL_STACK_SIZE);
 
 	stack[stackSize++] = { (uint16)(numMips - 1), 0, 0 };
 
@@ -109,8 +112,6 @@ void heightmap_collider_chunk::iterateTrianglesInVolume(uint32 volMinX, uint32 v
 			stack[stackSize++] = { (uint16)(entry.mipLevel - 1), (uint16)(2 * entry.x + 1), (uint16)(2 * entry.z + 1) };
 		}
 	}
-
-	arena.resetToMarker(marker);
 }
 
 struct heightmap_collider_component
@@ -120,7 +121,7 @@ struct heightmap_collider_component
 	void update(vec3 minCorner, float amplitudeScale);
 
 	template <typename callback_func>
-	void iterateTrianglesInVolume(bounding_box volume, eallocator& arena, const callback_func& func) const;
+	void iterateTrianglesInVolume(bounding_box volume, const callback_func& func) const;
 
 	float getHeightAt(vec2 coord) const;
 
@@ -142,7 +143,7 @@ private:
 };
 
 template<typename callback_func>
-inline void heightmap_collider_component::iterateTrianglesInVolume(bounding_box volume, eallocator& arena, const callback_func& func) const
+inline void heightmap_collider_component::iterateTrianglesInVolume(bounding_box volume, const callback_func& func) const
 {
 	volume.minCorner -= this->minCorner;
 	volume.maxCorner -= this->minCorner;
@@ -188,7 +189,7 @@ inline void heightmap_collider_component::iterateTrianglesInVolume(bounding_box
 			vec3 chunkMinCorner = vec3(x * chunkSize, 0.f, z * chunkSize) + this->minCorner;
 
 			collider(x, z).iterateTrianglesInVolume(chunkSpaceMinX, chunkSpaceMinZ, chunkSpaceMaxX, chunkSpaceMaxZ, 
-				minHeight, maxHeight, chunkScale, heightScale, chunkMinCorner, arena, func);
+				minHeight, maxHeight, chunkScale, heightScale, chunkMinCorner, func);
 		}
 	}
 }
\ No newline at end of file
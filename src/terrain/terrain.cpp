@@ -323,7 +323,7 @@ struct height_generator_warped : height_generator
 
 		vec3 domainWarpValue = fbm(noiseFunc, fbmPosition + settings.domainWarpNoiseOffset, settings.domainWarpOctaves);
 		float domainWarpHeight = domainWarpValue.x;
-		vec2 J_domainWarpHeight_fbmPosition = domainWarpValue.yz;
+		vec2 J_domainWarpHeight_fbmPosition = vec2(domainWarpValue.y, domainWarpValue.z);
 
 		vec2 warpedFbmPosition = fbmPosition + vec2(domainWarpHeight * settings.domainWarpStrength) + settings.noiseOffset + vec2(1000.f);
 		float J_warpedFbmPosition_fbmPosition = 1.f;
@@ -331,7 +331,7 @@ struct height_generator_warped : height_generator
 
 		vec3 value = fbm(noiseFunc, warpedFbmPosition, settings.noiseOctaves);
 		float height = value.x;
-		vec2 J_height_warpedFbmPosition = value.yz;
+		vec2 J_height_warpedFbmPosition = vec2(value.y, value.z);
 
 		float scaledHeight = height * 0.5f + 0.5f;
 		float J_scaledHeight_height = 0.5f;
@@ -380,11 +380,11 @@ struct height_generator_layered : height_generator
 
 		vec3 value = fbm(noiseFunc, fbmPosition);
 		float height = value.x;
-		vec2 J_height_fbmPosition = value.yz;
+		vec2 J_height_fbmPosition = vec2(value.y, value.z);
 
 		vec3 largeScaleValue = fbm(noiseFunc, largeScaleFbmPosition, 3);
 		float largeScaleHeight = largeScaleValue.x;
-		vec2 J_largeScaleHeight_largeScaleFbmPosition = largeScaleValue.yz;
+		vec2 J_largeScaleHeight_largeScaleFbmPosition = vec2(largeScaleValue.y, largeScaleValue.z);
 
 		float combinedHeight = largeScaleHeight * largeScaleWeight + height * smallScaleWeight;
 		vec2 J_combinedHeight_height = smallScaleWeight;